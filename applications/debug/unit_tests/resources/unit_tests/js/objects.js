@@ -0,0 +1,60 @@
+let tests = require("tests");
+
+// Objects with many properties, read back by long and short names
+let o = {
+    alpha: 1, beta: 2, gamma: 3, delta: 4, epsilon: 5, zeta: 6,
+    eta: 7, theta: 8, iota: 9, kappa: 10, lambda: 11, mu: 12,
+};
+let sum = 0;
+for (let i = 0; i < 100; i++) {
+    sum = sum + o.alpha + o.lambda + o.mu + o.epsilon;
+    o.theta = i;
+}
+tests.assert_eq(2900, sum);
+tests.assert_eq(99, o.theta);
+tests.assert_eq(12, o["m" + "u"]);
+tests.assert_eq(11, o["lamb" + "da"]);
+
+// Same names on different objects must not alias each other
+let a = { longname: "a" };
+let b = { longname: "b" };
+for (let i = 0; i < 10; i++) {
+    tests.assert_eq("a", a.longname);
+    tests.assert_eq("b", b.longname);
+}
+
+// Lots of temporary objects and strings to push the collector around
+let total = 0;
+for (let i = 0; i < 2000; i++) {
+    let suffix = (i % 2 === 0) ? "even" : "odd";
+    let t = { counter: i, payload: "payload_" + suffix };
+    t.extra = t.counter * 2;
+    total = total + t.extra;
+    if (t.payload !== "payload_" + suffix) {
+        tests.assert_eq("payload_" + suffix, t.payload);
+    }
+}
+tests.assert_eq(3998000, total);
+tests.assert_eq(1, o.alpha);
+tests.assert_eq("a", a.longname);
+
+// Removing elements must not leave stale lookups behind
+let arr = [10, 20, 30, 40];
+arr.splice(1, 1);
+tests.assert_eq(3, arr.length);
+tests.assert_eq(30, arr[1]);
+tests.assert_eq(40, arr[2]);
+
+// Globals accessed from a nested function
+let g_first = 1;
+let g_second = 2;
+function nested() {
+    let s = 0;
+    for (let i = 0; i < 100; i++) {
+        s = s + g_first + g_second;
+    }
+    return s;
+}
+tests.assert_eq(300, nested());
+g_second = 5;
+tests.assert_eq(600, nested());
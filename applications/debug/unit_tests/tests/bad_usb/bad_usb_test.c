@@ -0,0 +1,534 @@
+#include <furi.h>
+#include <furi_hal.h>
+
+#include "../test.h" // IWYU pragma: keep
+
+#include <storage/storage.h>
+#include <m-array.h>
+
+// BadUSB is an external app, so its script engine is built into the test
+#include <applications/main/bad_usb/helpers/ducky_script.c>
+#include <applications/main/bad_usb/helpers/ducky_script_commands.c>
+#include <applications/main/bad_usb/helpers/ducky_script_compiler.c>
+#include <applications/main/bad_usb/helpers/ducky_script_keycodes.c>
+
+#define BAD_USB_TEST_DIR_NAME    EXT_PATH(".tmp/unit_tests/bad_usb")
+#define BAD_USB_TEST_SCRIPT_NAME BAD_USB_TEST_DIR_NAME "/script.txt"
+
+#define BAD_USB_TEST_LINE_SIZE (64)
+
+typedef enum {
+    BadUsbTestReportPress,
+    BadUsbTestReportRelease,
+    BadUsbTestReportConsumerPress,
+    BadUsbTestReportConsumerRelease,
+    BadUsbTestReportReleaseAll,
+} BadUsbTestReportType;
+
+typedef struct {
+    BadUsbTestReportType type;
+    uint16_t key;
+} BadUsbTestReport;
+
+ARRAY_DEF(BadUsbTestReportArray, BadUsbTestReport, M_POD_OPLIST);
+
+typedef struct {
+    BadUsbTestReportArray_t reports;
+    BadUsbTestReportArray_t expected;
+    uint8_t led_state;
+} BadUsbTestHid;
+
+static BadUsbTestHid bad_usb_test_hid;
+
+/* Mock HID sink, records every report sent by the script engine */
+
+static void bad_usb_test_report(
+    BadUsbTestReportArray_t reports,
+    BadUsbTestReportType type,
+    uint16_t key) {
+    BadUsbTestReport report = {.type = type, .key = key};
+    BadUsbTestReportArray_push_back(reports, report);
+}
+
+static void* bad_usb_test_hid_init(FuriHalUsbHidConfig* hid_cfg) {
+    UNUSED(hid_cfg);
+    return &bad_usb_test_hid;
+}
+
+static void bad_usb_test_hid_deinit(void* inst) {
+    UNUSED(inst);
+}
+
+static void bad_usb_test_hid_set_state_callback(void* inst, HidStateCallback cb, void* context) {
+    UNUSED(inst);
+    UNUSED(cb);
+    UNUSED(context);
+}
+
+static bool bad_usb_test_hid_is_connected(void* inst) {
+    UNUSED(inst);
+    return true;
+}
+
+static bool bad_usb_test_hid_kb_press(void* inst, uint16_t button) {
+    BadUsbTestHid* hid = inst;
+    bad_usb_test_report(hid->reports, BadUsbTestReportPress, button);
+    return true;
+}
+
+static bool bad_usb_test_hid_kb_release(void* inst, uint16_t button) {
+    BadUsbTestHid* hid = inst;
+    bad_usb_test_report(hid->reports, BadUsbTestReportRelease, button);
+    return true;
+}
+
+static bool bad_usb_test_hid_consumer_press(void* inst, uint16_t button) {
+    BadUsbTestHid* hid = inst;
+    bad_usb_test_report(hid->reports, BadUsbTestReportConsumerPress, button);
+    return true;
+}
+
+static bool bad_usb_test_hid_consumer_release(void* inst, uint16_t button) {
+    BadUsbTestHid* hid = inst;
+    bad_usb_test_report(hid->reports, BadUsbTestReportConsumerRelease, button);
+    return true;
+}
+
+static bool bad_usb_test_hid_release_all(void* inst) {
+    BadUsbTestHid* hid = inst;
+    bad_usb_test_report(hid->reports, BadUsbTestReportReleaseAll, 0);
+    return true;
+}
+
+static uint8_t bad_usb_test_hid_get_led_state(void* inst) {
+    BadUsbTestHid* hid = inst;
+    return hid->led_state;
+}
+
+static const BadUsbHidApi bad_usb_test_hid_api = {
+    .init = bad_usb_test_hid_init,
+    .deinit = bad_usb_test_hid_deinit,
+    .set_state_callback = bad_usb_test_hid_set_state_callback,
+    .is_connected = bad_usb_test_hid_is_connected,
+    .kb_press = bad_usb_test_hid_kb_press,
+    .kb_release = bad_usb_test_hid_kb_release,
+    .consumer_press = bad_usb_test_hid_consumer_press,
+    .consumer_release = bad_usb_test_hid_consumer_release,
+    .release_all = bad_usb_test_hid_release_all,
+    .get_led_state = bad_usb_test_hid_get_led_state,
+};
+
+const BadUsbHidApi* bad_usb_hid_get_interface(BadUsbHidInterface interface) {
+    UNUSED(interface);
+    return &bad_usb_test_hid_api;
+}
+
+/* Expected report stream */
+
+static void bad_usb_test_expect_key(uint16_t key) {
+    bad_usb_test_report(bad_usb_test_hid.expected, BadUsbTestReportPress, key);
+    bad_usb_test_report(bad_usb_test_hid.expected, BadUsbTestReportRelease, key);
+}
+
+static void bad_usb_test_expect_string(const char* text) {
+    for(size_t i = 0; text[i] != '\0'; i++) {
+        uint16_t key = HID_ASCII_TO_KEY(text[i]);
+        if(key != HID_KEYBOARD_NONE) {
+            bad_usb_test_expect_key(key);
+        }
+    }
+}
+
+static void bad_usb_test_expect_altcode(const char* code) {
+    bad_usb_test_report(bad_usb_test_hid.expected, BadUsbTestReportPress, KEY_MOD_LEFT_ALT);
+    for(size_t i = 0; code[i] != '\0'; i++) {
+        bad_usb_test_expect_key(numpad_keys[code[i] - '0']);
+    }
+    bad_usb_test_report(bad_usb_test_hid.expected, BadUsbTestReportRelease, KEY_MOD_LEFT_ALT);
+}
+
+static void bad_usb_test_expect_release_all(void) {
+    bad_usb_test_report(bad_usb_test_hid.expected, BadUsbTestReportReleaseAll, 0);
+}
+
+static bool bad_usb_test_reports_match(void) {
+    size_t expected_count = BadUsbTestReportArray_size(bad_usb_test_hid.expected);
+    size_t count = BadUsbTestReportArray_size(bad_usb_test_hid.reports);
+
+    for(size_t i = 0; i < MIN(count, expected_count); i++) {
+        const BadUsbTestReport* expected =
+            BadUsbTestReportArray_cget(bad_usb_test_hid.expected, i);
+        const BadUsbTestReport* report = BadUsbTestReportArray_cget(bad_usb_test_hid.reports, i);
+        if((report->type != expected->type) || (report->key != expected->key)) {
+            FURI_LOG_E(
+                TAG,
+                "Report %zu: %d:%04X, expected %d:%04X",
+                i,
+                report->type,
+                report->key,
+                expected->type,
+                expected->key);
+            return false;
+        }
+    }
+
+    if(count != expected_count) {
+        FURI_LOG_E(TAG, "%zu reports, expected %zu", count, expected_count);
+        return false;
+    }
+    return true;
+}
+
+/* Script engine driver */
+
+static void bad_usb_test_reset(uint8_t led_state) {
+    BadUsbTestReportArray_reset(bad_usb_test_hid.reports);
+    BadUsbTestReportArray_reset(bad_usb_test_hid.expected);
+    bad_usb_test_hid.led_state = led_state;
+}
+
+static void bad_usb_test_write_script(const char* text) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, BAD_USB_TEST_DIR_NAME);
+    File* file = storage_file_alloc(storage);
+
+    furi_check(storage_file_open(file, BAD_USB_TEST_SCRIPT_NAME, FSAM_WRITE, FSOM_CREATE_ALWAYS));
+    size_t size = strlen(text);
+    furi_check(storage_file_write(file, text, size) == size);
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static BadUsbScript* bad_usb_test_script_alloc(void) {
+    BadUsbScript* bad_usb = malloc(sizeof(BadUsbScript));
+    memset(bad_usb, 0, sizeof(BadUsbScript));
+    bad_usb->hid = bad_usb_hid_get_interface(BadUsbHidInterfaceUsb);
+    bad_usb_script_set_default_keyboard_layout(bad_usb);
+
+    DuckyOpArray_init(bad_usb->ops);
+    DuckyKeyArray_init(bad_usb->keys);
+    DuckyDefineArray_init(bad_usb->defines);
+    return bad_usb;
+}
+
+static void bad_usb_test_script_free(BadUsbScript* bad_usb) {
+    ducky_script_compile_reset(bad_usb);
+    DuckyOpArray_clear(bad_usb->ops);
+    DuckyKeyArray_clear(bad_usb->keys);
+    DuckyDefineArray_clear(bad_usb->defines);
+    free(bad_usb);
+}
+
+// Runs the script the way the worker does, without delays and button waits
+static bool bad_usb_test_run(const char* text, BadUsbState* state) {
+    bad_usb_test_write_script(text);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    furi_check(storage_file_open(file, BAD_USB_TEST_SCRIPT_NAME, FSAM_READ, FSOM_OPEN_EXISTING));
+
+    BadUsbScript* bad_usb = bad_usb_test_script_alloc();
+    bool success = ducky_script_preload(bad_usb, file);
+
+    if(success) {
+        ducky_script_prepare(bad_usb);
+        while(true) {
+            int32_t result = ducky_script_execute_next(bad_usb, file);
+            if(result == SCRIPT_STATE_STRING_START) {
+                bad_usb->string_print_pos = 0;
+                while(!ducky_string_next(bad_usb)) {
+                }
+                bad_usb->stringdelay = 0;
+            } else if((result == SCRIPT_STATE_END) || (result == SCRIPT_STATE_ERROR)) {
+                success = (result == SCRIPT_STATE_END);
+                bad_usb->hid->release_all(bad_usb->hid_inst);
+                break;
+            }
+        }
+    }
+    *state = bad_usb->st;
+
+    bad_usb->hid->deinit(bad_usb->hid_inst);
+    bad_usb_test_script_free(bad_usb);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    return success;
+}
+
+// Adds a line of exactly BAD_USB_TEST_LINE_SIZE bytes, newline included
+static void
+    bad_usb_test_line(FuriString* script, const char* command, char* param, uint32_t seed) {
+    const size_t param_size = BAD_USB_TEST_LINE_SIZE - strlen(command) - 2;
+    for(size_t i = 0; i < param_size; i++) {
+        param[i] = 'a' + (seed + i) % 26;
+    }
+    param[param_size] = '\0';
+    furi_string_cat_printf(script, "%s %s\n", command, param);
+}
+
+MU_TEST(bad_usb_test_string) {
+    BadUsbState state;
+    bad_usb_test_reset(0);
+
+    mu_check(bad_usb_test_run(
+        "STRING Hello, World!\n"
+        "\n"
+        "STRINGLN  two spaces \n"
+        "STRING_DELAY 10\n"
+        "STRING delayed\n"
+        "STRINGLN\n",
+        &state));
+    mu_assert_int_eq(5, state.line_nb);
+
+    bad_usb_test_expect_string("Hello, World!");
+    bad_usb_test_expect_string(" two spaces");
+    bad_usb_test_expect_key(HID_KEYBOARD_RETURN);
+    bad_usb_test_expect_string("delayed");
+    bad_usb_test_expect_key(HID_KEYBOARD_RETURN);
+    bad_usb_test_expect_release_all();
+    mu_check(bad_usb_test_reports_match());
+}
+
+MU_TEST(bad_usb_test_repeat) {
+    BadUsbState state;
+    bad_usb_test_reset(0);
+
+    mu_check(bad_usb_test_run(
+        "REPEAT 3\n"
+        "STRING a\n"
+        "REPEAT 1\n"
+        "REPEAT 2\n"
+        "ENTER\n"
+        "REPEAT 1\n"
+        "CTRL-ALT DELETE\n"
+        "REPEAT 1\n",
+        &state));
+
+    // Nothing to repeat at the start
+    bad_usb_test_expect_string("aaaa");
+    bad_usb_test_expect_key(HID_KEYBOARD_RETURN);
+    bad_usb_test_expect_key(HID_KEYBOARD_RETURN);
+    bad_usb_test_expect_key(KEY_MOD_LEFT_CTRL | KEY_MOD_LEFT_ALT | HID_KEYBOARD_DELETE_FORWARD);
+    bad_usb_test_expect_key(KEY_MOD_LEFT_CTRL | KEY_MOD_LEFT_ALT | HID_KEYBOARD_DELETE_FORWARD);
+    bad_usb_test_expect_release_all();
+    mu_check(bad_usb_test_reports_match());
+
+    // Repeated REPEAT refers to the same op
+    bad_usb_test_write_script("STRING a\nREPEAT 1\nREPEAT 2\nENTER\nREPEAT 4\n");
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    mu_check(storage_file_open(file, BAD_USB_TEST_SCRIPT_NAME, FSAM_READ, FSOM_OPEN_EXISTING));
+    BadUsbScript* bad_usb = bad_usb_test_script_alloc();
+
+    ducky_script_compile_reset(bad_usb);
+    mu_check(ducky_script_compile_next(bad_usb, file, NULL));
+    mu_check(bad_usb->compile_end);
+    mu_assert_int_eq(5, DuckyOpArray_size(bad_usb->ops));
+
+    const DuckyOp* op = DuckyOpArray_cget(bad_usb->ops, 1);
+    mu_assert_int_eq(DuckyOpRepeat, op->type);
+    mu_assert_int_eq(1, op->param);
+    mu_assert_int_eq(0, op->size);
+    op = DuckyOpArray_cget(bad_usb->ops, 2);
+    mu_assert_int_eq(DuckyOpRepeat, op->type);
+    mu_assert_int_eq(2, op->param);
+    mu_assert_int_eq(0, op->size);
+    op = DuckyOpArray_cget(bad_usb->ops, 4);
+    mu_assert_int_eq(DuckyOpRepeat, op->type);
+    mu_assert_int_eq(5, op->line);
+    mu_assert_int_eq(3, op->size);
+
+    bad_usb_test_script_free(bad_usb);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+MU_TEST(bad_usb_test_define) {
+    BadUsbState state;
+    bad_usb_test_reset(0);
+
+    mu_check(bad_usb_test_run(
+        "DEFINE #A a\n"
+        "DEFINE #AB #A b\n"
+        "DEFINE STRING c\n"
+        "DEFINE #KEY x\n"
+        "STRING #AB #A\n"
+        "STRING x#A #A, STRING\n"
+        "CTRL #KEY\n"
+        "DEFINE #A #A z\n"
+        "STRINGLN #A\n",
+        &state));
+    mu_assert_int_eq(9, state.line_nb);
+
+    bad_usb_test_expect_string("a b a");
+    bad_usb_test_expect_string("x#A #A, c");
+    bad_usb_test_expect_key(KEY_MOD_LEFT_CTRL | HID_KEYBOARD_X);
+    bad_usb_test_expect_string("a z");
+    bad_usb_test_expect_key(HID_KEYBOARD_RETURN);
+    bad_usb_test_expect_release_all();
+    mu_check(bad_usb_test_reports_match());
+}
+
+MU_TEST(bad_usb_test_altstring) {
+    BadUsbState state;
+    bad_usb_test_reset(HID_KB_LED_NUM);
+
+    mu_check(bad_usb_test_run("ALTSTRING A 1\n", &state));
+    bad_usb_test_expect_altcode("65");
+    bad_usb_test_expect_altcode("32");
+    bad_usb_test_expect_altcode("49");
+    bad_usb_test_expect_release_all();
+    mu_check(bad_usb_test_reports_match());
+
+    // Num Lock is switched on first
+    bad_usb_test_reset(0);
+    mu_check(bad_usb_test_run("ALTCHAR 97\nREPEAT 1\n", &state));
+    for(size_t i = 0; i < 2; i++) {
+        bad_usb_test_expect_key(HID_KEYBOARD_LOCK_NUM_LOCK);
+        bad_usb_test_expect_altcode("97");
+    }
+    bad_usb_test_expect_release_all();
+    mu_check(bad_usb_test_reports_match());
+
+    mu_check(!bad_usb_test_run("ALTSTRING\n", &state));
+    mu_assert_int_eq(1, state.error_line);
+}
+
+MU_TEST(bad_usb_test_window) {
+    const size_t window_lines = DUCKY_COMPILE_WINDOW / BAD_USB_TEST_LINE_SIZE;
+    char line[BAD_USB_TEST_LINE_SIZE];
+    FuriString* script = furi_string_alloc();
+    bad_usb_test_reset(0);
+
+    // Last line of the first window is repeated from the second one
+    for(size_t i = 0; i < window_lines - 1; i++) {
+        bad_usb_test_line(script, "REM", line, i);
+    }
+    bad_usb_test_line(script, "STRING", line, window_lines);
+    furi_string_cat_str(script, "REPEAT 2\nREPEAT 1\nSTRINGLN end\n");
+    for(size_t i = 0; i < 4; i++) {
+        bad_usb_test_expect_string(line);
+    }
+    bad_usb_test_expect_string("end");
+    bad_usb_test_expect_key(HID_KEYBOARD_RETURN);
+
+    // Line longer than the window
+    furi_string_cat_str(script, "REM ");
+    for(size_t i = 0; i < DUCKY_COMPILE_WINDOW + 100; i++) {
+        furi_string_push_back(script, '0' + i % 10);
+    }
+    furi_string_cat_str(script, "\nSTRING 0123456789\n");
+    bad_usb_test_expect_string("0123456789");
+    bad_usb_test_expect_release_all();
+
+    BadUsbState state;
+    mu_check(bad_usb_test_run(furi_string_get_cstr(script), &state));
+    mu_assert_int_eq(window_lines + 5, state.line_nb);
+    mu_check(bad_usb_test_reports_match());
+
+    // Op stream of the first two windows
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    mu_check(storage_file_open(file, BAD_USB_TEST_SCRIPT_NAME, FSAM_READ, FSOM_OPEN_EXISTING));
+    BadUsbScript* bad_usb = bad_usb_test_script_alloc();
+
+    ducky_script_compile_reset(bad_usb);
+    mu_check(ducky_script_compile_next(bad_usb, file, NULL));
+    mu_check(!bad_usb->compile_end);
+    mu_assert_int_eq(window_lines, bad_usb->compile_line);
+    mu_assert_int_eq(window_lines, DuckyOpArray_size(bad_usb->ops));
+
+    mu_check(ducky_script_compile_next(bad_usb, file, NULL));
+    mu_assert_int_eq(window_lines + 3, bad_usb->compile_line);
+    mu_assert_int_eq(4, DuckyOpArray_size(bad_usb->ops));
+    mu_assert_int_eq(1, bad_usb->op_next);
+
+    const DuckyOp* op = DuckyOpArray_cget(bad_usb->ops, 0);
+    mu_assert_int_eq(DuckyOpString, op->type);
+    mu_assert_int_eq(window_lines, op->line);
+    mu_assert_int_eq(0, op->param);
+    mu_assert_int_eq(strlen(line), op->size);
+    for(size_t i = 0; i < op->size; i++) {
+        mu_assert_int_eq(HID_ASCII_TO_KEY(line[i]), *DuckyKeyArray_cget(bad_usb->keys, i));
+    }
+    for(size_t i = 1; i < 3; i++) {
+        op = DuckyOpArray_cget(bad_usb->ops, i);
+        mu_assert_int_eq(DuckyOpRepeat, op->type);
+        mu_assert_int_eq(3 - i, op->param);
+        mu_assert_int_eq(0, op->size);
+    }
+
+    bad_usb_test_script_free(bad_usb);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(script);
+}
+
+MU_TEST(bad_usb_test_error_line) {
+    BadUsbState state;
+    bad_usb_test_reset(0);
+
+    // Compile errors are found before anything is sent
+    mu_check(!bad_usb_test_run("STRING ok\nREM fine\nFOO bar\nSTRING never\n", &state));
+    mu_assert_int_eq(3, state.error_line);
+    mu_assert_string_eq("No keycode defined for FOO bar", state.error);
+    mu_assert_int_eq(0, BadUsbTestReportArray_size(bad_usb_test_hid.reports));
+
+    mu_check(!bad_usb_test_run("DEFINE #D 0\nDELAY #D\n", &state));
+    mu_assert_int_eq(2, state.error_line);
+
+    // Keyword is never replaced by a define
+    mu_check(!bad_usb_test_run("DEFINE DELAY STRING\nDELAY 10\nDELAY text\n", &state));
+    mu_assert_int_eq(3, state.error_line);
+
+    FuriString* script = furi_string_alloc();
+    char line[BAD_USB_TEST_LINE_SIZE];
+    for(size_t i = 0; i < 40; i++) {
+        bad_usb_test_line(script, "REM", line, i);
+    }
+    furi_string_cat_str(script, "REPEAT x\n");
+    mu_check(!bad_usb_test_run(furi_string_get_cstr(script), &state));
+    mu_assert_int_eq(41, state.error_line);
+    furi_string_free(script);
+
+    // Runtime errors stop the script at the failing line
+    bad_usb_test_reset(0);
+    mu_check(!bad_usb_test_run("STRING a\nRELEASE CTRL\nSTRING b\n", &state));
+    mu_assert_int_eq(2, state.error_line);
+    mu_assert_string_eq("No keys are hold", state.error);
+    bad_usb_test_expect_string("a");
+    bad_usb_test_expect_release_all();
+    mu_check(bad_usb_test_reports_match());
+}
+
+MU_TEST_SUITE(test_bad_usb_suite) {
+    BadUsbTestReportArray_init(bad_usb_test_hid.reports);
+    BadUsbTestReportArray_init(bad_usb_test_hid.expected);
+
+    MU_RUN_TEST(bad_usb_test_string);
+    MU_RUN_TEST(bad_usb_test_repeat);
+    MU_RUN_TEST(bad_usb_test_define);
+    MU_RUN_TEST(bad_usb_test_altstring);
+    MU_RUN_TEST(bad_usb_test_window);
+    MU_RUN_TEST(bad_usb_test_error_line);
+
+    BadUsbTestReportArray_clear(bad_usb_test_hid.reports);
+    BadUsbTestReportArray_clear(bad_usb_test_hid.expected);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_remove_recursive(storage, BAD_USB_TEST_DIR_NAME);
+    furi_record_close(RECORD_STORAGE);
+}
+
+int run_minunit_test_bad_usb(void) {
+    MU_RUN_SUITE(test_bad_usb_suite);
+    return MU_EXIT_CODE;
+}
+
+TEST_API_DEFINE(run_minunit_test_bad_usb)
@@ -79,6 +79,33 @@ MU_TEST(test_bit_lib_push) {
     mu_assert_mem_eq(expected_data_6, data, TEST_BIT_LIB_PUSH_DATA_SIZE);
 }
 
+MU_TEST(test_bit_lib_ring_push) {
+#define TEST_BIT_LIB_RING_DATA_SIZE 5
+    uint8_t data[TEST_BIT_LIB_RING_DATA_SIZE] = {0};
+    BitLibRing* ring = bit_lib_ring_alloc(TEST_BIT_LIB_RING_DATA_SIZE * 8);
+
+    for(uint32_t i = 0; i < TEST_BIT_LIB_RING_DATA_SIZE * 8 * 3; ++i) {
+        // irregular pattern, so that misplaced window shows up
+        bool bit = (i % 3 == 0) || (i % 7 == 0);
+        bit_lib_push_bit(data, TEST_BIT_LIB_RING_DATA_SIZE, bit);
+        bit_lib_ring_push_bit(ring, bit);
+
+        size_t position;
+        const uint8_t* ring_data = bit_lib_ring_get_data(ring, &position);
+        mu_assert_int_eq(
+            bit_lib_get_bits_32(data, 0, 32), bit_lib_get_bits_32(ring_data, position, 32));
+        mu_assert_int_eq(
+            bit_lib_get_bits(data, 32, 8), bit_lib_get_bits(ring_data, position + 32, 8));
+    }
+
+    bit_lib_ring_reset(ring);
+    size_t position;
+    const uint8_t* ring_data = bit_lib_ring_get_data(ring, &position);
+    mu_assert_int_eq(0, bit_lib_get_bits_32(ring_data, position, 32));
+
+    bit_lib_ring_free(ring);
+}
+
 MU_TEST(test_bit_lib_set_bit) {
     uint8_t value[2] = {0x00, 0xFF};
     bit_lib_set_bit(value, 15, false);
@@ -712,6 +739,7 @@ MU_TEST_SUITE(test_bit_lib) {
     MU_RUN_TEST(test_bit_lib_increment_index);
     MU_RUN_TEST(test_bit_lib_is_set);
     MU_RUN_TEST(test_bit_lib_push);
+    MU_RUN_TEST(test_bit_lib_ring_push);
     MU_RUN_TEST(test_bit_lib_set_bit);
     MU_RUN_TEST(test_bit_lib_set_bits);
     MU_RUN_TEST(test_bit_lib_get_bit);
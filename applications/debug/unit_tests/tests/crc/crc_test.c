@@ -0,0 +1,477 @@
+#include <furi.h>
+#include <furi_hal.h>
+
+#include "../test.h" // IWYU pragma: keep
+
+#include <toolbox/crc.h>
+#include <toolbox/crc32_calc.h>
+#include <bit_lib/bit_lib.h>
+#include <nfc/helpers/iso14443_crc.h>
+#include <nfc/helpers/iso13239_crc.h>
+#include <storage/storage.h>
+
+#define CRC_TEST_DIR_NAME  EXT_PATH(".tmp/unit_tests/crc")
+#define CRC_TEST_FILE_NAME CRC_TEST_DIR_NAME "/data.bin"
+
+#define CRC_TEST_BUFFER_SIZE (1024)
+#define CRC_TEST_ROUNDS      (200)
+
+static const uint8_t crc_test_check_data[] = "123456789";
+#define CRC_TEST_CHECK_SIZE (sizeof(crc_test_check_data) - 1)
+
+static uint32_t crc_test_random_state;
+
+static uint32_t crc_test_random(void) {
+    // xorshift32, fixed seed keeps failures reproducible
+    crc_test_random_state ^= crc_test_random_state << 13;
+    crc_test_random_state ^= crc_test_random_state >> 17;
+    crc_test_random_state ^= crc_test_random_state << 5;
+    return crc_test_random_state;
+}
+
+static void crc_test_random_fill(uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        data[i] = crc_test_random();
+    }
+}
+
+/* Reference implementations, as they were before the shared engine */
+
+static uint32_t crc_test_reference_crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    static const uint32_t rtable[16] = {
+        0x00000000,
+        0x1db71064,
+        0x3b6e20c8,
+        0x26d930ac,
+        0x76dc4190,
+        0x6b6b51f4,
+        0x4db26158,
+        0x5005713c,
+        0xedb88320,
+        0xf00f9344,
+        0xd6d6a3e8,
+        0xcb61b38c,
+        0x9b64c2b0,
+        0x86d3d2d4,
+        0xa00ae278,
+        0xbdbdf21c,
+    };
+
+    crc = ~crc;
+    for(size_t i = 0; i < size; i++) {
+        crc = (crc >> 4) ^ rtable[(crc ^ (data[i] >> 0)) & 0xf];
+        crc = (crc >> 4) ^ rtable[(crc ^ (data[i] >> 4)) & 0xf];
+    }
+
+    return ~crc;
+}
+
+static uint16_t crc_test_reference_iso14443(bool type_a, const uint8_t* data, size_t size) {
+    uint16_t crc = type_a ? 0x6363 : 0xFFFF;
+
+    for(size_t i = 0; i < size; i++) {
+        uint8_t byte = data[i];
+        byte ^= (uint8_t)(crc & 0xff);
+        byte ^= byte << 4;
+        crc = (crc >> 8) ^ (((uint16_t)byte) << 8) ^ (((uint16_t)byte) << 3) ^ (byte >> 4);
+    }
+
+    return type_a ? crc : ~crc;
+}
+
+static uint16_t crc_test_reference_iso13239(bool picopass, const uint8_t* data, size_t size) {
+    uint16_t crc = picopass ? 0xE012 : 0xFFFF;
+
+    for(size_t i = 0; i < size; ++i) {
+        crc ^= (uint16_t)data[i];
+        for(size_t j = 0; j < 8; ++j) {
+            if(crc & 1U) {
+                crc = (crc >> 1) ^ 0x8408;
+            } else {
+                crc >>= 1;
+            }
+        }
+    }
+
+    return picopass ? crc : ~crc;
+}
+
+static uint16_t crc_test_reference_xmodem(const uint8_t* data, size_t size) {
+    uint16_t crc = 0x0000;
+
+    for(size_t i = 0; i < size; i++) {
+        crc ^= ((uint16_t)data[i] << 8);
+        for(size_t j = 0; j < 8; j++) {
+            if(crc & 0x8000) {
+                crc = (crc << 1) ^ 0x1021;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+
+    return crc;
+}
+
+static uint8_t crc_test_reference_reverse_8(uint8_t byte) {
+    uint8_t result = 0;
+    for(uint8_t i = 0; i < 8; i++) {
+        result = (result << 1) | ((byte >> i) & 1);
+    }
+    return result;
+}
+
+static uint16_t crc_test_reference_reverse_16(uint16_t value) {
+    return (crc_test_reference_reverse_8(value) << 8) | crc_test_reference_reverse_8(value >> 8);
+}
+
+static uint8_t crc_test_reference_crc8(
+    const uint8_t* data,
+    size_t size,
+    uint8_t polynom,
+    uint8_t init,
+    bool ref_in,
+    bool ref_out,
+    uint8_t xor_out) {
+    uint8_t crc = init;
+
+    for(size_t i = 0; i < size; ++i) {
+        uint8_t byte = data[i];
+        if(ref_in) byte = crc_test_reference_reverse_8(byte);
+        crc ^= byte;
+
+        for(size_t j = 8; j > 0; --j) {
+            if(crc & 0x80) {
+                crc = (crc << 1) ^ polynom;
+            } else {
+                crc = (crc << 1);
+            }
+        }
+    }
+
+    if(ref_out) crc = crc_test_reference_reverse_8(crc);
+    return crc ^ xor_out;
+}
+
+static uint16_t crc_test_reference_crc16(
+    const uint8_t* data,
+    size_t size,
+    uint16_t polynom,
+    uint16_t init,
+    bool ref_in,
+    bool ref_out,
+    uint16_t xor_out) {
+    uint16_t crc = init;
+
+    for(size_t i = 0; i < size; ++i) {
+        uint8_t byte = data[i];
+        if(ref_in) byte = crc_test_reference_reverse_8(byte);
+
+        for(size_t j = 0; j < 8; ++j) {
+            bool c15 = (crc >> 15 & 1);
+            bool bit = (byte >> (7 - j) & 1);
+            crc <<= 1;
+            if(c15 ^ bit) crc ^= polynom;
+        }
+    }
+
+    if(ref_out) crc = crc_test_reference_reverse_16(crc);
+    return crc ^ xor_out;
+}
+
+/* Models without lookup tables, calculated bit by bit */
+
+static const CrcModel crc_test_model_crc8_maxim = {
+    .width = 8,
+    .polynomial = 0x31,
+    .init = 0x00,
+    .reflect_in = true,
+    .reflect_out = true,
+    .xor_out = 0x00,
+};
+
+static const CrcModel crc_test_model_crc8_smbus = {
+    .width = 8,
+    .polynomial = 0x07,
+    .init = 0x00,
+    .reflect_in = false,
+    .reflect_out = false,
+    .xor_out = 0x00,
+};
+
+static const CrcModel crc_test_model_crc12_umts = {
+    .width = 12,
+    .polynomial = 0x80F,
+    .init = 0x000,
+    .reflect_in = false,
+    .reflect_out = true,
+    .xor_out = 0x000,
+};
+
+static const CrcModel crc_test_model_crc16_modbus = {
+    .width = 16,
+    .polynomial = 0x8005,
+    .init = 0xFFFF,
+    .reflect_in = true,
+    .reflect_out = true,
+    .xor_out = 0x0000,
+};
+
+static const CrcModel crc_test_model_crc16_genibus = {
+    .width = 16,
+    .polynomial = 0x1021,
+    .init = 0xFFFF,
+    .reflect_in = false,
+    .reflect_out = false,
+    .xor_out = 0xFFFF,
+};
+
+static const CrcModel crc_test_model_crc24_openpgp = {
+    .width = 24,
+    .polynomial = 0x864CFB,
+    .init = 0xB704CE,
+    .reflect_in = false,
+    .reflect_out = false,
+    .xor_out = 0x000000,
+};
+
+static const CrcModel crc_test_model_crc32_bzip2 = {
+    .width = 32,
+    .polynomial = 0x04C11DB7,
+    .init = 0xFFFFFFFF,
+    .reflect_in = false,
+    .reflect_out = false,
+    .xor_out = 0xFFFFFFFF,
+};
+
+typedef struct {
+    const CrcModel* model;
+    uint32_t check;
+} CrcTestCheck;
+
+static const CrcTestCheck crc_test_checks[] = {
+    {&crc_model_crc32, 0xCBF43926},
+    {&crc_model_crc16_iso14443a, 0xBF05},
+    {&crc_model_crc16_x25, 0x906E},
+    {&crc_model_crc16_picopass, 0x5D04},
+    {&crc_model_crc16_xmodem, 0x31C3},
+    {&crc_test_model_crc8_maxim, 0xA1},
+    {&crc_test_model_crc8_smbus, 0xF4},
+    {&crc_test_model_crc12_umts, 0xDAF},
+    {&crc_test_model_crc16_modbus, 0x4B37},
+    {&crc_test_model_crc16_genibus, 0xD64E},
+    {&crc_test_model_crc24_openpgp, 0x21CF02},
+    {&crc_test_model_crc32_bzip2, 0xFC891918},
+};
+
+MU_TEST(crc_test_check_values) {
+    for(size_t i = 0; i < COUNT_OF(crc_test_checks); i++) {
+        const CrcTestCheck* check = &crc_test_checks[i];
+        mu_assert_int_eq(
+            check->check,
+            crc_calculate(check->model, crc_test_check_data, CRC_TEST_CHECK_SIZE));
+    }
+
+    // empty input gives the init value passed through the output stage
+    mu_assert_int_eq(0x00000000, crc_calculate(&crc_model_crc32, crc_test_check_data, 0));
+    mu_assert_int_eq(0x6363, crc_calculate(&crc_model_crc16_iso14443a, crc_test_check_data, 0));
+}
+
+MU_TEST(crc_test_reference_vectors) {
+    uint8_t* data = malloc(CRC_TEST_BUFFER_SIZE);
+    crc_test_random_state = 0x12345678;
+
+    for(size_t round = 0; round < CRC_TEST_ROUNDS; round++) {
+        const size_t size = crc_test_random() % CRC_TEST_BUFFER_SIZE;
+        crc_test_random_fill(data, size);
+
+        mu_assert_int_eq(
+            crc_test_reference_crc32(0, data, size),
+            crc_calculate(&crc_model_crc32, data, size));
+        mu_assert_int_eq(
+            crc_test_reference_iso14443(true, data, size),
+            crc_calculate(&crc_model_crc16_iso14443a, data, size));
+        mu_assert_int_eq(
+            crc_test_reference_iso14443(false, data, size),
+            crc_calculate(&crc_model_crc16_x25, data, size));
+        mu_assert_int_eq(
+            crc_test_reference_iso13239(false, data, size),
+            crc_calculate(&crc_model_crc16_x25, data, size));
+        mu_assert_int_eq(
+            crc_test_reference_iso13239(true, data, size),
+            crc_calculate(&crc_model_crc16_picopass, data, size));
+        mu_assert_int_eq(
+            crc_test_reference_xmodem(data, size),
+            crc_calculate(&crc_model_crc16_xmodem, data, size));
+    }
+
+    free(data);
+}
+
+MU_TEST(crc_test_bit_lib) {
+    uint8_t data[64];
+    crc_test_random_state = 0x9E3779B9;
+
+    for(size_t round = 0; round < CRC_TEST_ROUNDS; round++) {
+        const size_t size = crc_test_random() % sizeof(data);
+        crc_test_random_fill(data, size);
+
+        // any polynomial and init, every reflection combination
+        const uint32_t params = crc_test_random();
+        const bool ref_in = params & 1;
+        const bool ref_out = params & 2;
+        const uint16_t polynom = (params >> 8) | 1;
+        const uint16_t init = crc_test_random();
+        const uint16_t xor_out = crc_test_random();
+
+        mu_assert_int_eq(
+            crc_test_reference_crc8(data, size, polynom, init, ref_in, ref_out, xor_out),
+            bit_lib_crc8(data, size, polynom, init, ref_in, ref_out, xor_out));
+        mu_assert_int_eq(
+            crc_test_reference_crc16(data, size, polynom, init, ref_in, ref_out, xor_out),
+            bit_lib_crc16(data, size, polynom, init, ref_in, ref_out, xor_out));
+    }
+}
+
+MU_TEST(crc_test_nfc_helpers) {
+    uint8_t data[32];
+    BitBuffer* buffer = bit_buffer_alloc(sizeof(data) + 2);
+    crc_test_random_state = 0xC0FFEE01;
+
+    for(size_t round = 0; round < CRC_TEST_ROUNDS; round++) {
+        const size_t size = 1 + crc_test_random() % (sizeof(data) - 1);
+        crc_test_random_fill(data, size);
+
+        bit_buffer_copy_bytes(buffer, data, size);
+        iso14443_crc_append(Iso14443CrcTypeA, buffer);
+        uint16_t crc = crc_test_reference_iso14443(true, data, size);
+        mu_assert_int_eq(crc & 0xFF, bit_buffer_get_byte(buffer, size));
+        mu_assert_int_eq(crc >> 8, bit_buffer_get_byte(buffer, size + 1));
+        mu_check(iso14443_crc_check(Iso14443CrcTypeA, buffer));
+
+        bit_buffer_copy_bytes(buffer, data, size);
+        iso14443_crc_append(Iso14443CrcTypeB, buffer);
+        crc = crc_test_reference_iso14443(false, data, size);
+        mu_assert_int_eq(crc & 0xFF, bit_buffer_get_byte(buffer, size));
+        mu_assert_int_eq(crc >> 8, bit_buffer_get_byte(buffer, size + 1));
+        mu_check(iso14443_crc_check(Iso14443CrcTypeB, buffer));
+
+        bit_buffer_copy_bytes(buffer, data, size);
+        iso13239_crc_append(Iso13239CrcTypePicopass, buffer);
+        crc = crc_test_reference_iso13239(true, data, size);
+        mu_assert_int_eq(crc & 0xFF, bit_buffer_get_byte(buffer, size));
+        mu_assert_int_eq(crc >> 8, bit_buffer_get_byte(buffer, size + 1));
+        mu_check(iso13239_crc_check(Iso13239CrcTypePicopass, buffer));
+    }
+
+    bit_buffer_free(buffer);
+}
+
+MU_TEST(crc_test_streaming) {
+    static const CrcModel* const models[] = {
+        &crc_model_crc32,
+        &crc_model_crc16_iso14443a,
+        &crc_model_crc16_x25,
+        &crc_model_crc16_picopass,
+        &crc_model_crc16_xmodem,
+        &crc_test_model_crc8_maxim,
+        &crc_test_model_crc12_umts,
+        &crc_test_model_crc16_genibus,
+        &crc_test_model_crc24_openpgp,
+        &crc_test_model_crc32_bzip2,
+    };
+
+    uint8_t* data = malloc(CRC_TEST_BUFFER_SIZE);
+    crc_test_random_state = 0xDEADBEEF;
+
+    for(size_t round = 0; round < CRC_TEST_ROUNDS / 4; round++) {
+        const size_t size = crc_test_random() % CRC_TEST_BUFFER_SIZE;
+        crc_test_random_fill(data, size);
+
+        for(size_t i = 0; i < COUNT_OF(models); i++) {
+            const CrcModel* model = models[i];
+            const uint32_t expected = crc_calculate(model, data, size);
+
+            // random chunk sizes, including empty and unaligned ones
+            CrcContext context;
+            crc_init(&context, model);
+            for(size_t offset = 0; offset < size;) {
+                const size_t chunk_size = crc_test_random() % 37;
+                const size_t chunk = MIN(size - offset, chunk_size);
+                crc_update(&context, data + offset, chunk);
+                offset += chunk;
+
+                // finish does not modify the context
+                if(offset == size / 2) {
+                    mu_assert_int_eq(
+                        crc_calculate(model, data, offset), crc_finish(&context));
+                }
+            }
+            mu_assert_int_eq(expected, crc_finish(&context));
+
+            // continue from a finished value
+            if(model->reflect_in == model->reflect_out) {
+                const size_t split = size ? crc_test_random() % size : 0;
+                crc_init(&context, model);
+                crc_update(&context, data, split);
+                const uint32_t partial = crc_finish(&context);
+
+                crc_resume(&context, model, partial);
+                crc_update(&context, data + split, size - split);
+                mu_assert_int_eq(expected, crc_finish(&context));
+            }
+        }
+
+        // crc32_calc_buffer chaining, as used by DFU and updater
+        const size_t split = size ? crc_test_random() % size : 0;
+        uint32_t crc = crc32_calc_buffer(0, data, split);
+        mu_assert_int_eq(crc_test_reference_crc32(0, data, split), crc);
+        crc = crc32_calc_buffer(crc, data + split, size - split);
+        mu_assert_int_eq(crc_test_reference_crc32(0, data, size), crc);
+    }
+
+    free(data);
+}
+
+MU_TEST(crc_test_file) {
+    const size_t size = 3 * 4096 + 123;
+    uint8_t* data = malloc(size);
+    crc_test_random_state = 0x0BADF00D;
+    crc_test_random_fill(data, size);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, CRC_TEST_DIR_NAME);
+    File* file = storage_file_alloc(storage);
+
+    mu_check(storage_file_open(file, CRC_TEST_FILE_NAME, FSAM_READ_WRITE, FSOM_CREATE_ALWAYS));
+    mu_assert_int_eq(size, storage_file_write(file, data, size));
+
+    const uint32_t expected = crc_test_reference_crc32(0, data, size);
+    mu_assert_int_eq(expected, crc32_calc_file(file, NULL, NULL));
+    mu_assert_int_eq(expected, crc_calculate_file(&crc_model_crc32, file, NULL, NULL));
+    mu_assert_int_eq(
+        crc_test_reference_xmodem(data, size),
+        crc_calculate_file(&crc_model_crc16_xmodem, file, NULL, NULL));
+
+    storage_file_close(file);
+    storage_file_free(file);
+    storage_simply_remove_recursive(storage, CRC_TEST_DIR_NAME);
+    furi_record_close(RECORD_STORAGE);
+    free(data);
+}
+
+MU_TEST_SUITE(test_crc_suite) {
+    MU_RUN_TEST(crc_test_check_values);
+    MU_RUN_TEST(crc_test_reference_vectors);
+    MU_RUN_TEST(crc_test_bit_lib);
+    MU_RUN_TEST(crc_test_nfc_helpers);
+    MU_RUN_TEST(crc_test_streaming);
+    MU_RUN_TEST(crc_test_file);
+}
+
+int run_minunit_test_crc(void) {
+    MU_RUN_SUITE(test_crc_suite);
+    return MU_EXIT_CODE;
+}
+
+TEST_API_DEFINE(run_minunit_test_crc)
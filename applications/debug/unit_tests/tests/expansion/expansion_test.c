@@ -4,9 +4,10 @@
 #include <furi_hal_random.h>
 
 #include <expansion/expansion_protocol.h>
+#include <expansion/expansion_protocol_window.h>
 
 #define EXPANSION_TEST_GARBAGE_MAGIC      (0xB19AF)
-#define EXPANSION_TEST_GARBAGE_BUF_SIZE   (0x100U)
+#define EXPANSION_TEST_GARBAGE_BUF_SIZE   (sizeof(ExpansionFrame))
 #define EXPANSION_TEST_GARBAGE_ITERATIONS (100U)
 
 MU_TEST(test_expansion_encoded_size) {
@@ -29,6 +30,15 @@ MU_TEST(test_expansion_encoded_size) {
         frame.content.data.size = i;
         mu_assert_int_eq(i + 2, expansion_frame_get_encoded_size(&frame));
     }
+
+    frame.header.type = ExpansionFrameTypeWindowData;
+    for(size_t i = 1; i <= EXPANSION_PROTOCOL_WINDOW_DATA_SIZE; ++i) {
+        frame.content.window_data.size = i;
+        mu_assert_int_eq(i + 6, expansion_frame_get_encoded_size(&frame));
+    }
+
+    frame.header.type = ExpansionFrameTypeWindowAck;
+    mu_assert_int_eq(3, expansion_frame_get_encoded_size(&frame));
 }
 
 MU_TEST(test_expansion_remaining_size) {
@@ -90,6 +100,123 @@ MU_TEST(test_expansion_remaining_size) {
     }
     mu_check(expansion_frame_get_remaining_size(&frame, 100, &remaining_size));
     mu_assert_int_eq(0, remaining_size);
+
+    frame.header.type = ExpansionFrameTypeWindowData;
+    frame.content.window_data.size = EXPANSION_PROTOCOL_WINDOW_DATA_SIZE;
+    mu_check(expansion_frame_get_remaining_size(&frame, 1, &remaining_size));
+    mu_assert_int_eq(3, remaining_size);
+    mu_check(expansion_frame_get_remaining_size(&frame, 4, &remaining_size));
+    mu_assert_int_eq(EXPANSION_PROTOCOL_WINDOW_DATA_SIZE + 2, remaining_size);
+    mu_check(expansion_frame_get_remaining_size(&frame, 300, &remaining_size));
+    mu_assert_int_eq(0, remaining_size);
+    frame.content.window_data.size = 0;
+    mu_check(!expansion_frame_get_remaining_size(&frame, 4, &remaining_size));
+    frame.content.window_data.size = EXPANSION_PROTOCOL_WINDOW_DATA_SIZE + 1;
+    mu_check(!expansion_frame_get_remaining_size(&frame, 4, &remaining_size));
+
+    frame.header.type = ExpansionFrameTypeWindowAck;
+    mu_check(expansion_frame_get_remaining_size(&frame, 1, &remaining_size));
+    mu_assert_int_eq(2, remaining_size);
+    mu_check(expansion_frame_get_remaining_size(&frame, 3, &remaining_size));
+    mu_assert_int_eq(0, remaining_size);
+}
+
+MU_TEST(test_expansion_crc) {
+    const char check[] = "123456789";
+    mu_assert_int_eq(
+        0x29B1, expansion_protocol_update_crc(0xFFFFU, (const uint8_t*)check, strlen(check)));
+
+    ExpansionFrame frame = {
+        .header.type = ExpansionFrameTypeWindowData,
+        .content.window_data.seq = 1,
+        .content.window_data.size = 4,
+        .content.window_data.bytes = {0xde, 0xad, 0xbe, 0xef},
+    };
+
+    const uint16_t crc = expansion_protocol_get_crc(&frame);
+    frame.content.window_data.crc = ~crc;
+    mu_assert_int_eq(crc, expansion_protocol_get_crc(&frame));
+    frame.content.window_data.bytes[4] = 0xff;
+    mu_assert_int_eq(crc, expansion_protocol_get_crc(&frame));
+    frame.content.window_data.seq = 2;
+    mu_check(crc != expansion_protocol_get_crc(&frame));
+}
+
+MU_TEST(test_expansion_window) {
+    ExpansionWindow* sender = malloc(sizeof(ExpansionWindow));
+    ExpansionWindow* receiver = malloc(sizeof(ExpansionWindow));
+    expansion_window_reset(sender);
+    expansion_window_reset(receiver);
+
+    ExpansionFrame frame;
+    uint8_t data[EXPANSION_PROTOCOL_WINDOW_DATA_SIZE + 1];
+    for(size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = i;
+    }
+
+    // Data is split into frames, up to the window size
+    mu_assert_int_eq(
+        EXPANSION_PROTOCOL_WINDOW_DATA_SIZE, expansion_window_push(sender, data, sizeof(data)));
+    for(size_t i = 1; i < EXPANSION_PROTOCOL_WINDOW_SIZE; ++i) {
+        mu_assert_int_eq(i, expansion_window_push(sender, data, i));
+    }
+    mu_assert_int_eq(0, expansion_window_push(sender, data, 1));
+
+    // Frame 1 is lost
+    for(size_t i = 0; i < EXPANSION_PROTOCOL_WINDOW_SIZE; ++i) {
+        mu_check(expansion_window_get_frame(sender, 0, 100, &frame));
+        mu_assert_int_eq(i, frame.content.window_data.seq);
+        if(i != 1) {
+            mu_check(expansion_window_receive(receiver, &frame));
+        }
+    }
+    mu_check(!expansion_window_get_frame(sender, 99, 100, &frame));
+
+    const uint8_t* received;
+    mu_assert_int_eq(
+        EXPANSION_PROTOCOL_WINDOW_DATA_SIZE, expansion_window_read(receiver, &received));
+    mu_assert_mem_eq(data, received, EXPANSION_PROTOCOL_WINDOW_DATA_SIZE);
+    expansion_window_consume(receiver, EXPANSION_PROTOCOL_WINDOW_DATA_SIZE);
+    mu_assert_int_eq(0, expansion_window_read(receiver, &received));
+
+    // Frame 0 is freed, lost frame 1 is sent again right away
+    expansion_window_get_ack(receiver, &frame);
+    mu_assert_int_eq(1, expansion_window_ack(sender, &frame));
+    mu_check(expansion_window_get_frame(sender, 1, 100, &frame));
+    mu_assert_int_eq(1, frame.content.window_data.seq);
+    mu_assert_int_eq(1, sender->tx.retransmitted);
+    mu_check(!expansion_window_get_frame(sender, 2, 100, &frame));
+
+    // Corrupted frames are rejected, duplicates ignored
+    frame.content.window_data.crc ^= 1;
+    mu_check(!expansion_window_receive(receiver, &frame));
+    frame.content.window_data.crc ^= 1;
+    mu_check(expansion_window_receive(receiver, &frame));
+    mu_check(expansion_window_receive(receiver, &frame));
+
+    for(size_t i = 1; i < EXPANSION_PROTOCOL_WINDOW_SIZE; ++i) {
+        mu_assert_int_eq(i, expansion_window_read(receiver, &received));
+        mu_assert_mem_eq(data, received, i);
+        expansion_window_consume(receiver, i);
+    }
+    mu_assert_int_eq(0, expansion_window_read(receiver, &received));
+
+    // Stale acknowledgements are ignored
+    expansion_window_get_ack(receiver, &frame);
+    mu_assert_int_eq(EXPANSION_PROTOCOL_WINDOW_SIZE - 1, expansion_window_ack(sender, &frame));
+    mu_check(expansion_window_is_empty(sender));
+    frame.content.window_ack.seq = 1;
+    mu_assert_int_eq(0, expansion_window_ack(sender, &frame));
+
+    // Unacknowledged frames are sent again after the timeout
+    mu_assert_int_eq(1, expansion_window_push(sender, data, 1));
+    mu_check(expansion_window_get_frame(sender, 1000, 100, &frame));
+    mu_check(!expansion_window_get_frame(sender, 1099, 100, &frame));
+    mu_check(expansion_window_get_frame(sender, 1100, 100, &frame));
+    mu_assert_int_eq(EXPANSION_PROTOCOL_WINDOW_SIZE, frame.content.window_data.seq);
+
+    free(receiver);
+    free(sender);
 }
 
 typedef struct {
@@ -190,6 +317,8 @@ MU_TEST(test_expansion_garbage_input) {
 MU_TEST_SUITE(test_expansion_suite) {
     MU_RUN_TEST(test_expansion_encoded_size);
     MU_RUN_TEST(test_expansion_remaining_size);
+    MU_RUN_TEST(test_expansion_crc);
+    MU_RUN_TEST(test_expansion_window);
     MU_RUN_TEST(test_expansion_encode_decode_frame);
     MU_RUN_TEST(test_expansion_garbage_input);
 }
@@ -456,6 +456,67 @@ static bool test_read_multikey(const char* file_name) {
     return result;
 }
 
+static bool test_read_next_line(const char* file_name, bool check_values) {
+    const char* expected[][2] = {
+        {"Filetype", "Flipper File test"},
+        {"Version", "666"},
+        {"String data", "String"},
+        {"Int32 data", "1234 -6345 7813 0"},
+        {"Uint32 data", "1234 0 5678 9098 7654321"},
+        {"Float data", "1.5 1000.0"},
+        {"Bool data", "true false"},
+        {"Hex data", "DE AD BE"},
+    };
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool result = false;
+    FlipperFormat* file = flipper_format_buffered_file_alloc(storage);
+
+    FuriString* key = furi_string_alloc();
+    FuriString* value = furi_string_alloc();
+
+    do {
+        if(!flipper_format_buffered_file_open_existing(file, file_name)) break;
+
+        bool error = false;
+        for(size_t i = 0; i < COUNT_OF(expected); i++) {
+            if(!flipper_format_read_next_line(file, key, value)) {
+                error = true;
+                break;
+            }
+
+            // trailing whitespace is kept as is
+            furi_string_trim(value);
+            if(!furi_string_equal(key, expected[i][0]) ||
+               (check_values && !furi_string_equal(value, expected[i][1]))) {
+                error = true;
+                break;
+            }
+        }
+        if(error) break;
+        if(flipper_format_read_next_line(file, key, value)) break;
+
+        // keyed reads work after walking the lines
+        uint32_t uint32_value;
+        if(!flipper_format_rewind(file)) break;
+        if(!flipper_format_read_next_line(file, key, NULL)) break;
+        if(!flipper_format_read_uint32(file, test_uint_key, &uint32_value, 1)) break;
+        if(uint32_value != test_uint_data[0]) break;
+        if(!flipper_format_read_next_line(file, key, value)) break;
+        if(!furi_string_equal(key, test_float_key)) break;
+
+        result = true;
+    } while(false);
+
+    furi_string_free(value);
+    furi_string_free(key);
+
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    return result;
+}
+
 MU_TEST(flipper_format_write_test) {
     mu_assert(storage_write_string(test_file_linux, test_data_nix), "Write test error [Linux]");
     mu_assert(
@@ -528,6 +589,15 @@ MU_TEST(flipper_format_oddities_test) {
     mu_assert(test_read(test_file_linux), "Read test error [Oddities]");
 }
 
+MU_TEST(flipper_format_read_next_line_test) {
+    mu_assert(storage_write_string(test_file_linux, test_data_nix), "Write test error [Linux]");
+    mu_assert(
+        storage_write_string(test_file_windows, test_data_win), "Write test error [Windows]");
+    mu_assert(test_read_next_line(test_file_linux, true), "Line read test error [Linux]");
+    mu_assert(test_read_next_line(test_file_windows, true), "Line read test error [Windows]");
+    mu_assert(test_read_next_line(test_file_oddities, false), "Line read test error [Oddities]");
+}
+
 MU_TEST_SUITE(flipper_format) {
     tests_setup();
     MU_RUN_TEST(flipper_format_write_test);
@@ -542,6 +612,7 @@ MU_TEST_SUITE(flipper_format) {
     MU_RUN_TEST(flipper_format_update_2_result_test);
     MU_RUN_TEST(flipper_format_multikey_test);
     MU_RUN_TEST(flipper_format_oddities_test);
+    MU_RUN_TEST(flipper_format_read_next_line_test);
     tests_teardown();
 }
 
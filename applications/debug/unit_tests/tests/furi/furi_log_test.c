@@ -0,0 +1,73 @@
+#include <furi.h>
+#include "../test.h" // IWYU pragma: keep
+
+#define TAG       "LogTest"
+#define FLOOD_CNT 256
+
+static void furi_log_test_handler(const uint8_t* data, size_t size, void* context) {
+    FuriString* output = context;
+    for(size_t i = 0; i < size; i++) {
+        furi_string_push_back(output, data[i]);
+    }
+}
+
+static void test_furi_log_deferred_format(FuriString* output) {
+    char buffer[16];
+    strlcpy(buffer, "original", sizeof(buffer));
+
+    FURI_LOG_I(TAG, "int %d long %lu str %s|%.3s|%*d", -7, 123456UL, buffer, buffer, 4, 5);
+    FURI_LOG_RAW_I("raw %s\r\n", buffer);
+    // Arguments are copied when logged, not when printed
+    strlcpy(buffer, "modified", sizeof(buffer));
+    furi_log_flush();
+
+    mu_assert(
+        furi_string_search_str(output, "[LogTest] ") != FURI_STRING_FAILURE,
+        "tag is not printed");
+    mu_assert(
+        furi_string_search_str(output, "int -7 long 123456 str original|ori|   5\r\n") !=
+            FURI_STRING_FAILURE,
+        "record is not formatted");
+    mu_assert(
+        furi_string_search_str(output, "raw original\r\n") != FURI_STRING_FAILURE,
+        "raw record is not formatted");
+    mu_assert(
+        furi_string_search_str(output, "modified") == FURI_STRING_FAILURE,
+        "string argument is not copied");
+}
+
+static void test_furi_log_overflow(FuriString* output) {
+    uint32_t dropped = furi_log_get_dropped_count();
+
+    // Log thread has lower priority and can't drain the ring while we are busy
+    for(size_t i = 0; i < FLOOD_CNT; i++) {
+        FURI_LOG_I(TAG, "flood %zu", i);
+    }
+    mu_assert(furi_log_get_dropped_count() > dropped, "ring overflow is not counted");
+
+    furi_string_reset(output);
+    furi_log_flush();
+    mu_assert(
+        furi_string_search_str(output, "records dropped") != FURI_STRING_FAILURE,
+        "ring overflow is not reported");
+    mu_assert(
+        furi_string_search_str(output, "flood 0\r\n") != FURI_STRING_FAILURE,
+        "first records are lost");
+}
+
+void test_furi_log(void) {
+    FuriLogLevel level = furi_log_get_level();
+    furi_log_set_level(FuriLogLevelInfo);
+    furi_log_flush();
+
+    FuriString* output = furi_string_alloc();
+    FuriLogHandler handler = {.callback = furi_log_test_handler, .context = output};
+    mu_check(furi_log_add_handler(handler));
+
+    test_furi_log_deferred_format(output);
+    test_furi_log_overflow(output);
+
+    mu_check(furi_log_remove_handler(handler));
+    furi_string_free(output);
+    furi_log_set_level(level);
+}
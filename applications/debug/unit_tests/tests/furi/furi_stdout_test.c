@@ -0,0 +1,61 @@
+#include <furi.h>
+#include "../test.h" // IWYU pragma: keep
+
+static FuriString* stdout_output = NULL;
+static size_t stdout_writes = 0;
+
+static void furi_stdout_test_callback(const char* data, size_t size) {
+    stdout_writes++;
+    furi_string_cat_printf(stdout_output, "%.*s", (int)size, data);
+}
+
+static void test_furi_stdout_lines(void) {
+    furi_thread_stdout_write("partial", 7);
+    putchar(' ');
+    mu_assert_int_eq(0, stdout_writes);
+
+    // Everything up to the last newline is written at once
+    furi_thread_stdout_write("line\nnext", 9);
+    mu_assert_int_eq(1, stdout_writes);
+    mu_assert_string_eq("partial line\n", furi_string_get_cstr(stdout_output));
+
+    furi_thread_stdout_flush();
+    mu_assert_int_eq(2, stdout_writes);
+    mu_assert_string_eq("partial line\nnext", furi_string_get_cstr(stdout_output));
+
+    furi_thread_stdout_flush();
+    mu_assert_int_eq(2, stdout_writes);
+}
+
+static void test_furi_stdout_printf(void) {
+    furi_string_reset(stdout_output);
+    stdout_writes = 0;
+
+    FuriString* expected = furi_string_alloc();
+    for(uint32_t i = 0; i < 64; i++) {
+        printf("%08lX: %s ", i, "0123456789ABCDEF");
+        furi_string_cat_printf(expected, "%08lX: %s ", i, "0123456789ABCDEF");
+    }
+    printf("\r\n");
+    furi_string_cat_str(expected, "\r\n");
+
+    // A line longer than the buffer still comes out whole and in order
+    mu_assert(stdout_writes > 1, "long line is not flushed by size");
+    mu_assert(stdout_writes < 64, "output is not buffered");
+    mu_assert_string_eq(furi_string_get_cstr(expected), furi_string_get_cstr(stdout_output));
+
+    furi_string_free(expected);
+}
+
+void test_furi_stdout(void) {
+    FuriThreadStdoutWriteCallback callback = furi_thread_get_stdout_callback();
+    stdout_output = furi_string_alloc();
+    furi_thread_set_stdout_callback(furi_stdout_test_callback);
+
+    test_furi_stdout_lines();
+    test_furi_stdout_printf();
+
+    furi_thread_set_stdout_callback(callback);
+    furi_string_free(stdout_output);
+    stdout_output = NULL;
+}
@@ -10,6 +10,8 @@ void test_furi_memmgr(void);
 void test_furi_event_loop(void);
 void test_errno_saving(void);
 void test_furi_primitives(void);
+void test_furi_log(void);
+void test_furi_stdout(void);
 
 static int foo = 0;
 
@@ -52,6 +54,14 @@ MU_TEST(mu_test_furi_primitives) {
     test_furi_primitives();
 }
 
+MU_TEST(mu_test_furi_log) {
+    test_furi_log();
+}
+
+MU_TEST(mu_test_furi_stdout) {
+    test_furi_stdout();
+}
+
 MU_TEST_SUITE(test_suite) {
     MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
     MU_RUN_TEST(test_check);
@@ -63,6 +73,8 @@ MU_TEST_SUITE(test_suite) {
     MU_RUN_TEST(mu_test_furi_event_loop);
     MU_RUN_TEST(mu_test_errno_saving);
     MU_RUN_TEST(mu_test_furi_primitives);
+    MU_RUN_TEST(mu_test_furi_log);
+    MU_RUN_TEST(mu_test_furi_stdout);
 }
 
 int run_minunit_test_furi(void) {
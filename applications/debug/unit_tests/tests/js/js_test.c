@@ -11,6 +11,10 @@
 
 #define JS_SCRIPT_PATH(name) EXT_PATH("unit_tests/js/" name ".js")
 
+#define JS_CACHE_TEST_PATH    EXT_PATH("unit_tests/js/.bcode_cache.js")
+#define JS_CACHE_TEST_JSC     EXT_PATH("unit_tests/js/.bcode_cache.jsc")
+#define JS_CACHE_TEST_MAX_JSC (256)
+
 typedef enum {
     JsTestsFinished = 1,
     JsTestsError = 2,
@@ -33,9 +37,10 @@ static void js_test_callback(JsThreadEvent event, const char* msg, void* param)
     }
 }
 
-static void js_test_run(const char* script_path) {
+static FuriString* js_test_execute(const char* script_path) {
     JsTestCallbackContext* context = malloc(sizeof(JsTestCallbackContext));
     context->event_flags = furi_event_flag_alloc();
+    context->error_string = NULL;
 
     JsThread* thread = js_thread_run(script_path, js_test_callback, context);
     uint32_t flags = furi_event_flag_wait(
@@ -51,7 +56,13 @@ static void js_test_run(const char* script_path) {
     furi_event_flag_free(context->event_flags);
     free(context);
 
-    if(flags & JsTestsError) {
+    return error_string;
+}
+
+static void js_test_run(const char* script_path) {
+    FuriString* error_string = js_test_execute(script_path);
+
+    if(error_string) {
         // memory leak: not freeing the FuriString if the tests fail,
         // because mu_fail executes a return
         //
@@ -72,12 +83,100 @@ MU_TEST(js_test_event_loop) {
 MU_TEST(js_test_storage) {
     js_test_run(JS_SCRIPT_PATH("storage"));
 }
+MU_TEST(js_test_objects) {
+    js_test_run(JS_SCRIPT_PATH("objects"));
+}
+
+static void
+    js_test_write_file(Storage* storage, const char* path, const void* data, size_t size) {
+    File* file = storage_file_alloc(storage);
+    mu_assert(
+        storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS), "failed to create file");
+    mu_assert(storage_file_write(file, data, size) == size, "failed to write file");
+    storage_file_free(file);
+}
+
+static void js_test_write_script(Storage* storage, const char* source) {
+    js_test_write_file(storage, JS_CACHE_TEST_PATH, source, strlen(source));
+}
+
+static size_t js_test_read_jsc(Storage* storage, uint8_t* buffer) {
+    File* file = storage_file_alloc(storage);
+    size_t size = 0;
+    if(storage_file_open(file, JS_CACHE_TEST_JSC, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        size = storage_file_read(file, buffer, JS_CACHE_TEST_MAX_JSC);
+    }
+    storage_file_free(file);
+    return size;
+}
+
+static uint8_t* js_test_find(uint8_t* data, size_t size, const char* str) {
+    const size_t str_size = strlen(str);
+    for(size_t i = 0; i + str_size <= size; i++) {
+        if(memcmp(data + i, str, str_size) == 0) return data + i;
+    }
+    return NULL;
+}
+
+MU_TEST(js_test_bcode_cache) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    uint8_t* cold_jsc = malloc(JS_CACHE_TEST_MAX_JSC);
+    uint8_t* new_jsc = malloc(JS_CACHE_TEST_MAX_JSC);
+
+    storage_simply_remove(storage, JS_CACHE_TEST_JSC);
+
+    // cold start generates the cache
+    js_test_write_script(storage, "tests.assert_eq(\"parsed\", \"parsed\");");
+    js_test_run(JS_CACHE_TEST_PATH);
+    size_t cold_size = js_test_read_jsc(storage, cold_jsc);
+    mu_assert(cold_size > 0, "cache not generated");
+
+    // warm start runs from the cache and leaves it as is
+    js_test_run(JS_CACHE_TEST_PATH);
+    mu_assert_int_eq(cold_size, js_test_read_jsc(storage, new_jsc));
+    mu_assert_mem_eq(cold_jsc, new_jsc, cold_size);
+
+    // patch only the first literal of the cached bcode: the assertion can only fail if the
+    // cache is executed
+    memcpy(new_jsc, cold_jsc, cold_size);
+    uint8_t* literal = js_test_find(new_jsc, cold_size, "parsed");
+    mu_assert(literal != NULL, "literal not found in cache");
+    memcpy(literal, "cached", strlen("cached"));
+    js_test_write_file(storage, JS_CACHE_TEST_JSC, new_jsc, cold_size);
+
+    FuriString* error_string = js_test_execute(JS_CACHE_TEST_PATH);
+    mu_assert(error_string != NULL, "cache not used");
+    furi_string_free(error_string);
+
+    // cache from another firmware build: build id is the third trailer word
+    const size_t build_id_offset = cold_size - 3 * sizeof(uint32_t);
+    new_jsc[build_id_offset] ^= 0xFF;
+    js_test_write_file(storage, JS_CACHE_TEST_JSC, new_jsc, cold_size);
+
+    js_test_run(JS_CACHE_TEST_PATH);
+    mu_assert_int_eq(cold_size, js_test_read_jsc(storage, new_jsc));
+    mu_assert_mem_eq(cold_jsc, new_jsc, cold_size);
+
+    // same size, different source: the stale cache must be rebuilt
+    js_test_write_script(storage, "tests.assert_eq(\"source\", \"source\");");
+    js_test_run(JS_CACHE_TEST_PATH);
+    mu_assert_int_eq(cold_size, js_test_read_jsc(storage, new_jsc));
+    mu_assert(js_test_find(new_jsc, cold_size, "source") != NULL, "stale cache not rebuilt");
+
+    free(cold_jsc);
+    free(new_jsc);
+    storage_simply_remove(storage, JS_CACHE_TEST_PATH);
+    storage_simply_remove(storage, JS_CACHE_TEST_JSC);
+    furi_record_close(RECORD_STORAGE);
+}
 
 MU_TEST_SUITE(test_js) {
     MU_RUN_TEST(js_test_basic);
     MU_RUN_TEST(js_test_math);
     MU_RUN_TEST(js_test_event_loop);
     MU_RUN_TEST(js_test_storage);
+    MU_RUN_TEST(js_test_objects);
+    MU_RUN_TEST(js_test_bcode_cache);
 }
 
 int run_minunit_test_js(void) {
@@ -3,6 +3,7 @@
 #include <toolbox/protocols/protocol_dict.h>
 #include <lfrfid/protocols/lfrfid_protocols.h>
 #include <toolbox/pulse_protocols/pulse_glue.h>
+#include <toolbox/manchester_decoder.h>
 
 #define LF_RFID_READ_TIMING_MULTIPLIER 8
 
@@ -526,6 +527,54 @@ MU_TEST(test_lfrfid_protocol_fdxb_read_simple) {
     protocol_dict_free(dict);
 }
 
+MU_TEST(test_lfrfid_manchester_advance_run) {
+    const ManchesterEvent event_map[] = {
+        ManchesterEventShortLow,
+        ManchesterEventShortHigh,
+        ManchesterEventLongLow,
+        ManchesterEventLongHigh,
+        ManchesterEventReset,
+    };
+    ManchesterEvent events[257];
+    uint32_t seed = 0x12345678;
+
+    for(size_t i = 0; i < COUNT_OF(events); i++) {
+        seed = seed * 1103515245 + 12345;
+        // make resets rare to get long decoded runs
+        size_t index = (seed >> 16) % 33;
+        events[i] = index < 32 ? event_map[index % 4] : event_map[4];
+    }
+
+    ManchesterState state_single;
+    manchester_advance(ManchesterStateStart1, ManchesterEventReset, &state_single, NULL);
+    ManchesterState state_shift = state_single;
+    ManchesterState state_run = state_single;
+    uint64_t register_single = 0;
+    uint64_t register_shift = 0;
+    uint64_t register_run = 0;
+    size_t bits_single = 0;
+    size_t bits_shift = 0;
+
+    for(size_t i = 0; i < COUNT_OF(events); i++) {
+        bool data;
+        if(manchester_advance(state_single, events[i], &state_single, &data)) {
+            register_single = (register_single << 1) | data;
+            bits_single++;
+        }
+        bits_shift += manchester_advance_shift(&state_shift, events[i], &register_shift);
+    }
+
+    size_t bits_run = manchester_advance_run(&state_run, events, COUNT_OF(events), &register_run);
+
+    mu_assert(bits_single > 64, "too few bits decoded");
+    mu_assert_int_eq(bits_single, bits_shift);
+    mu_assert_int_eq(bits_single, bits_run);
+    mu_assert_int_eq(state_single, state_shift);
+    mu_assert_int_eq(state_single, state_run);
+    mu_assert(register_single == register_shift, "shift register mismatch");
+    mu_assert(register_single == register_run, "run register mismatch");
+}
+
 MU_TEST_SUITE(test_lfrfid_protocols_suite) {
     MU_RUN_TEST(test_lfrfid_protocol_em_read_simple);
     MU_RUN_TEST(test_lfrfid_protocol_em_emulate_simple);
@@ -540,6 +589,8 @@ MU_TEST_SUITE(test_lfrfid_protocols_suite) {
 
     MU_RUN_TEST(test_lfrfid_protocol_fdxb_read_simple);
     MU_RUN_TEST(test_lfrfid_protocol_fdxb_emulate_simple);
+
+    MU_RUN_TEST(test_lfrfid_manchester_advance_run);
 }
 
 int run_minunit_test_lfrfid_protocols(void) {
@@ -64,9 +64,107 @@ MU_TEST(manifest_iteration_test) {
     mu_assert(result, "Manifest forward iterate failed\r\n");
 }
 
+MU_TEST(manifest_index_test) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    ResourceManifestIndex* index =
+        resource_manifest_index_alloc(storage, EXT_PATH("unit_tests/Manifest_test"));
+    ResourceManifestReader* manifest_reader = resource_manifest_reader_alloc(storage);
+
+    do {
+        mu_assert(index, "Manifest index failed\r\n");
+        if(!index) break;
+        if(!resource_manifest_reader_open(manifest_reader, EXT_PATH("unit_tests/Manifest_test"))) {
+            mu_fail("Manifest open failed\r\n");
+            break;
+        }
+
+        // Every entry matches itself
+        size_t count = 0;
+        ResourceManifestEntry* entry_ptr = NULL;
+        while((entry_ptr = resource_manifest_reader_next(manifest_reader))) {
+            if(entry_ptr->type == ResourceManifestEntryTypeFile ||
+               entry_ptr->type == ResourceManifestEntryTypeDirectory) {
+                mu_assert(
+                    resource_manifest_index_match(index, entry_ptr) ==
+                        ResourceManifestIndexMatchSame,
+                    "Entry mismatch\r\n");
+                count++;
+            }
+        }
+        mu_assert_int_eq(count, resource_manifest_index_get_count(index));
+
+        ResourceManifestEntry entry = {
+            .type = ResourceManifestEntryTypeFile,
+            .name = furi_string_alloc_set("subghz/came.sub"),
+            .size = 157,
+            .hash = {0x37, 0x0a, 0x0c, 0x62, 0xbe, 0x96, 0x7b, 0x42,
+                     0x0d, 0xa5, 0xe6, 0x0f, 0xfc, 0xdc, 0x07, 0x8b},
+        };
+        mu_assert(
+            resource_manifest_index_match(index, &entry) == ResourceManifestIndexMatchSame,
+            "Same file mismatch\r\n");
+
+        entry.size++;
+        mu_assert(
+            resource_manifest_index_match(index, &entry) == ResourceManifestIndexMatchChanged,
+            "Resized file match\r\n");
+        entry.size--;
+        entry.hash[0]++;
+        mu_assert(
+            resource_manifest_index_match(index, &entry) == ResourceManifestIndexMatchChanged,
+            "Changed file match\r\n");
+        entry.hash[0]--;
+        entry.hash[7]++;
+        mu_assert(
+            resource_manifest_index_match(index, &entry) == ResourceManifestIndexMatchChanged,
+            "Changed hash tail match\r\n");
+        entry.hash[7]--;
+
+        entry.type = ResourceManifestEntryTypeDirectory;
+        mu_assert(
+            resource_manifest_index_match(index, &entry) == ResourceManifestIndexMatchNone,
+            "Directory matches file\r\n");
+
+        entry.type = ResourceManifestEntryTypeFile;
+        furi_string_set(entry.name, "subghz/removed.sub");
+        mu_assert(
+            resource_manifest_index_match(index, &entry) == ResourceManifestIndexMatchNone,
+            "Removed file match\r\n");
+        furi_string_free(entry.name);
+
+        mu_assert(
+            !resource_manifest_index_is_installed(index, "subghz/came.sub"),
+            "File installed\r\n");
+        resource_manifest_index_set_installed(index, "subghz/came.sub");
+        mu_assert(
+            resource_manifest_index_is_installed(index, "subghz/came.sub"),
+            "File not installed\r\n");
+        mu_assert(
+            !resource_manifest_index_is_installed(index, "subghz/bett.sub"),
+            "Other file installed\r\n");
+    } while(false);
+
+    resource_manifest_reader_free(manifest_reader);
+    if(index) resource_manifest_index_free(index);
+    furi_record_close(RECORD_STORAGE);
+}
+
+MU_TEST(manifest_index_version_test) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    ResourceManifestIndex* index =
+        resource_manifest_index_alloc(storage, EXT_PATH("unit_tests/Manifest_test_version"));
+    const bool indexed = index != NULL;
+    if(index) resource_manifest_index_free(index);
+    furi_record_close(RECORD_STORAGE);
+
+    mu_assert(!indexed, "Manifest of unknown version indexed\r\n");
+}
+
 MU_TEST_SUITE(manifest_suite) {
     MU_RUN_TEST(manifest_type_test);
     MU_RUN_TEST(manifest_iteration_test);
+    MU_RUN_TEST(manifest_index_test);
+    MU_RUN_TEST(manifest_index_version_test);
 }
 
 int run_minunit_test_manifest(void) {
@@ -24,6 +24,7 @@
 #include <nfc/nfc_poller.h>
 
 #include <toolbox/keys_dict.h>
+#include <toolbox/stream/file_stream.h>
 #include <nfc/nfc.h>
 
 #include "../test.h" // IWYU pragma: keep
@@ -207,6 +208,55 @@ MU_TEST(mf_classic_4k_7b_file_test) {
     nfc_file_test_with_generator(NfcDataGeneratorTypeMfClassic4k_7b);
 }
 
+MU_TEST(mf_classic_1k_reordered_file_test) {
+    NfcDevice* nfc_device_ref = nfc_device_alloc();
+    NfcDevice* nfc_device_dut = nfc_device_alloc();
+    nfc_data_generator_fill_data(NfcDataGeneratorTypeMfClassic1k_4b, nfc_device_ref);
+    mu_assert(
+        nfc_device_save(nfc_device_ref, NFC_TEST_NFC_DEV_PATH), "nfc_device_save() failed\r\n");
+
+    // Swap blocks 1 and 2 and put extra whitespace before every block value
+    FuriString* file_str = furi_string_alloc();
+    FuriString* held_str = furi_string_alloc();
+    FuriString* line = furi_string_alloc();
+    Stream* stream = file_stream_alloc(nfc_test->storage);
+    mu_assert(
+        file_stream_open(stream, NFC_TEST_NFC_DEV_PATH, FSAM_READ_WRITE, FSOM_OPEN_EXISTING),
+        "file_stream_open() failed\r\n");
+    while(stream_read_line(stream, line)) {
+        if(furi_string_start_with_str(line, "Block ")) {
+            furi_string_replace_str(line, ": ", ": \t  ");
+        }
+        if(furi_string_start_with_str(line, "Block 1:")) {
+            furi_string_set(held_str, line);
+        } else {
+            furi_string_cat(file_str, line);
+            if(furi_string_start_with_str(line, "Block 2:")) {
+                furi_string_cat(file_str, held_str);
+            }
+        }
+    }
+    stream_clean(stream);
+    const bool file_written = stream_write_string(stream, file_str) == furi_string_size(file_str);
+    stream_free(stream);
+    furi_string_free(line);
+    furi_string_free(held_str);
+    furi_string_free(file_str);
+    mu_assert(file_written, "stream_write_string() failed\r\n");
+
+    mu_assert(
+        nfc_device_load(nfc_device_dut, NFC_TEST_NFC_DEV_PATH), "nfc_device_load() failed\r\n");
+    mu_assert(
+        nfc_device_is_equal(nfc_device_ref, nfc_device_dut),
+        "nfc_device_data_dut != nfc_device_data_ref\r\n");
+    mu_assert(
+        storage_simply_remove(nfc_test->storage, NFC_TEST_NFC_DEV_PATH),
+        "storage_simply_remove() failed\r\n");
+
+    nfc_device_free(nfc_device_dut);
+    nfc_device_free(nfc_device_ref);
+}
+
 MU_TEST(iso14443_3a_reader) {
     Nfc* poller = nfc_alloc();
     Nfc* listener = nfc_alloc();
@@ -858,6 +908,7 @@ MU_TEST_SUITE(nfc) {
     MU_RUN_TEST(mf_classic_1k_7b_file_test);
     MU_RUN_TEST(mf_classic_4k_4b_file_test);
     MU_RUN_TEST(mf_classic_4k_7b_file_test);
+    MU_RUN_TEST(mf_classic_1k_reordered_file_test);
 
     MU_RUN_TEST(mf_classic_reader);
     MU_RUN_TEST(mf_classic_write);
@@ -0,0 +1,96 @@
+#include <furi.h>
+#include <furi_hal.h>
+
+#include "../test.h" // IWYU pragma: keep
+
+#include <storage/storage.h>
+
+#define NFC_PLUGINS_TEST_DIR_NAME        EXT_PATH(".tmp/unit_tests/nfc_plugins")
+#define NFC_SUPPORTED_CARDS_PLUGINS_PATH NFC_PLUGINS_TEST_DIR_NAME "/plugins"
+#define NFC_SUPPORTED_CARDS_INDEX_PATH   NFC_PLUGINS_TEST_DIR_NAME "/.plugins.idx"
+
+#define NFC_PLUGINS_TEST_UNRELATED_PATH NFC_PLUGINS_TEST_DIR_NAME "/unrelated.txt"
+
+// NFC is an external app, so its plugin loader is built into the test
+#include <applications/main/nfc/helpers/nfc_supported_cards.c>
+
+static bool nfc_plugins_test_resolve(
+    const ElfApiInterface* interface,
+    uint32_t hash,
+    Elf32_Addr* address) {
+    UNUSED(interface);
+    UNUSED(hash);
+    UNUSED(address);
+    return false;
+}
+
+// The app symbol table is not needed, test plugins are never mapped
+static const ElfApiInterface nfc_plugins_test_api_interface = {
+    .api_version_major = 0,
+    .api_version_minor = 0,
+    .resolver_callback = nfc_plugins_test_resolve,
+};
+
+const ElfApiInterface* const nfc_application_api_interface = &nfc_plugins_test_api_interface;
+
+static void nfc_plugins_test_write_file(const char* path, const char* text) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    furi_check(storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS));
+    size_t size = strlen(text);
+    furi_check(storage_file_write(file, text, size) == size);
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static size_t nfc_plugins_test_load(void) {
+    NfcSupportedCards* supported_cards = nfc_supported_cards_alloc();
+    nfc_supported_cards_load_cache(supported_cards);
+    const size_t plugins_inspected = supported_cards->plugins_inspected;
+    nfc_supported_cards_free(supported_cards);
+
+    return plugins_inspected;
+}
+
+MU_TEST(nfc_plugins_test_index) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_remove_recursive(storage, NFC_PLUGINS_TEST_DIR_NAME);
+    storage_simply_mkdir(storage, NFC_PLUGINS_TEST_DIR_NAME);
+    storage_simply_mkdir(storage, NFC_SUPPORTED_CARDS_PLUGINS_PATH);
+    furi_record_close(RECORD_STORAGE);
+
+    // Not valid ELF files, such plugins are indexed as well
+    nfc_plugins_test_write_file(NFC_SUPPORTED_CARDS_PLUGINS_PATH "/first_parser.fal", "first");
+    nfc_plugins_test_write_file(NFC_SUPPORTED_CARDS_PLUGINS_PATH "/second_parser.fal", "second");
+    nfc_plugins_test_write_file(NFC_SUPPORTED_CARDS_PLUGINS_PATH "/readme.txt", "not a plugin");
+
+    mu_assert_int_eq(2, nfc_plugins_test_load());
+
+    // Move the storage timestamp past the one the index was saved with
+    furi_delay_ms(1100);
+    nfc_plugins_test_write_file(NFC_PLUGINS_TEST_UNRELATED_PATH, "unrelated");
+    mu_assert_int_eq(0, nfc_plugins_test_load());
+
+    // Same size, different data
+    nfc_plugins_test_write_file(NFC_SUPPORTED_CARDS_PLUGINS_PATH "/first_parser.fal", "FIRST");
+    mu_assert_int_eq(1, nfc_plugins_test_load());
+    mu_assert_int_eq(0, nfc_plugins_test_load());
+}
+
+MU_TEST_SUITE(test_nfc_plugins_suite) {
+    MU_RUN_TEST(nfc_plugins_test_index);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_remove_recursive(storage, NFC_PLUGINS_TEST_DIR_NAME);
+    furi_record_close(RECORD_STORAGE);
+}
+
+int run_minunit_test_nfc_plugins(void) {
+    MU_RUN_SUITE(test_nfc_plugins_suite);
+    return MU_EXIT_CODE;
+}
+
+TEST_API_DEFINE(run_minunit_test_nfc_plugins)
@@ -0,0 +1,179 @@
+#include <furi.h>
+#include <notification/notification_app.h>
+#include <notification/notification_messages.h>
+#include "../test.h" // IWYU pragma: keep
+
+#define NOTIFICATION_TEST_LONG_MS  (250U)
+#define NOTIFICATION_TEST_SHORT_MS (100U)
+#define NOTIFICATION_TEST_STEP_MS  (10U)
+#define NOTIFICATION_TEST_IDLE_MS  (500U)
+
+// Test sequences keep the leds as the test runner has set them and do not vibrate.
+// Vibro beats led, so led requests wait for this one
+static const NotificationSequence notification_test_vibro = {
+    &message_vibro_off,
+    &message_red_0,
+    &message_do_not_reset,
+    &message_delay_250,
+    NULL,
+};
+
+static const NotificationSequence notification_test_led_long = {
+    &message_red_0,
+    &message_do_not_reset,
+    &message_delay_250,
+    NULL,
+};
+
+static const NotificationSequence notification_test_led = {
+    &message_red_0,
+    &message_do_not_reset,
+    &message_delay_100,
+    NULL,
+};
+
+static const NotificationSequence notification_test_led_other = {
+    &message_red_0,
+    &message_do_not_reset,
+    &message_delay_100,
+    NULL,
+};
+
+typedef struct {
+    NotificationApp* notification;
+    const NotificationSequence* sequence;
+    uint32_t start;
+    uint32_t elapsed;
+    FuriThread* thread;
+} NotificationTestRequest;
+
+static int32_t notification_test_request_thread(void* context) {
+    NotificationTestRequest* request = context;
+    notification_message_block(request->notification, request->sequence);
+    request->elapsed = furi_get_tick() - request->start;
+    return 0;
+}
+
+static void notification_test_request_start(
+    NotificationTestRequest* request,
+    NotificationApp* notification,
+    const NotificationSequence* sequence,
+    uint32_t start) {
+    request->notification = notification;
+    request->sequence = sequence;
+    request->start = start;
+    request->thread = furi_thread_alloc_ex(
+        "NotificationTest", 1024, notification_test_request_thread, request);
+    furi_thread_start(request->thread);
+    // Let the request reach the service before the next one is sent
+    furi_delay_ms(NOTIFICATION_TEST_STEP_MS);
+}
+
+static void notification_test_request_wait(NotificationTestRequest* request) {
+    furi_thread_join(request->thread);
+    furi_thread_free(request->thread);
+}
+
+static void notification_test_idle(void) {
+    furi_delay_ms(NOTIFICATION_TEST_IDLE_MS);
+}
+
+MU_TEST(notification_test_preempt) {
+    NotificationApp* notification = furi_record_open(RECORD_NOTIFICATION);
+    notification_test_idle();
+
+    const uint32_t start = furi_get_tick();
+    NotificationTestRequest request;
+    notification_test_request_start(&request, notification, &notification_test_led_long, start);
+    notification_message(notification, &notification_test_led);
+    notification_test_request_wait(&request);
+
+    notification_test_idle();
+    furi_record_close(RECORD_NOTIFICATION);
+
+    mu_assert(
+        request.elapsed < NOTIFICATION_TEST_LONG_MS / 2,
+        "Preempted blocking request is not complete");
+}
+
+MU_TEST(notification_test_priority) {
+    NotificationApp* notification = furi_record_open(RECORD_NOTIFICATION);
+    notification_test_idle();
+
+    const uint32_t start = furi_get_tick();
+    notification_message(notification, &notification_test_vibro);
+    furi_delay_ms(NOTIFICATION_TEST_STEP_MS);
+    NotificationTestRequest request;
+    notification_test_request_start(&request, notification, &notification_test_led, start);
+    notification_test_request_wait(&request);
+
+    notification_test_idle();
+    furi_record_close(RECORD_NOTIFICATION);
+
+    mu_assert(
+        request.elapsed >= NOTIFICATION_TEST_LONG_MS + NOTIFICATION_TEST_SHORT_MS,
+        "Lower priority request did not wait");
+}
+
+MU_TEST(notification_test_pending_overflow) {
+    NotificationApp* notification = furi_record_open(RECORD_NOTIFICATION);
+    notification_test_idle();
+
+    const uint32_t start = furi_get_tick();
+    notification_message(notification, &notification_test_vibro);
+    furi_delay_ms(NOTIFICATION_TEST_STEP_MS);
+    NotificationTestRequest requests[NOTIFICATION_PENDING_COUNT + 1];
+    for(size_t i = 0; i < COUNT_OF(requests); i++) {
+        notification_test_request_start(&requests[i], notification, &notification_test_led, start);
+    }
+    for(size_t i = 0; i < COUNT_OF(requests); i++) {
+        notification_test_request_wait(&requests[i]);
+    }
+
+    notification_test_idle();
+    furi_record_close(RECORD_NOTIFICATION);
+
+    mu_assert(
+        requests[0].elapsed < NOTIFICATION_TEST_LONG_MS / 2,
+        "Dropped pending request is not complete");
+    for(size_t i = 1; i < COUNT_OF(requests); i++) {
+        mu_assert(
+            requests[i].elapsed >= NOTIFICATION_TEST_LONG_MS, "Pending request did not wait");
+    }
+}
+
+MU_TEST(notification_test_coalesce) {
+    NotificationApp* notification = furi_record_open(RECORD_NOTIFICATION);
+    notification_test_idle();
+
+    const uint32_t start = furi_get_tick();
+    notification_message(notification, &notification_test_vibro);
+    furi_delay_ms(NOTIFICATION_TEST_STEP_MS);
+    NotificationTestRequest request;
+    notification_test_request_start(&request, notification, &notification_test_led, start);
+    // Would push the blocking request out of the pending list if each one took a slot
+    for(size_t i = 0; i < NOTIFICATION_PENDING_COUNT; i++) {
+        notification_message(notification, &notification_test_led_other);
+        furi_delay_ms(NOTIFICATION_TEST_STEP_MS);
+    }
+    notification_test_request_wait(&request);
+
+    notification_test_idle();
+    furi_record_close(RECORD_NOTIFICATION);
+
+    mu_assert(request.elapsed >= NOTIFICATION_TEST_LONG_MS, "Repeated request was not coalesced");
+}
+
+MU_TEST_SUITE(notification_suite) {
+    MU_RUN_TEST(notification_test_preempt);
+    MU_RUN_TEST(notification_test_priority);
+    MU_RUN_TEST(notification_test_pending_overflow);
+    MU_RUN_TEST(notification_test_coalesce);
+}
+
+int run_minunit_test_notification(void) {
+    MU_RUN_SUITE(notification_suite);
+    return MU_EXIT_CODE;
+}
+
+TEST_API_DEFINE(run_minunit_test_notification)
@@ -0,0 +1,217 @@
+#include <furi.h>
+#include <furi_hal.h>
+
+#include "../test.h" // IWYU pragma: keep
+
+#include <toolbox/pattern_matcher.h>
+
+#define PATTERN_MATCHER_TEST_STREAM_SIZE   (1024 * 1024)
+#define PATTERN_MATCHER_TEST_CHUNK_SIZE    (64)
+#define PATTERN_MATCHER_TEST_BLOCK_SIZE    (4096)
+// 5x the fastest UART baud rate (921600 baud, ~92 KB/s)
+#define PATTERN_MATCHER_TEST_MIN_RATE      (460 * 1024)
+#define PATTERN_MATCHER_TEST_RANDOM_ROUNDS (500)
+
+static void pattern_matcher_test_add_str(PatternMatcher* matcher, const char* pattern) {
+    mu_check(pattern_matcher_add(matcher, (const uint8_t*)pattern, strlen(pattern)));
+}
+
+static bool pattern_matcher_test_feed_str(
+    PatternMatcher* matcher,
+    const char* data,
+    PatternMatcherMatch* match) {
+    size_t consumed;
+    return pattern_matcher_feed(matcher, (const uint8_t*)data, strlen(data), &consumed, match);
+}
+
+MU_TEST(pattern_matcher_test_basic) {
+    PatternMatcher* matcher = pattern_matcher_alloc();
+    PatternMatcherMatch match;
+    size_t consumed;
+
+    pattern_matcher_test_add_str(matcher, "he");
+    pattern_matcher_test_add_str(matcher, "she");
+    pattern_matcher_test_add_str(matcher, "his");
+    pattern_matcher_test_add_str(matcher, "hers");
+    mu_assert_int_eq(4, pattern_matcher_get_count(matcher));
+
+    // "she" and "he" end at the same byte, the first added one wins
+    const char* data = "ushers";
+    mu_check(pattern_matcher_feed(matcher, (const uint8_t*)data, 6, &consumed, &match));
+    mu_assert_int_eq(4, consumed);
+    mu_assert_int_eq(0, match.index);
+    mu_assert_int_eq(2, match.offset);
+    mu_assert_int_eq(2, match.size);
+
+    // matching continues from the same state
+    mu_check(pattern_matcher_feed(matcher, (const uint8_t*)data + 4, 2, &consumed, &match));
+    mu_assert_int_eq(2, consumed);
+    mu_assert_int_eq(3, match.index);
+    mu_assert_int_eq(2, match.offset);
+
+    pattern_matcher_reset(matcher);
+    mu_check(!pattern_matcher_test_feed_str(matcher, "hi, s", &match));
+    // pattern split across chunks
+    mu_check(pattern_matcher_test_feed_str(matcher, "his", &match));
+    mu_assert_int_eq(2, match.index);
+    mu_assert_int_eq(5, match.offset);
+
+    pattern_matcher_free(matcher);
+}
+
+MU_TEST(pattern_matcher_test_bytes) {
+    PatternMatcher* matcher = pattern_matcher_alloc();
+    PatternMatcherMatch match;
+    size_t consumed;
+
+    const uint8_t pattern_a[] = {0x00, 0xFF, 0x00};
+    const uint8_t pattern_b[] = {0xFF, 0x00, 0xFF, 0xFF};
+    mu_check(pattern_matcher_add(matcher, pattern_a, sizeof(pattern_a)));
+    mu_check(pattern_matcher_add(matcher, pattern_b, sizeof(pattern_b)));
+
+    const uint8_t data[] = {0xFF, 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0x00};
+    for(size_t i = 0; i < 3; i++) {
+        mu_check(!pattern_matcher_feed(matcher, &data[i], 1, &consumed, &match));
+    }
+    mu_check(pattern_matcher_feed(matcher, &data[3], 4, &consumed, &match));
+    mu_assert_int_eq(1, consumed);
+    mu_assert_int_eq(1, match.index);
+    mu_assert_int_eq(0, match.offset);
+
+    mu_check(pattern_matcher_feed(matcher, &data[4], 3, &consumed, &match));
+    mu_assert_int_eq(3, consumed);
+    mu_assert_int_eq(0, match.index);
+    mu_assert_int_eq(4, match.offset);
+
+    pattern_matcher_clear(matcher);
+    mu_assert_int_eq(0, pattern_matcher_get_count(matcher));
+    mu_check(!pattern_matcher_feed(matcher, data, sizeof(data), &consumed, &match));
+    mu_assert_int_eq(sizeof(data), consumed);
+
+    pattern_matcher_free(matcher);
+}
+
+MU_TEST(pattern_matcher_test_random) {
+    PatternMatcher* matcher = pattern_matcher_alloc();
+    uint8_t patterns[4][6];
+    size_t pattern_sizes[4];
+    uint8_t data[128];
+
+    for(size_t round = 0; round < PATTERN_MATCHER_TEST_RANDOM_ROUNDS; round++) {
+        pattern_matcher_clear(matcher);
+        const size_t pattern_count = 1 + rand() % COUNT_OF(patterns);
+        for(size_t i = 0; i < pattern_count; i++) {
+            pattern_sizes[i] = 1 + rand() % sizeof(patterns[i]);
+            for(size_t j = 0; j < pattern_sizes[i]; j++) {
+                patterns[i][j] = 'a' + rand() % 3;
+            }
+            mu_check(pattern_matcher_add(matcher, patterns[i], pattern_sizes[i]));
+        }
+        for(size_t i = 0; i < sizeof(data); i++) {
+            data[i] = 'a' + rand() % 3;
+        }
+
+        // naive search for the first match end, compared with chunked feeding
+        int32_t expected_index = -1;
+        size_t expected_end = 0;
+        for(size_t end = 1; end <= sizeof(data) && expected_index < 0; end++) {
+            for(size_t i = 0; i < pattern_count; i++) {
+                if(pattern_sizes[i] <= end &&
+                   memcmp(&data[end - pattern_sizes[i]], patterns[i], pattern_sizes[i]) == 0) {
+                    expected_index = i;
+                    expected_end = end;
+                    break;
+                }
+            }
+        }
+
+        PatternMatcherMatch match;
+        size_t position = 0;
+        bool found = false;
+        while(position < sizeof(data) && !found) {
+            size_t chunk = MIN(1 + (size_t)rand() % 7, sizeof(data) - position);
+            size_t consumed;
+            found = pattern_matcher_feed(matcher, &data[position], chunk, &consumed, &match);
+            position += consumed;
+        }
+
+        mu_assert_int_eq(expected_index >= 0, found);
+        if(found) {
+            mu_assert_int_eq(expected_index, match.index);
+            mu_assert_int_eq(expected_end, position);
+            mu_assert_int_eq(expected_end - pattern_sizes[expected_index], match.offset);
+        }
+    }
+
+    pattern_matcher_free(matcher);
+}
+
+MU_TEST(pattern_matcher_test_throughput) {
+    static const char* const patterns[] = {
+        "Kernel panic - not syncing",
+        "login: ",
+        "root@OpenWrt:~# ",
+        "Password:",
+        "U-Boot 2023.04",
+        "ERROR: timeout waiting for",
+        "\r\n# ",
+        "Hit any key to stop autoboot",
+    };
+
+    PatternMatcher* matcher = pattern_matcher_alloc();
+    for(size_t i = 0; i < COUNT_OF(patterns); i++) {
+        pattern_matcher_test_add_str(matcher, patterns[i]);
+    }
+
+    // printable text with line breaks, like a boot log
+    uint8_t* block = malloc(PATTERN_MATCHER_TEST_BLOCK_SIZE);
+    for(size_t i = 0; i < PATTERN_MATCHER_TEST_BLOCK_SIZE; i++) {
+        block[i] = (i % 80 == 79) ? '\n' : ' ' + rand() % 95;
+    }
+
+    size_t matches = 0;
+    const uint32_t start = furi_get_tick();
+    for(size_t total = 0; total < PATTERN_MATCHER_TEST_STREAM_SIZE;
+        total += PATTERN_MATCHER_TEST_BLOCK_SIZE) {
+        for(size_t i = 0; i < PATTERN_MATCHER_TEST_BLOCK_SIZE;
+            i += PATTERN_MATCHER_TEST_CHUNK_SIZE) {
+            size_t position = 0;
+            while(position < PATTERN_MATCHER_TEST_CHUNK_SIZE) {
+                PatternMatcherMatch match;
+                size_t consumed;
+                if(pattern_matcher_feed(
+                       matcher,
+                       &block[i + position],
+                       PATTERN_MATCHER_TEST_CHUNK_SIZE - position,
+                       &consumed,
+                       &match)) {
+                    matches++;
+                }
+                position += consumed;
+            }
+        }
+    }
+    const uint32_t elapsed = MAX(furi_get_tick() - start, 1UL);
+
+    const uint32_t rate = (uint64_t)PATTERN_MATCHER_TEST_STREAM_SIZE *
+                          furi_kernel_get_tick_frequency() / elapsed;
+    FURI_LOG_I("PatternMatcher", "%lu bytes/s, %zu matches", rate, matches);
+    mu_assert(rate >= PATTERN_MATCHER_TEST_MIN_RATE, "matcher is too slow");
+
+    free(block);
+    pattern_matcher_free(matcher);
+}
+
+MU_TEST_SUITE(test_pattern_matcher_suite) {
+    MU_RUN_TEST(pattern_matcher_test_basic);
+    MU_RUN_TEST(pattern_matcher_test_bytes);
+    MU_RUN_TEST(pattern_matcher_test_random);
+    MU_RUN_TEST(pattern_matcher_test_throughput);
+}
+
+int run_minunit_test_pattern_matcher(void) {
+    MU_RUN_SUITE(test_pattern_matcher_suite);
+    return MU_EXIT_CODE;
+}
+
+TEST_API_DEFINE(run_minunit_test_pattern_matcher)
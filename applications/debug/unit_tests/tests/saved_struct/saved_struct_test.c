@@ -0,0 +1,163 @@
+#include <furi.h>
+#include <storage/storage.h>
+#include <toolbox/saved_struct.h>
+
+#include "../test.h" // IWYU pragma: keep
+
+#define TEST_DIR_NAME  EXT_PATH(".tmp/unit_tests/saved_struct")
+#define TEST_FILE_NAME TEST_DIR_NAME "/test.settings"
+#define TEST_MAGIC     (0x5A)
+#define TEST_VERSION   (3)
+
+typedef struct {
+    uint32_t counter;
+    uint32_t timestamp;
+    uint8_t data[64];
+} TestStruct;
+
+static uint64_t test_file_size(const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FileInfo info = {};
+    storage_common_stat(storage, path, &info);
+    furi_record_close(RECORD_STORAGE);
+    return info.size;
+}
+
+static void test_file_truncate(const char* path, uint64_t size) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    mu_check(storage_file_open(file, path, FSAM_READ_WRITE, FSOM_OPEN_EXISTING));
+    mu_check(storage_file_seek(file, size, true));
+    mu_check(storage_file_truncate(file));
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static void test_setup(void) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    mu_assert(storage_simply_remove_recursive(storage, TEST_DIR_NAME), "Cannot clean data");
+    mu_assert(storage_simply_mkdir(storage, TEST_DIR_NAME), "Cannot create dir");
+    furi_record_close(RECORD_STORAGE);
+}
+
+static void test_teardown(void) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    mu_assert(storage_simply_remove_recursive(storage, TEST_DIR_NAME), "Cannot clean data");
+    furi_record_close(RECORD_STORAGE);
+}
+
+MU_TEST(test_saved_struct_journal) {
+    TestStruct data = {.counter = 1};
+    TestStruct loaded;
+
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    const uint64_t base_size = test_file_size(TEST_FILE_NAME);
+
+    // Small changes are appended instead of rewriting the whole file
+    for(uint32_t i = 0; i < 10; i++) {
+        data.counter++;
+        mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    }
+    mu_check(test_file_size(TEST_FILE_NAME) > base_size);
+    mu_check(test_file_size(TEST_FILE_NAME) < base_size + 10 * sizeof(data));
+
+    memset(&loaded, 0, sizeof(loaded));
+    mu_check(saved_struct_load(TEST_FILE_NAME, &loaded, sizeof(loaded), TEST_MAGIC, TEST_VERSION));
+    mu_assert_mem_eq(&data, &loaded, sizeof(data));
+
+    size_t payload_size = 0;
+    uint8_t magic = 0, version = 0;
+    mu_check(saved_struct_get_metadata(TEST_FILE_NAME, &magic, &version, &payload_size));
+    mu_assert_int_eq(TEST_MAGIC, magic);
+    mu_assert_int_eq(TEST_VERSION, version);
+    mu_assert_int_eq(sizeof(data), payload_size);
+
+    // Unchanged data is not written at all
+    const uint64_t journal_size = test_file_size(TEST_FILE_NAME);
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    mu_assert_int_eq(journal_size, test_file_size(TEST_FILE_NAME));
+
+    // Journal is compacted eventually
+    for(uint32_t i = 0; i < 100; i++) {
+        memset(data.data, i, sizeof(data.data));
+        mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    }
+    mu_check(test_file_size(TEST_FILE_NAME) < base_size + 10 * sizeof(data));
+    mu_check(saved_struct_load(TEST_FILE_NAME, &loaded, sizeof(loaded), TEST_MAGIC, TEST_VERSION));
+    mu_assert_mem_eq(&data, &loaded, sizeof(data));
+}
+
+MU_TEST(test_saved_struct_truncated_journal) {
+    TestStruct data = {.counter = 1};
+    TestStruct loaded;
+
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    data.counter = 2;
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    const uint64_t committed_size = test_file_size(TEST_FILE_NAME);
+    data.counter = 3;
+    data.timestamp = 0xDEADBEEF;
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+
+    // Interrupted save leaves a partial record, the last committed state is loaded
+    for(uint64_t size = test_file_size(TEST_FILE_NAME) - 1; size >= committed_size; size--) {
+        test_file_truncate(TEST_FILE_NAME, size);
+        mu_check(
+            saved_struct_load(TEST_FILE_NAME, &loaded, sizeof(loaded), TEST_MAGIC, TEST_VERSION));
+        mu_assert_int_eq(2, loaded.counter);
+        mu_assert_int_eq(0, loaded.timestamp);
+    }
+
+    // Partial record is dropped by the next save
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    test_file_truncate(TEST_FILE_NAME, committed_size + 3);
+    data.counter = 4;
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    mu_check(saved_struct_load(TEST_FILE_NAME, &loaded, sizeof(loaded), TEST_MAGIC, TEST_VERSION));
+    mu_assert_mem_eq(&data, &loaded, sizeof(data));
+}
+
+MU_TEST(test_saved_struct_migration) {
+    TestStruct data = {.counter = 42};
+    TestStruct loaded;
+
+    // Header written before journal support: magic, version, checksum, flags, timestamp
+    uint8_t header[8] = {TEST_MAGIC, TEST_VERSION, 42, 0, 0, 0, 0, 0};
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    mu_check(storage_file_open(file, TEST_FILE_NAME, FSAM_WRITE, FSOM_CREATE_ALWAYS));
+    mu_assert_int_eq(sizeof(header), storage_file_write(file, header, sizeof(header)));
+    mu_assert_int_eq(sizeof(data), storage_file_write(file, &data, sizeof(data)));
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    mu_check(saved_struct_load(TEST_FILE_NAME, &loaded, sizeof(loaded), TEST_MAGIC, TEST_VERSION));
+    mu_assert_mem_eq(&data, &loaded, sizeof(data));
+
+    data.counter++;
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+    data.counter++;
+    mu_check(saved_struct_save(TEST_FILE_NAME, &data, sizeof(data), TEST_MAGIC, TEST_VERSION));
+
+    size_t payload_size = 0;
+    mu_check(saved_struct_get_metadata(TEST_FILE_NAME, NULL, NULL, &payload_size));
+    mu_assert_int_eq(sizeof(data), payload_size);
+    mu_check(saved_struct_load(TEST_FILE_NAME, &loaded, sizeof(loaded), TEST_MAGIC, TEST_VERSION));
+    mu_assert_mem_eq(&data, &loaded, sizeof(data));
+}
+
+MU_TEST_SUITE(test_saved_struct_suite) {
+    MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+    MU_RUN_TEST(test_saved_struct_journal);
+    MU_RUN_TEST(test_saved_struct_truncated_journal);
+    MU_RUN_TEST(test_saved_struct_migration);
+}
+
+int run_minunit_test_saved_struct(void) {
+    MU_RUN_SUITE(test_saved_struct_suite);
+    return MU_EXIT_CODE;
+}
+
+TEST_API_DEFINE(run_minunit_test_saved_struct)
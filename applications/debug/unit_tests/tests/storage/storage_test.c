@@ -176,6 +176,54 @@ MU_TEST(storage_file_read_write_64k) {
     furi_record_close(RECORD_STORAGE);
 }
 
+#define STORAGE_SEEK_FILE       UNIT_TESTS_PATH("seek.test")
+#define STORAGE_SEEK_BLOCK_SIZE (1024U)
+
+MU_TEST(storage_file_seek_large) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    // big enough for the link map in storage_ext
+    SDInfo sd_info;
+    mu_assert_int_eq(FSE_OK, storage_sd_info(storage, &sd_info));
+    const uint32_t size = sd_info.cluster_size * sd_info.sector_size * 20;
+    const uint32_t block_count = size / STORAGE_SEEK_BLOCK_SIZE;
+
+    uint32_t* block = malloc(STORAGE_SEEK_BLOCK_SIZE);
+    storage_simply_remove(storage, STORAGE_SEEK_FILE);
+    mu_check(storage_file_open(file, STORAGE_SEEK_FILE, FSAM_WRITE, FSOM_CREATE_NEW));
+    for(uint32_t i = 0; i < block_count; i++) {
+        block[0] = i;
+        mu_assert_int_eq(
+            STORAGE_SEEK_BLOCK_SIZE, storage_file_write(file, block, STORAGE_SEEK_BLOCK_SIZE));
+    }
+    mu_check(storage_file_close(file));
+
+    // back and forth over the whole file
+    mu_check(storage_file_open(file, STORAGE_SEEK_FILE, FSAM_READ, FSOM_OPEN_EXISTING));
+    uint32_t index = block_count - 1;
+    for(uint32_t i = 0; i < 64; i++) {
+        const uint32_t next = (index * 7 + i) % block_count;
+        if(next > index) {
+            const uint32_t offset = (next - index) * STORAGE_SEEK_BLOCK_SIZE - sizeof(uint32_t);
+            mu_check(storage_file_seek(file, offset, false));
+        } else {
+            mu_check(storage_file_seek(file, next * STORAGE_SEEK_BLOCK_SIZE, true));
+        }
+        mu_assert_int_eq(sizeof(uint32_t), storage_file_read(file, block, sizeof(uint32_t)));
+        mu_assert_int_eq(next, block[0]);
+        index = next;
+    }
+    mu_check(storage_file_seek(file, size, true));
+    mu_check(storage_file_eof(file));
+    mu_check(storage_file_close(file));
+
+    free(block);
+    mu_check(storage_simply_remove(storage, STORAGE_SEEK_FILE));
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
 MU_TEST_SUITE(storage_file) {
     storage_file_open_lock_setup();
     MU_RUN_TEST(storage_file_open_close);
@@ -185,6 +233,7 @@ MU_TEST_SUITE(storage_file) {
 
 MU_TEST_SUITE(storage_file_64k) {
     MU_RUN_TEST(storage_file_read_write_64k);
+    MU_RUN_TEST(storage_file_seek_large);
 }
 
 MU_TEST(storage_dir_open_close) {
@@ -482,10 +531,11 @@ static int32_t storage_test_app(void* arg) {
 }
 
 MU_TEST(test_storage_data_path_apps) {
-    for(size_t i = 0; i < storage_test_apps_count; i++) {
-        FuriThread* thread =
-            furi_thread_alloc_ex(storage_test_apps[i], 1024, storage_test_app, NULL);
-        furi_thread_set_appid(thread, storage_test_apps[i]);
+    // second round checks that removed app data dirs are not remembered as existing
+    for(size_t i = 0; i < storage_test_apps_count * 2; i++) {
+        const char* appid = storage_test_apps[i % storage_test_apps_count];
+        FuriThread* thread = furi_thread_alloc_ex(appid, 1024, storage_test_app, NULL);
+        furi_thread_set_appid(thread, appid);
         furi_thread_start(thread);
         furi_thread_join(thread);
 
@@ -494,13 +544,13 @@ MU_TEST(test_storage_data_path_apps) {
         // Check if app data dir and file exists
         Storage* storage = furi_record_open(RECORD_STORAGE);
         FuriString* expected = furi_string_alloc();
-        furi_string_printf(expected, APPSDATA_APP_PATH("%s"), storage_test_apps[i]);
+        furi_string_printf(expected, APPSDATA_APP_PATH("%s"), appid);
 
         mu_check(storage_dir_exists(storage, furi_string_get_cstr(expected)));
         furi_string_cat(expected, "/test");
         mu_check(storage_file_exists(storage, furi_string_get_cstr(expected)));
 
-        furi_string_printf(expected, APPSDATA_APP_PATH("%s"), storage_test_apps[i]);
+        furi_string_printf(expected, APPSDATA_APP_PATH("%s"), appid);
         storage_simply_remove_recursive(storage, furi_string_get_cstr(expected));
 
         furi_record_close(RECORD_STORAGE);
@@ -738,6 +788,102 @@ MU_TEST(test_md5_calc) {
     furi_record_close(RECORD_STORAGE);
 }
 
+#include <lib/toolbox/file_digest.h>
+#include <lib/toolbox/crc32_calc.h>
+
+MU_TEST(test_file_digest_calc) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    FileDigestCache* cache = file_digest_cache_alloc(storage, 2);
+
+    const char* path = UNIT_TESTS_RESOURCES_PATH("storage/md5.txt");
+    const uint32_t types = FileDigestTypeMd5 | FileDigestTypeSha256 | FileDigestTypeCrc32;
+
+    uint8_t md5[MD5_HASH_SIZE];
+    mu_check(md5_calc_file(file, path, md5, NULL));
+
+    mu_check(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING));
+    const uint32_t crc32 = crc32_calc_file(file, NULL, NULL);
+    storage_file_close(file);
+
+    FileDigest digest;
+    memset(&digest, 0, sizeof(digest));
+    mu_check(file_digest_calc_file(file, path, types, &digest, NULL));
+    mu_assert_mem_eq(md5, digest.md5, MD5_HASH_SIZE);
+    mu_assert_int_eq(crc32, digest.crc32);
+
+    FileDigest cached;
+    memset(&cached, 0, sizeof(cached));
+    mu_check(file_digest_cache_calc_file(cache, file, path, types, &cached, NULL));
+    mu_assert_mem_eq(&digest, &cached, sizeof(FileDigest));
+
+    memset(&cached, 0, sizeof(cached));
+    mu_check(file_digest_cache_calc_file(cache, file, path, types, &cached, NULL));
+    mu_assert_mem_eq(&digest, &cached, sizeof(FileDigest));
+
+    FS_Error error = FSE_OK;
+    mu_check(!file_digest_cache_calc_file(
+        cache, file, UNIT_TESTS_RESOURCES_PATH("storage/missing.txt"), types, &cached, &error));
+    mu_assert_int_eq(FSE_NOT_EXIST, error);
+
+    file_digest_cache_free(cache);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+#define FILE_DIGEST_TEST_FILE UNIT_TESTS_PATH("digest.test")
+
+static void test_file_digest_write(Storage* storage, const uint8_t* data, size_t size) {
+    File* file = storage_file_alloc(storage);
+    mu_check(storage_file_open(file, FILE_DIGEST_TEST_FILE, FSAM_WRITE, FSOM_CREATE_ALWAYS));
+    mu_assert_int_eq(size, storage_file_write(file, data, size));
+    storage_file_close(file);
+    storage_file_free(file);
+}
+
+MU_TEST(test_file_digest_sizes) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    FileDigestCache* cache = file_digest_cache_alloc(storage, 2);
+
+    // empty, single chunk, synchronous limit and pipelined sizes
+    const size_t sizes[] = {0, 100, 4096, 16 * 1024, 16 * 1024 + 1, 40 * 1024 + 7};
+    uint8_t* data = malloc(sizes[COUNT_OF(sizes) - 1]);
+
+    for(size_t i = 0; i < COUNT_OF(sizes); i++) {
+        const size_t size = sizes[i];
+        for(size_t j = 0; j < size; j++) {
+            data[j] = (j * 7 + i) & 0xFF;
+        }
+        test_file_digest_write(storage, data, size);
+
+        FileDigest digest;
+        mu_check(file_digest_calc_file(
+            file, FILE_DIGEST_TEST_FILE, FileDigestTypeCrc32, &digest, NULL));
+        mu_assert_int_eq(crc32_calc_buffer(0, data, size), digest.crc32);
+
+        // same size rewrite right after hashing must not be served from cache
+        mu_check(file_digest_cache_calc_file(
+            cache, file, FILE_DIGEST_TEST_FILE, FileDigestTypeCrc32, &digest, NULL));
+        mu_assert_int_eq(crc32_calc_buffer(0, data, size), digest.crc32);
+
+        for(size_t j = 0; j < size; j++) {
+            data[j] ^= 0x5A;
+        }
+        test_file_digest_write(storage, data, size);
+
+        mu_check(file_digest_cache_calc_file(
+            cache, file, FILE_DIGEST_TEST_FILE, FileDigestTypeCrc32, &digest, NULL));
+        mu_assert_int_eq(crc32_calc_buffer(0, data, size), digest.crc32);
+    }
+
+    free(data);
+    storage_common_remove(storage, FILE_DIGEST_TEST_FILE);
+    file_digest_cache_free(cache);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
 MU_TEST_SUITE(test_data_path) {
     MU_RUN_TEST(test_storage_data_path);
     MU_RUN_TEST(test_storage_data_path_apps);
@@ -749,6 +895,8 @@ MU_TEST_SUITE(test_storage_common) {
 
 MU_TEST_SUITE(test_md5_calc_suite) {
     MU_RUN_TEST(test_md5_calc);
+    MU_RUN_TEST(test_file_digest_calc);
+    MU_RUN_TEST(test_file_digest_sizes);
 }
 
 int run_minunit_test_storage(void) {
@@ -0,0 +1,181 @@
+#include <furi.h>
+#include <furi_hal.h>
+
+#include "../test.h" // IWYU pragma: keep
+
+#include <lib/subghz/receiver.h>
+#include <lib/subghz/protocols/protocol_items.h>
+
+// SubGhz is an external app, so its history is built into the test
+#include <applications/main/subghz/subghz_history.c>
+
+#define SUBGHZ_HISTORY_TEST_DIR_NAME EXT_PATH("unit_tests/subghz")
+#define SUBGHZ_HISTORY_TEST_COUNT    (150)
+#define SUBGHZ_HISTORY_TEST_TIMEOUT  (5000)
+
+static const char* const subghz_history_test_files[] = {
+    "princeton.sub",
+    "came_twee.sub",
+    "security_pls_2_0.sub",
+    "smc5326.sub",
+    "megacode.sub",
+    "nice_flo.sub",
+    "dooya.sub",
+};
+
+#define SUBGHZ_HISTORY_TEST_FILE_COUNT COUNT_OF(subghz_history_test_files)
+
+static uint8_t subghz_history_test_custom_preset_data[] = {0x02, 0x0D, 0x03, 0x07, 0x00, 0x00};
+
+static SubGhzProtocolDecoderBase*
+    subghz_history_test_load(SubGhzReceiver* receiver, const char* file_name) {
+    SubGhzProtocolDecoderBase* decoder = NULL;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+    FuriString* path =
+        furi_string_alloc_printf("%s/%s", SUBGHZ_HISTORY_TEST_DIR_NAME, file_name);
+    FuriString* protocol = furi_string_alloc();
+
+    do {
+        if(!flipper_format_file_open_existing(file, furi_string_get_cstr(path))) break;
+        if(!flipper_format_read_string(file, "Protocol", protocol)) break;
+        decoder = subghz_receiver_search_decoder_base_by_name(
+            receiver, furi_string_get_cstr(protocol));
+        if(!decoder) break;
+        if(!flipper_format_rewind(file)) break;
+        if(subghz_protocol_decoder_base_deserialize(decoder, file) != SubGhzProtocolStatusOk) {
+            decoder = NULL;
+        }
+    } while(false);
+
+    furi_string_free(protocol);
+    furi_string_free(path);
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return decoder;
+}
+
+static void subghz_history_test_read(FlipperFormat* flipper_format, FuriString* output) {
+    Stream* stream = flipper_format_get_raw_stream(flipper_format);
+    uint8_t buffer[32];
+    size_t was_read;
+
+    furi_string_reset(output);
+    stream_rewind(stream);
+    while((was_read = stream_read(stream, buffer, sizeof(buffer))) > 0) {
+        furi_string_cat_printf(output, "%.*s", (int)was_read, (const char*)buffer);
+    }
+}
+
+MU_TEST(subghz_history_test_round_trip) {
+    SubGhzEnvironment* environment = subghz_environment_alloc();
+    subghz_environment_set_protocol_registry(environment, (void*)&subghz_protocol_registry);
+    SubGhzReceiver* receiver = subghz_receiver_alloc_init(environment);
+
+    SubGhzProtocolDecoderBase* decoders[SUBGHZ_HISTORY_TEST_FILE_COUNT];
+    for(size_t i = 0; i < SUBGHZ_HISTORY_TEST_FILE_COUNT; i++) {
+        decoders[i] = subghz_history_test_load(receiver, subghz_history_test_files[i]);
+        mu_assert(decoders[i], "Test signal load error");
+    }
+
+    // The custom preset is printed with its data
+    SubGhzRadioPreset presets[] = {
+        {
+            .name = furi_string_alloc_set_str("AM650"),
+            .frequency = 433920000,
+        },
+        {
+            .name = furi_string_alloc_set_str("Test"),
+            .frequency = 315000000,
+            .data = subghz_history_test_custom_preset_data,
+            .data_size = sizeof(subghz_history_test_custom_preset_data),
+        },
+    };
+
+    SubGhzHistory* history = subghz_history_alloc();
+    bool added = true;
+    for(size_t i = 0; added && (i < SUBGHZ_HISTORY_TEST_COUNT); i++) {
+        const uint32_t start = furi_get_tick();
+        const uint16_t lost = subghz_history_get_lost(history);
+        do {
+            // Not a repeat of the previous signal
+            history->last_update_timestamp = furi_get_tick() - 1000;
+            added = subghz_history_add_to_history(
+                history,
+                decoders[i % SUBGHZ_HISTORY_TEST_FILE_COUNT],
+                &presets[i % COUNT_OF(presets)],
+                -60.0f);
+            if(!added) {
+                // Counted when the worker has not freed RAM yet
+                if(subghz_history_get_lost(history) == lost ||
+                   subghz_history_get_text_space_left(history, NULL)) {
+                    break;
+                }
+                furi_delay_ms(1);
+            }
+        } while(!added && (furi_get_tick() - start < SUBGHZ_HISTORY_TEST_TIMEOUT));
+    }
+
+    // Wait until the oldest records are in the journal
+    const uint32_t start = furi_get_tick();
+    while(furi_get_tick() - start < SUBGHZ_HISTORY_TEST_TIMEOUT) {
+        furi_check(furi_mutex_acquire(history->mutex, FuriWaitForever) == FuriStatusOk);
+        const bool spill_needed = subghz_history_ram_spill_needed(history);
+        furi_mutex_release(history->mutex);
+        if(!spill_needed) break;
+        furi_delay_ms(10);
+    }
+    const uint16_t journal_count = history->ram_first;
+
+    FlipperFormat* expected_format = flipper_format_string_alloc();
+    FuriString* expected = furi_string_alloc();
+    FuriString* actual = furi_string_alloc();
+    size_t mismatch_count = 0;
+    for(size_t i = 0; added && (i < SUBGHZ_HISTORY_TEST_COUNT); i++) {
+        SubGhzProtocolDecoderBase* decoder = decoders[i % SUBGHZ_HISTORY_TEST_FILE_COUNT];
+        subghz_protocol_decoder_base_serialize(
+            decoder, expected_format, &presets[i % COUNT_OF(presets)]);
+        subghz_history_test_read(expected_format, expected);
+
+        FlipperFormat* raw_data = subghz_history_get_raw_data(history, i);
+        if(raw_data) {
+            subghz_history_test_read(raw_data, actual);
+        } else {
+            furi_string_reset(actual);
+        }
+
+        if(!furi_string_equal(expected, actual) ||
+           strcmp(subghz_history_get_protocol_name(history, i), decoder->protocol->name) != 0) {
+            FURI_LOG_E(TAG, "Record %zu differs", i);
+            mismatch_count++;
+        }
+    }
+    const uint16_t item_count = subghz_history_get_item(history);
+
+    furi_string_free(actual);
+    furi_string_free(expected);
+    flipper_format_free(expected_format);
+    subghz_history_free(history);
+    for(size_t i = 0; i < COUNT_OF(presets); i++) {
+        furi_string_free(presets[i].name);
+    }
+    subghz_receiver_free(receiver);
+    subghz_environment_free(environment);
+
+    mu_assert(added, "Signal was not added");
+    mu_assert_int_eq(SUBGHZ_HISTORY_TEST_COUNT, item_count);
+    mu_assert(journal_count > 0, "No records in the journal");
+    mu_assert(journal_count < item_count, "No records in RAM");
+    mu_assert_int_eq(0, mismatch_count);
+}
+
+MU_TEST_SUITE(test_subghz_history_suite) {
+    MU_RUN_TEST(subghz_history_test_round_trip);
+}
+
+int run_minunit_test_subghz_history(void) {
+    MU_RUN_SUITE(test_subghz_history_suite);
+    return MU_EXIT_CODE;
+}
+
+TEST_API_DEFINE(run_minunit_test_subghz_history)
@@ -15,6 +15,18 @@ static constexpr auto unit_tests_api_table = sort(create_array_t<sym_entry>(
     API_METHOD(resource_manifest_reader_open, bool, (ResourceManifestReader*, const char*)),
     API_METHOD(resource_manifest_reader_next, ResourceManifestEntry*, (ResourceManifestReader*)),
     API_METHOD(resource_manifest_reader_previous, ResourceManifestEntry*, (ResourceManifestReader*)),
+    API_METHOD(resource_manifest_index_alloc, ResourceManifestIndex*, (Storage*, const char*)),
+    API_METHOD(resource_manifest_index_free, void, (ResourceManifestIndex*)),
+    API_METHOD(resource_manifest_index_get_count, size_t, (const ResourceManifestIndex*)),
+    API_METHOD(
+        resource_manifest_index_match,
+        ResourceManifestIndexMatch,
+        (const ResourceManifestIndex*, const ResourceManifestEntry*)),
+    API_METHOD(resource_manifest_index_set_installed, void, (ResourceManifestIndex*, const char*)),
+    API_METHOD(
+        resource_manifest_index_is_installed,
+        bool,
+        (const ResourceManifestIndex*, const char*)),
     API_METHOD(slix_process_iso15693_3_error, SlixError, (Iso15693_3Error)),
     API_METHOD(iso15693_3_poller_get_data, const Iso15693_3Data*, (Iso15693_3Poller*)),
     API_METHOD(rpc_system_storage_get_error, PB_CommandStatus, (FS_Error)),
@@ -13,9 +13,6 @@
 
 #define WORKER_TAG TAG "Worker"
 
-#define BADUSB_ASCII_TO_KEY(script, x) \
-    (((uint8_t)x < 128) ? (script->layout[(uint8_t)x]) : HID_KEYBOARD_NONE)
-
 typedef enum {
     WorkerEvtStartStop = (1 << 0),
     WorkerEvtPauseResume = (1 << 1),
@@ -24,8 +21,6 @@ typedef enum {
     WorkerEvtDisconnect = (1 << 4),
 } WorkerEvtFlags;
 
-static const char ducky_cmd_id[] = {"ID"};
-
 static const uint8_t numpad_keys[10] = {
     HID_KEYPAD_0,
     HID_KEYPAD_1,
@@ -39,12 +34,9 @@ static const uint8_t numpad_keys[10] = {
     HID_KEYPAD_9,
 };
 
-uint32_t ducky_get_command_len(const char* line) {
-    uint32_t len = strlen(line);
-    for(uint32_t i = 0; i < len; i++) {
-        if(line[i] == ' ') return i;
-    }
-    return 0;
+const char* ducky_get_param(const char* line) {
+    const char* param = strchr(line, ' ');
+    return param ? &param[1] : &line[strlen(line)];
 }
 
 bool ducky_is_line_end(const char chr) {
@@ -72,57 +64,17 @@ bool ducky_get_number(const char* param, uint32_t* val) {
     return false;
 }
 
-void ducky_numlock_on(BadUsbScript* bad_usb) {
-    if((bad_usb->hid->get_led_state(bad_usb->hid_inst) & HID_KB_LED_NUM) == 0) {
-        bad_usb->hid->kb_press(bad_usb->hid_inst, HID_KEYBOARD_LOCK_NUM_LOCK);
-        bad_usb->hid->kb_release(bad_usb->hid_inst, HID_KEYBOARD_LOCK_NUM_LOCK);
-    }
-}
-
-bool ducky_numpad_press(BadUsbScript* bad_usb, const char num) {
-    if((num < '0') || (num > '9')) return false;
-
-    uint16_t key = numpad_keys[num - '0'];
-    bad_usb->hid->kb_press(bad_usb->hid_inst, key);
-    bad_usb->hid->kb_release(bad_usb->hid_inst, key);
-
-    return true;
-}
-
-bool ducky_altchar(BadUsbScript* bad_usb, const char* charcode) {
+bool ducky_add_altcode(BadUsbScript* bad_usb, const char* charcode) {
     uint8_t i = 0;
-    bool state = false;
-
-    bad_usb->hid->kb_press(bad_usb->hid_inst, KEY_MOD_LEFT_ALT);
 
     while(!ducky_is_line_end(charcode[i])) {
-        state = ducky_numpad_press(bad_usb, charcode[i]);
-        if(state == false) break;
+        if((charcode[i] < '0') || (charcode[i] > '9')) return false;
+        DuckyKeyArray_push_back(bad_usb->keys, numpad_keys[charcode[i] - '0']);
         i++;
     }
+    DuckyKeyArray_push_back(bad_usb->keys, HID_KEYBOARD_NONE);
 
-    bad_usb->hid->kb_release(bad_usb->hid_inst, KEY_MOD_LEFT_ALT);
-    return state;
-}
-
-bool ducky_altstring(BadUsbScript* bad_usb, const char* param) {
-    uint32_t i = 0;
-    bool state = false;
-
-    while(param[i] != '\0') {
-        if((param[i] < ' ') || (param[i] > '~')) {
-            i++;
-            continue; // Skip non-printable chars
-        }
-
-        char temp_str[4];
-        snprintf(temp_str, 4, "%u", param[i]);
-
-        state = ducky_altchar(bad_usb, temp_str);
-        if(state == false) break;
-        i++;
-    }
-    return state;
+    return i > 0;
 }
 
 int32_t ducky_error(BadUsbScript* bad_usb, const char* text, ...) {
@@ -135,102 +87,131 @@ int32_t ducky_error(BadUsbScript* bad_usb, const char* text, ...) {
     return SCRIPT_STATE_ERROR;
 }
 
-bool ducky_string(BadUsbScript* bad_usb, const char* param) {
-    uint32_t i = 0;
-
-    while(param[i] != '\0') {
-        if(param[i] != '\n') {
-            uint16_t keycode = BADUSB_ASCII_TO_KEY(bad_usb, param[i]);
-            if(keycode != HID_KEYBOARD_NONE) {
-                bad_usb->hid->kb_press(bad_usb->hid_inst, keycode);
-                bad_usb->hid->kb_release(bad_usb->hid_inst, keycode);
-            }
-        } else {
-            bad_usb->hid->kb_press(bad_usb->hid_inst, HID_KEYBOARD_RETURN);
-            bad_usb->hid->kb_release(bad_usb->hid_inst, HID_KEYBOARD_RETURN);
-        }
-        i++;
+static void ducky_numlock_on(BadUsbScript* bad_usb) {
+    if((bad_usb->hid->get_led_state(bad_usb->hid_inst) & HID_KB_LED_NUM) == 0) {
+        bad_usb->hid->kb_press(bad_usb->hid_inst, HID_KEYBOARD_LOCK_NUM_LOCK);
+        bad_usb->hid->kb_release(bad_usb->hid_inst, HID_KEYBOARD_LOCK_NUM_LOCK);
     }
-    bad_usb->stringdelay = 0;
-    return true;
 }
 
-static bool ducky_string_next(BadUsbScript* bad_usb) {
-    if(bad_usb->string_print_pos >= furi_string_size(bad_usb->string_print)) {
-        return true;
-    }
+static void ducky_altcode(BadUsbScript* bad_usb, const DuckyOp* op) {
+    bool alt_pressed = false;
 
-    char print_char = furi_string_get_char(bad_usb->string_print, bad_usb->string_print_pos);
-
-    if(print_char != '\n') {
-        uint16_t keycode = BADUSB_ASCII_TO_KEY(bad_usb, print_char);
+    for(size_t i = 0; i < op->size; i++) {
+        uint16_t keycode = *DuckyKeyArray_cget(bad_usb->keys, op->param + i);
+        if(!alt_pressed) {
+            bad_usb->hid->kb_press(bad_usb->hid_inst, KEY_MOD_LEFT_ALT);
+            alt_pressed = true;
+        }
         if(keycode != HID_KEYBOARD_NONE) {
             bad_usb->hid->kb_press(bad_usb->hid_inst, keycode);
             bad_usb->hid->kb_release(bad_usb->hid_inst, keycode);
+        } else { // End of char code
+            bad_usb->hid->kb_release(bad_usb->hid_inst, KEY_MOD_LEFT_ALT);
+            alt_pressed = false;
         }
-    } else {
-        bad_usb->hid->kb_press(bad_usb->hid_inst, HID_KEYBOARD_RETURN);
-        bad_usb->hid->kb_release(bad_usb->hid_inst, HID_KEYBOARD_RETURN);
     }
-
-    bad_usb->string_print_pos++;
-
-    return false;
 }
 
-static int32_t ducky_parse_line(BadUsbScript* bad_usb, FuriString* line) {
-    uint32_t line_len = furi_string_size(line);
-    const char* line_tmp = furi_string_get_cstr(line);
-
-    if(line_len == 0) {
-        return SCRIPT_STATE_NEXT_LINE; // Skip empty lines
+static void ducky_string(BadUsbScript* bad_usb, const DuckyOp* op) {
+    // Keycodes are resolved at compile time, so reports go out back to back
+    for(size_t i = 0; i < op->size; i++) {
+        uint16_t keycode = *DuckyKeyArray_cget(bad_usb->keys, op->param + i);
+        bad_usb->hid->kb_press(bad_usb->hid_inst, keycode);
+        bad_usb->hid->kb_release(bad_usb->hid_inst, keycode);
     }
-    FURI_LOG_D(WORKER_TAG, "line:%s", line_tmp);
+    bad_usb->stringdelay = 0;
+}
 
-    // Ducky Lang Functions
-    int32_t cmd_result = ducky_execute_cmd(bad_usb, line_tmp);
-    if(cmd_result != SCRIPT_STATE_CMD_UNKNOWN) {
-        return cmd_result;
+static bool ducky_string_next(BadUsbScript* bad_usb) {
+    const DuckyOp* op = DuckyOpArray_cget(bad_usb->ops, bad_usb->string_op);
+    if(bad_usb->string_print_pos >= op->size) {
+        return true;
     }
 
-    // Special keys + modifiers
-    uint16_t key = ducky_get_keycode(bad_usb, line_tmp, false);
-    if(key == HID_KEYBOARD_NONE) {
-        return ducky_error(bad_usb, "No keycode defined for %s", line_tmp);
-    }
-    if((key & 0xFF00) != 0) {
-        // It's a modifier key
-        line_tmp = &line_tmp[ducky_get_command_len(line_tmp) + 1];
-        key |= ducky_get_keycode(bad_usb, line_tmp, true);
-    }
-    bad_usb->hid->kb_press(bad_usb->hid_inst, key);
-    bad_usb->hid->kb_release(bad_usb->hid_inst, key);
-    return 0;
+    uint16_t keycode = *DuckyKeyArray_cget(bad_usb->keys, op->param + bad_usb->string_print_pos);
+    bad_usb->hid->kb_press(bad_usb->hid_inst, keycode);
+    bad_usb->hid->kb_release(bad_usb->hid_inst, keycode);
+
+    bad_usb->string_print_pos++;
+
+    return false;
 }
 
-static bool ducky_set_usb_id(BadUsbScript* bad_usb, const char* line) {
-    if(sscanf(line, "%lX:%lX", &bad_usb->hid_cfg.vid, &bad_usb->hid_cfg.pid) == 2) {
-        bad_usb->hid_cfg.manuf[0] = '\0';
-        bad_usb->hid_cfg.product[0] = '\0';
-
-        uint8_t id_len = ducky_get_command_len(line);
-        if(!ducky_is_line_end(line[id_len + 1])) {
-            sscanf(
-                &line[id_len + 1],
-                "%31[^\r\n:]:%31[^\r\n]",
-                bad_usb->hid_cfg.manuf,
-                bad_usb->hid_cfg.product);
+static int32_t ducky_execute_op(BadUsbScript* bad_usb, uint32_t op_index) {
+    const DuckyOp* op = DuckyOpArray_cget(bad_usb->ops, op_index);
+
+    switch(op->type) {
+    case DuckyOpNop:
+        break;
+    case DuckyOpKey:
+        bad_usb->hid->kb_press(bad_usb->hid_inst, op->param);
+        bad_usb->hid->kb_release(bad_usb->hid_inst, op->param);
+        break;
+    case DuckyOpString:
+        if(bad_usb->stringdelay == 0 &&
+           bad_usb->defstringdelay == 0) { // stringdelay not set - run command immediately
+            ducky_string(bad_usb, op);
+        } else { // stringdelay is set - run command in thread to keep handling external events
+            bad_usb->string_op = op_index;
+            return SCRIPT_STATE_STRING_START;
         }
-        FURI_LOG_D(
-            WORKER_TAG,
-            "set id: %04lX:%04lX mfr:%s product:%s",
-            bad_usb->hid_cfg.vid,
-            bad_usb->hid_cfg.pid,
-            bad_usb->hid_cfg.manuf,
-            bad_usb->hid_cfg.product);
-        return true;
+        break;
+    case DuckyOpDelay:
+        return (int32_t)op->param;
+    case DuckyOpDefaultDelay:
+        bad_usb->defdelay = op->param;
+        break;
+    case DuckyOpStringDelay:
+        bad_usb->stringdelay = op->param;
+        break;
+    case DuckyOpDefaultStringDelay:
+        bad_usb->defstringdelay = op->param;
+        break;
+    case DuckyOpRepeat:
+        if(op->size != DUCKY_OP_NONE) {
+            bad_usb->repeat_op = op->size;
+            bad_usb->repeat_cnt = op->param;
+        }
+        break;
+    case DuckyOpSysrq:
+        bad_usb->hid->kb_press(bad_usb->hid_inst, KEY_MOD_LEFT_ALT | HID_KEYBOARD_PRINT_SCREEN);
+        bad_usb->hid->kb_press(bad_usb->hid_inst, op->param);
+        bad_usb->hid->release_all(bad_usb->hid_inst);
+        break;
+    case DuckyOpAltCode:
+        ducky_numlock_on(bad_usb);
+        ducky_altcode(bad_usb, op);
+        break;
+    case DuckyOpHold:
+        bad_usb->key_hold_nb++;
+        if(bad_usb->key_hold_nb > (HID_KB_MAX_KEYS - 1)) {
+            return ducky_error(bad_usb, "Too many keys are hold");
+        }
+        bad_usb->hid->kb_press(bad_usb->hid_inst, op->param);
+        break;
+    case DuckyOpRelease:
+        if(bad_usb->key_hold_nb == 0) {
+            return ducky_error(bad_usb, "No keys are hold");
+        }
+        bad_usb->key_hold_nb--;
+        bad_usb->hid->kb_release(bad_usb->hid_inst, op->param);
+        break;
+    case DuckyOpMedia:
+        bad_usb->hid->consumer_press(bad_usb->hid_inst, op->param);
+        bad_usb->hid->consumer_release(bad_usb->hid_inst, op->param);
+        break;
+    case DuckyOpGlobe:
+        bad_usb->hid->consumer_press(bad_usb->hid_inst, HID_CONSUMER_FN_GLOBE);
+        bad_usb->hid->kb_press(bad_usb->hid_inst, op->param);
+        bad_usb->hid->kb_release(bad_usb->hid_inst, op->param);
+        bad_usb->hid->consumer_release(bad_usb->hid_inst, HID_CONSUMER_FN_GLOBE);
+        break;
+    case DuckyOpWaitForButton:
+        return SCRIPT_STATE_WAIT_FOR_BTN;
     }
-    return false;
+
+    return 0;
 }
 
 static void bad_usb_hid_state_callback(bool state, void* context) {
@@ -245,37 +226,15 @@ static void bad_usb_hid_state_callback(bool state, void* context) {
 }
 
 static bool ducky_script_preload(BadUsbScript* bad_usb, File* script_file) {
-    uint8_t ret = 0;
-    uint32_t line_len = 0;
-
-    furi_string_reset(bad_usb->line);
-
-    do {
-        ret = storage_file_read(script_file, bad_usb->file_buf, FILE_BUFFER_LEN);
-        for(uint16_t i = 0; i < ret; i++) {
-            if(bad_usb->file_buf[i] == '\n' && line_len > 0) {
-                bad_usb->st.line_nb++;
-                line_len = 0;
-            } else {
-                if(bad_usb->st.line_nb == 0) { // Save first line
-                    furi_string_push_back(bad_usb->line, bad_usb->file_buf[i]);
-                }
-                line_len++;
-            }
-        }
-        if(storage_file_eof(script_file)) {
-            if(line_len > 0) {
-                bad_usb->st.line_nb++;
-                break;
-            }
-        }
-    } while(ret > 0);
-
-    const char* line_tmp = furi_string_get_cstr(bad_usb->line);
     bool id_set = false; // Looking for ID command at first line
-    if(strncmp(line_tmp, ducky_cmd_id, strlen(ducky_cmd_id)) == 0) {
-        id_set = ducky_set_usb_id(bad_usb, &line_tmp[strlen(ducky_cmd_id) + 1]);
+    bool state = true;
+
+    // Check the whole script and count lines
+    ducky_script_compile_reset(bad_usb);
+    while(state && !bad_usb->compile_end) {
+        state = ducky_script_compile_next(bad_usb, script_file, &id_set);
     }
+    bad_usb->st.line_nb = bad_usb->compile_line;
 
     if(id_set) {
         bad_usb->hid_inst = bad_usb->hid->init(&bad_usb->hid_cfg);
@@ -284,79 +243,54 @@ static bool ducky_script_preload(BadUsbScript* bad_usb, File* script_file) {
     }
     bad_usb->hid->set_state_callback(bad_usb->hid_inst, bad_usb_hid_state_callback, bad_usb);
 
-    storage_file_seek(script_file, 0, true);
-    furi_string_reset(bad_usb->line);
+    return state;
+}
+
+static void ducky_script_prepare(BadUsbScript* bad_usb) {
+    // Compiled again on run to pick up current keyboard layout
+    ducky_script_compile_reset(bad_usb);
 
-    return true;
+    bad_usb->op_next = 0;
+    bad_usb->st.line_cur = 0;
+    bad_usb->defdelay = 0;
+    bad_usb->stringdelay = 0;
+    bad_usb->defstringdelay = 0;
+    bad_usb->repeat_cnt = 0;
+    bad_usb->key_hold_nb = 0;
 }
 
 static int32_t ducky_script_execute_next(BadUsbScript* bad_usb, File* script_file) {
-    int32_t delay_val = 0;
+    uint32_t op_index = 0;
 
     if(bad_usb->repeat_cnt > 0) {
         bad_usb->repeat_cnt--;
-        delay_val = ducky_parse_line(bad_usb, bad_usb->line_prev);
-        if(delay_val == SCRIPT_STATE_NEXT_LINE) { // Empty line
-            return 0;
-        } else if(delay_val == SCRIPT_STATE_STRING_START) { // Print string with delays
-            return delay_val;
-        } else if(delay_val == SCRIPT_STATE_WAIT_FOR_BTN) { // wait for button
-            return delay_val;
-        } else if(delay_val < 0) { // Script error
-            bad_usb->st.error_line = bad_usb->st.line_cur - 1;
-            FURI_LOG_E(WORKER_TAG, "Unknown command at line %zu", bad_usb->st.line_cur - 1U);
-            return SCRIPT_STATE_ERROR;
-        } else {
-            return delay_val + bad_usb->defdelay;
-        }
-    }
-
-    furi_string_set(bad_usb->line_prev, bad_usb->line);
-    furi_string_reset(bad_usb->line);
-
-    while(1) {
-        if(bad_usb->buf_len == 0) {
-            bad_usb->buf_len = storage_file_read(script_file, bad_usb->file_buf, FILE_BUFFER_LEN);
-            if(storage_file_eof(script_file)) {
-                if((bad_usb->buf_len < FILE_BUFFER_LEN) && (bad_usb->file_end == false)) {
-                    bad_usb->file_buf[bad_usb->buf_len] = '\n';
-                    bad_usb->buf_len++;
-                    bad_usb->file_end = true;
-                }
+        op_index = bad_usb->repeat_op;
+    } else {
+        while(bad_usb->op_next >= DuckyOpArray_size(bad_usb->ops)) {
+            if(bad_usb->compile_end) {
+                bad_usb->st.line_cur = bad_usb->st.line_nb;
+                return SCRIPT_STATE_END;
             }
-
-            bad_usb->buf_start = 0;
-            if(bad_usb->buf_len == 0) return SCRIPT_STATE_END;
-        }
-        for(uint8_t i = bad_usb->buf_start; i < (bad_usb->buf_start + bad_usb->buf_len); i++) {
-            if(bad_usb->file_buf[i] == '\n' && furi_string_size(bad_usb->line) > 0) {
-                bad_usb->st.line_cur++;
-                bad_usb->buf_len = bad_usb->buf_len + bad_usb->buf_start - (i + 1);
-                bad_usb->buf_start = i + 1;
-                furi_string_trim(bad_usb->line);
-                delay_val = ducky_parse_line(bad_usb, bad_usb->line);
-                if(delay_val == SCRIPT_STATE_NEXT_LINE) { // Empty line
-                    return 0;
-                } else if(delay_val == SCRIPT_STATE_STRING_START) { // Print string with delays
-                    return delay_val;
-                } else if(delay_val == SCRIPT_STATE_WAIT_FOR_BTN) { // wait for button
-                    return delay_val;
-                } else if(delay_val < 0) {
-                    bad_usb->st.error_line = bad_usb->st.line_cur;
-                    FURI_LOG_E(WORKER_TAG, "Unknown command at line %zu", bad_usb->st.line_cur);
-                    return SCRIPT_STATE_ERROR;
-                } else {
-                    return delay_val + bad_usb->defdelay;
-                }
-            } else {
-                furi_string_push_back(bad_usb->line, bad_usb->file_buf[i]);
+            if(!ducky_script_compile_next(bad_usb, script_file, NULL)) {
+                return SCRIPT_STATE_ERROR;
             }
         }
-        bad_usb->buf_len = 0;
-        if(bad_usb->file_end) return SCRIPT_STATE_END;
+        op_index = bad_usb->op_next++;
+        bad_usb->st.line_cur = DuckyOpArray_cget(bad_usb->ops, op_index)->line;
     }
 
-    return 0;
+    int32_t delay_val = ducky_execute_op(bad_usb, op_index);
+    if(delay_val == SCRIPT_STATE_STRING_START) { // Print string with delays
+        return delay_val;
+    } else if(delay_val == SCRIPT_STATE_WAIT_FOR_BTN) { // wait for button
+        return delay_val;
+    } else if(delay_val < 0) { // Script error
+        bad_usb->st.error_line = bad_usb->st.line_cur;
+        FURI_LOG_E(WORKER_TAG, "Error at line %zu", bad_usb->st.line_cur);
+        return SCRIPT_STATE_ERROR;
+    } else {
+        return delay_val + bad_usb->defdelay;
+    }
 }
 
 static uint32_t bad_usb_flags_get(uint32_t flags_mask, uint32_t timeout) {
@@ -381,9 +315,9 @@ static int32_t bad_usb_worker(void* context) {
 
     FURI_LOG_I(WORKER_TAG, "Init");
     File* script_file = storage_file_alloc(furi_record_open(RECORD_STORAGE));
-    bad_usb->line = furi_string_alloc();
-    bad_usb->line_prev = furi_string_alloc();
-    bad_usb->string_print = furi_string_alloc();
+    DuckyOpArray_init(bad_usb->ops);
+    DuckyKeyArray_init(bad_usb->keys);
+    DuckyDefineArray_init(bad_usb->defines);
 
     while(1) {
         if(worker_state == BadUsbStateInit) { // State: initialization
@@ -430,15 +364,7 @@ static int32_t bad_usb_worker(void* context) {
             } else if(flags & WorkerEvtStartStop) { // Start executing script
                 dolphin_deed(DolphinDeedBadUsbPlayScript);
                 delay_val = 0;
-                bad_usb->buf_len = 0;
-                bad_usb->st.line_cur = 0;
-                bad_usb->defdelay = 0;
-                bad_usb->stringdelay = 0;
-                bad_usb->defstringdelay = 0;
-                bad_usb->repeat_cnt = 0;
-                bad_usb->key_hold_nb = 0;
-                bad_usb->file_end = false;
-                storage_file_seek(script_file, 0, true);
+                ducky_script_prepare(bad_usb);
                 worker_state = BadUsbStateRunning;
             } else if(flags & WorkerEvtDisconnect) {
                 worker_state = BadUsbStateNotConnected; // USB disconnected
@@ -454,14 +380,7 @@ static int32_t bad_usb_worker(void* context) {
             } else if(flags & WorkerEvtConnect) { // Start executing script
                 dolphin_deed(DolphinDeedBadUsbPlayScript);
                 delay_val = 0;
-                bad_usb->buf_len = 0;
-                bad_usb->st.line_cur = 0;
-                bad_usb->defdelay = 0;
-                bad_usb->stringdelay = 0;
-                bad_usb->defstringdelay = 0;
-                bad_usb->repeat_cnt = 0;
-                bad_usb->file_end = false;
-                storage_file_seek(script_file, 0, true);
+                ducky_script_prepare(bad_usb);
                 // extra time for PC to recognize Flipper as keyboard
                 flags = furi_thread_flags_wait(
                     WorkerEvtEnd | WorkerEvtDisconnect | WorkerEvtStartStop,
@@ -635,9 +554,10 @@ static int32_t bad_usb_worker(void* context) {
 
     storage_file_close(script_file);
     storage_file_free(script_file);
-    furi_string_free(bad_usb->line);
-    furi_string_free(bad_usb->line_prev);
-    furi_string_free(bad_usb->string_print);
+    ducky_script_compile_reset(bad_usb);
+    DuckyOpArray_clear(bad_usb->ops);
+    DuckyKeyArray_clear(bad_usb->keys);
+    DuckyDefineArray_clear(bad_usb->defines);
 
     FURI_LOG_I(WORKER_TAG, "End");
 
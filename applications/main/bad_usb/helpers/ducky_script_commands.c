@@ -2,240 +2,171 @@
 #include "ducky_script.h"
 #include "ducky_script_i.h"
 
-typedef int32_t (*DuckyCmdCallback)(BadUsbScript* bad_usb, const char* line, int32_t param);
+typedef int32_t (*DuckyCmdCallback)(
+    BadUsbScript* bad_usb,
+    const char* line,
+    int32_t param,
+    DuckyOp* op);
 
 typedef struct {
     char* name;
     DuckyCmdCallback callback;
+    DuckyOpType type;
     int32_t param;
 } DuckyCmd;
 
-static int32_t ducky_fnc_delay(BadUsbScript* bad_usb, const char* line, int32_t param) {
+static int32_t
+    ducky_fnc_delay(BadUsbScript* bad_usb, const char* line, int32_t param, DuckyOp* op) {
     UNUSED(param);
 
-    line = &line[ducky_get_command_len(line) + 1];
-    uint32_t delay_val = 0;
-    bool state = ducky_get_number(line, &delay_val);
-    if((state) && (delay_val > 0)) {
-        return (int32_t)delay_val;
+    line = ducky_get_param(line);
+    bool state = ducky_get_number(line, &op->param);
+    if((state) && (op->param > 0)) {
+        return 0;
     }
 
     return ducky_error(bad_usb, "Invalid number %s", line);
 }
 
-static int32_t ducky_fnc_defdelay(BadUsbScript* bad_usb, const char* line, int32_t param) {
+static int32_t
+    ducky_fnc_number(BadUsbScript* bad_usb, const char* line, int32_t param, DuckyOp* op) {
     UNUSED(param);
 
-    line = &line[ducky_get_command_len(line) + 1];
-    bool state = ducky_get_number(line, &bad_usb->defdelay);
+    line = ducky_get_param(line);
+    bool state = ducky_get_number(line, &op->param);
     if(!state) {
         return ducky_error(bad_usb, "Invalid number %s", line);
     }
     return 0;
 }
 
-static int32_t ducky_fnc_strdelay(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    UNUSED(param);
-
-    line = &line[ducky_get_command_len(line) + 1];
-    bool state = ducky_get_number(line, &bad_usb->stringdelay);
-    if(!state) {
-        return ducky_error(bad_usb, "Invalid number %s", line);
-    }
-    return 0;
-}
-
-static int32_t ducky_fnc_defstrdelay(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    UNUSED(param);
+static int32_t
+    ducky_fnc_string(BadUsbScript* bad_usb, const char* line, int32_t param, DuckyOp* op) {
+    line = ducky_get_param(line);
+    op->param = DuckyKeyArray_size(bad_usb->keys);
 
-    line = &line[ducky_get_command_len(line) + 1];
-    bool state = ducky_get_number(line, &bad_usb->defstringdelay);
-    if(!state) {
-        return ducky_error(bad_usb, "Invalid number %s", line);
+    for(size_t i = 0; line[i] != '\0'; i++) {
+        uint16_t keycode = BADUSB_ASCII_TO_KEY(bad_usb, line[i]);
+        if(keycode != HID_KEYBOARD_NONE) {
+            DuckyKeyArray_push_back(bad_usb->keys, keycode);
+        }
     }
-    return 0;
-}
-
-static int32_t ducky_fnc_string(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    line = &line[ducky_get_command_len(line) + 1];
-    furi_string_set_str(bad_usb->string_print, line);
     if(param == 1) {
-        furi_string_cat(bad_usb->string_print, "\n");
-    }
-
-    if(bad_usb->stringdelay == 0 &&
-       bad_usb->defstringdelay == 0) { // stringdelay not set - run command immediately
-        bool state = ducky_string(bad_usb, furi_string_get_cstr(bad_usb->string_print));
-        if(!state) {
-            return ducky_error(bad_usb, "Invalid string %s", line);
-        }
-    } else { // stringdelay is set - run command in thread to keep handling external events
-        return SCRIPT_STATE_STRING_START;
+        DuckyKeyArray_push_back(bad_usb->keys, HID_KEYBOARD_RETURN);
     }
 
+    op->size = DuckyKeyArray_size(bad_usb->keys) - op->param;
     return 0;
 }
 
-static int32_t ducky_fnc_repeat(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    UNUSED(param);
-
-    line = &line[ducky_get_command_len(line) + 1];
-    bool state = ducky_get_number(line, &bad_usb->repeat_cnt);
-    if((!state) || (bad_usb->repeat_cnt == 0)) {
-        return ducky_error(bad_usb, "Invalid number %s", line);
+static int32_t
+    ducky_fnc_keycode(BadUsbScript* bad_usb, const char* line, int32_t param, DuckyOp* op) {
+    line = ducky_get_param(line);
+    op->param = ducky_get_keycode(bad_usb, line, true);
+    if((param == 1) && (op->param == HID_KEYBOARD_NONE)) {
+        return ducky_error(bad_usb, "No keycode defined for %s", line);
     }
     return 0;
 }
 
-static int32_t ducky_fnc_sysrq(BadUsbScript* bad_usb, const char* line, int32_t param) {
+static int32_t
+    ducky_fnc_altchar(BadUsbScript* bad_usb, const char* line, int32_t param, DuckyOp* op) {
     UNUSED(param);
 
-    line = &line[ducky_get_command_len(line) + 1];
-    uint16_t key = ducky_get_keycode(bad_usb, line, true);
-    bad_usb->hid->kb_press(bad_usb->hid_inst, KEY_MOD_LEFT_ALT | HID_KEYBOARD_PRINT_SCREEN);
-    bad_usb->hid->kb_press(bad_usb->hid_inst, key);
-    bad_usb->hid->release_all(bad_usb->hid_inst);
-    return 0;
-}
-
-static int32_t ducky_fnc_altchar(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    UNUSED(param);
-
-    line = &line[ducky_get_command_len(line) + 1];
-    ducky_numlock_on(bad_usb);
-    bool state = ducky_altchar(bad_usb, line);
+    line = ducky_get_param(line);
+    op->param = DuckyKeyArray_size(bad_usb->keys);
+    bool state = ducky_add_altcode(bad_usb, line);
     if(!state) {
         return ducky_error(bad_usb, "Invalid altchar %s", line);
     }
+    op->size = DuckyKeyArray_size(bad_usb->keys) - op->param;
     return 0;
 }
 
-static int32_t ducky_fnc_altstring(BadUsbScript* bad_usb, const char* line, int32_t param) {
+static int32_t
+    ducky_fnc_altstring(BadUsbScript* bad_usb, const char* line, int32_t param, DuckyOp* op) {
     UNUSED(param);
 
-    line = &line[ducky_get_command_len(line) + 1];
-    ducky_numlock_on(bad_usb);
-    bool state = ducky_altstring(bad_usb, line);
-    if(!state) {
-        return ducky_error(bad_usb, "Invalid altstring %s", line);
-    }
-    return 0;
-}
-
-static int32_t ducky_fnc_hold(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    UNUSED(param);
+    line = ducky_get_param(line);
+    op->param = DuckyKeyArray_size(bad_usb->keys);
+    bool state = false;
 
-    line = &line[ducky_get_command_len(line) + 1];
-    uint16_t key = ducky_get_keycode(bad_usb, line, true);
-    if(key == HID_KEYBOARD_NONE) {
-        return ducky_error(bad_usb, "No keycode defined for %s", line);
-    }
-    bad_usb->key_hold_nb++;
-    if(bad_usb->key_hold_nb > (HID_KB_MAX_KEYS - 1)) {
-        return ducky_error(bad_usb, "Too many keys are hold");
-    }
-    bad_usb->hid->kb_press(bad_usb->hid_inst, key);
-    return 0;
-}
+    for(size_t i = 0; line[i] != '\0'; i++) {
+        if((line[i] < ' ') || (line[i] > '~')) {
+            continue; // Skip non-printable chars
+        }
 
-static int32_t ducky_fnc_release(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    UNUSED(param);
+        char temp_str[4];
+        snprintf(temp_str, 4, "%u", line[i]);
 
-    line = &line[ducky_get_command_len(line) + 1];
-    uint16_t key = ducky_get_keycode(bad_usb, line, true);
-    if(key == HID_KEYBOARD_NONE) {
-        return ducky_error(bad_usb, "No keycode defined for %s", line);
-    }
-    if(bad_usb->key_hold_nb == 0) {
-        return ducky_error(bad_usb, "No keys are hold");
+        state = ducky_add_altcode(bad_usb, temp_str);
+        if(state == false) break;
     }
-    bad_usb->key_hold_nb--;
-    bad_usb->hid->kb_release(bad_usb->hid_inst, key);
-    return 0;
-}
-
-static int32_t ducky_fnc_media(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    UNUSED(param);
-
-    line = &line[ducky_get_command_len(line) + 1];
-    uint16_t key = ducky_get_media_keycode_by_name(line);
-    if(key == HID_CONSUMER_UNASSIGNED) {
-        return ducky_error(bad_usb, "No keycode defined for %s", line);
+    if(!state) {
+        return ducky_error(bad_usb, "Invalid altstring %s", line);
     }
-    bad_usb->hid->consumer_press(bad_usb->hid_inst, key);
-    bad_usb->hid->consumer_release(bad_usb->hid_inst, key);
+    op->size = DuckyKeyArray_size(bad_usb->keys) - op->param;
     return 0;
 }
 
-static int32_t ducky_fnc_globe(BadUsbScript* bad_usb, const char* line, int32_t param) {
+static int32_t
+    ducky_fnc_media(BadUsbScript* bad_usb, const char* line, int32_t param, DuckyOp* op) {
     UNUSED(param);
 
-    line = &line[ducky_get_command_len(line) + 1];
-    uint16_t key = ducky_get_keycode(bad_usb, line, true);
-    if(key == HID_KEYBOARD_NONE) {
+    line = ducky_get_param(line);
+    op->param = ducky_get_media_keycode_by_name(line);
+    if(op->param == HID_CONSUMER_UNASSIGNED) {
         return ducky_error(bad_usb, "No keycode defined for %s", line);
     }
-
-    bad_usb->hid->consumer_press(bad_usb->hid_inst, HID_CONSUMER_FN_GLOBE);
-    bad_usb->hid->kb_press(bad_usb->hid_inst, key);
-    bad_usb->hid->kb_release(bad_usb->hid_inst, key);
-    bad_usb->hid->consumer_release(bad_usb->hid_inst, HID_CONSUMER_FN_GLOBE);
     return 0;
 }
 
-static int32_t ducky_fnc_waitforbutton(BadUsbScript* bad_usb, const char* line, int32_t param) {
-    UNUSED(param);
-    UNUSED(bad_usb);
-    UNUSED(line);
-
-    return SCRIPT_STATE_WAIT_FOR_BTN;
-}
-
 static const DuckyCmd ducky_commands[] = {
-    {"REM", NULL, -1},
-    {"ID", NULL, -1},
-    {"DELAY", ducky_fnc_delay, -1},
-    {"STRING", ducky_fnc_string, 0},
-    {"STRINGLN", ducky_fnc_string, 1},
-    {"DEFAULT_DELAY", ducky_fnc_defdelay, -1},
-    {"DEFAULTDELAY", ducky_fnc_defdelay, -1},
-    {"STRINGDELAY", ducky_fnc_strdelay, -1},
-    {"STRING_DELAY", ducky_fnc_strdelay, -1},
-    {"DEFAULT_STRING_DELAY", ducky_fnc_defstrdelay, -1},
-    {"DEFAULTSTRINGDELAY", ducky_fnc_defstrdelay, -1},
-    {"REPEAT", ducky_fnc_repeat, -1},
-    {"SYSRQ", ducky_fnc_sysrq, -1},
-    {"ALTCHAR", ducky_fnc_altchar, -1},
-    {"ALTSTRING", ducky_fnc_altstring, -1},
-    {"ALTCODE", ducky_fnc_altstring, -1},
-    {"HOLD", ducky_fnc_hold, -1},
-    {"RELEASE", ducky_fnc_release, -1},
-    {"WAIT_FOR_BUTTON_PRESS", ducky_fnc_waitforbutton, -1},
-    {"MEDIA", ducky_fnc_media, -1},
-    {"GLOBE", ducky_fnc_globe, -1},
+    {"REM", NULL, DuckyOpNop, -1},
+    {"ID", NULL, DuckyOpNop, -1},
+    {"DELAY", ducky_fnc_delay, DuckyOpDelay, -1},
+    {"STRING", ducky_fnc_string, DuckyOpString, 0},
+    {"STRINGLN", ducky_fnc_string, DuckyOpString, 1},
+    {"DEFAULT_DELAY", ducky_fnc_number, DuckyOpDefaultDelay, -1},
+    {"DEFAULTDELAY", ducky_fnc_number, DuckyOpDefaultDelay, -1},
+    {"STRINGDELAY", ducky_fnc_number, DuckyOpStringDelay, -1},
+    {"STRING_DELAY", ducky_fnc_number, DuckyOpStringDelay, -1},
+    {"DEFAULT_STRING_DELAY", ducky_fnc_number, DuckyOpDefaultStringDelay, -1},
+    {"DEFAULTSTRINGDELAY", ducky_fnc_number, DuckyOpDefaultStringDelay, -1},
+    {"REPEAT", ducky_fnc_delay, DuckyOpRepeat, -1},
+    {"SYSRQ", ducky_fnc_keycode, DuckyOpSysrq, 0},
+    {"ALTCHAR", ducky_fnc_altchar, DuckyOpAltCode, -1},
+    {"ALTSTRING", ducky_fnc_altstring, DuckyOpAltCode, -1},
+    {"ALTCODE", ducky_fnc_altstring, DuckyOpAltCode, -1},
+    {"HOLD", ducky_fnc_keycode, DuckyOpHold, 1},
+    {"RELEASE", ducky_fnc_keycode, DuckyOpRelease, 1},
+    {"WAIT_FOR_BUTTON_PRESS", NULL, DuckyOpWaitForButton, -1},
+    {"MEDIA", ducky_fnc_media, DuckyOpMedia, -1},
+    {"GLOBE", ducky_fnc_keycode, DuckyOpGlobe, 1},
 };
 
 #define TAG "BadUsb"
 
 #define WORKER_TAG TAG "Worker"
 
-int32_t ducky_execute_cmd(BadUsbScript* bad_usb, const char* line) {
-    size_t cmd_word_len = strcspn(line, " ");
-    for(size_t i = 0; i < COUNT_OF(ducky_commands); i++) {
-        size_t cmd_compare_len = strlen(ducky_commands[i].name);
-
-        if(cmd_compare_len != cmd_word_len) {
-            continue;
-        }
+int32_t ducky_compile_cmd(BadUsbScript* bad_usb, const char* line, DuckyOp* op) {
+    static DuckyNameIndex index;
+    if(!index.table) {
+        ducky_name_index_init(
+            &index, ducky_commands, COUNT_OF(ducky_commands), sizeof(DuckyCmd));
+    }
 
-        if(strncmp(line, ducky_commands[i].name, cmd_compare_len) == 0) {
-            if(ducky_commands[i].callback == NULL) {
-                return 0;
-            } else {
-                return (ducky_commands[i].callback)(bad_usb, line, ducky_commands[i].param);
-            }
-        }
+    const DuckyCmd* cmd = ducky_name_index_find(&index, line, strcspn(line, " "));
+    if(cmd == NULL) {
+        return SCRIPT_STATE_CMD_UNKNOWN;
     }
 
-    return SCRIPT_STATE_CMD_UNKNOWN;
+    op->type = cmd->type;
+    op->param = 0;
+    op->size = 0;
+    if(cmd->callback == NULL) {
+        return 0;
+    } else {
+        return (cmd->callback)(bad_usb, line, cmd->param, op);
+    }
 }
@@ -0,0 +1,329 @@
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include "ducky_script.h"
+#include "ducky_script_i.h"
+
+#define TAG "BadUsb"
+
+#define WORKER_TAG TAG "Worker"
+
+#define DUCKY_TRIM_CHARS  " \n\r\t"
+#define DUCKY_SPACE_CHARS " \t"
+
+static const char ducky_cmd_id[] = {"ID"};
+static const char ducky_cmd_define[] = {"DEFINE"};
+
+static uint32_t ducky_name_hash(const char* name, size_t len) {
+    uint32_t hash = 2166136261UL;
+    for(size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static inline const char* ducky_name_index_get_name(const DuckyNameIndex* index, size_t entry) {
+    return *(const char* const*)((const uint8_t*)index->table + entry * index->stride);
+}
+
+void ducky_name_index_init(DuckyNameIndex* index, const void* table, size_t count, size_t stride) {
+    furi_check(count < DUCKY_NAME_INDEX_SIZE * 3 / 4);
+
+    index->table = table;
+    index->count = count;
+    index->stride = stride;
+    memset(index->slots, 0, sizeof(index->slots));
+
+    for(size_t i = 0; i < count; i++) {
+        const char* name = ducky_name_index_get_name(index, i);
+        size_t len = strlen(name);
+        if(ducky_name_index_find(index, name, len)) continue; // First entry wins
+
+        size_t slot = ducky_name_hash(name, len) % DUCKY_NAME_INDEX_SIZE;
+        while(index->slots[slot]) {
+            slot = (slot + 1) % DUCKY_NAME_INDEX_SIZE;
+        }
+        index->slots[slot] = i + 1;
+    }
+}
+
+const void* ducky_name_index_find(const DuckyNameIndex* index, const char* name, size_t len) {
+    size_t slot = ducky_name_hash(name, len) % DUCKY_NAME_INDEX_SIZE;
+    while(index->slots[slot]) {
+        size_t entry = index->slots[slot] - 1;
+        const char* entry_name = ducky_name_index_get_name(index, entry);
+        if((strncmp(entry_name, name, len) == 0) && (entry_name[len] == '\0')) {
+            return (const uint8_t*)index->table + entry * index->stride;
+        }
+        slot = (slot + 1) % DUCKY_NAME_INDEX_SIZE;
+    }
+    return NULL;
+}
+
+static bool ducky_set_usb_id(BadUsbScript* bad_usb, const char* line) {
+    if(sscanf(line, "%lX:%lX", &bad_usb->hid_cfg.vid, &bad_usb->hid_cfg.pid) == 2) {
+        bad_usb->hid_cfg.manuf[0] = '\0';
+        bad_usb->hid_cfg.product[0] = '\0';
+
+        const char* id_name = ducky_get_param(line);
+        if(!ducky_is_line_end(id_name[0])) {
+            sscanf(
+                id_name,
+                "%31[^\r\n:]:%31[^\r\n]",
+                bad_usb->hid_cfg.manuf,
+                bad_usb->hid_cfg.product);
+        }
+        FURI_LOG_D(
+            WORKER_TAG,
+            "set id: %04lX:%04lX mfr:%s product:%s",
+            bad_usb->hid_cfg.vid,
+            bad_usb->hid_cfg.pid,
+            bad_usb->hid_cfg.manuf,
+            bad_usb->hid_cfg.product);
+        return true;
+    }
+    return false;
+}
+
+static DuckyDefine* ducky_find_define(DuckyDefineArray_t defines, const char* name, size_t len) {
+    for(size_t i = 0; i < DuckyDefineArray_size(defines); i++) {
+        DuckyDefine* define = DuckyDefineArray_get(defines, i);
+        if((furi_string_size(define->name) == len) &&
+           (strncmp(furi_string_get_cstr(define->name), name, len) == 0)) {
+            return define;
+        }
+    }
+    return NULL;
+}
+
+// Appends text to result with defined names replaced, only whole space separated words match
+static void
+    ducky_substitute_defines(DuckyDefineArray_t defines, FuriString* result, const char* text) {
+    while(*text != '\0') {
+        size_t space_len = strspn(text, DUCKY_SPACE_CHARS);
+        for(size_t i = 0; i < space_len; i++) {
+            furi_string_push_back(result, text[i]);
+        }
+        text += space_len;
+
+        size_t word_len = strcspn(text, DUCKY_SPACE_CHARS);
+        if(word_len == 0) break;
+
+        DuckyDefine* define = ducky_find_define(defines, text, word_len);
+        if(define) {
+            furi_string_cat(result, define->value);
+        } else {
+            for(size_t i = 0; i < word_len; i++) {
+                furi_string_push_back(result, text[i]);
+            }
+        }
+        text += word_len;
+    }
+}
+
+static bool ducky_add_define(DuckyDefineArray_t defines, const char* line) {
+    const char* name = ducky_get_param(line);
+    size_t name_len = strcspn(name, DUCKY_SPACE_CHARS);
+    if(name_len == 0) return false;
+
+    const char* value = &name[name_len];
+    value += strspn(value, DUCKY_SPACE_CHARS);
+
+    // Value may refer to previous definitions, including the previous value of this one
+    FuriString* value_defined = furi_string_alloc();
+    ducky_substitute_defines(defines, value_defined, value);
+
+    DuckyDefine* define = ducky_find_define(defines, name, name_len);
+    if(define == NULL) {
+        define = DuckyDefineArray_push_new(defines);
+        define->name = furi_string_alloc();
+        define->value = furi_string_alloc();
+        furi_string_set_strn(define->name, name, name_len);
+    }
+    furi_string_swap(define->value, value_defined);
+    furi_string_free(value_defined);
+
+    return true;
+}
+
+static int32_t ducky_compile_line(BadUsbScript* bad_usb, const char* line, DuckyOp* op) {
+    // Ducky Lang Functions
+    int32_t cmd_result = ducky_compile_cmd(bad_usb, line, op);
+    if(cmd_result != SCRIPT_STATE_CMD_UNKNOWN) {
+        return cmd_result;
+    }
+
+    // Special keys + modifiers
+    uint16_t key = ducky_get_keycode(bad_usb, line, false);
+    if(key == HID_KEYBOARD_NONE) {
+        return ducky_error(bad_usb, "No keycode defined for %s", line);
+    }
+    if((key & 0xFF00) != 0) {
+        // It's a modifier key
+        key |= ducky_get_keycode(bad_usb, ducky_get_param(line), true);
+    }
+
+    op->type = DuckyOpKey;
+    op->param = key;
+    op->size = 0;
+    return 0;
+}
+
+void ducky_script_compile_reset(BadUsbScript* bad_usb) {
+    DuckyOpArray_reset(bad_usb->ops);
+    DuckyKeyArray_reset(bad_usb->keys);
+    for(size_t i = 0; i < DuckyDefineArray_size(bad_usb->defines); i++) {
+        DuckyDefine* define = DuckyDefineArray_get(bad_usb->defines, i);
+        furi_string_free(define->name);
+        furi_string_free(define->value);
+    }
+    DuckyDefineArray_reset(bad_usb->defines);
+
+    bad_usb->compile_pos = 0;
+    bad_usb->compile_line = 0;
+    bad_usb->compile_prev = DUCKY_OP_NONE;
+    bad_usb->compile_end = false;
+}
+
+static void ducky_script_compile_carry(BadUsbScript* bad_usb) {
+    uint32_t prev_op = bad_usb->compile_prev;
+    DuckyOp op = {0};
+    if(prev_op != DUCKY_OP_NONE) {
+        op = *DuckyOpArray_cget(bad_usb->ops, prev_op);
+    }
+
+    if((op.type == DuckyOpString) || (op.type == DuckyOpAltCode)) {
+        // Move keycodes of the carried op to the start of the pool
+        if(op.size > 0) {
+            uint16_t* keys = DuckyKeyArray_get(bad_usb->keys, 0);
+            memmove(keys, &keys[op.param], op.size * sizeof(uint16_t));
+        }
+        DuckyKeyArray_resize(bad_usb->keys, op.size);
+        op.param = 0;
+    } else {
+        DuckyKeyArray_reset(bad_usb->keys);
+    }
+
+    DuckyOpArray_reset(bad_usb->ops);
+    if(prev_op != DUCKY_OP_NONE) {
+        DuckyOpArray_push_back(bad_usb->ops, op);
+        bad_usb->compile_prev = 0;
+    }
+
+    // Carried op was already executed
+    bad_usb->op_next = DuckyOpArray_size(bad_usb->ops);
+}
+
+static size_t ducky_script_compile_read(BadUsbScript* bad_usb, File* script_file, char** script) {
+    size_t window_size = DUCKY_COMPILE_WINDOW;
+    size_t script_size = 0;
+
+    while(true) {
+        *script = realloc(*script, window_size + 1); //-V701
+        storage_file_seek(script_file, bad_usb->compile_pos, true);
+        script_size = storage_file_read(script_file, *script, window_size);
+        if(script_size < window_size) {
+            bad_usb->compile_end = true;
+            break;
+        }
+
+        // Stop at the last complete line
+        while((script_size > 0) && ((*script)[script_size - 1] != '\n')) {
+            script_size--;
+        }
+        if(script_size > 0) break;
+
+        // Line does not fit in the window
+        window_size *= 2;
+    }
+
+    bad_usb->compile_pos += script_size;
+    (*script)[script_size] = '\0';
+    return script_size;
+}
+
+bool ducky_script_compile_next(BadUsbScript* bad_usb, File* script_file, bool* id_set) {
+    // Previous op is kept, next window may start with REPEAT
+    ducky_script_compile_carry(bad_usb);
+
+    char* script = NULL;
+    size_t script_size = ducky_script_compile_read(bad_usb, script_file, &script);
+
+    FuriString* line_defined = furi_string_alloc();
+    uint32_t prev_op = bad_usb->compile_prev;
+    int32_t result = 0;
+    char* script_end = &script[script_size];
+    char* line_next = script;
+
+    while(line_next < script_end) {
+        char* line = line_next;
+        char* line_end = memchr(line, '\n', script_end - line);
+        if(line_end == NULL) line_end = script_end;
+        line_next = line_end + 1;
+
+        if(line_end == line) continue; // Skip empty lines
+        bad_usb->compile_line++;
+
+        while((line_end > line) && strchr(DUCKY_TRIM_CHARS, line_end[-1])) {
+            line_end--;
+        }
+        *line_end = '\0';
+        while((line < line_end) && strchr(DUCKY_TRIM_CHARS, *line)) {
+            line++;
+        }
+
+        if(line == line_end) {
+            prev_op = DUCKY_OP_NONE; // Nothing to repeat
+            continue;
+        }
+        FURI_LOG_T(WORKER_TAG, "line:%s", line);
+
+        if(id_set && (bad_usb->compile_line == 1) &&
+           (strncmp(line, ducky_cmd_id, strlen(ducky_cmd_id)) == 0)) {
+            // Looking for ID command at first line
+            *id_set = ducky_set_usb_id(bad_usb, ducky_get_param(line));
+        }
+
+        if((strncmp(line, ducky_cmd_define, strlen(ducky_cmd_define)) == 0) &&
+           (line[strlen(ducky_cmd_define)] == ' ')) {
+            if(!ducky_add_define(bad_usb->defines, line)) {
+                result = ducky_error(bad_usb, "Invalid define %s", line);
+                break;
+            }
+            continue;
+        }
+
+        const char* line_tmp = line;
+        if(DuckyDefineArray_size(bad_usb->defines) > 0) {
+            // Command keyword is kept as is, defines only apply to its parameters
+            size_t keyword_len = strcspn(line, DUCKY_SPACE_CHARS);
+            furi_string_set_strn(line_defined, line, keyword_len);
+            ducky_substitute_defines(bad_usb->defines, line_defined, &line[keyword_len]);
+            line_tmp = furi_string_get_cstr(line_defined);
+        }
+
+        DuckyOp op = {.line = bad_usb->compile_line};
+        result = ducky_compile_line(bad_usb, line_tmp, &op);
+        if(result < 0) break;
+
+        if(op.type == DuckyOpRepeat) {
+            op.size = prev_op;
+        }
+        DuckyOpArray_push_back(bad_usb->ops, op);
+
+        // Repeating REPEAT extends the repeat of the same line
+        prev_op = (op.type == DuckyOpRepeat) ? op.size : DuckyOpArray_size(bad_usb->ops) - 1;
+    }
+
+    furi_string_free(line_defined);
+    free(script);
+
+    if(result < 0) {
+        bad_usb->st.error_line = bad_usb->compile_line;
+        FURI_LOG_E(WORKER_TAG, "Unknown command at line %lu", bad_usb->compile_line);
+        return false;
+    }
+
+    bad_usb->compile_prev = prev_op;
+    return true;
+}
@@ -6,6 +6,8 @@ extern "C" {
 
 #include <furi.h>
 #include <furi_hal.h>
+#include <storage/storage.h>
+#include <m-array.h>
 #include "ducky_script.h"
 #include "bad_usb_hid.h"
 
@@ -16,7 +18,57 @@ extern "C" {
 #define SCRIPT_STATE_STRING_START (-5)
 #define SCRIPT_STATE_WAIT_FOR_BTN (-6)
 
-#define FILE_BUFFER_LEN 16
+#define BADUSB_ASCII_TO_KEY(script, x) \
+    (((uint8_t)x < 128) ? (script->layout[(uint8_t)x]) : HID_KEYBOARD_NONE)
+
+#define DUCKY_OP_NONE UINT32_MAX
+
+#define DUCKY_COMPILE_WINDOW 2048
+
+typedef enum {
+    DuckyOpNop,
+    DuckyOpKey, // param: keycode
+    DuckyOpString, // param, size: keycode pool slice
+    DuckyOpDelay, // param: delay in ms
+    DuckyOpDefaultDelay, // param: delay in ms
+    DuckyOpStringDelay, // param: delay in ms
+    DuckyOpDefaultStringDelay, // param: delay in ms
+    DuckyOpRepeat, // param: count, size: index of repeated op or DUCKY_OP_NONE
+    DuckyOpSysrq, // param: keycode
+    DuckyOpAltCode, // param, size: keycode pool slice, numpad codes separated by 0
+    DuckyOpHold, // param: keycode
+    DuckyOpRelease, // param: keycode
+    DuckyOpMedia, // param: consumer keycode
+    DuckyOpGlobe, // param: keycode
+    DuckyOpWaitForButton,
+} DuckyOpType;
+
+typedef struct {
+    DuckyOpType type;
+    uint32_t line;
+    uint32_t param;
+    uint32_t size;
+} DuckyOp;
+
+ARRAY_DEF(DuckyOpArray, DuckyOp, M_POD_OPLIST);
+ARRAY_DEF(DuckyKeyArray, uint16_t, M_POD_OPLIST);
+
+typedef struct {
+    FuriString* name;
+    FuriString* value;
+} DuckyDefine;
+
+ARRAY_DEF(DuckyDefineArray, DuckyDefine, M_POD_OPLIST);
+
+/** Open addressing index over a static table whose entries start with a name */
+#define DUCKY_NAME_INDEX_SIZE 128
+
+typedef struct {
+    const void* table;
+    size_t count;
+    size_t stride;
+    uint8_t slots[DUCKY_NAME_INDEX_SIZE]; // entry index + 1, 0 if empty
+} DuckyNameIndex;
 
 struct BadUsbScript {
     FuriHalUsbHidConfig hid_cfg;
@@ -26,28 +78,37 @@ struct BadUsbScript {
     BadUsbState st;
 
     FuriString* file_path;
-    uint8_t file_buf[FILE_BUFFER_LEN + 1];
-    uint8_t buf_start;
-    uint8_t buf_len;
-    bool file_end;
+
+    // Script is compiled in windows of DUCKY_COMPILE_WINDOW bytes to bound memory use
+    DuckyOpArray_t ops;
+    DuckyKeyArray_t keys;
+    DuckyDefineArray_t defines;
+    size_t compile_pos;
+    uint32_t compile_line;
+    uint32_t compile_prev;
+    bool compile_end;
 
     uint32_t defdelay;
     uint32_t stringdelay;
     uint32_t defstringdelay;
     uint16_t layout[128];
 
-    FuriString* line;
-    FuriString* line_prev;
+    size_t op_next;
+    uint32_t repeat_op;
     uint32_t repeat_cnt;
     uint8_t key_hold_nb;
 
-    FuriString* string_print;
+    uint32_t string_op;
     size_t string_print_pos;
 };
 
+void ducky_name_index_init(DuckyNameIndex* index, const void* table, size_t count, size_t stride);
+
+const void* ducky_name_index_find(const DuckyNameIndex* index, const char* name, size_t len);
+
 uint16_t ducky_get_keycode(BadUsbScript* bad_usb, const char* param, bool accept_chars);
 
-uint32_t ducky_get_command_len(const char* line);
+const char* ducky_get_param(const char* line);
 
 bool ducky_is_line_end(const char chr);
 
@@ -57,17 +118,13 @@ uint16_t ducky_get_media_keycode_by_name(const char* param);
 
 bool ducky_get_number(const char* param, uint32_t* val);
 
-void ducky_numlock_on(BadUsbScript* bad_usb);
-
-bool ducky_numpad_press(BadUsbScript* bad_usb, const char num);
-
-bool ducky_altchar(BadUsbScript* bad_usb, const char* charcode);
+bool ducky_add_altcode(BadUsbScript* bad_usb, const char* charcode);
 
-bool ducky_altstring(BadUsbScript* bad_usb, const char* param);
+int32_t ducky_compile_cmd(BadUsbScript* bad_usb, const char* line, DuckyOp* op);
 
-bool ducky_string(BadUsbScript* bad_usb, const char* param);
+void ducky_script_compile_reset(BadUsbScript* bad_usb);
 
-int32_t ducky_execute_cmd(BadUsbScript* bad_usb, const char* line);
+bool ducky_script_compile_next(BadUsbScript* bad_usb, File* script_file, bool* id_set);
 
 int32_t ducky_error(BadUsbScript* bad_usb, const char* text, ...);
 
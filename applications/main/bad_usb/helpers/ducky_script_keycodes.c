@@ -108,26 +108,31 @@ static const DuckyKey ducky_media_keys[] = {
     {"BRIGHT_DOWN", HID_CONSUMER_BRIGHTNESS_DECREMENT},
 };
 
+static size_t ducky_get_name_len(const char* param) {
+    size_t len = 0;
+    while(!ducky_is_line_end(param[len])) {
+        len++;
+    }
+    return len;
+}
+
 uint16_t ducky_get_keycode_by_name(const char* param) {
-    for(size_t i = 0; i < COUNT_OF(ducky_keys); i++) {
-        size_t key_cmd_len = strlen(ducky_keys[i].name);
-        if((strncmp(param, ducky_keys[i].name, key_cmd_len) == 0) &&
-           (ducky_is_line_end(param[key_cmd_len]))) {
-            return ducky_keys[i].keycode;
-        }
+    static DuckyNameIndex index;
+    if(!index.table) {
+        ducky_name_index_init(&index, ducky_keys, COUNT_OF(ducky_keys), sizeof(DuckyKey));
     }
 
-    return HID_KEYBOARD_NONE;
+    const DuckyKey* key = ducky_name_index_find(&index, param, ducky_get_name_len(param));
+    return key ? key->keycode : HID_KEYBOARD_NONE;
 }
 
 uint16_t ducky_get_media_keycode_by_name(const char* param) {
-    for(size_t i = 0; i < COUNT_OF(ducky_media_keys); i++) {
-        size_t key_cmd_len = strlen(ducky_media_keys[i].name);
-        if((strncmp(param, ducky_media_keys[i].name, key_cmd_len) == 0) &&
-           (ducky_is_line_end(param[key_cmd_len]))) {
-            return ducky_media_keys[i].keycode;
-        }
+    static DuckyNameIndex index;
+    if(!index.table) {
+        ducky_name_index_init(
+            &index, ducky_media_keys, COUNT_OF(ducky_media_keys), sizeof(DuckyKey));
     }
 
-    return HID_CONSUMER_UNASSIGNED;
+    const DuckyKey* key = ducky_name_index_find(&index, param, ducky_get_name_len(param));
+    return key ? key->keycode : HID_CONSUMER_UNASSIGNED;
 }
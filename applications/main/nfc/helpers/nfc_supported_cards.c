@@ -11,12 +11,25 @@
 #include <furi.h>
 #include <path.h>
 #include <m-array.h>
+#include <flipper_format/flipper_format.h>
+#include <toolbox/crc32_calc.h>
 
 #define TAG "NfcSupportedCards"
 
-#define NFC_SUPPORTED_CARDS_PLUGINS_PATH  APP_DATA_PATH("plugins")
+#ifndef NFC_SUPPORTED_CARDS_PLUGINS_PATH
+#define NFC_SUPPORTED_CARDS_PLUGINS_PATH APP_DATA_PATH("plugins")
+#endif
+#ifndef NFC_SUPPORTED_CARDS_INDEX_PATH
+#define NFC_SUPPORTED_CARDS_INDEX_PATH APP_DATA_PATH(".plugins.idx")
+#endif
+
 #define NFC_SUPPORTED_CARDS_PLUGIN_SUFFIX "_parser.fal"
 
+#define NFC_SUPPORTED_CARDS_RESIDENT_COUNT (2)
+
+static const char* nfc_supported_cards_index_header = "Flipper NFC plugin index";
+static const uint32_t nfc_supported_cards_index_version = 2;
+
 typedef enum {
     NfcSupportedCardsPluginFeatureHasVerify = (1U << 0),
     NfcSupportedCardsPluginFeatureHasRead = (1U << 1),
@@ -27,6 +40,8 @@ typedef struct {
     FuriString* name;
     NfcProtocol protocol;
     NfcSupportedCardsPluginFeature feature;
+    uint32_t file_size;
+    uint32_t file_crc;
 } NfcSupportedCardsPluginCache;
 
 ARRAY_DEF(NfcSupportedCardsPluginCache, NfcSupportedCardsPluginCache, M_POD_OPLIST);
@@ -41,15 +56,27 @@ typedef enum {
 typedef struct {
     Storage* storage;
     File* directory;
+    File* file;
     char file_name[256];
+    FileInfo file_info;
     FlipperApplication* app;
 } NfcSupportedCardsLoadContext;
 
+typedef struct {
+    FlipperApplication* app;
+    const NfcSupportedCardsPlugin* plugin;
+    size_t cache_idx;
+    uint32_t last_used;
+} NfcSupportedCardsResidentPlugin;
+
 struct NfcSupportedCards {
     CompositeApiResolver* api_resolver;
     NfcSupportedCardsPluginCache_t plugins_cache_arr;
     NfcSupportedCardsLoadState load_state;
     NfcSupportedCardsLoadContext* load_context;
+    NfcSupportedCardsResidentPlugin resident[NFC_SUPPORTED_CARDS_RESIDENT_COUNT];
+    uint32_t resident_counter;
+    size_t plugins_inspected;
 };
 
 NfcSupportedCards* nfc_supported_cards_alloc(void) {
@@ -67,6 +94,12 @@ NfcSupportedCards* nfc_supported_cards_alloc(void) {
 void nfc_supported_cards_free(NfcSupportedCards* instance) {
     furi_assert(instance);
 
+    for(size_t i = 0; i < NFC_SUPPORTED_CARDS_RESIDENT_COUNT; i++) {
+        if(instance->resident[i].app) {
+            flipper_application_free(instance->resident[i].app);
+        }
+    }
+
     NfcSupportedCardsPluginCache_it_t iter;
     for(NfcSupportedCardsPluginCache_it(iter, instance->plugins_cache_arr);
         !NfcSupportedCardsPluginCache_end_p(iter);
@@ -85,6 +118,7 @@ static NfcSupportedCardsLoadContext* nfc_supported_cards_load_context_alloc(void
 
     instance->storage = furi_record_open(RECORD_STORAGE);
     instance->directory = storage_file_alloc(instance->storage);
+    instance->file = storage_file_alloc(instance->storage);
 
     if(!storage_dir_open(instance->directory, NFC_SUPPORTED_CARDS_PLUGINS_PATH)) {
         FURI_LOG_D(TAG, "Failed to open directory: %s", NFC_SUPPORTED_CARDS_PLUGINS_PATH);
@@ -100,33 +134,26 @@ static void nfc_supported_cards_load_context_free(NfcSupportedCardsLoadContext*
 
     storage_dir_close(instance->directory);
     storage_file_free(instance->directory);
+    storage_file_free(instance->file);
 
     furi_record_close(RECORD_STORAGE);
     free(instance);
 }
 
-static const NfcSupportedCardsPlugin* nfc_supported_cards_get_plugin(
-    NfcSupportedCardsLoadContext* instance,
-    const char* name,
-    const ElfApiInterface* api_interface) {
-    furi_assert(instance);
-    furi_assert(name);
-
+static const NfcSupportedCardsPlugin* nfc_supported_cards_load_plugin(
+    FlipperApplication* app,
+    const char* name) {
     const NfcSupportedCardsPlugin* plugin = NULL;
     FuriString* plugin_path = furi_string_alloc_printf(
         "%s/%s%s", NFC_SUPPORTED_CARDS_PLUGINS_PATH, name, NFC_SUPPORTED_CARDS_PLUGIN_SUFFIX);
     do {
-        if(instance->app) flipper_application_free(instance->app);
-        instance->app = flipper_application_alloc(instance->storage, api_interface);
-
-        if(flipper_application_preload(instance->app, furi_string_get_cstr(plugin_path)) !=
+        if(flipper_application_preload(app, furi_string_get_cstr(plugin_path)) !=
            FlipperApplicationPreloadStatusSuccess)
             break;
-        if(!flipper_application_is_plugin(instance->app)) break;
-        if(flipper_application_map_to_memory(instance->app) != FlipperApplicationLoadStatusSuccess)
-            break;
+        if(!flipper_application_is_plugin(app)) break;
+        if(flipper_application_map_to_memory(app) != FlipperApplicationLoadStatusSuccess) break;
         const FlipperAppPluginDescriptor* descriptor =
-            flipper_application_plugin_get_descriptor(instance->app);
+            flipper_application_plugin_get_descriptor(app);
 
         if(descriptor == NULL) break;
 
@@ -140,35 +167,207 @@ static const NfcSupportedCardsPlugin* nfc_supported_cards_get_plugin(
     return plugin;
 }
 
-static const NfcSupportedCardsPlugin* nfc_supported_cards_get_next_plugin(
+static const NfcSupportedCardsPlugin* nfc_supported_cards_get_plugin(
     NfcSupportedCardsLoadContext* instance,
+    const char* name,
     const ElfApiInterface* api_interface) {
-    const NfcSupportedCardsPlugin* plugin = NULL;
+    furi_assert(instance);
+    furi_assert(name);
 
-    do {
+    if(instance->app) flipper_application_free(instance->app);
+    instance->app = flipper_application_alloc(instance->storage, api_interface);
+
+    return nfc_supported_cards_load_plugin(instance->app, name);
+}
+
+static const NfcSupportedCardsPlugin*
+    nfc_supported_cards_get_resident_plugin(NfcSupportedCards* instance, size_t cache_idx) {
+    NfcSupportedCardsResidentPlugin* slot = &instance->resident[0];
+
+    for(size_t i = 0; i < NFC_SUPPORTED_CARDS_RESIDENT_COUNT; i++) {
+        NfcSupportedCardsResidentPlugin* resident = &instance->resident[i];
+        if(resident->app && resident->cache_idx == cache_idx) {
+            resident->last_used = ++instance->resident_counter;
+            return resident->plugin;
+        }
+        // Pick an empty or the least recently used slot for eviction
+        if(slot->app && (!resident->app || resident->last_used < slot->last_used)) {
+            slot = resident;
+        }
+    }
+
+    const NfcSupportedCardsPluginCache* plugin_cache =
+        NfcSupportedCardsPluginCache_cget(instance->plugins_cache_arr, cache_idx);
+
+    if(slot->app) {
+        flipper_application_free(slot->app);
+    }
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    const ElfApiInterface* api_interface = composite_api_resolver_get(instance->api_resolver);
+    slot->app = flipper_application_alloc(storage, api_interface);
+    slot->plugin =
+        nfc_supported_cards_load_plugin(slot->app, furi_string_get_cstr(plugin_cache->name));
+    furi_record_close(RECORD_STORAGE);
+
+    if(slot->plugin) {
+        slot->cache_idx = cache_idx;
+        slot->last_used = ++instance->resident_counter;
+    } else {
+        flipper_application_free(slot->app);
+        slot->app = NULL;
+    }
+
+    return slot->plugin;
+}
+
+static bool nfc_supported_cards_get_next_plugin_file(NfcSupportedCardsLoadContext* instance) {
+    bool found = false;
+
+    while(!found) {
         if(!storage_file_is_open(instance->directory)) break;
         if(!storage_dir_read(
-               instance->directory, NULL, instance->file_name, sizeof(instance->file_name)))
+               instance->directory,
+               &instance->file_info,
+               instance->file_name,
+               sizeof(instance->file_name)))
             break;
 
         const size_t suffix_len = strlen(NFC_SUPPORTED_CARDS_PLUGIN_SUFFIX);
         const size_t file_name_len = strlen(instance->file_name);
-        if(file_name_len <= suffix_len) break;
+        if(file_name_len <= suffix_len) continue;
 
         size_t suffix_start_pos = file_name_len - suffix_len;
         if(memcmp(
                &instance->file_name[suffix_start_pos],
                NFC_SUPPORTED_CARDS_PLUGIN_SUFFIX,
                suffix_len) != 0) //-V1051
-            break;
+            continue;
 
         // Trim suffix from file_name to save memory. The suffix will be concatenated on plugin load.
         instance->file_name[suffix_start_pos] = '\0';
+        found = true;
+    }
 
-        plugin = nfc_supported_cards_get_plugin(instance, instance->file_name, api_interface);
-    } while(plugin == NULL); //-V654
+    return found;
+}
 
-    return plugin;
+static void nfc_supported_cards_index_load(NfcSupportedCardsPluginCache_t index) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    FuriString* temp_str = furi_string_alloc();
+
+    do {
+        if(!flipper_format_buffered_file_open_existing(ff, NFC_SUPPORTED_CARDS_INDEX_PATH)) break;
+
+        uint32_t version = 0;
+        if(!flipper_format_read_header(ff, temp_str, &version)) break;
+        if(furi_string_cmp_str(temp_str, nfc_supported_cards_index_header) != 0) break;
+        if(version != nfc_supported_cards_index_version) break;
+
+        uint32_t api_version[2] = {};
+        if(!flipper_format_read_uint32(ff, "API version", api_version, COUNT_OF(api_version)))
+            break;
+        if(api_version[0] != firmware_api_interface->api_version_major ||
+           api_version[1] != firmware_api_interface->api_version_minor)
+            break;
+
+        while(flipper_format_read_string(ff, "Plugin", temp_str)) {
+            NfcSupportedCardsPluginCache plugin_cache = {};
+            uint32_t protocol = NfcProtocolInvalid;
+            uint32_t feature = 0;
+            if(!flipper_format_read_uint32(ff, "Protocol", &protocol, 1)) break;
+            if(!flipper_format_read_uint32(ff, "Features", &feature, 1)) break;
+            if(!flipper_format_read_uint32(ff, "Size", &plugin_cache.file_size, 1)) break;
+            if(!flipper_format_read_uint32(ff, "CRC32", &plugin_cache.file_crc, 1)) break;
+
+            plugin_cache.name = furi_string_alloc_set(temp_str);
+            plugin_cache.protocol = protocol;
+            plugin_cache.feature = feature;
+            NfcSupportedCardsPluginCache_push_back(index, plugin_cache);
+        }
+    } while(false);
+
+    furi_string_free(temp_str);
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static void nfc_supported_cards_index_save(NfcSupportedCardsPluginCache_t plugins_cache_arr) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+
+    bool save_success = false;
+    do {
+        if(!flipper_format_buffered_file_open_always(ff, NFC_SUPPORTED_CARDS_INDEX_PATH)) break;
+        if(!flipper_format_write_header_cstr(
+               ff, nfc_supported_cards_index_header, nfc_supported_cards_index_version))
+            break;
+
+        uint32_t api_version[2] = {
+            firmware_api_interface->api_version_major,
+            firmware_api_interface->api_version_minor,
+        };
+        if(!flipper_format_write_uint32(ff, "API version", api_version, COUNT_OF(api_version)))
+            break;
+
+        NfcSupportedCardsPluginCache_it_t iter;
+        for(NfcSupportedCardsPluginCache_it(iter, plugins_cache_arr);
+            !NfcSupportedCardsPluginCache_end_p(iter);
+            NfcSupportedCardsPluginCache_next(iter)) {
+            const NfcSupportedCardsPluginCache* plugin_cache =
+                NfcSupportedCardsPluginCache_cref(iter);
+            uint32_t protocol = plugin_cache->protocol;
+            uint32_t feature = plugin_cache->feature;
+            if(!flipper_format_write_string(ff, "Plugin", plugin_cache->name)) break;
+            if(!flipper_format_write_uint32(ff, "Protocol", &protocol, 1)) break;
+            if(!flipper_format_write_uint32(ff, "Features", &feature, 1)) break;
+            if(!flipper_format_write_uint32(ff, "Size", &plugin_cache->file_size, 1)) break;
+            if(!flipper_format_write_uint32(ff, "CRC32", &plugin_cache->file_crc, 1)) break;
+        }
+        save_success = NfcSupportedCardsPluginCache_end_p(iter);
+    } while(false);
+
+    flipper_format_free(ff);
+    if(!save_success) {
+        FURI_LOG_W(TAG, "Failed to save plugin index");
+        storage_simply_remove(storage, NFC_SUPPORTED_CARDS_INDEX_PATH);
+    }
+    furi_record_close(RECORD_STORAGE);
+}
+
+static void nfc_supported_cards_index_clear(NfcSupportedCardsPluginCache_t index) {
+    NfcSupportedCardsPluginCache_it_t iter;
+    for(NfcSupportedCardsPluginCache_it(iter, index); !NfcSupportedCardsPluginCache_end_p(iter);
+        NfcSupportedCardsPluginCache_next(iter)) {
+        furi_string_free(NfcSupportedCardsPluginCache_ref(iter)->name);
+    }
+    NfcSupportedCardsPluginCache_clear(index);
+}
+
+static bool nfc_supported_cards_index_find(
+    NfcSupportedCardsPluginCache_t index,
+    const char* name,
+    uint32_t file_size,
+    uint32_t file_crc,
+    NfcSupportedCardsPluginCache* plugin_cache) {
+    bool found = false;
+
+    NfcSupportedCardsPluginCache_it_t iter;
+    for(NfcSupportedCardsPluginCache_it(iter, index); !NfcSupportedCardsPluginCache_end_p(iter);
+        NfcSupportedCardsPluginCache_next(iter)) {
+        const NfcSupportedCardsPluginCache* entry = NfcSupportedCardsPluginCache_cref(iter);
+        if(furi_string_cmp_str(entry->name, name) == 0) {
+            found = (entry->file_size == file_size) && (entry->file_crc == file_crc);
+            if(found) {
+                plugin_cache->protocol = entry->protocol;
+                plugin_cache->feature = entry->feature;
+            }
+            break;
+        }
+    }
+
+    return found;
 }
 
 void nfc_supported_cards_load_cache(NfcSupportedCards* instance) {
@@ -179,38 +378,94 @@ void nfc_supported_cards_load_cache(NfcSupportedCards* instance) {
            (instance->load_state == NfcSupportedCardsLoadStateFail))
             break;
 
-        instance->load_context = nfc_supported_cards_load_context_alloc();
-
-        while(true) {
-            const ElfApiInterface* api_interface =
-                composite_api_resolver_get(instance->api_resolver);
-            const NfcSupportedCardsPlugin* plugin =
-                nfc_supported_cards_get_next_plugin(instance->load_context, api_interface);
-            if(plugin == NULL) break; //-V547
+        NfcSupportedCardsPluginCache_t index;
+        NfcSupportedCardsPluginCache_init(index);
+        nfc_supported_cards_index_load(index);
 
-            NfcSupportedCardsPluginCache plugin_cache = {}; //-V779
-            plugin_cache.name = furi_string_alloc_set(instance->load_context->file_name);
-            plugin_cache.protocol = plugin->protocol;
-            if(plugin->verify) {
-                plugin_cache.feature |= NfcSupportedCardsPluginFeatureHasVerify;
+        instance->load_context = nfc_supported_cards_load_context_alloc();
+        NfcSupportedCardsLoadContext* load_context = instance->load_context;
+
+        size_t plugins_loaded = 0;
+        bool index_changed = false;
+        FuriString* plugin_path = furi_string_alloc();
+
+        while(nfc_supported_cards_get_next_plugin_file(load_context)) {
+            NfcSupportedCardsPluginCache plugin_cache = {};
+            plugin_cache.protocol = NfcProtocolInvalid;
+            plugin_cache.file_size = load_context->file_info.size;
+
+            furi_string_printf(
+                plugin_path,
+                "%s/%s%s",
+                NFC_SUPPORTED_CARDS_PLUGINS_PATH,
+                load_context->file_name,
+                NFC_SUPPORTED_CARDS_PLUGIN_SUFFIX);
+            // Storage timestamps change on any SD write, so the plugin is identified by its data
+            bool file_read = storage_file_open(
+                load_context->file,
+                furi_string_get_cstr(plugin_path),
+                FSAM_READ,
+                FSOM_OPEN_EXISTING);
+            if(file_read) {
+                plugin_cache.file_crc = crc32_calc_file(load_context->file, NULL, NULL);
+                file_read = storage_file_get_error(load_context->file) == FSE_OK;
             }
-            if(plugin->read) {
-                plugin_cache.feature |= NfcSupportedCardsPluginFeatureHasRead;
+            storage_file_close(load_context->file);
+
+            if(!file_read || !nfc_supported_cards_index_find(
+                                 index,
+                                 load_context->file_name,
+                                 plugin_cache.file_size,
+                                 plugin_cache.file_crc,
+                                 &plugin_cache)) {
+                // Unknown or changed plugin, inspect it. Broken plugins are indexed too.
+                const ElfApiInterface* api_interface =
+                    composite_api_resolver_get(instance->api_resolver);
+                const NfcSupportedCardsPlugin* plugin = nfc_supported_cards_get_plugin(
+                    load_context, load_context->file_name, api_interface);
+                if(plugin) {
+                    plugin_cache.protocol = plugin->protocol;
+                    if(plugin->verify) {
+                        plugin_cache.feature |= NfcSupportedCardsPluginFeatureHasVerify;
+                    }
+                    if(plugin->read) {
+                        plugin_cache.feature |= NfcSupportedCardsPluginFeatureHasRead;
+                    }
+                    if(plugin->parse) {
+                        plugin_cache.feature |= NfcSupportedCardsPluginFeatureHasParse;
+                    }
+                }
+                instance->plugins_inspected++;
+                index_changed = true;
             }
-            if(plugin->parse) {
-                plugin_cache.feature |= NfcSupportedCardsPluginFeatureHasParse;
+
+            if(plugin_cache.protocol != NfcProtocolInvalid) {
+                plugins_loaded++;
             }
+
+            plugin_cache.name = furi_string_alloc_set(load_context->file_name);
             NfcSupportedCardsPluginCache_push_back(instance->plugins_cache_arr, plugin_cache);
         }
 
+        furi_string_free(plugin_path);
         nfc_supported_cards_load_context_free(instance->load_context);
 
-        size_t plugins_loaded = NfcSupportedCardsPluginCache_size(instance->plugins_cache_arr);
+        // Removed plugins also make the stored index stale
+        if(index_changed || (NfcSupportedCardsPluginCache_size(index) !=
+                             NfcSupportedCardsPluginCache_size(instance->plugins_cache_arr))) {
+            nfc_supported_cards_index_save(instance->plugins_cache_arr);
+        }
+        nfc_supported_cards_index_clear(index);
+
         if(plugins_loaded == 0) {
             FURI_LOG_D(TAG, "Plugins not found");
             instance->load_state = NfcSupportedCardsLoadStateFail;
         } else {
-            FURI_LOG_D(TAG, "Loaded %zu plugins", plugins_loaded);
+            FURI_LOG_D(
+                TAG,
+                "Loaded %zu plugins, %zu inspected",
+                plugins_loaded,
+                instance->plugins_inspected);
             instance->load_state = NfcSupportedCardsLoadStateSuccess;
         }
 
@@ -228,20 +483,15 @@ bool nfc_supported_cards_read(NfcSupportedCards* instance, NfcDevice* device, Nf
     do {
         if(instance->load_state != NfcSupportedCardsLoadStateSuccess) break;
 
-        instance->load_context = nfc_supported_cards_load_context_alloc();
-
-        NfcSupportedCardsPluginCache_it_t iter;
-        for(NfcSupportedCardsPluginCache_it(iter, instance->plugins_cache_arr);
-            !NfcSupportedCardsPluginCache_end_p(iter);
-            NfcSupportedCardsPluginCache_next(iter)) {
-            NfcSupportedCardsPluginCache* plugin_cache = NfcSupportedCardsPluginCache_ref(iter);
+        size_t plugins_count = NfcSupportedCardsPluginCache_size(instance->plugins_cache_arr);
+        for(size_t i = 0; i < plugins_count; i++) {
+            const NfcSupportedCardsPluginCache* plugin_cache =
+                NfcSupportedCardsPluginCache_cget(instance->plugins_cache_arr, i);
             if(plugin_cache->protocol != protocol) continue;
             if((plugin_cache->feature & NfcSupportedCardsPluginFeatureHasRead) == 0) continue;
 
-            const ElfApiInterface* api_interface =
-                composite_api_resolver_get(instance->api_resolver);
-            const NfcSupportedCardsPlugin* plugin = nfc_supported_cards_get_plugin(
-                instance->load_context, furi_string_get_cstr(plugin_cache->name), api_interface);
+            const NfcSupportedCardsPlugin* plugin =
+                nfc_supported_cards_get_resident_plugin(instance, i);
             if(plugin == NULL) continue;
 
             if(plugin->verify) {
@@ -255,8 +505,6 @@ bool nfc_supported_cards_read(NfcSupportedCards* instance, NfcDevice* device, Nf
                 }
             }
         }
-
-        nfc_supported_cards_load_context_free(instance->load_context);
     } while(false);
 
     return card_read;
@@ -276,20 +524,15 @@ bool nfc_supported_cards_parse(
     do {
         if(instance->load_state != NfcSupportedCardsLoadStateSuccess) break;
 
-        instance->load_context = nfc_supported_cards_load_context_alloc();
-
-        NfcSupportedCardsPluginCache_it_t iter;
-        for(NfcSupportedCardsPluginCache_it(iter, instance->plugins_cache_arr);
-            !NfcSupportedCardsPluginCache_end_p(iter);
-            NfcSupportedCardsPluginCache_next(iter)) {
-            NfcSupportedCardsPluginCache* plugin_cache = NfcSupportedCardsPluginCache_ref(iter);
+        size_t plugins_count = NfcSupportedCardsPluginCache_size(instance->plugins_cache_arr);
+        for(size_t i = 0; i < plugins_count; i++) {
+            const NfcSupportedCardsPluginCache* plugin_cache =
+                NfcSupportedCardsPluginCache_cget(instance->plugins_cache_arr, i);
             if(plugin_cache->protocol != protocol) continue;
             if((plugin_cache->feature & NfcSupportedCardsPluginFeatureHasParse) == 0) continue;
 
-            const ElfApiInterface* api_interface =
-                composite_api_resolver_get(instance->api_resolver);
-            const NfcSupportedCardsPlugin* plugin = nfc_supported_cards_get_plugin(
-                instance->load_context, furi_string_get_cstr(plugin_cache->name), api_interface);
+            const NfcSupportedCardsPlugin* plugin =
+                nfc_supported_cards_get_resident_plugin(instance, i);
             if(plugin == NULL) continue;
 
             if(plugin->parse) {
@@ -299,8 +542,6 @@ bool nfc_supported_cards_parse(
                 }
             }
         }
-
-        nfc_supported_cards_load_context_free(instance->load_context);
     } while(false);
 
     return card_parsed;
@@ -1,155 +1,804 @@
 #include "subghz_history.h"
 #include <lib/subghz/receiver.h>
-#include <lib/subghz/protocols/came.h>
+#include <lib/subghz/blocks/generic.h>
+#include <flipper_format/flipper_format_i.h>
+#include <storage/storage.h>
+#include <toolbox/hex.h>
 
 #include <furi.h>
 
-#define SUBGHZ_HISTORY_MAX       50
-#define SUBGHZ_HISTORY_FREE_HEAP 20480
+// Two digits of the status bar, when there is no SD card to spill to
+#define SUBGHZ_HISTORY_RAM_MAX     99
+#define SUBGHZ_HISTORY_RAM_SIZE    6144
+#define SUBGHZ_HISTORY_JOURNAL_MAX 9999
+#define SUBGHZ_HISTORY_PRESET_MAX  16
+#define SUBGHZ_HISTORY_TEXT_CACHE  4
+#define SUBGHZ_HISTORY_LOST_MAX    99 // Status bar has room for two digits
+
+#define SUBGHZ_HISTORY_JOURNAL_PATH       SUBGHZ_APP_FOLDER "/.history"
+#define SUBGHZ_HISTORY_JOURNAL_INDEX_PATH SUBGHZ_APP_FOLDER "/.history_index"
+
+#define SUBGHZ_HISTORY_RECORD_BIT      (1U << 0)
+#define SUBGHZ_HISTORY_RECORD_KEY      (1U << 1)
+#define SUBGHZ_HISTORY_RECORD_VERBATIM (1U << 2) // text is the whole serialized signal
+
+#define SUBGHZ_HISTORY_ALIGN(size) (((size) + 3) & ~3U)
+
+#define SUBGHZ_HISTORY_WORKER_STACK_SIZE 2048
+
+typedef enum {
+    SubGhzHistoryWorkerEvtSpill = (1 << 0),
+    SubGhzHistoryWorkerEvtRead = (1 << 1),
+    SubGhzHistoryWorkerEvtExit = (1 << 2),
+} SubGhzHistoryWorkerEvt;
+
+#define SUBGHZ_HISTORY_WORKER_EVT_ALL \
+    (SubGhzHistoryWorkerEvtSpill | SubGhzHistoryWorkerEvtRead | SubGhzHistoryWorkerEvtExit)
 
 #define TAG "SubGhzHistory"
 
+/** Received signal, followed by text_size bytes of null-terminated text
+ *
+ * Fields common to all protocols are kept binary, the text holds protocol
+ * specific lines of the serialized signal. Signals that do not serialize
+ * the common fields the usual way are kept as text entirely.
+ */
 typedef struct {
-    FuriString* item_str;
-    FlipperFormat* flipper_string;
+    uint64_t key;
+    const SubGhzProtocol* protocol;
+    uint32_t frequency;
+    uint32_t timestamp;
+    uint32_t bit_count;
+    uint16_t text_size;
+    uint8_t preset;
+    int8_t rssi;
     uint8_t type;
-    SubGhzRadioPreset* preset;
-} SubGhzHistoryItem;
-
-ARRAY_DEF(SubGhzHistoryItemArray, SubGhzHistoryItem, M_POD_OPLIST)
-
-#define M_OPL_SubGhzHistoryItemArray_t() ARRAY_OPLIST(SubGhzHistoryItemArray, M_POD_OPLIST)
+    uint8_t flags;
+} SubGhzHistoryRecord;
 
 typedef struct {
-    SubGhzHistoryItemArray_t data;
-} SubGhzHistoryStruct;
+    uint16_t idx;
+    uint8_t type;
+    bool pending; // text is read from the journal by the worker
+    FuriString* text;
+} SubGhzHistoryTextCache;
 
 struct SubGhzHistory {
     uint32_t last_update_timestamp;
     uint16_t last_index_write;
+    uint16_t lost_count;
     uint8_t code_last_hash_data;
+    bool full;
     FuriString* tmp_string;
-    SubGhzHistoryStruct* history;
+    FuriString* preset_name;
+    FuriMutex* mutex;
+
+    SubGhzRadioPreset presets[SUBGHZ_HISTORY_PRESET_MAX];
+    size_t preset_count;
+    SubGhzRadioPreset preset;
+    FlipperFormat* flipper_string;
+    char* buffer;
+    size_t buffer_size;
+
+    // Most recent records, older ones are moved to the journal by the worker
+    uint8_t* ram;
+    uint32_t ram_head;
+    uint32_t ram_tail;
+    uint32_t ram_wanted;
+    uint16_t ram_first;
+    uint32_t ram_position[SUBGHZ_HISTORY_RAM_MAX];
+
+    // SD card access is done outside of mutex, receive callback never waits for it
+    FuriThread* thread;
+    FuriMutex* journal_mutex;
+    Storage* storage;
+    File* journal;
+    File* journal_index;
+    uint32_t journal_size;
+    bool journal_enabled;
+    char* journal_buffer;
+    size_t journal_buffer_size;
+
+    SubGhzHistoryTextCache text_cache[SUBGHZ_HISTORY_TEXT_CACHE];
 };
 
+static int32_t subghz_history_worker(void* context);
+
+/** Journal first, then records: the worker takes them in the same order */
+static void subghz_history_lock(SubGhzHistory* instance) {
+    furi_check(furi_mutex_acquire(instance->journal_mutex, FuriWaitForever) == FuriStatusOk);
+    furi_check(furi_mutex_acquire(instance->mutex, FuriWaitForever) == FuriStatusOk);
+}
+
+static void subghz_history_unlock(SubGhzHistory* instance) {
+    furi_mutex_release(instance->mutex);
+    furi_mutex_release(instance->journal_mutex);
+}
+
+static void subghz_history_journal_close(SubGhzHistory* instance) {
+    if(instance->journal) {
+        storage_file_free(instance->journal);
+        storage_file_free(instance->journal_index);
+        instance->journal = NULL;
+        instance->journal_index = NULL;
+        storage_simply_remove(instance->storage, SUBGHZ_HISTORY_JOURNAL_PATH);
+        storage_simply_remove(instance->storage, SUBGHZ_HISTORY_JOURNAL_INDEX_PATH);
+    }
+    instance->journal_size = 0;
+}
+
 SubGhzHistory* subghz_history_alloc(void) {
     SubGhzHistory* instance = malloc(sizeof(SubGhzHistory));
     instance->tmp_string = furi_string_alloc();
-    instance->history = malloc(sizeof(SubGhzHistoryStruct));
-    SubGhzHistoryItemArray_init(instance->history->data);
+    instance->preset_name = furi_string_alloc();
+    instance->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    instance->journal_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    instance->preset.name = furi_string_alloc();
+    instance->flipper_string = flipper_format_string_alloc();
+    instance->ram = malloc(SUBGHZ_HISTORY_RAM_SIZE);
+    instance->storage = furi_record_open(RECORD_STORAGE);
+    for(size_t i = 0; i < SUBGHZ_HISTORY_TEXT_CACHE; i++) {
+        instance->text_cache[i].idx = UINT16_MAX;
+        instance->text_cache[i].text = furi_string_alloc();
+    }
+    instance->journal_enabled = storage_sd_status(instance->storage) == FSE_OK;
+
+    instance->thread = furi_thread_alloc_ex(
+        "SubGhzHistory", SUBGHZ_HISTORY_WORKER_STACK_SIZE, subghz_history_worker, instance);
+    furi_thread_start(instance->thread);
     return instance;
 }
 
 void subghz_history_free(SubGhzHistory* instance) {
     furi_assert(instance);
+    furi_thread_flags_set(furi_thread_get_id(instance->thread), SubGhzHistoryWorkerEvtExit);
+    furi_thread_join(instance->thread);
+    furi_thread_free(instance->thread);
+
+    subghz_history_reset(instance);
+    furi_record_close(RECORD_STORAGE);
+    for(size_t i = 0; i < SUBGHZ_HISTORY_TEXT_CACHE; i++) {
+        furi_string_free(instance->text_cache[i].text);
+    }
+    free(instance->ram);
+    free(instance->buffer);
+    free(instance->journal_buffer);
+    flipper_format_free(instance->flipper_string);
+    furi_string_free(instance->preset.name);
+    furi_mutex_free(instance->journal_mutex);
+    furi_mutex_free(instance->mutex);
+    furi_string_free(instance->preset_name);
     furi_string_free(instance->tmp_string);
-    for
-        M_EACH(item, instance->history->data, SubGhzHistoryItemArray_t) {
-            furi_string_free(item->item_str);
-            furi_string_free(item->preset->name);
-            free(item->preset);
-            flipper_format_free(item->flipper_string);
-            item->type = 0;
-        }
-    SubGhzHistoryItemArray_clear(instance->history->data);
-    free(instance->history);
     free(instance);
 }
 
+void subghz_history_reset(SubGhzHistory* instance) {
+    furi_assert(instance);
+    subghz_history_lock(instance);
+    furi_string_reset(instance->tmp_string);
+    for(size_t i = 0; i < instance->preset_count; i++) {
+        furi_string_free(instance->presets[i].name);
+    }
+    instance->preset_count = 0;
+    for(size_t i = 0; i < SUBGHZ_HISTORY_TEXT_CACHE; i++) {
+        instance->text_cache[i].idx = UINT16_MAX;
+        instance->text_cache[i].pending = false;
+    }
+    subghz_history_journal_close(instance);
+    instance->journal_enabled = storage_sd_status(instance->storage) == FSE_OK;
+    instance->ram_head = 0;
+    instance->ram_tail = 0;
+    instance->ram_wanted = 0;
+    instance->ram_first = 0;
+    instance->last_index_write = 0;
+    instance->lost_count = 0;
+    instance->code_last_hash_data = 0;
+    instance->full = false;
+    subghz_history_unlock(instance);
+}
+
+static char* subghz_history_get_buffer(char** buffer, size_t* buffer_size, size_t size) {
+    if(*buffer_size < size) {
+        *buffer = realloc(*buffer, size); //-V701
+        *buffer_size = size;
+    }
+    return *buffer;
+}
+
+/** Called by the worker with journal mutex held, entry stays in place until ram_first moves */
+static bool
+    subghz_history_journal_write(SubGhzHistory* instance, uint16_t idx, const uint8_t* entry) {
+    if(!instance->journal) {
+        instance->journal = storage_file_alloc(instance->storage);
+        instance->journal_index = storage_file_alloc(instance->storage);
+        if(!storage_file_open(
+               instance->journal,
+               SUBGHZ_HISTORY_JOURNAL_PATH,
+               FSAM_READ_WRITE,
+               FSOM_CREATE_ALWAYS) ||
+           !storage_file_open(
+               instance->journal_index,
+               SUBGHZ_HISTORY_JOURNAL_INDEX_PATH,
+               FSAM_READ_WRITE,
+               FSOM_CREATE_ALWAYS)) {
+            FURI_LOG_E(TAG, "Unable to create journal");
+            subghz_history_journal_close(instance);
+            return false;
+        }
+    }
+
+    const SubGhzHistoryRecord* record = (const SubGhzHistoryRecord*)entry;
+    const uint32_t size = sizeof(SubGhzHistoryRecord) + SUBGHZ_HISTORY_ALIGN(record->text_size);
+
+    if(!storage_file_seek(instance->journal, instance->journal_size, true) ||
+       storage_file_write(instance->journal, entry, size) != size ||
+       !storage_file_seek(instance->journal_index, idx * sizeof(uint32_t), true) ||
+       storage_file_write(instance->journal_index, &instance->journal_size, sizeof(uint32_t)) !=
+           sizeof(uint32_t)) {
+        FURI_LOG_E(TAG, "Journal write failed");
+        return false;
+    }
+
+    instance->journal_size += size;
+    return true;
+}
+
+/** Called with journal mutex held, text is valid until it is released */
+static const char* subghz_history_journal_read(
+    SubGhzHistory* instance,
+    uint16_t idx,
+    SubGhzHistoryRecord* record) {
+    uint32_t offset = 0;
+    if(!instance->journal ||
+       !storage_file_seek(instance->journal_index, idx * sizeof(uint32_t), true) ||
+       storage_file_read(instance->journal_index, &offset, sizeof(uint32_t)) !=
+           sizeof(uint32_t) ||
+       !storage_file_seek(instance->journal, offset, true) ||
+       storage_file_read(instance->journal, record, sizeof(SubGhzHistoryRecord)) !=
+           sizeof(SubGhzHistoryRecord)) {
+        return NULL;
+    }
+
+    char* text = subghz_history_get_buffer(
+        &instance->journal_buffer, &instance->journal_buffer_size, record->text_size);
+    if(storage_file_read(instance->journal, text, record->text_size) != record->text_size ||
+       record->text_size == 0 || text[record->text_size - 1] != '\0') {
+        return NULL;
+    }
+    return text;
+}
+
+static const uint8_t* subghz_history_ram_entry(SubGhzHistory* instance, uint16_t idx) {
+    return &instance->ram[instance->ram_position[idx % SUBGHZ_HISTORY_RAM_MAX] %
+                          SUBGHZ_HISTORY_RAM_SIZE];
+}
+
+static bool
+    subghz_history_record_is_valid(SubGhzHistory* instance, const SubGhzHistoryRecord* record) {
+    return record->protocol && (record->preset < instance->preset_count);
+}
+
+/** Called with both mutexes held */
+static const char*
+    subghz_history_get_record(SubGhzHistory* instance, uint16_t idx, SubGhzHistoryRecord* record) {
+    furi_check(idx < instance->last_index_write);
+
+    const char* text = NULL;
+    if(idx < instance->ram_first) {
+        text = subghz_history_journal_read(instance, idx, record);
+    } else {
+        const uint8_t* entry = subghz_history_ram_entry(instance, idx);
+        memcpy(record, entry, sizeof(SubGhzHistoryRecord));
+        text = (const char*)entry + sizeof(SubGhzHistoryRecord);
+    }
+
+    if(text && !subghz_history_record_is_valid(instance, record)) {
+        FURI_LOG_E(TAG, "Invalid record %u", idx);
+        text = NULL;
+    }
+    return text;
+}
+
+/** Worker keeps RAM half free, so new records rarely wait for the SD card */
+static bool subghz_history_ram_spill_needed(SubGhzHistory* instance) {
+    const uint32_t used = instance->ram_head - instance->ram_tail;
+    return instance->journal_enabled && (instance->ram_first < instance->last_index_write) &&
+           ((instance->last_index_write - instance->ram_first > SUBGHZ_HISTORY_RAM_MAX / 2) ||
+            (used > SUBGHZ_HISTORY_RAM_SIZE / 2) ||
+            (used + 2 * instance->ram_wanted > SUBGHZ_HISTORY_RAM_SIZE));
+}
+
+static uint8_t* subghz_history_ram_reserve(SubGhzHistory* instance, uint32_t size) {
+    if(size > SUBGHZ_HISTORY_RAM_SIZE) return NULL;
+
+    if(instance->ram_first == instance->last_index_write) {
+        // Nothing is kept, start from the beginning so that any record fits
+        instance->ram_head = 0;
+        instance->ram_tail = 0;
+    }
+
+    const uint32_t offset = instance->ram_head % SUBGHZ_HISTORY_RAM_SIZE;
+    // Records never wrap, the end of the buffer is skipped instead
+    const uint32_t padding =
+        (offset + size > SUBGHZ_HISTORY_RAM_SIZE) ? SUBGHZ_HISTORY_RAM_SIZE - offset : 0;
+
+    if((instance->last_index_write - instance->ram_first >= SUBGHZ_HISTORY_RAM_MAX) ||
+       (instance->ram_head + padding + size - instance->ram_tail > SUBGHZ_HISTORY_RAM_SIZE)) {
+        // Worker frees space for the next one, if there is a journal
+        instance->ram_wanted = size;
+        return NULL;
+    }
+
+    const uint32_t position = instance->ram_head + padding;
+    instance->ram_position[instance->last_index_write % SUBGHZ_HISTORY_RAM_MAX] = position;
+    instance->ram_head = position + size;
+    instance->ram_wanted = 0;
+    return &instance->ram[position % SUBGHZ_HISTORY_RAM_SIZE];
+}
+
+static bool subghz_history_get_preset_index(
+    SubGhzHistory* instance,
+    SubGhzRadioPreset* preset,
+    uint8_t* index) {
+    for(size_t i = 0; i < instance->preset_count; i++) {
+        if(instance->presets[i].data == preset->data &&
+           instance->presets[i].data_size == preset->data_size &&
+           furi_string_equal(instance->presets[i].name, preset->name)) {
+            *index = i;
+            return true;
+        }
+    }
+
+    if(instance->preset_count == SUBGHZ_HISTORY_PRESET_MAX) return false;
+
+    SubGhzRadioPreset* item = &instance->presets[instance->preset_count];
+    item->name = furi_string_alloc_set(preset->name);
+    item->frequency = 0;
+    item->data = preset->data;
+    item->data_size = preset->data_size;
+    *index = instance->preset_count++;
+    return true;
+}
+
+static void subghz_history_print_hex(FuriString* output, const uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        furi_string_cat_printf(output, (i + 1 < size) ? "%02X " : "%02X\n", data[i]);
+    }
+}
+
+/** Print the common fields the way protocols serialize them */
+static void subghz_history_print_common(
+    SubGhzHistory* instance,
+    const SubGhzHistoryRecord* record,
+    FuriString* output) {
+    const SubGhzRadioPreset* preset = &instance->presets[record->preset];
+    subghz_block_generic_get_preset_name(
+        furi_string_get_cstr(preset->name), instance->preset_name);
+
+    furi_string_printf(
+        output,
+        "Filetype: %s\nVersion: %u\nFrequency: %lu\nPreset: %s\n",
+        SUBGHZ_KEY_FILE_TYPE,
+        SUBGHZ_KEY_FILE_VERSION,
+        record->frequency,
+        furi_string_get_cstr(instance->preset_name));
+    if(!furi_string_cmp_str(instance->preset_name, "FuriHalSubGhzPresetCustom")) {
+        furi_string_cat_str(output, "Custom_preset_module: CC1101\nCustom_preset_data: ");
+        subghz_history_print_hex(output, preset->data, preset->data_size);
+    }
+    furi_string_cat_printf(output, "Protocol: %s\n", record->protocol->name);
+}
+
+static size_t subghz_history_print_bit(const SubGhzHistoryRecord* record, FuriString* output) {
+    furi_string_printf(output, "Bit: %lu\n", record->bit_count);
+    return furi_string_size(output);
+}
+
+static size_t subghz_history_print_key(const SubGhzHistoryRecord* record, FuriString* output) {
+    uint8_t key_data[sizeof(uint64_t)];
+    for(size_t i = 0; i < sizeof(uint64_t); i++) {
+        key_data[i] = record->key >> ((sizeof(uint64_t) - i - 1) * 8);
+    }
+    furi_string_set_str(output, "Key: ");
+    subghz_history_print_hex(output, key_data, sizeof(key_data));
+    return furi_string_size(output);
+}
+
+static bool subghz_history_parse_key(const char* text, uint64_t* key) {
+    uint64_t data = 0;
+    for(size_t i = 0; i < sizeof(uint64_t); i++) {
+        uint8_t byte;
+        if(!hex_char_to_uint8(text[0], text[1], &byte)) return false;
+        data = (data << 8) | byte;
+        text += 2;
+        if(*text == ' ') text++;
+    }
+    *key = data;
+    return true;
+}
+
+/** Move common fields of serialized signal into record
+ *
+ * @return     protocol specific part of the text
+ */
+static const char* subghz_history_parse(
+    SubGhzHistory* instance,
+    SubGhzHistoryRecord* record,
+    const char* text) {
+    subghz_history_print_common(instance, record, instance->tmp_string);
+    const size_t common_size = furi_string_size(instance->tmp_string);
+    if(strncmp(text, furi_string_get_cstr(instance->tmp_string), common_size)) {
+        record->flags |= SUBGHZ_HISTORY_RECORD_VERBATIM;
+        return text;
+    }
+
+    const char* extra = text + common_size;
+
+    if(!strncmp(extra, "Bit: ", 5)) {
+        record->bit_count = strtoul(extra + 5, NULL, 10);
+        size_t size = subghz_history_print_bit(record, instance->tmp_string);
+        if(strncmp(extra, furi_string_get_cstr(instance->tmp_string), size)) {
+            record->flags |= SUBGHZ_HISTORY_RECORD_VERBATIM;
+            return text;
+        }
+        record->flags |= SUBGHZ_HISTORY_RECORD_BIT;
+        extra += size;
+    }
+
+    if(!strncmp(extra, "Key: ", 5) && subghz_history_parse_key(extra + 5, &record->key)) {
+        size_t size = subghz_history_print_key(record, instance->tmp_string);
+        if(strncmp(extra, furi_string_get_cstr(instance->tmp_string), size)) {
+            record->flags |= SUBGHZ_HISTORY_RECORD_VERBATIM;
+            return text;
+        }
+        record->flags |= SUBGHZ_HISTORY_RECORD_KEY;
+        extra += size;
+    }
+
+    return extra;
+}
+
+/** Find value of the first line with given key in serialized text */
+static const char* subghz_history_find_value(const char* text, const char* key) {
+    const size_t key_size = strlen(key);
+    for(const char* line = text; line; line = strchr(line, '\n')) {
+        if(*line == '\n') line++;
+        if(!strncmp(line, key, key_size) && !strncmp(line + key_size, ": ", 2)) {
+            return line + key_size + 2;
+        }
+    }
+    return NULL;
+}
+
+static void subghz_history_render_item(
+    const SubGhzHistoryRecord* record,
+    const char* text,
+    FuriString* output) {
+    const char* name = record->protocol->name;
+    const char* manufacture = NULL;
+    if(!strcmp(name, "KeeLoq")) {
+        name = "KL ";
+        manufacture = subghz_history_find_value(text, "Manufacture");
+    } else if(!strcmp(name, "Star Line")) {
+        name = "SL ";
+        manufacture = subghz_history_find_value(text, "Manufacture");
+    }
+    furi_string_set_str(output, name);
+    if(manufacture) {
+        furi_string_cat_printf(output, "%.*s", (int)strcspn(manufacture, "\n"), manufacture);
+    }
+
+    uint64_t data = 0;
+    if(record->flags & SUBGHZ_HISTORY_RECORD_KEY) {
+        data = record->key;
+    } else if(record->flags & SUBGHZ_HISTORY_RECORD_VERBATIM) {
+        const char* key = subghz_history_find_value(text, "Key");
+        if(!key || !subghz_history_parse_key(key, &data)) {
+            data = 0;
+        }
+    }
+
+    if(data != 0) {
+        if(!(uint32_t)(data >> 32)) {
+            furi_string_cat_printf(output, " %lX", (uint32_t)(data & 0xFFFFFFFF));
+        } else {
+            furi_string_cat_printf(
+                output, " %lX%08lX", (uint32_t)(data >> 32), (uint32_t)(data & 0xFFFFFFFF));
+        }
+    }
+}
+
+/** Called with records mutex held, never touches the SD card */
+static SubGhzHistoryTextCache*
+    subghz_history_get_text_cache(SubGhzHistory* instance, uint16_t idx) {
+    SubGhzHistoryTextCache* cache = &instance->text_cache[idx % SUBGHZ_HISTORY_TEXT_CACHE];
+    if(cache->idx != idx) {
+        cache->idx = idx;
+        cache->type = SubGhzProtocolTypeUnknown;
+        cache->pending = false;
+
+        if(idx < instance->ram_first) {
+            // Filled by the worker, the view is redrawn on the next tick
+            furi_string_set_str(cache->text, "...");
+            cache->pending = true;
+            furi_thread_flags_set(
+                furi_thread_get_id(instance->thread), SubGhzHistoryWorkerEvtRead);
+        } else {
+            SubGhzHistoryRecord record;
+            const uint8_t* entry = subghz_history_ram_entry(instance, idx);
+            memcpy(&record, entry, sizeof(SubGhzHistoryRecord));
+            subghz_history_render_item(
+                &record, (const char*)entry + sizeof(SubGhzHistoryRecord), cache->text);
+            cache->type = record.type;
+        }
+    }
+    return cache;
+}
+
+static void subghz_history_worker_read(SubGhzHistory* instance) {
+    furi_check(furi_mutex_acquire(instance->journal_mutex, FuriWaitForever) == FuriStatusOk);
+
+    for(size_t i = 0; i < SUBGHZ_HISTORY_TEXT_CACHE; i++) {
+        SubGhzHistoryTextCache* cache = &instance->text_cache[i];
+        furi_check(furi_mutex_acquire(instance->mutex, FuriWaitForever) == FuriStatusOk);
+        const bool pending = cache->pending;
+        const uint16_t idx = cache->idx;
+        furi_mutex_release(instance->mutex);
+        if(!pending) continue;
+
+        SubGhzHistoryRecord record;
+        const char* text = subghz_history_journal_read(instance, idx, &record);
+
+        furi_check(furi_mutex_acquire(instance->mutex, FuriWaitForever) == FuriStatusOk);
+        if(cache->pending && (cache->idx == idx)) {
+            if(text && subghz_history_record_is_valid(instance, &record)) {
+                subghz_history_render_item(&record, text, cache->text);
+                cache->type = record.type;
+            } else {
+                furi_string_set_str(cache->text, "Journal error");
+            }
+            cache->pending = false;
+        }
+        furi_mutex_release(instance->mutex);
+    }
+
+    furi_mutex_release(instance->journal_mutex);
+}
+
+static void subghz_history_worker_spill(SubGhzHistory* instance) {
+    furi_check(furi_mutex_acquire(instance->journal_mutex, FuriWaitForever) == FuriStatusOk);
+
+    while(true) {
+        furi_check(furi_mutex_acquire(instance->mutex, FuriWaitForever) == FuriStatusOk);
+        const bool spill = subghz_history_ram_spill_needed(instance);
+        const uint16_t idx = instance->ram_first;
+        const uint8_t* entry = subghz_history_ram_entry(instance, idx);
+        furi_mutex_release(instance->mutex);
+        if(!spill) break;
+
+        // Receive callback only appends, the entry is not touched while it is written
+        const bool written = subghz_history_journal_write(instance, idx, entry);
+
+        furi_check(furi_mutex_acquire(instance->mutex, FuriWaitForever) == FuriStatusOk);
+        if(written) {
+            instance->ram_first++;
+            instance->ram_tail =
+                (instance->ram_first < instance->last_index_write) ?
+                    instance->ram_position[instance->ram_first % SUBGHZ_HISTORY_RAM_MAX] :
+                    instance->ram_head;
+        } else {
+            // Records stay in RAM, history gets full as if there was no SD card
+            instance->journal_enabled = false;
+        }
+        furi_mutex_release(instance->mutex);
+        if(!written) break;
+    }
+
+    furi_mutex_release(instance->journal_mutex);
+}
+
+static int32_t subghz_history_worker(void* context) {
+    SubGhzHistory* instance = context;
+
+    while(true) {
+        uint32_t flags = furi_thread_flags_wait(
+            SUBGHZ_HISTORY_WORKER_EVT_ALL, FuriFlagWaitAny, FuriWaitForever);
+        furi_check((flags & FuriFlagError) == 0);
+
+        if(flags & SubGhzHistoryWorkerEvtExit) break;
+        // Menu is on screen, it goes first
+        if(flags & SubGhzHistoryWorkerEvtRead) subghz_history_worker_read(instance);
+        if(flags & SubGhzHistoryWorkerEvtSpill) subghz_history_worker_spill(instance);
+    }
+
+    return 0;
+}
+
 uint32_t subghz_history_get_frequency(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    return item->preset->frequency;
+    subghz_history_lock(instance);
+    SubGhzHistoryRecord record;
+    uint32_t frequency = 0;
+    if(subghz_history_get_record(instance, idx, &record)) {
+        frequency = record.frequency;
+    }
+    subghz_history_unlock(instance);
+    return frequency;
 }
 
 SubGhzRadioPreset* subghz_history_get_radio_preset(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    return item->preset;
+    subghz_history_lock(instance);
+    SubGhzHistoryRecord record;
+    if(subghz_history_get_record(instance, idx, &record)) {
+        const SubGhzRadioPreset* preset = &instance->presets[record.preset];
+        furi_string_set(instance->preset.name, preset->name);
+        instance->preset.frequency = record.frequency;
+        instance->preset.data = preset->data;
+        instance->preset.data_size = preset->data_size;
+    } else {
+        furi_string_reset(instance->preset.name);
+        instance->preset.frequency = 0;
+        instance->preset.data = NULL;
+        instance->preset.data_size = 0;
+    }
+    subghz_history_unlock(instance);
+    return &instance->preset;
 }
 
 const char* subghz_history_get_preset(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    return furi_string_get_cstr(item->preset->name);
+    subghz_history_lock(instance);
+    SubGhzHistoryRecord record;
+    const char* name = "";
+    if(subghz_history_get_record(instance, idx, &record)) {
+        name = furi_string_get_cstr(instance->presets[record.preset].name);
+    }
+    subghz_history_unlock(instance);
+    return name;
 }
 
-void subghz_history_reset(SubGhzHistory* instance) {
+uint16_t subghz_history_get_item(SubGhzHistory* instance) {
     furi_assert(instance);
-    furi_string_reset(instance->tmp_string);
-    for
-        M_EACH(item, instance->history->data, SubGhzHistoryItemArray_t) {
-            furi_string_free(item->item_str);
-            furi_string_free(item->preset->name);
-            free(item->preset);
-            flipper_format_free(item->flipper_string);
-            item->type = 0;
-        }
-    SubGhzHistoryItemArray_reset(instance->history->data);
-    instance->last_index_write = 0;
-    instance->code_last_hash_data = 0;
+    return instance->last_index_write;
 }
 
-uint16_t subghz_history_get_item(SubGhzHistory* instance) {
+uint16_t subghz_history_get_lost(SubGhzHistory* instance) {
     furi_assert(instance);
-    return instance->last_index_write;
+    return instance->lost_count;
 }
 
 uint8_t subghz_history_get_type_protocol(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    return item->type;
+    furi_check(furi_mutex_acquire(instance->mutex, FuriWaitForever) == FuriStatusOk);
+    uint8_t type = subghz_history_get_text_cache(instance, idx)->type;
+    furi_mutex_release(instance->mutex);
+    return type;
 }
 
 const char* subghz_history_get_protocol_name(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    flipper_format_rewind(item->flipper_string);
-    if(!flipper_format_read_string(item->flipper_string, "Protocol", instance->tmp_string)) {
+    subghz_history_lock(instance);
+    SubGhzHistoryRecord record = {0};
+    const char* name = "";
+    if(subghz_history_get_record(instance, idx, &record)) {
+        name = record.protocol->name;
+    } else {
         FURI_LOG_E(TAG, "Missing Protocol");
-        furi_string_reset(instance->tmp_string);
     }
-    return furi_string_get_cstr(instance->tmp_string);
+    subghz_history_unlock(instance);
+    return name;
 }
 
 FlipperFormat* subghz_history_get_raw_data(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    if(item->flipper_string) {
-        return item->flipper_string;
-    } else {
-        return NULL;
+    subghz_history_lock(instance);
+
+    FlipperFormat* flipper_format = NULL;
+    SubGhzHistoryRecord record;
+    const char* text = subghz_history_get_record(instance, idx, &record);
+    if(text) {
+        Stream* stream = flipper_format_get_raw_stream(instance->flipper_string);
+        stream_clean(stream);
+        if(!(record.flags & SUBGHZ_HISTORY_RECORD_VERBATIM)) {
+            subghz_history_print_common(instance, &record, instance->tmp_string);
+            stream_write_string(stream, instance->tmp_string);
+            if(record.flags & SUBGHZ_HISTORY_RECORD_BIT) {
+                subghz_history_print_bit(&record, instance->tmp_string);
+                stream_write_string(stream, instance->tmp_string);
+            }
+            if(record.flags & SUBGHZ_HISTORY_RECORD_KEY) {
+                subghz_history_print_key(&record, instance->tmp_string);
+                stream_write_string(stream, instance->tmp_string);
+            }
+        }
+        stream_write_cstring(stream, text);
+        flipper_format_rewind(instance->flipper_string);
+        flipper_format = instance->flipper_string;
     }
+
+    subghz_history_unlock(instance);
+    return flipper_format;
 }
+
 bool subghz_history_get_text_space_left(SubGhzHistory* instance, FuriString* output) {
     furi_assert(instance);
-    if(memmgr_get_free_heap() < SUBGHZ_HISTORY_FREE_HEAP) {
-        if(output != NULL) furi_string_printf(output, "    Free heap LOW");
-        return true;
-    }
-    if(instance->last_index_write == SUBGHZ_HISTORY_MAX) {
+    if(instance->full) {
         if(output != NULL) furi_string_printf(output, "   Memory is FULL");
         return true;
     }
-    if(output != NULL)
-        furi_string_printf(output, "%02u/%02u", instance->last_index_write, SUBGHZ_HISTORY_MAX);
+    if(output != NULL) {
+        if(instance->lost_count) {
+            furi_string_printf(
+                output,
+                "%u-%u",
+                instance->last_index_write,
+                MIN(instance->lost_count, SUBGHZ_HISTORY_LOST_MAX));
+        } else if(instance->journal_enabled) {
+            furi_string_printf(output, "%u", instance->last_index_write);
+        } else {
+            furi_string_printf(
+                output, "%02u/%02u", instance->last_index_write, SUBGHZ_HISTORY_RAM_MAX);
+        }
+    }
     return false;
 }
 
 void subghz_history_get_text_item_menu(SubGhzHistory* instance, FuriString* output, uint16_t idx) {
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_get(instance->history->data, idx);
-    furi_string_set(output, item->item_str);
+    furi_assert(instance);
+    furi_check(furi_mutex_acquire(instance->mutex, FuriWaitForever) == FuriStatusOk);
+    furi_string_set(output, subghz_history_get_text_cache(instance, idx)->text);
+    furi_mutex_release(instance->mutex);
+}
+
+static bool subghz_history_add_record(
+    SubGhzHistory* instance,
+    SubGhzProtocolDecoderBase* decoder_base,
+    SubGhzRadioPreset* preset,
+    float rssi) {
+    SubGhzHistoryRecord record = {
+        .protocol = decoder_base->protocol,
+        .frequency = preset->frequency,
+        .timestamp = furi_get_tick(),
+        .rssi = CLAMP(rssi, INT8_MAX, INT8_MIN),
+        .type = decoder_base->protocol->type,
+    };
+    if(!subghz_history_get_preset_index(instance, preset, &record.preset)) {
+        FURI_LOG_E(TAG, "Too many presets");
+        return false;
+    }
+
+    Stream* stream = flipper_format_get_raw_stream(instance->flipper_string);
+    subghz_protocol_decoder_base_serialize(decoder_base, instance->flipper_string, preset);
+    const size_t size = stream_size(stream);
+    char* text = subghz_history_get_buffer(&instance->buffer, &instance->buffer_size, size + 1);
+    stream_rewind(stream);
+    text[stream_read(stream, (uint8_t*)text, size)] = '\0';
+
+    const char* extra = subghz_history_parse(instance, &record, text);
+    const size_t text_size = strlen(extra) + 1;
+    if(text_size > UINT16_MAX) return false;
+    record.text_size = text_size;
+
+    uint8_t* entry = subghz_history_ram_reserve(
+        instance, sizeof(SubGhzHistoryRecord) + SUBGHZ_HISTORY_ALIGN(text_size));
+    if(!entry) return false;
+
+    memcpy(entry, &record, sizeof(SubGhzHistoryRecord));
+    memcpy(entry + sizeof(SubGhzHistoryRecord), extra, text_size);
+    instance->last_index_write++;
+    return true;
 }
 
 bool subghz_history_add_to_history(
     SubGhzHistory* instance,
     void* context,
-    SubGhzRadioPreset* preset) {
+    SubGhzRadioPreset* preset,
+    float rssi) {
     furi_assert(instance);
     furi_assert(context);
 
-    if(memmgr_get_free_heap() < SUBGHZ_HISTORY_FREE_HEAP) return false;
-    if(instance->last_index_write >= SUBGHZ_HISTORY_MAX) return false;
+    if(instance->full) return false;
 
     SubGhzProtocolDecoderBase* decoder_base = context;
     if((instance->code_last_hash_data ==
@@ -162,79 +811,23 @@ bool subghz_history_add_to_history(
     instance->code_last_hash_data = subghz_protocol_decoder_base_get_hash_data(decoder_base);
     instance->last_update_timestamp = furi_get_tick();
 
-    FuriString* text;
-    text = furi_string_alloc();
-    SubGhzHistoryItem* item = SubGhzHistoryItemArray_push_raw(instance->history->data);
-    item->preset = malloc(sizeof(SubGhzRadioPreset));
-    item->type = decoder_base->protocol->type;
-    item->preset->frequency = preset->frequency;
-    item->preset->name = furi_string_alloc();
-    furi_string_set(item->preset->name, preset->name);
-    item->preset->data = preset->data;
-    item->preset->data_size = preset->data_size;
-
-    item->item_str = furi_string_alloc();
-    item->flipper_string = flipper_format_string_alloc();
-    subghz_protocol_decoder_base_serialize(decoder_base, item->flipper_string, preset);
-
-    do {
-        if(!flipper_format_rewind(item->flipper_string)) {
-            FURI_LOG_E(TAG, "Rewind error");
-            break;
-        }
-        if(!flipper_format_read_string(item->flipper_string, "Protocol", instance->tmp_string)) {
-            FURI_LOG_E(TAG, "Missing Protocol");
-            break;
-        }
-        if(!strcmp(furi_string_get_cstr(instance->tmp_string), "KeeLoq")) {
-            furi_string_set(instance->tmp_string, "KL ");
-            if(!flipper_format_read_string(item->flipper_string, "Manufacture", text)) {
-                FURI_LOG_E(TAG, "Missing Protocol");
-                break;
-            }
-            furi_string_cat(instance->tmp_string, text);
-        } else if(!strcmp(furi_string_get_cstr(instance->tmp_string), "Star Line")) {
-            furi_string_set(instance->tmp_string, "SL ");
-            if(!flipper_format_read_string(item->flipper_string, "Manufacture", text)) {
-                FURI_LOG_E(TAG, "Missing Protocol");
-                break;
-            }
-            furi_string_cat(instance->tmp_string, text);
-        }
-        if(!flipper_format_rewind(item->flipper_string)) {
-            FURI_LOG_E(TAG, "Rewind error");
-            break;
-        }
-        uint8_t key_data[sizeof(uint64_t)] = {0};
-        if(!flipper_format_read_hex(item->flipper_string, "Key", key_data, sizeof(uint64_t))) {
-            FURI_LOG_D(TAG, "No Key");
-        }
-        uint64_t data = 0;
-        for(uint8_t i = 0; i < sizeof(uint64_t); i++) {
-            data = (data << 8) | key_data[i];
-        }
-        if(data != 0) {
-            if(!(uint32_t)(data >> 32)) {
-                furi_string_printf(
-                    item->item_str,
-                    "%s %lX",
-                    furi_string_get_cstr(instance->tmp_string),
-                    (uint32_t)(data & 0xFFFFFFFF));
-            } else {
-                furi_string_printf(
-                    item->item_str,
-                    "%s %lX%08lX",
-                    furi_string_get_cstr(instance->tmp_string),
-                    (uint32_t)(data >> 32),
-                    (uint32_t)(data & 0xFFFFFFFF));
-            }
-        } else {
-            furi_string_printf(item->item_str, "%s", furi_string_get_cstr(instance->tmp_string));
-        }
-
-    } while(false);
+    furi_check(furi_mutex_acquire(instance->mutex, FuriWaitForever) == FuriStatusOk);
+    const uint16_t max = instance->journal_enabled ? SUBGHZ_HISTORY_JOURNAL_MAX :
+                                                     SUBGHZ_HISTORY_RAM_MAX;
+    bool added = false;
+    if(instance->last_index_write < max) {
+        added = subghz_history_add_record(instance, decoder_base, preset, rssi);
+    }
+    // With the journal a failed add only waits for the worker to free RAM
+    instance->full = (!added && !instance->journal_enabled) ||
+                     (instance->last_index_write == max);
+    if(!added && !instance->full && (instance->lost_count < UINT16_MAX)) {
+        instance->lost_count++;
+    }
+    if(subghz_history_ram_spill_needed(instance)) {
+        furi_thread_flags_set(furi_thread_get_id(instance->thread), SubGhzHistoryWorkerEvtSpill);
+    }
+    furi_mutex_release(instance->mutex);
 
-    furi_string_free(text);
-    instance->last_index_write++;
-    return true;
+    return added;
 }
@@ -52,6 +52,13 @@ const char* subghz_history_get_preset(SubGhzHistory* instance, uint16_t idx);
  */
 uint16_t subghz_history_get_item(SubGhzHistory* instance);
 
+/** Get the number of signals that were not added because RAM was not freed in time
+ * 
+ * @param instance  - SubGhzHistory instance
+ * @return count    - lost signals since the last reset
+ */
+uint16_t subghz_history_get_lost(SubGhzHistory* instance);
+
 /** Get type protocol to history[idx]
  * 
  * @param instance  - SubGhzHistory instance
@@ -85,21 +92,28 @@ void subghz_history_get_text_item_menu(SubGhzHistory* instance, FuriString* outp
 bool subghz_history_get_text_space_left(SubGhzHistory* instance, FuriString* output);
 
 /** Add protocol to history
+ * 
+ * Records are kept in a RAM ring, older ones are moved to a journal on the
+ * SD card by a worker thread. Never waits for the SD card, returns false when
+ * the ring is full and the worker has not freed it yet. Such signals are
+ * counted, see subghz_history_get_lost.
  * 
  * @param instance  - SubGhzHistory instance
  * @param context    - SubGhzProtocolCommon context
  * @param preset    - SubGhzRadioPreset preset
+ * @param rssi      - signal RSSI, dBm
  * @return bool;
  */
 bool subghz_history_add_to_history(
     SubGhzHistory* instance,
     void* context,
-    SubGhzRadioPreset* preset);
+    SubGhzRadioPreset* preset,
+    float rssi);
 
 /** Get SubGhzProtocolCommonLoad to load into the protocol decoder bin data
  * 
  * @param instance  - SubGhzHistory instance
  * @param idx       - record index
- * @return SubGhzProtocolCommonLoad*
+ * @return SubGhzProtocolCommonLoad*, valid until the next call
  */
 FlipperFormat* subghz_history_get_raw_data(SubGhzHistory* instance, uint16_t idx);
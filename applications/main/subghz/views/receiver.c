@@ -4,7 +4,6 @@
 #include <input/input.h>
 #include <gui/elements.h>
 #include <assets_icons.h>
-#include <m-array.h>
 
 #define FRAME_HEIGHT 12
 #define MAX_LEN_PX   111
@@ -13,22 +12,6 @@
 
 #define SUBGHZ_RAW_THRESHOLD_MIN -90.0f
 
-typedef struct {
-    FuriString* item_str;
-    uint8_t type;
-} SubGhzReceiverMenuItem;
-
-ARRAY_DEF(SubGhzReceiverMenuItemArray, SubGhzReceiverMenuItem, M_POD_OPLIST)
-
-#define M_OPL_SubGhzReceiverMenuItemArray_t() \
-    ARRAY_OPLIST(SubGhzReceiverMenuItemArray, M_POD_OPLIST)
-
-struct SubGhzReceiverHistory {
-    SubGhzReceiverMenuItemArray_t data;
-};
-
-typedef struct SubGhzReceiverHistory SubGhzReceiverHistory;
-
 static const Icon* ReceiverItemIcons[] = {
     [SubGhzProtocolTypeUnknown] = &I_Quest_7x8,
     [SubGhzProtocolTypeStatic] = &I_Unlock_7x8,
@@ -55,7 +38,9 @@ typedef struct {
     FuriString* frequency_str;
     FuriString* preset_str;
     FuriString* history_stat_str;
-    SubGhzReceiverHistory* history;
+    FuriString* item_str;
+    SubGhzViewReceiverItemCallback item_callback;
+    void* item_context;
     uint16_t idx;
     uint16_t list_offset;
     uint16_t history_item;
@@ -132,19 +117,41 @@ static void subghz_view_receiver_update_offset(SubGhzViewReceiver* subghz_receiv
         true);
 }
 
-void subghz_view_receiver_add_item_to_menu(
+void subghz_view_receiver_set_item_callback(
     SubGhzViewReceiver* subghz_receiver,
-    const char* name,
-    uint8_t type) {
+    SubGhzViewReceiverItemCallback callback,
+    void* context) {
+    furi_assert(subghz_receiver);
+    furi_assert(callback);
+    with_view_model(
+        subghz_receiver->view,
+        SubGhzViewReceiverModel * model,
+        {
+            model->item_callback = callback;
+            model->item_context = context;
+        },
+        false);
+}
+
+void subghz_view_receiver_set_item_count(SubGhzViewReceiver* subghz_receiver, uint16_t count) {
+    furi_assert(subghz_receiver);
+    with_view_model(
+        subghz_receiver->view,
+        SubGhzViewReceiverModel * model,
+        {
+            model->history_item = count;
+            model->idx = count ? count - 1 : 0;
+        },
+        true);
+    subghz_view_receiver_update_offset(subghz_receiver);
+}
+
+void subghz_view_receiver_add_item(SubGhzViewReceiver* subghz_receiver) {
     furi_assert(subghz_receiver);
     with_view_model(
         subghz_receiver->view,
         SubGhzViewReceiverModel * model,
         {
-            SubGhzReceiverMenuItem* item_menu =
-                SubGhzReceiverMenuItemArray_push_raw(model->history->data);
-            item_menu->item_str = furi_string_alloc_set(name);
-            item_menu->type = type;
             if(model->idx == model->history_item - 1) {
                 model->history_item++;
                 model->idx++;
@@ -216,29 +223,28 @@ void subghz_view_receiver_draw(Canvas* canvas, SubGhzViewReceiverModel* model) {
     elements_button_left(canvas, "Config");
 
     bool scrollbar = model->history_item > 4;
-    FuriString* str_buff;
-    str_buff = furi_string_alloc();
-
-    SubGhzReceiverMenuItem* item_menu;
+    FuriString* str_buff = model->item_str;
 
     for(size_t i = 0; i < MIN(model->history_item, MENU_ITEMS); ++i) {
         size_t idx = CLAMP((uint16_t)(i + model->list_offset), model->history_item, 0);
-        item_menu = SubGhzReceiverMenuItemArray_get(model->history->data, idx);
-        furi_string_set(str_buff, item_menu->item_str);
+        // Item text is only rendered for the visible rows
+        uint8_t type = SubGhzProtocolTypeUnknown;
+        furi_string_reset(str_buff);
+        if(model->item_callback) {
+            model->item_callback(idx, str_buff, &type, model->item_context);
+        }
         elements_string_fit_width(canvas, str_buff, scrollbar ? MAX_LEN_PX - 7 : MAX_LEN_PX);
         if(model->idx == idx) {
             subghz_view_receiver_draw_frame(canvas, i, scrollbar);
         } else {
             canvas_set_color(canvas, ColorBlack);
         }
-        canvas_draw_icon(canvas, 4, 2 + i * FRAME_HEIGHT, ReceiverItemIcons[item_menu->type]);
+        canvas_draw_icon(canvas, 4, 2 + i * FRAME_HEIGHT, ReceiverItemIcons[type]);
         canvas_draw_str(canvas, 15, 9 + i * FRAME_HEIGHT, furi_string_get_cstr(str_buff));
-        furi_string_reset(str_buff);
     }
     if(scrollbar) {
         elements_scrollbar_pos(canvas, 128, 0, 49, model->idx, model->history_item);
     }
-    furi_string_free(str_buff);
 
     canvas_set_color(canvas, ColorBlack);
 
@@ -392,15 +398,9 @@ void subghz_view_receiver_exit(void* context) {
             furi_string_reset(model->frequency_str);
             furi_string_reset(model->preset_str);
             furi_string_reset(model->history_stat_str);
-                for
-                    M_EACH(item_menu, model->history->data, SubGhzReceiverMenuItemArray_t) {
-                        furi_string_free(item_menu->item_str);
-                        item_menu->type = 0;
-                    }
-                SubGhzReceiverMenuItemArray_reset(model->history->data);
-                model->idx = 0;
-                model->list_offset = 0;
-                model->history_item = 0;
+            model->idx = 0;
+            model->list_offset = 0;
+            model->history_item = 0;
         },
         false);
     furi_timer_stop(subghz_receiver->timer);
@@ -430,8 +430,7 @@ SubGhzViewReceiver* subghz_view_receiver_alloc(void) {
             model->preset_str = furi_string_alloc();
             model->history_stat_str = furi_string_alloc();
             model->bar_show = SubGhzViewReceiverBarShowDefault;
-            model->history = malloc(sizeof(SubGhzReceiverHistory));
-            SubGhzReceiverMenuItemArray_init(model->history->data);
+            model->item_str = furi_string_alloc();
         },
         true);
     subghz_receiver->timer =
@@ -449,13 +448,7 @@ void subghz_view_receiver_free(SubGhzViewReceiver* subghz_receiver) {
             furi_string_free(model->frequency_str);
             furi_string_free(model->preset_str);
             furi_string_free(model->history_stat_str);
-                for
-                    M_EACH(item_menu, model->history->data, SubGhzReceiverMenuItemArray_t) {
-                        furi_string_free(item_menu->item_str);
-                        item_menu->type = 0;
-                    }
-                SubGhzReceiverMenuItemArray_clear(model->history->data);
-                free(model->history);
+            furi_string_free(model->item_str);
         },
         false);
     furi_timer_free(subghz_receiver->timer);
@@ -6,8 +6,15 @@
 #define TAG "CliVcp"
 
 #define USB_CDC_PKT_LEN CDC_DATA_SZ
-#define VCP_RX_BUF_SIZE (USB_CDC_PKT_LEN * 3)
-#define VCP_TX_BUF_SIZE (USB_CDC_PKT_LEN * 3)
+
+#ifndef VCP_RX_BUF_SIZE
+#define VCP_RX_BUF_SIZE (USB_CDC_PKT_LEN * 16)
+#endif
+#ifndef VCP_TX_BUF_SIZE
+#define VCP_TX_BUF_SIZE (USB_CDC_PKT_LEN * 16)
+#endif
+// Tx data is queued in batches, worker is woken up once per batch at most
+#define VCP_TX_BATCH_SIZE (VCP_TX_BUF_SIZE / 2)
 
 #define VCP_IF_NUM 0
 
@@ -39,6 +46,11 @@ typedef struct {
 
     volatile bool connected;
     volatile bool running;
+    volatile bool tx_idle;
+    volatile bool rx_stalled;
+
+    uint32_t rx_stalls; // endpoint left unread because rx buffer was full
+    uint32_t tx_stalls; // writer blocked because tx buffer was full
 
     FuriHalUsbInterface* usb_if_prev;
 
@@ -89,8 +101,6 @@ static void cli_vcp_deinit(void) {
 
 static int32_t vcp_worker(void* context) {
     UNUSED(context);
-    bool tx_idle = true;
-    size_t missed_rx = 0;
     uint8_t last_tx_pkt_len = 0;
 
     // Switch USB to VCP mode (if it is not set yet)
@@ -101,6 +111,10 @@ static int32_t vcp_worker(void* context) {
     furi_hal_cdc_set_callbacks(VCP_IF_NUM, &cdc_cb, NULL);
 
     FURI_LOG_D(TAG, "Start");
+    vcp->tx_idle = true;
+    vcp->rx_stalled = false;
+    vcp->rx_stalls = 0;
+    vcp->tx_stalls = 0;
     vcp->running = true;
 
     while(1) {
@@ -124,24 +138,28 @@ static int32_t vcp_worker(void* context) {
 
             if(vcp->connected == true) {
                 vcp->connected = false;
-                furi_stream_buffer_receive(vcp->tx_stream, vcp->data_buffer, USB_CDC_PKT_LEN, 0);
+                while(furi_stream_buffer_receive(
+                    vcp->tx_stream, vcp->data_buffer, USB_CDC_PKT_LEN, 0)) {
+                }
                 furi_stream_buffer_send(vcp->rx_stream, &ascii_eot, 1, FuriWaitForever);
+                FURI_LOG_D(TAG, "Stalls: rx %lu, tx %lu", vcp->rx_stalls, vcp->tx_stalls);
             }
         }
 
         // Rx buffer was read, maybe there is enough space for new data?
-        if((flags & VcpEvtStreamRx) && (missed_rx > 0)) {
+        if((flags & VcpEvtStreamRx) && vcp->rx_stalled) {
             VCP_DEBUG("StreamRx");
-
-            if(furi_stream_buffer_spaces_available(vcp->rx_stream) >= USB_CDC_PKT_LEN) {
-                flags |= VcpEvtRx;
-                missed_rx--;
-            }
+            flags |= VcpEvtRx;
         }
 
         // New data received
         if(flags & VcpEvtRx) {
+            // Set before the check, so that reader can't miss it after freeing some space
+            const bool rx_was_stalled = vcp->rx_stalled;
+            vcp->rx_stalled = true;
+
             if(furi_stream_buffer_spaces_available(vcp->rx_stream) >= USB_CDC_PKT_LEN) {
+                vcp->rx_stalled = false;
                 int32_t len = furi_hal_cdc_receive(VCP_IF_NUM, vcp->data_buffer, USB_CDC_PKT_LEN);
                 VCP_DEBUG("Rx %ld", len);
 
@@ -151,9 +169,10 @@ static int32_t vcp_worker(void* context) {
                             vcp->rx_stream, vcp->data_buffer, len, FuriWaitForever) ==
                         (size_t)len);
                 }
-            } else {
-                VCP_DEBUG("Rx missed");
-                missed_rx++;
+            } else if(!rx_was_stalled) {
+                // Endpoint stays unread and host is NAKed until reader frees some space
+                VCP_DEBUG("Rx stalled");
+                vcp->rx_stalls++;
             }
         }
 
@@ -161,7 +180,7 @@ static int32_t vcp_worker(void* context) {
         if(flags & VcpEvtStreamTx) {
             VCP_DEBUG("StreamTx");
 
-            if(tx_idle) {
+            if(vcp->tx_idle) {
                 flags |= VcpEvtTx;
             }
         }
@@ -174,7 +193,7 @@ static int32_t vcp_worker(void* context) {
             VCP_DEBUG("Tx %d", len);
 
             if(len > 0) { // Some data left in Tx buffer. Sending it now
-                tx_idle = false;
+                vcp->tx_idle = false;
                 furi_hal_cdc_send(VCP_IF_NUM, vcp->data_buffer, len);
                 last_tx_pkt_len = len;
             } else { // There is nothing to send.
@@ -183,7 +202,11 @@ static int32_t vcp_worker(void* context) {
                     furi_hal_cdc_send(VCP_IF_NUM, NULL, 0);
                 } else {
                     // Set flag to start next transfer instantly
-                    tx_idle = true;
+                    vcp->tx_idle = true;
+                    // Writer could have queued data before the flag was set
+                    if(furi_stream_buffer_bytes_available(vcp->tx_stream)) {
+                        furi_thread_flags_set(furi_thread_get_current_id(), VcpEvtStreamTx);
+                    }
                 }
                 last_tx_pkt_len = 0;
             }
@@ -198,7 +221,9 @@ static int32_t vcp_worker(void* context) {
                 furi_hal_usb_unlock();
                 furi_hal_usb_set_config(vcp->usb_if_prev, NULL);
             }
-            furi_stream_buffer_receive(vcp->tx_stream, vcp->data_buffer, USB_CDC_PKT_LEN, 0);
+            while(
+                furi_stream_buffer_receive(vcp->tx_stream, vcp->data_buffer, USB_CDC_PKT_LEN, 0)) {
+            }
             furi_stream_buffer_send(vcp->rx_stream, &ascii_eot, 1, FuriWaitForever);
             break;
         }
@@ -232,7 +257,9 @@ static size_t cli_vcp_rx(uint8_t* buffer, size_t size, uint32_t timeout) {
             rx_cnt += len;
             break;
         }
-        furi_thread_flags_set(furi_thread_get_id(vcp->thread), VcpEvtStreamRx);
+        if(vcp->rx_stalled) {
+            furi_thread_flags_set(furi_thread_get_id(vcp->thread), VcpEvtStreamRx);
+        }
         size -= len;
         buffer += len;
         rx_cnt += len;
@@ -254,10 +281,16 @@ static void cli_vcp_tx(const uint8_t* buffer, size_t size) {
 
     while(size > 0 && vcp->connected) {
         size_t batch_size = size;
-        if(batch_size > USB_CDC_PKT_LEN) batch_size = USB_CDC_PKT_LEN;
+        if(batch_size > VCP_TX_BATCH_SIZE) batch_size = VCP_TX_BATCH_SIZE;
 
+        if(furi_stream_buffer_spaces_available(vcp->tx_stream) < batch_size) {
+            vcp->tx_stalls++;
+        }
         furi_stream_buffer_send(vcp->tx_stream, buffer, batch_size, FuriWaitForever);
-        furi_thread_flags_set(furi_thread_get_id(vcp->thread), VcpEvtStreamTx);
+        // Worker picks new data up by itself when transfer is in progress
+        if(vcp->tx_idle) {
+            furi_thread_flags_set(furi_thread_get_id(vcp->thread), VcpEvtStreamTx);
+        }
         VCP_DEBUG("tx %u", batch_size);
 
         size -= batch_size;
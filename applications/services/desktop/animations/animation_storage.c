@@ -14,13 +14,52 @@
 #define TAG "AnimationStorage"
 
 #define ANIMATION_META_FILE     "meta.txt"
+#define ANIMATION_PACK_FILE     "animation.pack"
 #define ANIMATION_DIR           EXT_PATH("dolphin")
 #define ANIMATION_MANIFEST_FILE ANIMATION_DIR "/manifest.txt"
 
+#define ANIMATION_PACK_MAGIC       (0x4B504E41UL) /* "ANPK" */
+#define ANIMATION_PACK_VERSION     (1)
+#define ANIMATION_BUBBLE_SLOTS_MAX (20)
+#define ANIMATION_BUBBLE_TEXT_MAX  (100)
+
+/* Animation pack: header, meta section and frame data section.
+ * Meta section holds frame offsets (uint32_t[frame_count], relative to the
+ * frame data section), frames order and bubbles with their text.
+ * Frame data is the same as in frame_N.bm files. */
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t width;
+    uint8_t height;
+    uint8_t frame_count;
+    uint8_t passive_frames;
+    uint8_t active_frames;
+    uint8_t active_cycles;
+    uint8_t frame_rate;
+    uint16_t duration;
+    uint16_t active_cooldown;
+    uint8_t bubble_slots;
+    uint8_t bubble_count;
+    uint16_t meta_size;
+    uint32_t data_size;
+} FURI_PACKED AnimationPackHeader;
+
+typedef struct {
+    uint8_t slot;
+    uint8_t x;
+    uint8_t y;
+    uint8_t align_h;
+    uint8_t align_v;
+    uint8_t start_frame;
+    uint8_t end_frame;
+    uint8_t text_size; /* followed by text without terminating zero */
+} FURI_PACKED AnimationPackBubble;
+
 static void animation_storage_free_bubbles(BubbleAnimation* animation);
 static void animation_storage_free_frames(BubbleAnimation* animation);
-static void animation_storage_free_animation(BubbleAnimation** storage_animation);
-static BubbleAnimation* animation_storage_load_animation(const char* name);
+static void animation_storage_free_animation(StorageAnimation* storage_animation);
+static bool animation_storage_load_animation(StorageAnimation* storage_animation);
 
 static bool animation_storage_load_single_manifest_info(
     StorageAnimationManifestInfo* manifest_info,
@@ -100,6 +139,7 @@ void animation_storage_fill_animation_list(StorageAnimationList_t* animation_lis
         do {
             storage_animation = malloc(sizeof(StorageAnimation));
             storage_animation->external = true;
+            storage_animation->packed = false;
             storage_animation->animation = NULL;
             storage_animation->manifest_info.name = NULL;
 
@@ -159,13 +199,14 @@ StorageAnimation* animation_storage_find_animation(const char* name) {
     if(!storage_animation) {
         storage_animation = malloc(sizeof(StorageAnimation));
         storage_animation->external = true;
+        storage_animation->packed = false;
+        storage_animation->animation = NULL;
 
         bool result = false;
         result =
             animation_storage_load_single_manifest_info(&storage_animation->manifest_info, name);
         if(result) {
-            storage_animation->animation = animation_storage_load_animation(name);
-            result = !!storage_animation->animation;
+            result = animation_storage_load_animation(storage_animation);
         }
         if(!result) {
             animation_storage_free_storage_animation(&storage_animation);
@@ -192,23 +233,28 @@ void animation_storage_cache_animation(StorageAnimation* storage_animation) {
 
     if(storage_animation->external) {
         if(!storage_animation->animation) {
-            storage_animation->animation =
-                animation_storage_load_animation(storage_animation->manifest_info.name);
+            animation_storage_load_animation(storage_animation);
         }
     }
 }
 
-static void animation_storage_free_animation(BubbleAnimation** animation) {
-    furi_assert(animation);
+static void animation_storage_free_animation(StorageAnimation* storage_animation) {
+    furi_assert(storage_animation);
 
-    if(*animation) {
-        animation_storage_free_bubbles(*animation);
-        animation_storage_free_frames(*animation);
-        if((*animation)->frame_order) {
-            free((void*)(*animation)->frame_order);
+    BubbleAnimation* animation = (BubbleAnimation*)storage_animation->animation;
+    if(animation) {
+        animation_storage_free_bubbles(animation);
+        if(storage_animation->packed) {
+            /* frame data shares one allocation with frame pointers */
+            free((void*)animation->icon_animation.frames);
+        } else {
+            animation_storage_free_frames(animation);
         }
-        free(*animation);
-        *animation = NULL;
+        if(animation->frame_order) {
+            free((void*)animation->frame_order);
+        }
+        free(animation);
+        storage_animation->animation = NULL;
     }
 }
 
@@ -217,7 +263,7 @@ void animation_storage_free_storage_animation(StorageAnimation** storage_animati
     furi_assert(*storage_animation);
 
     if((*storage_animation)->external) {
-        animation_storage_free_animation((BubbleAnimation**)&(*storage_animation)->animation);
+        animation_storage_free_animation(*storage_animation);
 
         if((*storage_animation)->manifest_info.name) {
             free((void*)(*storage_animation)->manifest_info.name);
@@ -424,14 +470,13 @@ static bool animation_storage_load_bubbles(BubbleAnimation* animation, FlipperFo
     return success;
 }
 
-static BubbleAnimation* animation_storage_load_animation(const char* name) {
+static BubbleAnimation* animation_storage_load_legacy(Storage* storage, const char* name) {
     furi_assert(name);
     BubbleAnimation* animation = malloc(sizeof(BubbleAnimation));
 
     uint32_t height = 0;
     uint32_t width = 0;
     uint32_t* u32array = NULL;
-    Storage* storage = furi_record_open(RECORD_STORAGE);
     FlipperFormat* ff = flipper_format_file_alloc(storage);
     /* Forbid skipping fields */
     flipper_format_set_strict_mode(ff, true);
@@ -443,8 +488,6 @@ static BubbleAnimation* animation_storage_load_animation(const char* name) {
     do {
         uint32_t u32value;
 
-        if(FSE_OK != storage_sd_status(storage)) break;
-
         furi_string_printf(str, ANIMATION_DIR "/%s/" ANIMATION_META_FILE, name);
         if(!flipper_format_file_open_existing(ff, furi_string_get_cstr(str))) break;
         if(!flipper_format_read_header(ff, str, &u32value)) break;
@@ -506,6 +549,232 @@ static BubbleAnimation* animation_storage_load_animation(const char* name) {
     return animation;
 }
 
+static bool animation_storage_check_pack_header(const AnimationPackHeader* header) {
+    const size_t frame_order_count = header->passive_frames + header->active_frames;
+    const size_t max_filesize = ROUND_UP_TO(header->width, 8) * header->height + 1;
+
+    if(header->magic != ANIMATION_PACK_MAGIC) return false;
+    if(header->version != ANIMATION_PACK_VERSION) return false;
+    if(!header->width || (header->width > 128) || !header->height || (header->height > 128))
+        return false;
+    if(!header->frame_count || !header->passive_frames) return false;
+    if(frame_order_count > UINT8_MAX) return false;
+    if(header->bubble_slots > ANIMATION_BUBBLE_SLOTS_MAX) return false;
+    if(header->meta_size < sizeof(uint32_t) * header->frame_count + frame_order_count)
+        return false;
+    if((header->data_size < header->frame_count) ||
+       (header->data_size > max_filesize * header->frame_count))
+        return false;
+
+    return true;
+}
+
+static bool animation_storage_load_pack_bubbles(
+    BubbleAnimation* animation,
+    uint8_t bubble_count,
+    const uint8_t* data,
+    size_t size) {
+    furi_assert(!animation->frame_bubble_sequences);
+
+    if(animation->frame_bubble_sequences_count == 0) {
+        return (bubble_count == 0) && (size == 0);
+    }
+
+    animation->frame_bubble_sequences =
+        malloc(sizeof(FrameBubble*) * animation->frame_bubble_sequences_count);
+    for(int i = 0; i < animation->frame_bubble_sequences_count; ++i) {
+        FURI_CONST_ASSIGN_PTR(animation->frame_bubble_sequences[i], malloc(sizeof(FrameBubble)));
+    }
+
+    FrameBubble* bubble = NULL;
+    int32_t index = -1;
+    size_t offset = 0;
+    size_t loaded = 0;
+
+    for(; loaded < bubble_count; ++loaded) {
+        if(offset + sizeof(AnimationPackBubble) > size) break;
+        const AnimationPackBubble* entry = (const AnimationPackBubble*)&data[offset];
+        offset += sizeof(AnimationPackBubble);
+
+        /* same rules as for meta.txt: slots start from 0 and go in ascending order */
+        if(entry->slot == index) {
+            bubble->next_bubble = malloc(sizeof(FrameBubble));
+            bubble = (FrameBubble*)bubble->next_bubble;
+        } else if(
+            (entry->slot == index + 1) &&
+            (entry->slot < animation->frame_bubble_sequences_count)) {
+            ++index;
+            bubble = (FrameBubble*)animation->frame_bubble_sequences[index];
+        } else {
+            break;
+        }
+
+        if(entry->text_size > ANIMATION_BUBBLE_TEXT_MAX) break;
+        if(offset + entry->text_size > size) break;
+        if((entry->align_h > AlignCenter) || (entry->align_v > AlignCenter)) break;
+
+        char* text = malloc(entry->text_size + 1);
+        memcpy(text, &data[offset], entry->text_size);
+        text[entry->text_size] = '\0';
+        offset += entry->text_size;
+
+        bubble->bubble.x = entry->x;
+        bubble->bubble.y = entry->y;
+        bubble->bubble.text = text;
+        bubble->bubble.align_h = entry->align_h;
+        bubble->bubble.align_v = entry->align_v;
+        bubble->start_frame = entry->start_frame;
+        bubble->end_frame = entry->end_frame;
+    }
+
+    bool success = (loaded == bubble_count) && (offset == size) &&
+                   ((index + 1) == animation->frame_bubble_sequences_count);
+    if(!success) {
+        FURI_LOG_E(TAG, "Failed to load animation bubbles");
+        animation_storage_free_bubbles(animation);
+    }
+
+    return success;
+}
+
+static bool animation_storage_load_pack_frames(
+    File* file,
+    BubbleAnimation* animation,
+    const AnimationPackHeader* header,
+    const uint32_t* frame_offsets) {
+    const size_t max_filesize = ROUND_UP_TO(header->width, 8) * header->height + 1;
+
+    /* Each frame takes the space up to the start of the next one */
+    for(int i = 0; i < header->frame_count; ++i) {
+        uint32_t frame_end = (i + 1 < header->frame_count) ? frame_offsets[i + 1] :
+                                                             header->data_size;
+        if((frame_offsets[i] >= frame_end) || (frame_end > header->data_size)) return false;
+        if(frame_end - frame_offsets[i] > max_filesize) return false;
+    }
+
+    /* Frame pointers and all frame data in one allocation, read at once */
+    Icon* icon = (Icon*)&animation->icon_animation;
+    const uint8_t** frames =
+        malloc(sizeof(const uint8_t*) * header->frame_count + header->data_size);
+    uint8_t* frame_data = (uint8_t*)&frames[header->frame_count];
+
+    if(storage_file_read(file, frame_data, header->data_size) != header->data_size) {
+        free(frames);
+        return false;
+    }
+
+    for(int i = 0; i < header->frame_count; ++i) {
+        frames[i] = &frame_data[frame_offsets[i]];
+    }
+
+    FURI_CONST_ASSIGN(icon->frame_count, header->frame_count);
+    FURI_CONST_ASSIGN(icon->frame_rate, header->frame_rate);
+    FURI_CONST_ASSIGN(icon->height, header->height);
+    FURI_CONST_ASSIGN(icon->width, header->width);
+    icon->frames = frames;
+
+    return true;
+}
+
+static BubbleAnimation* animation_storage_load_pack(Storage* storage, const char* name) {
+    furi_assert(name);
+
+    BubbleAnimation* animation = NULL;
+    AnimationPackHeader header;
+    uint8_t* meta = NULL;
+    File* file = storage_file_alloc(storage);
+    FuriString* path = furi_string_alloc_printf(ANIMATION_DIR "/%s/" ANIMATION_PACK_FILE, name);
+
+    bool success = false;
+    do {
+        if(!storage_file_open(file, furi_string_get_cstr(path), FSAM_READ, FSOM_OPEN_EXISTING))
+            break;
+
+        if(storage_file_read(file, &header, sizeof(header)) != sizeof(header)) break;
+        if(!animation_storage_check_pack_header(&header)) {
+            FURI_LOG_E(TAG, "Invalid pack \'%s\'", furi_string_get_cstr(path));
+            break;
+        }
+
+        meta = malloc(header.meta_size);
+        if(storage_file_read(file, meta, header.meta_size) != header.meta_size) break;
+
+        const uint32_t* frame_offsets = (const uint32_t*)meta;
+        const uint8_t* frame_order = &meta[sizeof(uint32_t) * header.frame_count];
+        const uint8_t frame_order_count = header.passive_frames + header.active_frames;
+        const uint8_t* bubbles = &frame_order[frame_order_count];
+
+        bool frame_order_ok = true;
+        for(int i = 0; i < frame_order_count; ++i) {
+            frame_order_ok &= frame_order[i] < header.frame_count;
+        }
+        if(!frame_order_ok) {
+            FURI_LOG_E(TAG, "Error loading animation: frames order");
+            break;
+        }
+
+        animation = malloc(sizeof(BubbleAnimation));
+        animation->frame_bubble_sequences = NULL;
+        animation->passive_frames = header.passive_frames;
+        animation->active_frames = header.active_frames;
+        animation->active_cycles = header.active_cycles;
+        animation->duration = header.duration;
+        animation->active_cooldown = header.active_cooldown;
+        animation->frame_order = malloc(frame_order_count);
+        memcpy((void*)animation->frame_order, frame_order, frame_order_count);
+
+        animation->frame_bubble_sequences_count = header.bubble_slots;
+        if(!animation_storage_load_pack_bubbles(
+               animation, header.bubble_count, bubbles, &meta[header.meta_size] - bubbles))
+            break;
+
+        if(!animation_storage_load_pack_frames(file, animation, &header, frame_offsets)) {
+            FURI_LOG_E(TAG, "Error loading animation: frames");
+            animation_storage_free_bubbles(animation);
+            break;
+        }
+
+        success = true;
+    } while(0);
+
+    if(!success && animation) {
+        free((void*)animation->frame_order);
+        free(animation);
+        animation = NULL;
+    }
+
+    if(meta) {
+        free(meta);
+    }
+    furi_string_free(path);
+    storage_file_free(file);
+
+    return animation;
+}
+
+static bool animation_storage_load_animation(StorageAnimation* storage_animation) {
+    furi_assert(storage_animation);
+    furi_assert(!storage_animation->animation);
+    const char* name = storage_animation->manifest_info.name;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    BubbleAnimation* animation = NULL;
+
+    if(FSE_OK == storage_sd_status(storage)) {
+        animation = animation_storage_load_pack(storage, name);
+        storage_animation->packed = !!animation;
+        if(!animation) {
+            /* No pack: meta.txt and a frame_N.bm file per frame */
+            animation = animation_storage_load_legacy(storage, name);
+        }
+    }
+
+    furi_record_close(RECORD_STORAGE);
+
+    storage_animation->animation = animation;
+    return !!animation;
+}
+
 static void animation_storage_free_bubbles(BubbleAnimation* animation) {
     if(!animation->frame_bubble_sequences) return;
 
@@ -5,5 +5,6 @@
 struct StorageAnimation {
     const BubbleAnimation* animation;
     bool external;
+    bool packed; /* frames were loaded from a pack and share one allocation */
     StorageAnimationManifestInfo manifest_info;
 };
@@ -29,6 +29,11 @@ extern "C" {
  */
 #define EXPANSION_PROTOCOL_MAX_DATA_SIZE (64U)
 
+/**
+ * @brief Maximum data size per windowed data frame, in bytes.
+ */
+#define EXPANSION_PROTOCOL_WINDOW_DATA_SIZE (256U)
+
 /**
  * @brief Maximum allowed inactivity period, in milliseconds.
  */
@@ -48,6 +53,8 @@ typedef enum {
     ExpansionFrameTypeBaudRate = 3, /**< Baud rate negotiation frame. */
     ExpansionFrameTypeControl = 4, /**< Control frame. */
     ExpansionFrameTypeData = 5, /**< Data frame. */
+    ExpansionFrameTypeWindowData = 6, /**< Windowed data frame. */
+    ExpansionFrameTypeWindowAck = 7, /**< Windowed data acknowledgement frame. */
     ExpansionFrameTypeReserved, /**< Special value. */
 } ExpansionFrameType;
 
@@ -86,6 +93,12 @@ typedef enum {
       * otherwise OTG is to be controlled via RPC messages.
       */
     ExpansionFrameControlCommandDisableOtg = 0x03,
+    /** @brief Switch data transfer to windowed data frames.
+      *
+      * Must only be used while the RPC session is NOT active.
+      * Hosts that do not support it drop the connection instead of responding.
+      */
+    ExpansionFrameControlCommandStartWindow = 0x04,
 } ExpansionFrameControlCommand;
 
 #pragma pack(push, 1)
@@ -135,6 +148,30 @@ typedef struct {
     uint8_t bytes[EXPANSION_PROTOCOL_MAX_DATA_SIZE];
 } ExpansionFrameData;
 
+/**
+ * @brief Windowed data frame contents.
+ */
+typedef struct {
+    /** Sequence number of the frame, wraps around after 255. */
+    uint8_t seq;
+    /** Size of the data. Must be between 1 and EXPANSION_PROTOCOL_WINDOW_DATA_SIZE. */
+    uint16_t size;
+    /** CRC-16 of the frame type, sequence number, size and data. */
+    uint16_t crc;
+    /** Data bytes. Valid only up to ExpansionFrameWindowData::size bytes. */
+    uint8_t bytes[EXPANSION_PROTOCOL_WINDOW_DATA_SIZE];
+} ExpansionFrameWindowData;
+
+/**
+ * @brief Windowed data acknowledgement frame contents.
+ */
+typedef struct {
+    /** Sequence number of the first frame not yet consumed by the receiver. */
+    uint8_t seq;
+    /** Bit N is set if frame seq + N has been received. */
+    uint8_t received;
+} ExpansionFrameWindowAck;
+
 /**
  * @brief Expansion protocol frame structure.
  */
@@ -146,6 +183,8 @@ typedef struct {
         ExpansionFrameBaudRate baud_rate; /**< Baud rate frame contents. */
         ExpansionFrameControl control; /**< Control frame contents. */
         ExpansionFrameData data; /**< Data frame contents. */
+        ExpansionFrameWindowData window_data; /**< Windowed data frame contents. */
+        ExpansionFrameWindowAck window_ack; /**< Windowed data acknowledgement frame contents. */
     } content; /**< Contents of the frame. */
 } ExpansionFrame;
 
@@ -200,6 +239,11 @@ static inline size_t expansion_frame_get_encoded_size(const ExpansionFrame* fram
         return sizeof(frame->header) + sizeof(frame->content.control);
     case ExpansionFrameTypeData:
         return sizeof(frame->header) + sizeof(frame->content.data.size) + frame->content.data.size;
+    case ExpansionFrameTypeWindowData:
+        return sizeof(frame->header) + offsetof(ExpansionFrameWindowData, bytes) +
+               frame->content.window_data.size;
+    case ExpansionFrameTypeWindowAck:
+        return sizeof(frame->header) + sizeof(frame->content.window_ack);
     default:
         return 0;
     }
@@ -253,6 +297,23 @@ static inline bool expansion_frame_get_remaining_size(
             content_size = sizeof(frame->content.data.size) + frame->content.data.size;
         }
         break;
+    case ExpansionFrameTypeWindowData:
+        if(received_content_size < offsetof(ExpansionFrameWindowData, crc)) {
+            // Data size is unknown as of now
+            content_size = offsetof(ExpansionFrameWindowData, crc);
+        } else if(
+            (frame->content.window_data.size == 0) ||
+            (frame->content.window_data.size > sizeof(frame->content.window_data.bytes))) {
+            // Malformed frame or garbage input
+            return false;
+        } else {
+            content_size =
+                offsetof(ExpansionFrameWindowData, bytes) + frame->content.window_data.size;
+        }
+        break;
+    case ExpansionFrameTypeWindowAck:
+        content_size = sizeof(frame->content.window_ack);
+        break;
     default:
         return false;
     }
@@ -294,6 +355,43 @@ static inline ExpansionFrameChecksum
     return checksum;
 }
 
+/**
+ * @brief Update a CRC-16 value with more data
+ *
+ * CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF. Computed bitwise
+ * to avoid lookup tables on small modules.
+ *
+ * @param[in] crc current CRC value, 0xFFFF for the first call.
+ * @param[in] data pointer to a byte buffer containing the data.
+ * @param[in] data_size size of the data buffer.
+ * @returns updated CRC value.
+ */
+static inline uint16_t
+    expansion_protocol_update_crc(uint16_t crc, const uint8_t* data, size_t data_size) {
+    for(size_t i = 0; i < data_size; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for(uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Get the CRC of a windowed data frame
+ *
+ * Covers the frame type, sequence number, size and data, but not the crc field itself.
+ *
+ * @param[in] frame pointer to a windowed data frame with valid size.
+ * @returns CRC value to be stored in or compared with ExpansionFrameWindowData::crc.
+ */
+static inline uint16_t expansion_protocol_get_crc(const ExpansionFrame* frame) {
+    const ExpansionFrameWindowData* data = &frame->content.window_data;
+    const size_t head_size = sizeof(frame->header) + offsetof(ExpansionFrameWindowData, crc);
+    const uint16_t crc = expansion_protocol_update_crc(0xFFFFU, (const uint8_t*)frame, head_size);
+    return expansion_protocol_update_crc(crc, data->bytes, data->size);
+}
+
 /**
  * @brief Receive and decode a frame.
  *
@@ -0,0 +1,345 @@
+/**
+ * @file expansion_protocol_window.h
+ * @brief Flipper Expansion Protocol windowed transfer reference implementation.
+ *
+ * This file is licensed separately under The Unlicense.
+ * See https://unlicense.org/ for more details.
+ *
+ * Up to EXPANSION_PROTOCOL_WINDOW_SIZE windowed data frames may be in flight
+ * in each direction without waiting for a reply. The receiver acknowledges
+ * frames with a bitmask, so that only lost or corrupted frames are sent again.
+ *
+ * Like the parser, it does not use dynamic memory allocation or
+ * Flipper-specific libraries: the caller provides the window storage and
+ * the current time.
+ */
+#pragma once
+
+#include "expansion_protocol.h"
+
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of unacknowledged frames in each direction.
+ *
+ * Must be a power of 2, not greater than the number of bits in ExpansionFrameWindowAck::received.
+ */
+#define EXPANSION_PROTOCOL_WINDOW_SIZE (8U)
+
+/**
+ * @brief Line idle time after which the receiver expects a frame start, in milliseconds.
+ *
+ * After a malformed frame, the receiver drops all input until the line has been
+ * idle for this period. The sender pauses when its window is full.
+ */
+#define EXPANSION_PROTOCOL_WINDOW_RESYNC_MS (5U)
+
+/**
+ * @brief Retransmission timeout margin, in milliseconds.
+ *
+ * @see expansion_window_get_timeout().
+ */
+#define EXPANSION_PROTOCOL_WINDOW_RETRANSMIT_MS (20U)
+
+#if(EXPANSION_PROTOCOL_WINDOW_SIZE > 8U) || \
+    (EXPANSION_PROTOCOL_WINDOW_SIZE & (EXPANSION_PROTOCOL_WINDOW_SIZE - 1U))
+#error "EXPANSION_PROTOCOL_WINDOW_SIZE must be a power of 2 not greater than 8"
+#endif
+
+/**
+ * @brief Windowed transfer state of one side of the connection.
+ */
+typedef struct {
+    /** @brief Sending side. */
+    struct {
+        uint8_t seq; /**< Sequence number of the oldest unacknowledged frame. */
+        uint8_t count; /**< Number of frames in the window. */
+        uint8_t acked; /**< Bit N is set if frame seq + N has been acknowledged. */
+        uint8_t pending; /**< Bit N is set if frame seq + N is to be (re)transmitted. */
+        uint32_t order; /**< Number of transmitted frames. */
+        uint32_t retransmitted; /**< Number of retransmitted frames. */
+        struct {
+            uint32_t order; /**< Value of the order counter when last sent, 0 if never. */
+            uint32_t time; /**< Time when last sent, in milliseconds. */
+            uint16_t size; /**< Size of the data. */
+            uint8_t bytes[EXPANSION_PROTOCOL_WINDOW_DATA_SIZE]; /**< Data bytes. */
+        } frames[EXPANSION_PROTOCOL_WINDOW_SIZE]; /**< Frame seq + N is at (seq + N) % size. */
+    } tx;
+    /** @brief Receiving side. */
+    struct {
+        uint8_t seq; /**< Sequence number of the first frame not yet consumed. */
+        uint8_t received; /**< Bit N is set if frame seq + N has been received. */
+        uint16_t offset; /**< Number of consumed bytes of frame seq. */
+        struct {
+            uint16_t size; /**< Size of the data. */
+            uint8_t bytes[EXPANSION_PROTOCOL_WINDOW_DATA_SIZE]; /**< Data bytes. */
+        } frames[EXPANSION_PROTOCOL_WINDOW_SIZE]; /**< Frame seq + N is at (seq + N) % size. */
+    } rx;
+} ExpansionWindow;
+
+/**
+ * @brief Get the window slot of a frame.
+ *
+ * @param[in] seq sequence number of the frame.
+ * @returns index into the frames array.
+ */
+static inline uint8_t expansion_window_get_slot(uint8_t seq) {
+    return seq % EXPANSION_PROTOCOL_WINDOW_SIZE;
+}
+
+/**
+ * @brief Reset the window state.
+ *
+ * Both sides must reset their windows when the windowed transfer is started.
+ *
+ * @param[out] window pointer to the window state.
+ */
+static inline void expansion_window_reset(ExpansionWindow* window) {
+    memset(window, 0, sizeof(ExpansionWindow));
+}
+
+/**
+ * @brief Get the retransmission timeout for the given baud rate.
+ *
+ * Long enough for a full window of the largest frames to be transferred
+ * before the acknowledgement comes back, so that frames are only sent again
+ * when lost.
+ *
+ * @param[in] baud_rate current baud rate.
+ * @returns retransmission timeout, in milliseconds.
+ */
+static inline uint32_t expansion_window_get_timeout(uint32_t baud_rate) {
+    // 10 bits per byte: start, 8 data bits and stop
+    const uint32_t window_bits = (EXPANSION_PROTOCOL_WINDOW_SIZE + 1U) *
+                                 (sizeof(ExpansionFrame) + sizeof(ExpansionFrameChecksum)) * 10U;
+    return window_bits * 1000U / baud_rate + EXPANSION_PROTOCOL_WINDOW_RESYNC_MS +
+           EXPANSION_PROTOCOL_WINDOW_RETRANSMIT_MS;
+}
+
+/**
+ * @brief Check if all sent data has been acknowledged.
+ *
+ * @param[in] window pointer to the window state.
+ * @returns true if there are no frames in flight.
+ */
+static inline bool expansion_window_is_empty(const ExpansionWindow* window) {
+    return window->tx.count == 0;
+}
+
+/**
+ * @brief Put data into the next frame to be sent.
+ *
+ * @param[in,out] window pointer to the window state.
+ * @param[in] data pointer to the data to be sent.
+ * @param[in] data_size size of the data, in bytes.
+ * @returns number of bytes taken, 0 if the window is full.
+ */
+static inline size_t
+    expansion_window_push(ExpansionWindow* window, const uint8_t* data, size_t data_size) {
+    if(window->tx.count == EXPANSION_PROTOCOL_WINDOW_SIZE || data_size == 0) {
+        return 0;
+    }
+
+    const uint8_t index = window->tx.count++;
+    const uint8_t slot = expansion_window_get_slot(window->tx.seq + index);
+    const size_t size =
+        data_size < EXPANSION_PROTOCOL_WINDOW_DATA_SIZE ? data_size :
+                                                          EXPANSION_PROTOCOL_WINDOW_DATA_SIZE;
+
+    window->tx.frames[slot].order = 0;
+    window->tx.frames[slot].size = size;
+    memcpy(window->tx.frames[slot].bytes, data, size);
+    window->tx.pending |= 1U << index;
+
+    return size;
+}
+
+/**
+ * @brief Get the next frame to be sent.
+ *
+ * New frames and frames known to be lost come first, then frames
+ * not acknowledged within the timeout. The oldest frame is also sent again
+ * if it has been received, but not consumed within the timeout, in case
+ * the acknowledgement that freed it got lost.
+ *
+ * @param[in,out] window pointer to the window state.
+ * @param[in] time current time, in milliseconds.
+ * @param[in] timeout retransmission timeout, in milliseconds. @see expansion_window_get_timeout().
+ * @param[out] frame pointer to the frame to be filled in.
+ * @returns true if the frame must be sent, false if there is nothing to send.
+ */
+static inline bool expansion_window_get_frame(
+    ExpansionWindow* window,
+    uint32_t time,
+    uint32_t timeout,
+    ExpansionFrame* frame) {
+    uint8_t index = 0;
+
+    if(window->tx.pending) {
+        while(!(window->tx.pending & (1U << index))) {
+            ++index;
+        }
+    } else {
+        for(; index < window->tx.count; ++index) {
+            const uint8_t slot = expansion_window_get_slot(window->tx.seq + index);
+            const bool is_acked = (index != 0) && (window->tx.acked & (1U << index));
+            if(!is_acked && (time - window->tx.frames[slot].time >= timeout)) {
+                break;
+            }
+        }
+        if(index == window->tx.count) {
+            return false;
+        }
+    }
+
+    const uint8_t slot = expansion_window_get_slot(window->tx.seq + index);
+
+    if(window->tx.frames[slot].order != 0) {
+        ++window->tx.retransmitted;
+    }
+
+    window->tx.pending &= ~(1U << index);
+    window->tx.frames[slot].order = ++window->tx.order;
+    window->tx.frames[slot].time = time;
+
+    frame->header.type = ExpansionFrameTypeWindowData;
+    frame->content.window_data.seq = window->tx.seq + index;
+    frame->content.window_data.size = window->tx.frames[slot].size;
+    memcpy(
+        frame->content.window_data.bytes,
+        window->tx.frames[slot].bytes,
+        window->tx.frames[slot].size);
+    frame->content.window_data.crc = expansion_protocol_get_crc(frame);
+
+    return true;
+}
+
+/**
+ * @brief Process a received acknowledgement frame.
+ *
+ * Frees the consumed frames. Frames that were sent before an acknowledged one,
+ * but are not acknowledged themselves, are considered lost and will be sent again.
+ *
+ * @param[in,out] window pointer to the window state.
+ * @param[in] frame pointer to the received acknowledgement frame.
+ * @returns number of freed frames.
+ */
+static inline uint8_t expansion_window_ack(ExpansionWindow* window, const ExpansionFrame* frame) {
+    const ExpansionFrameWindowAck* ack = &frame->content.window_ack;
+    const uint8_t freed = ack->seq - window->tx.seq;
+
+    if(freed > window->tx.count) {
+        // Stale or invalid acknowledgement
+        return 0;
+    }
+
+    window->tx.seq = ack->seq;
+    window->tx.count -= freed;
+    window->tx.acked = (uint8_t)((uint32_t)window->tx.acked >> freed);
+    window->tx.pending = (uint8_t)((uint32_t)window->tx.pending >> freed);
+    window->tx.acked |= ack->received & (uint8_t)((1U << window->tx.count) - 1U);
+
+    uint32_t newest_acked = 0;
+    for(uint8_t index = 0; index < window->tx.count; ++index) {
+        const uint8_t slot = expansion_window_get_slot(window->tx.seq + index);
+        if((window->tx.acked & (1U << index)) && (window->tx.frames[slot].order > newest_acked)) {
+            newest_acked = window->tx.frames[slot].order;
+        }
+    }
+
+    for(uint8_t index = 0; index < window->tx.count; ++index) {
+        const uint8_t slot = expansion_window_get_slot(window->tx.seq + index);
+        if(!(window->tx.acked & (1U << index)) && (window->tx.frames[slot].order != 0) &&
+           (window->tx.frames[slot].order < newest_acked)) {
+            window->tx.pending |= 1U << index;
+        }
+    }
+
+    return freed;
+}
+
+/**
+ * @brief Process a received windowed data frame.
+ *
+ * Duplicate frames and frames outside of the window are ignored, but must
+ * still be acknowledged, since the previous acknowledgement may have been lost.
+ *
+ * @param[in,out] window pointer to the window state.
+ * @param[in] frame pointer to the received windowed data frame.
+ * @returns true if the frame is intact and must be acknowledged, false on CRC mismatch.
+ */
+static inline bool expansion_window_receive(ExpansionWindow* window, const ExpansionFrame* frame) {
+    const ExpansionFrameWindowData* data = &frame->content.window_data;
+
+    if(data->crc != expansion_protocol_get_crc(frame)) {
+        return false;
+    }
+
+    const uint8_t index = data->seq - window->rx.seq;
+
+    if((index < EXPANSION_PROTOCOL_WINDOW_SIZE) && !(window->rx.received & (1U << index))) {
+        const uint8_t slot = expansion_window_get_slot(data->seq);
+        window->rx.frames[slot].size = data->size;
+        memcpy(window->rx.frames[slot].bytes, data->bytes, data->size);
+        window->rx.received |= 1U << index;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get received data in order.
+ *
+ * @param[in] window pointer to the window state.
+ * @param[out] data pointer to the variable to contain the pointer to the data.
+ * @returns number of bytes available, 0 if the next frame has not been received yet.
+ */
+static inline size_t expansion_window_read(const ExpansionWindow* window, const uint8_t** data) {
+    if(!(window->rx.received & 1U)) {
+        return 0;
+    }
+
+    const uint8_t slot = expansion_window_get_slot(window->rx.seq);
+    *data = window->rx.frames[slot].bytes + window->rx.offset;
+    return window->rx.frames[slot].size - window->rx.offset;
+}
+
+/**
+ * @brief Release received data.
+ *
+ * The frame is acknowledged as consumed once all of its data is released,
+ * which lets the sender reuse its window slot.
+ *
+ * @param[in,out] window pointer to the window state.
+ * @param[in] data_size number of bytes to release, up to expansion_window_read() result.
+ */
+static inline void expansion_window_consume(ExpansionWindow* window, size_t data_size) {
+    const uint8_t slot = expansion_window_get_slot(window->rx.seq);
+    window->rx.offset += data_size;
+
+    if(window->rx.offset == window->rx.frames[slot].size) {
+        window->rx.offset = 0;
+        window->rx.received >>= 1;
+        ++window->rx.seq;
+    }
+}
+
+/**
+ * @brief Get the acknowledgement frame for the current receiving state.
+ *
+ * @param[in] window pointer to the window state.
+ * @param[out] frame pointer to the frame to be filled in.
+ */
+static inline void expansion_window_get_ack(const ExpansionWindow* window, ExpansionFrame* frame) {
+    frame->header.type = ExpansionFrameTypeWindowAck;
+    frame->content.window_ack.seq = window->rx.seq;
+    frame->content.window_ack.received = window->rx.received;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,11 +8,16 @@
 #include <rpc/rpc.h>
 
 #include "expansion_protocol.h"
+#include "expansion_protocol_window.h"
 
 #define TAG "ExpansionSrv"
 
-#define EXPANSION_WORKER_STACK_SZIE  (768UL)
-#define EXPANSION_WORKER_BUFFER_SIZE (sizeof(ExpansionFrame) + sizeof(ExpansionFrameChecksum))
+#define EXPANSION_WORKER_STACK_SZIE (1536UL)
+// Room for a frame being received while the worker is busy sending another one
+#define EXPANSION_WORKER_BUFFER_SIZE \
+    (2 * (sizeof(ExpansionFrame) + sizeof(ExpansionFrameChecksum)))
+// Receive polling period while windowed frames may be waiting to be sent
+#define EXPANSION_WORKER_WINDOW_POLL_MS (EXPANSION_PROTOCOL_WINDOW_RESYNC_MS)
 
 typedef enum {
     ExpansionWorkerStateHandShake,
@@ -31,9 +36,11 @@ typedef enum {
     ExpansionWorkerFlagStop = 1 << 0,
     ExpansionWorkerFlagData = 1 << 1,
     ExpansionWorkerFlagError = 1 << 2,
+    ExpansionWorkerFlagTx = 1 << 3,
 } ExpansionWorkerFlag;
 
-#define EXPANSION_ALL_FLAGS (ExpansionWorkerFlagData | ExpansionWorkerFlagStop)
+#define EXPANSION_ALL_FLAGS \
+    (ExpansionWorkerFlagData | ExpansionWorkerFlagStop | ExpansionWorkerFlagTx)
 
 struct ExpansionWorker {
     FuriThread* thread;
@@ -45,6 +52,13 @@ struct ExpansionWorker {
 
     RpcSession* rpc_session;
 
+    ExpansionWindow* window;
+    FuriMutex* window_mutex;
+    uint32_t window_timeout;
+    uint32_t baud_rate;
+    ExpansionFrame tx_frame;
+    ExpansionFrame rpc_frame;
+
     ExpansionWorkerState state;
     ExpansionWorkerExitReason exit_reason;
     ExpansionWorkerCallback callback;
@@ -63,7 +77,10 @@ static void expansion_worker_serial_rx_callback(
 
     if(event & (FuriHalSerialRxEventNoiseError | FuriHalSerialRxEventFrameError |
                 FuriHalSerialRxEventOverrunError)) {
-        furi_thread_flags_set(furi_thread_get_id(instance->thread), ExpansionWorkerFlagError);
+        // Windowed transfer recovers from line errors by itself
+        if(!instance->window) {
+            furi_thread_flags_set(furi_thread_get_id(instance->thread), ExpansionWorkerFlagError);
+        }
     } else if(event & FuriHalSerialRxEventData) {
         while(furi_hal_serial_async_rx_available(handle)) {
             const uint8_t data = furi_hal_serial_async_rx(handle);
@@ -73,21 +90,51 @@ static void expansion_worker_serial_rx_callback(
     }
 }
 
+static bool expansion_worker_window_poll(ExpansionWorker* instance, bool* is_sent);
+
 static size_t expansion_worker_receive_callback(uint8_t* data, size_t data_size, void* context) {
     ExpansionWorker* instance = context;
 
     size_t received_size = 0;
+    uint32_t last_rx_tick = furi_get_tick();
 
     while(true) {
-        received_size += furi_stream_buffer_receive(
+        const size_t size = furi_stream_buffer_receive(
             instance->rx_buf, data + received_size, data_size - received_size, 0);
 
+        received_size += size;
         if(received_size == data_size) break;
 
+        uint32_t timeout_ms = EXPANSION_PROTOCOL_TIMEOUT_MS;
+
+        if(instance->window) {
+            if(size) {
+                last_rx_tick = furi_get_tick();
+            }
+
+            // Keep sending windowed frames while waiting for the rest of the input
+            bool is_sent;
+            if(!expansion_worker_window_poll(instance, &is_sent)) {
+                instance->exit_reason = ExpansionWorkerExitReasonError;
+                break;
+            } else if(is_sent) {
+                continue;
+            } else if(furi_get_tick() - last_rx_tick >= furi_ms_to_ticks(timeout_ms)) {
+                // Exiting due to timeout
+                instance->exit_reason = ExpansionWorkerExitReasonTimeout;
+                break;
+            }
+
+            timeout_ms = EXPANSION_WORKER_WINDOW_POLL_MS;
+        }
+
         const uint32_t flags = furi_thread_flags_wait(
-            EXPANSION_ALL_FLAGS, FuriFlagWaitAny, furi_ms_to_ticks(EXPANSION_PROTOCOL_TIMEOUT_MS));
+            EXPANSION_ALL_FLAGS, FuriFlagWaitAny, furi_ms_to_ticks(timeout_ms));
 
-        if(flags & FuriFlagError) {
+        if((flags == (unsigned)FuriFlagErrorTimeout) && instance->window) {
+            // Inactivity is tracked above
+            continue;
+        } else if(flags & FuriFlagError) {
             if(flags == (unsigned)FuriFlagErrorTimeout) {
                 // Exiting due to timeout
                 instance->exit_reason = ExpansionWorkerExitReasonTimeout;
@@ -104,7 +151,7 @@ static size_t expansion_worker_receive_callback(uint8_t* data, size_t data_size,
             // Exiting due to RPC error
             instance->exit_reason = ExpansionWorkerExitReasonError;
             break;
-        } else if(flags & ExpansionWorkerFlagData) {
+        } else if(flags & (ExpansionWorkerFlagData | ExpansionWorkerFlagTx)) {
             // Go to buffer reading
             continue;
         }
@@ -113,12 +160,6 @@ static size_t expansion_worker_receive_callback(uint8_t* data, size_t data_size,
     return received_size;
 }
 
-static inline bool
-    expansion_worker_receive_frame(ExpansionWorker* instance, ExpansionFrame* frame) {
-    return expansion_protocol_decode(frame, expansion_worker_receive_callback, instance) ==
-           ExpansionProtocolStatusOk;
-}
-
 static size_t
     expansion_worker_send_callback(const uint8_t* data, size_t data_size, void* context) {
     ExpansionWorker* instance = context;
@@ -158,19 +199,108 @@ static bool expansion_worker_send_data_response(
     size_t data_size) {
     furi_assert(data_size <= EXPANSION_PROTOCOL_MAX_DATA_SIZE);
 
-    ExpansionFrame frame = {
-        .header.type = ExpansionFrameTypeData,
-        .content.data.size = data_size,
-    };
+    // Not on the stack: called in Rpc session thread context
+    ExpansionFrame* frame = &instance->rpc_frame;
+    frame->header.type = ExpansionFrameTypeData;
+    frame->content.data.size = data_size;
 
-    memcpy(frame.content.data.bytes, data, data_size);
-    return expansion_worker_send_frame(instance, &frame);
+    memcpy(frame->content.data.bytes, data, data_size);
+    return expansion_worker_send_frame(instance, frame);
+}
+
+static bool expansion_worker_send_window_ack(ExpansionWorker* instance) {
+    ExpansionFrame* frame = &instance->tx_frame;
+    expansion_window_get_ack(instance->window, frame);
+    return expansion_worker_send_frame(instance, frame);
+}
+
+static void expansion_worker_window_start(ExpansionWorker* instance) {
+    if(!instance->window) {
+        instance->window = malloc(sizeof(ExpansionWindow));
+        instance->window_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    }
+
+    expansion_window_reset(instance->window);
+    instance->window_timeout = expansion_window_get_timeout(instance->baud_rate);
+}
+
+static void expansion_worker_window_stop(ExpansionWorker* instance) {
+    if(instance->window) {
+        furi_mutex_free(instance->window_mutex);
+        free(instance->window);
+        instance->window = NULL;
+    }
+}
+
+// Pass received data to the Rpc session as long as it has room for it
+static bool expansion_worker_window_deliver(ExpansionWorker* instance) {
+    bool is_consumed = false;
+
+    const uint8_t* data;
+    size_t data_size;
+
+    while((data_size = expansion_window_read(instance->window, &data)) != 0) {
+        const size_t size_consumed = rpc_session_feed(instance->rpc_session, data, data_size, 0);
+        if(size_consumed == 0) break;
+        expansion_window_consume(instance->window, size_consumed);
+        is_consumed = true;
+    }
+
+    return is_consumed;
+}
+
+static bool expansion_worker_window_poll(ExpansionWorker* instance, bool* is_sent) {
+    *is_sent = false;
+
+    if(instance->state == ExpansionWorkerStateRpcActive) {
+        // Freed window slots must be reported to the sender
+        if(expansion_worker_window_deliver(instance)) {
+            if(!expansion_worker_send_window_ack(instance)) return false;
+        }
+    }
+
+    furi_check(furi_mutex_acquire(instance->window_mutex, FuriWaitForever) == FuriStatusOk);
+    *is_sent = expansion_window_get_frame(
+        instance->window, furi_get_tick(), instance->window_timeout, &instance->tx_frame);
+    furi_mutex_release(instance->window_mutex);
+
+    return !*is_sent || expansion_worker_send_frame(instance, &instance->tx_frame);
+}
+
+static void expansion_worker_window_send(
+    ExpansionWorker* instance,
+    const uint8_t* data,
+    size_t data_size) {
+    // A full window is only freed after its frames have been transferred and acknowledged
+    const uint32_t timeout_ms = EXPANSION_PROTOCOL_TIMEOUT_MS + instance->window_timeout;
+
+    for(size_t sent_data_size = 0; sent_data_size < data_size;) {
+        furi_check(furi_mutex_acquire(instance->window_mutex, FuriWaitForever) == FuriStatusOk);
+        const size_t current_data_size = expansion_window_push(
+            instance->window, data + sent_data_size, data_size - sent_data_size);
+        furi_mutex_release(instance->window_mutex);
+
+        if(current_data_size) {
+            sent_data_size += current_data_size;
+            furi_thread_flags_set(furi_thread_get_id(instance->thread), ExpansionWorkerFlagTx);
+        } else if(
+            furi_semaphore_acquire(instance->tx_semaphore, furi_ms_to_ticks(timeout_ms)) !=
+            FuriStatusOk) {
+            furi_thread_flags_set(furi_thread_get_id(instance->thread), ExpansionWorkerFlagError);
+            break;
+        }
+    }
 }
 
 // Called in Rpc session thread context
 static void expansion_worker_rpc_send_callback(void* context, uint8_t* data, size_t data_size) {
     ExpansionWorker* instance = context;
 
+    if(instance->window) {
+        expansion_worker_window_send(instance, data, data_size);
+        return;
+    }
+
     for(size_t sent_data_size = 0; sent_data_size < data_size;) {
         if(furi_semaphore_acquire(
                instance->tx_semaphore, furi_ms_to_ticks(EXPANSION_PROTOCOL_TIMEOUT_MS)) !=
@@ -210,23 +340,27 @@ static void expansion_worker_rpc_session_close(ExpansionWorker* instance) {
     furi_record_close(RECORD_RPC);
 }
 
-static bool expansion_worker_handle_state_handshake(
+static bool expansion_worker_handle_baud_rate(
     ExpansionWorker* instance,
-    const ExpansionFrame* rx_frame) {
+    const ExpansionFrame* rx_frame,
+    bool* is_supported) {
     bool success = false;
 
     do {
-        if(rx_frame->header.type != ExpansionFrameTypeBaudRate) break;
         const uint32_t baud_rate = rx_frame->content.baud_rate.baud;
 
         FURI_LOG_D(TAG, "Proposed baud rate: %lu", baud_rate);
 
-        if(furi_hal_serial_is_baud_rate_supported(instance->serial_handle, baud_rate)) {
-            instance->state = ExpansionWorkerStateConnected;
+        *is_supported = furi_hal_serial_is_baud_rate_supported(instance->serial_handle, baud_rate);
+
+        if(*is_supported) {
             // Send response at previous baud rate
             if(!expansion_worker_send_status_response(instance, ExpansionFrameErrorNone)) break;
             furi_hal_serial_set_br(instance->serial_handle, baud_rate);
 
+            instance->baud_rate = baud_rate;
+            instance->window_timeout = expansion_window_get_timeout(baud_rate);
+
         } else {
             if(!expansion_worker_send_status_response(instance, ExpansionFrameErrorBaudRate))
                 break;
@@ -238,6 +372,50 @@ static bool expansion_worker_handle_state_handshake(
     return success;
 }
 
+static bool expansion_worker_handle_window_data(
+    ExpansionWorker* instance,
+    const ExpansionFrame* rx_frame) {
+    // Corrupted frames are acknowledged too, so that the sender learns what is missing
+    if(!expansion_window_receive(instance->window, rx_frame)) {
+        FURI_LOG_D(TAG, "Bad CRC");
+    }
+
+    expansion_worker_window_deliver(instance);
+    return expansion_worker_send_window_ack(instance);
+}
+
+static void
+    expansion_worker_handle_window_ack(ExpansionWorker* instance, const ExpansionFrame* rx_frame) {
+    furi_check(furi_mutex_acquire(instance->window_mutex, FuriWaitForever) == FuriStatusOk);
+    const uint8_t freed = expansion_window_ack(instance->window, rx_frame);
+    furi_mutex_release(instance->window_mutex);
+
+    if(freed && instance->state == ExpansionWorkerStateRpcActive) {
+        // Rpc session thread may be waiting for a free window slot
+        furi_semaphore_release(instance->tx_semaphore);
+    }
+}
+
+static bool expansion_worker_handle_state_handshake(
+    ExpansionWorker* instance,
+    const ExpansionFrame* rx_frame) {
+    bool success = false;
+
+    do {
+        if(rx_frame->header.type != ExpansionFrameTypeBaudRate) break;
+
+        bool is_supported;
+        if(!expansion_worker_handle_baud_rate(instance, rx_frame, &is_supported)) break;
+
+        if(is_supported) {
+            instance->state = ExpansionWorkerStateConnected;
+        }
+        success = true;
+    } while(false);
+
+    return success;
+}
+
 static bool expansion_worker_handle_state_connected(
     ExpansionWorker* instance,
     const ExpansionFrame* rx_frame) {
@@ -253,6 +431,8 @@ static bool expansion_worker_handle_state_connected(
                 furi_hal_power_enable_otg();
             } else if(command == ExpansionFrameControlCommandDisableOtg) {
                 furi_hal_power_disable_otg();
+            } else if(command == ExpansionFrameControlCommandStartWindow) {
+                expansion_worker_window_start(instance);
             } else {
                 break;
             }
@@ -262,6 +442,13 @@ static bool expansion_worker_handle_state_connected(
         } else if(rx_frame->header.type == ExpansionFrameTypeHeartbeat) {
             if(!expansion_worker_send_heartbeat(instance)) break;
 
+        } else if(rx_frame->header.type == ExpansionFrameTypeBaudRate && instance->window) {
+            bool is_supported;
+            if(!expansion_worker_handle_baud_rate(instance, rx_frame, &is_supported)) break;
+
+        } else if(rx_frame->header.type == ExpansionFrameTypeWindowAck && instance->window) {
+            expansion_worker_handle_window_ack(instance, rx_frame);
+
         } else {
             break;
         }
@@ -287,6 +474,16 @@ static bool expansion_worker_handle_state_rpc_active(
                 EXPANSION_PROTOCOL_TIMEOUT_MS);
             if(size_consumed != rx_frame->content.data.size) break;
 
+        } else if(rx_frame->header.type == ExpansionFrameTypeWindowData && instance->window) {
+            if(!expansion_worker_handle_window_data(instance, rx_frame)) break;
+
+        } else if(rx_frame->header.type == ExpansionFrameTypeWindowAck && instance->window) {
+            expansion_worker_handle_window_ack(instance, rx_frame);
+
+        } else if(rx_frame->header.type == ExpansionFrameTypeBaudRate && instance->window) {
+            bool is_supported;
+            if(!expansion_worker_handle_baud_rate(instance, rx_frame, &is_supported)) break;
+
         } else if(rx_frame->header.type == ExpansionFrameTypeControl) {
             const uint8_t command = rx_frame->content.control.command;
             if(command == ExpansionFrameControlCommandStopRpc) {
@@ -322,12 +519,62 @@ static const ExpansionWorkerStateHandler expansion_handlers[] = {
     [ExpansionWorkerStateRpcActive] = expansion_worker_handle_state_rpc_active,
 };
 
+// Drop the input until the line goes idle, then report the receiving state
+static bool expansion_worker_window_resync(ExpansionWorker* instance) {
+    const uint32_t start_tick = furi_get_tick();
+
+    while(true) {
+        uint8_t data[16];
+        while(furi_stream_buffer_receive(instance->rx_buf, data, sizeof(data), 0) != 0) {
+        }
+
+        const uint32_t flags = furi_thread_flags_wait(
+            ExpansionWorkerFlagData | ExpansionWorkerFlagStop,
+            FuriFlagWaitAny,
+            furi_ms_to_ticks(EXPANSION_PROTOCOL_WINDOW_RESYNC_MS));
+
+        if(flags == (unsigned)FuriFlagErrorTimeout) {
+            // Next byte starts a new frame
+            break;
+        } else if(flags & FuriFlagError) {
+            instance->exit_reason = ExpansionWorkerExitReasonError;
+            return false;
+        } else if(flags & ExpansionWorkerFlagStop) {
+            instance->exit_reason = ExpansionWorkerExitReasonUser;
+            return false;
+        } else if(
+            furi_get_tick() - start_tick >= furi_ms_to_ticks(EXPANSION_PROTOCOL_TIMEOUT_MS)) {
+            // Line never goes quiet
+            instance->exit_reason = ExpansionWorkerExitReasonError;
+            return false;
+        }
+    }
+
+    return expansion_worker_send_window_ack(instance);
+}
+
 static inline void expansion_worker_state_machine(ExpansionWorker* instance) {
     ExpansionFrame rx_frame;
+    bool is_skipped = false;
 
     while(true) {
-        if(!expansion_worker_receive_frame(instance, &rx_frame)) break;
-        if(!expansion_handlers[instance->state](instance, &rx_frame)) break;
+        const ExpansionProtocolStatus status =
+            expansion_protocol_decode(&rx_frame, expansion_worker_receive_callback, instance);
+
+        if(status == ExpansionProtocolStatusOk) {
+            if(!expansion_handlers[instance->state](instance, &rx_frame)) break;
+            is_skipped = false;
+        } else if(status == ExpansionProtocolStatusErrorCommunication || !instance->window) {
+            break;
+        } else if(status == ExpansionProtocolStatusErrorChecksum && !is_skipped) {
+            // Most likely corrupted data bytes, next frame should start right after this one
+            is_skipped = true;
+        } else {
+            // Windowed transfer recovers from malformed frames, lost ones are sent again
+            FURI_LOG_D(TAG, "Resync");
+            if(!expansion_worker_window_resync(instance)) break;
+            is_skipped = false;
+        }
     }
 }
 
@@ -344,6 +591,7 @@ static int32_t expansion_worker(void* context) {
 
     instance->state = ExpansionWorkerStateHandShake;
     instance->exit_reason = ExpansionWorkerExitReasonUnknown;
+    instance->baud_rate = EXPANSION_PROTOCOL_DEFAULT_BAUD_RATE;
 
     furi_hal_serial_init(instance->serial_handle, EXPANSION_PROTOCOL_DEFAULT_BAUD_RATE);
 
@@ -358,6 +606,8 @@ static int32_t expansion_worker(void* context) {
         expansion_worker_rpc_session_close(instance);
     }
 
+    expansion_worker_window_stop(instance);
+
     FURI_LOG_D(TAG, "Worker stopped");
 
     furi_hal_serial_control_release(instance->serial_handle);
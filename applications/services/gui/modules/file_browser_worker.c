@@ -19,6 +19,10 @@
 #define FILE_NAME_LEN_MAX   256
 #define LONG_LOAD_THRESHOLD 100
 
+#define LISTING_NAMES_SIZE_MIN (1024)
+#define LISTING_NAMES_SIZE_MAX (32 * 1024)
+#define LISTING_ENTRY_FOLDER   (1UL << 31)
+
 typedef enum {
     WorkerEvtStop = (1 << 0),
     WorkerEvtLoad = (1 << 1),
@@ -26,14 +30,30 @@ typedef enum {
     WorkerEvtFolderExit = (1 << 3),
     WorkerEvtFolderRefresh = (1 << 4),
     WorkerEvtConfigChange = (1 << 5),
+    WorkerEvtStorageChange = (1 << 6),
 } WorkerEvtFlags;
 
 #define WORKER_FLAGS_ALL                                                          \
     (WorkerEvtStop | WorkerEvtLoad | WorkerEvtFolderEnter | WorkerEvtFolderExit | \
-     WorkerEvtFolderRefresh | WorkerEvtConfigChange)
+     WorkerEvtFolderRefresh | WorkerEvtConfigChange | WorkerEvtStorageChange)
 
 ARRAY_DEF(IdxLastArray, int32_t)
 ARRAY_DEF(ExtFilterArray, FuriString*, FURI_STRING_OPLIST)
+ARRAY_DEF(ListingEntryArray, uint32_t)
+
+/** Filtered entries of the current folder, collected during the folder scan.
+ * Names are packed into one arena, each entry holds the name offset and the folder bit.
+ * If the arena limit is reached, only the leading part of the folder is cached.
+ */
+typedef struct {
+    FuriString* path;
+    char* names;
+    size_t names_size;
+    size_t names_capacity;
+    ListingEntryArray_t entries;
+    bool valid;
+    bool complete;
+} BrowserListing;
 
 struct BrowserWorker {
     FuriThread* thread;
@@ -48,6 +68,8 @@ struct BrowserWorker {
     bool hide_dot_files;
     IdxLastArray_t idx_last;
     ExtFilterArray_t ext_filter;
+    BrowserListing listing;
+    FuriPubSubSubscription* storage_sub;
 
     void* cb_ctx;
     BrowserWorkerFolderOpenCallback folder_cb;
@@ -56,6 +78,83 @@ struct BrowserWorker {
     BrowserWorkerLongLoadCallback long_load_cb;
 };
 
+static void browser_listing_init(BrowserListing* listing) {
+    listing->path = furi_string_alloc();
+    listing->names = NULL;
+    listing->names_size = 0;
+    listing->names_capacity = 0;
+    ListingEntryArray_init(listing->entries);
+    listing->valid = false;
+    listing->complete = false;
+}
+
+static void browser_listing_clear(BrowserListing* listing) {
+    ListingEntryArray_clear(listing->entries);
+    free(listing->names);
+    furi_string_free(listing->path);
+}
+
+static void browser_listing_reset(BrowserListing* listing, FuriString* path) {
+    furi_string_set(listing->path, path);
+    ListingEntryArray_reset(listing->entries);
+    free(listing->names);
+    listing->names = NULL;
+    listing->names_size = 0;
+    listing->names_capacity = 0;
+    listing->valid = false;
+    listing->complete = true;
+}
+
+static void browser_listing_add(BrowserListing* listing, const char* name, bool is_folder) {
+    if(!listing->complete) {
+        return;
+    }
+
+    size_t name_size = strlen(name) + 1;
+    size_t required = listing->names_size + name_size;
+    if(required > LISTING_NAMES_SIZE_MAX) {
+        // Too many names, rest of the folder is streamed from storage
+        listing->complete = false;
+        return;
+    }
+
+    if(required > listing->names_capacity) {
+        size_t capacity = MAX(listing->names_capacity, (size_t)LISTING_NAMES_SIZE_MIN);
+        while(capacity < required) {
+            capacity *= 2;
+        }
+        capacity = MIN(capacity, (size_t)LISTING_NAMES_SIZE_MAX);
+        listing->names = realloc(listing->names, capacity); //-V701
+        listing->names_capacity = capacity;
+    }
+
+    memcpy(&listing->names[listing->names_size], name, name_size);
+    ListingEntryArray_push_back(
+        listing->entries, listing->names_size | (is_folder ? LISTING_ENTRY_FOLDER : 0));
+    listing->names_size += name_size;
+}
+
+static bool browser_listing_covers(
+    BrowserListing* listing,
+    FuriString* path,
+    uint32_t offset,
+    uint32_t count) {
+    if(!listing->valid || (furi_string_cmp(listing->path, path) != 0)) {
+        return false;
+    }
+    return listing->complete || (offset + count <= ListingEntryArray_size(listing->entries));
+}
+
+static void browser_storage_callback(const void* message, void* context) {
+    const StorageEvent* event = message;
+    BrowserWorker* browser = context;
+
+    if((event->type == StorageEventTypeCardMount) ||
+       (event->type == StorageEventTypeCardUnmount)) {
+        furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtStorageChange);
+    }
+}
+
 static bool browser_path_is_file(FuriString* path) {
     bool state = false;
     FileInfo file_info;
@@ -187,6 +286,8 @@ static bool browser_folder_init(
     *item_cnt = 0;
     *file_idx = -1;
 
+    browser_listing_reset(&browser->listing, path);
+
     if(storage_dir_open(directory, furi_string_get_cstr(path))) {
         state = true;
         while(1) {
@@ -202,6 +303,8 @@ static bool browser_folder_init(
                             *file_idx = *item_cnt;
                         }
                     }
+                    browser_listing_add(
+                        &browser->listing, name_temp, file_info_is_dir(&file_info));
                     (*item_cnt)++;
                 }
                 if(total_files_cnt == LONG_LOAD_THRESHOLD) {
@@ -221,11 +324,51 @@ static bool browser_folder_init(
 
     furi_record_close(RECORD_STORAGE);
 
+    browser->listing.valid = state;
+
     return state;
 }
 
+static bool browser_listing_load(
+    BrowserWorker* browser,
+    FuriString* path,
+    uint32_t offset,
+    uint32_t count) {
+    BrowserListing* listing = &browser->listing;
+    uint32_t entries_cnt = ListingEntryArray_size(listing->entries);
+    uint32_t items_cnt = 0;
+
+    if(offset <= entries_cnt) {
+        if(browser->list_load_cb) {
+            browser->list_load_cb(browser->cb_ctx, offset);
+        }
+
+        FuriString* name_str = furi_string_alloc();
+        for(; (items_cnt < count) && (offset + items_cnt < entries_cnt); items_cnt++) {
+            uint32_t entry = *ListingEntryArray_cget(listing->entries, offset + items_cnt);
+            const char* name = &listing->names[entry & ~LISTING_ENTRY_FOLDER];
+            furi_string_printf(name_str, "%s/%s", furi_string_get_cstr(path), name);
+            if(browser->list_item_cb) {
+                browser->list_item_cb(
+                    browser->cb_ctx, name_str, (entry & LISTING_ENTRY_FOLDER) != 0, false);
+            }
+        }
+        furi_string_free(name_str);
+
+        if(browser->list_item_cb) {
+            browser->list_item_cb(browser->cb_ctx, NULL, false, true);
+        }
+    }
+
+    return items_cnt == count;
+}
+
 static bool
     browser_folder_load(BrowserWorker* browser, FuriString* path, uint32_t offset, uint32_t count) {
+    if(browser_listing_covers(&browser->listing, path, offset, count)) {
+        return browser_listing_load(browser, path, offset, count);
+    }
+
     FileInfo file_info;
 
     Storage* storage = furi_record_open(RECORD_STORAGE);
@@ -324,6 +467,7 @@ static int32_t browser_worker(void* context) {
                 path_extract_filename(browser->path_next, filename, false);
             }
             IdxLastArray_reset(browser->idx_last);
+            browser->listing.valid = false;
 
             furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtFolderEnter);
         }
@@ -389,6 +533,11 @@ static int32_t browser_worker(void* context) {
             }
         }
 
+        if(flags & WorkerEvtStorageChange) {
+            // Card was (un)mounted, cached listing is no longer trustworthy
+            browser->listing.valid = false;
+        }
+
         if(flags & WorkerEvtLoad) {
             FURI_LOG_D(
                 TAG, "Load offset: %lu cnt: %lu", browser->load_offset, browser->load_count);
@@ -417,6 +566,7 @@ BrowserWorker* file_browser_worker_alloc(
 
     IdxLastArray_init(browser->idx_last);
     ExtFilterArray_init(browser->ext_filter);
+    browser_listing_init(&browser->listing);
 
     browser_parse_ext_filter(browser->ext_filter, ext_filter);
     browser->skip_assets = skip_assets;
@@ -433,12 +583,21 @@ BrowserWorker* file_browser_worker_alloc(
     browser->thread = furi_thread_alloc_ex("BrowserWorker", 2048, browser_worker, browser);
     furi_thread_start(browser->thread);
 
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    browser->storage_sub =
+        furi_pubsub_subscribe(storage_get_pubsub(storage), browser_storage_callback, browser);
+    furi_record_close(RECORD_STORAGE);
+
     return browser;
 } //-V773
 
 void file_browser_worker_free(BrowserWorker* browser) {
     furi_check(browser);
 
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    furi_pubsub_unsubscribe(storage_get_pubsub(storage), browser->storage_sub);
+    furi_record_close(RECORD_STORAGE);
+
     furi_thread_flags_set(furi_thread_get_id(browser->thread), WorkerEvtStop);
     furi_thread_join(browser->thread);
     furi_thread_free(browser->thread);
@@ -449,6 +608,7 @@ void file_browser_worker_free(BrowserWorker* browser) {
 
     IdxLastArray_clear(browser->idx_last);
     ExtFilterArray_clear(browser->ext_filter);
+    browser_listing_clear(&browser->listing);
 
     free(browser);
 }
@@ -23,12 +23,21 @@ typedef struct {
     TextBoxFocus focus;
     const char* text;
 
+    // text owned by text_box, filled by text_box_append_text
+    FuriString* text_buffer;
+    size_t text_lines;
+    size_t max_lines;
+
     int32_t scroll_pos;
     int32_t scroll_num;
     int32_t lines_on_screen;
 
-    int32_t line_offset;
-    int32_t text_offset;
+    // start offsets of wrapped lines, the last one is wrapped again when text is appended
+    uint32_t* lines;
+    size_t lines_count;
+    size_t lines_capacity;
+    uint8_t glyph_width[UINT8_MAX + 1];
+
     FuriString* text_on_screen;
     FuriString* text_line;
 
@@ -101,148 +110,124 @@ static bool text_box_view_input_callback(InputEvent* event, void* context) {
     return consumed;
 }
 
-static bool text_box_end_of_text_reached(TextBoxModel* model) {
-    return model->text[model->text_offset] == '\0';
-}
-
-static bool text_box_start_of_text_reached(TextBoxModel* model) {
-    return model->text_offset == 0;
+static size_t text_box_glyph_width(Canvas* canvas, TextBoxModel* model, char symb) {
+    uint8_t* glyph_width = &model->glyph_width[(uint8_t)symb];
+    if(*glyph_width == 0) {
+        *glyph_width = canvas_glyph_width(canvas, symb);
+    }
+    return *glyph_width;
 }
 
-static void text_box_seek_next_line(Canvas* canvas, TextBoxModel* model) {
+static size_t text_box_seek_next_line(Canvas* canvas, TextBoxModel* model, size_t text_offset) {
     size_t line_width = 0;
 
-    while(!text_box_end_of_text_reached(model)) {
-        char symb = model->text[model->text_offset];
+    while(model->text[text_offset] != '\0') {
+        char symb = model->text[text_offset];
         if(symb == '\n') {
-            model->text_offset++;
+            text_offset++;
             break;
         } else {
-            size_t glyph_width = canvas_glyph_width(canvas, symb);
+            size_t glyph_width = text_box_glyph_width(canvas, model, symb);
             if(line_width + glyph_width > TEXT_BOX_TEXT_WIDTH) {
                 break;
             }
             line_width += glyph_width;
-            model->text_offset++;
+            text_offset++;
         }
     }
-}
 
-static void text_box_seek_end_of_prev_line(TextBoxModel* model) {
-    do {
-        if(text_box_start_of_text_reached(model)) break;
-        model->text_offset--;
-        if(text_box_start_of_text_reached(model)) break;
-        if(model->text[model->text_offset] == '\n') {
-            model->text_offset--;
-        }
-    } while(false);
+    return text_offset;
 }
 
-static void text_box_seek_prev_paragraph(TextBoxModel* model) {
-    while(!text_box_start_of_text_reached(model)) {
-        if(model->text[model->text_offset] == '\n') {
-            model->text_offset++;
-            break;
-        }
-        model->text_offset--;
+static void text_box_push_line(TextBoxModel* model, size_t text_offset) {
+    if(model->lines_count == model->lines_capacity) {
+        model->lines_capacity = MAX(model->lines_capacity * 2, TEXT_BOX_MAX_LINES_PER_SCREEN);
+        model->lines = realloc(model->lines, model->lines_capacity * sizeof(uint32_t)); //-V701
     }
+    model->lines[model->lines_count++] = text_offset;
 }
 
-static void text_box_seek_prev_line(Canvas* canvas, TextBoxModel* model) {
-    int32_t start_text_offset = model->text_offset;
+static void text_box_clear_lines(TextBoxModel* model) {
+    model->lines_count = 0;
+    model->scroll_num = 0;
+    model->scroll_pos = 0;
+}
 
-    text_box_seek_end_of_prev_line(model);
-    text_box_seek_prev_paragraph(model);
+static void text_box_update_lines(Canvas* canvas, TextBoxModel* model) {
+    model->lines_on_screen = TEXT_BOX_TEXT_HEIGHT / canvas_current_font_height(canvas);
+    const bool reset = (model->lines_count == 0);
+    const bool at_end = (model->scroll_pos >= model->scroll_num - 1);
 
-    int32_t current_text_offset = model->text_offset;
-    while(true) {
-        text_box_seek_next_line(canvas, model);
-        if(model->text_offset == start_text_offset) {
-            break;
-        }
-        current_text_offset = model->text_offset;
+    // Only the last line can change, wrapping continues from its start
+    size_t text_offset = 0;
+    if(model->lines_count > 0) {
+        text_offset = model->lines[--model->lines_count];
     }
-    model->text_offset = current_text_offset;
-}
+    do {
+        text_box_push_line(model, text_offset);
+        text_offset = text_box_seek_next_line(canvas, model, text_offset);
+    } while(model->text[text_offset] != '\0');
 
-static void text_box_move_line_offset(Canvas* canvas, TextBoxModel* model, int32_t line_offset) {
-    if(line_offset >= 0) {
-        for(int32_t i = 0; i < line_offset; i++) {
-            text_box_seek_next_line(canvas, model);
+    int32_t lines_num = model->lines_count + 1;
+    if(lines_num > model->lines_on_screen) {
+        model->scroll_num = lines_num - model->lines_on_screen;
+        if(model->focus == TextBoxFocusEnd && (reset || at_end)) {
+            model->scroll_pos = model->scroll_num - 1;
         }
     } else {
-        for(int32_t i = 0; i < (-line_offset); i++) {
-            text_box_seek_prev_line(canvas, model);
-        }
+        model->scroll_num = 0;
+        model->scroll_pos = 0;
     }
 }
 
-static void text_box_update_screen_text(Canvas* canvas, TextBoxModel* model) {
+static void text_box_update_screen_text(TextBoxModel* model) {
     furi_string_reset(model->text_on_screen);
-    furi_string_reset(model->text_line);
-
-    int32_t start_text_offset = model->text_offset;
-
-    for(int32_t i = 0; i < model->lines_on_screen; i++) {
-        int32_t current_line_text_offset = model->text_offset;
-        text_box_seek_next_line(canvas, model);
-        int32_t next_line_text_offset = model->text_offset;
-        furi_string_set_strn(
-            model->text_line,
-            &model->text[current_line_text_offset],
-            next_line_text_offset - current_line_text_offset);
+
+    size_t line_start = model->scroll_pos;
+    size_t line_end = MIN(line_start + model->lines_on_screen, model->lines_count);
+    for(size_t i = line_start; i < line_end; i++) {
+        const char* line = &model->text[model->lines[i]];
+        size_t line_size = (i + 1 < model->lines_count) ? model->lines[i + 1] - model->lines[i] :
+                                                           strlen(line);
+        furi_string_set_strn(model->text_line, line, line_size);
         size_t str_len = furi_string_size(model->text_line);
-        if(furi_string_get_char(model->text_line, str_len - 1) != '\n') {
+        if(str_len == 0 || furi_string_get_char(model->text_line, str_len - 1) != '\n') {
             furi_string_push_back(model->text_line, '\n');
         }
         furi_string_cat(model->text_on_screen, model->text_line);
-
-        if(text_box_end_of_text_reached(model)) break;
-        current_line_text_offset = next_line_text_offset;
     }
-
-    model->text_offset = start_text_offset;
 }
 
-static void text_box_update_text_on_screen(Canvas* canvas, TextBoxModel* model) {
-    int32_t line_offset = model->scroll_pos - model->line_offset;
-    text_box_move_line_offset(canvas, model, line_offset);
-    text_box_update_screen_text(canvas, model);
-    model->line_offset = model->scroll_pos;
-}
-
-static void text_box_prepare_model(Canvas* canvas, TextBoxModel* model) {
-    int32_t lines_num = 0;
-    model->text_offset = 0;
-    model->scroll_num = 0;
-    model->scroll_pos = 0;
-    model->line_offset = 0;
-    model->lines_on_screen = TEXT_BOX_TEXT_HEIGHT / canvas_current_font_height(canvas);
-
-    // Cache text offset to quick final text offset update if TextBoxFocusEnd is set
-    int32_t window_offset[TEXT_BOX_MAX_LINES_PER_SCREEN] = {};
-    do {
-        window_offset[lines_num % model->lines_on_screen] = model->text_offset;
-        text_box_seek_next_line(canvas, model);
-        lines_num++;
-    } while(!text_box_end_of_text_reached(model));
-    model->text_offset = 0;
-    lines_num++;
-
-    if(model->focus == TextBoxFocusEnd) {
-        if(lines_num > model->lines_on_screen) {
-            model->text_offset = window_offset[(lines_num - 1) % model->lines_on_screen];
-        }
+// Drop oldest text lines in batches, so the buffer is not moved on every append
+static void text_box_trim_text(TextBoxModel* model) {
+    if(model->max_lines == 0 || model->text_lines <= model->max_lines + model->max_lines / 4) {
+        return;
     }
 
-    if(lines_num > model->lines_on_screen) {
-        model->scroll_num = lines_num - model->lines_on_screen;
-        model->scroll_pos = (model->focus == TextBoxFocusEnd) ? model->scroll_num - 1 : 0;
+    const char* text = furi_string_get_cstr(model->text_buffer);
+    size_t drop_lines = model->text_lines - model->max_lines;
+    size_t drop_size = 0;
+    for(size_t i = 0; i < drop_lines; i++) {
+        drop_size = strchr(&text[drop_size], '\n') - text + 1;
+    }
+    furi_string_right(model->text_buffer, drop_size);
+    model->text = furi_string_get_cstr(model->text_buffer);
+    model->text_lines -= drop_lines;
+
+    // Lines are dropped whole, so the remaining wrapped lines only move
+    size_t drop_count = 0;
+    while(drop_count < model->lines_count && model->lines[drop_count] < drop_size) {
+        drop_count++;
+    }
+    model->lines_count -= drop_count;
+    for(size_t i = 0; i < model->lines_count; i++) {
+        model->lines[i] = model->lines[i + drop_count] - drop_size;
+    }
+    model->scroll_num = MAX(model->scroll_num - (int32_t)drop_count, 0);
+    model->scroll_pos = MAX(model->scroll_pos - (int32_t)drop_count, 0);
+    if(model->lines_count == 0) {
+        text_box_clear_lines(model);
     }
-
-    text_box_update_screen_text(canvas, model);
-    model->line_offset = model->scroll_pos;
 }
 
 static void text_box_view_draw_callback(Canvas* canvas, void* _model) {
@@ -260,16 +245,14 @@ static void text_box_view_draw_callback(Canvas* canvas, void* _model) {
     }
 
     if(!model->formatted) {
-        text_box_prepare_model(canvas, model);
+        text_box_update_lines(canvas, model);
         model->formatted = true;
     }
 
     elements_slightly_rounded_frame(canvas, 0, 0, 124, 64);
     elements_scrollbar(canvas, model->scroll_pos, model->scroll_num);
 
-    if(model->line_offset != model->scroll_pos) {
-        text_box_update_text_on_screen(canvas, model);
-    }
+    text_box_update_screen_text(model);
     elements_multiline_text(canvas, 3, 11, furi_string_get_cstr(model->text_on_screen));
 }
 
@@ -286,6 +269,13 @@ TextBox* text_box_alloc(void) {
         TextBoxModel * model,
         {
             model->text = NULL;
+            model->text_buffer = furi_string_alloc();
+            model->text_lines = 0;
+            model->max_lines = 0;
+            model->lines = NULL;
+            model->lines_capacity = 0;
+            text_box_clear_lines(model);
+            memset(model->glyph_width, 0, sizeof(model->glyph_width));
             model->text_on_screen = furi_string_alloc();
             model->text_line = furi_string_alloc();
             model->formatted = false;
@@ -303,6 +293,8 @@ void text_box_free(TextBox* text_box) {
         text_box->view,
         TextBoxModel * model,
         {
+            furi_string_free(model->text_buffer);
+            free(model->lines);
             furi_string_free(model->text_on_screen);
             furi_string_free(model->text_line);
         },
@@ -326,13 +318,14 @@ void text_box_reset(TextBox* text_box) {
             model->text = NULL;
             model->font = TextBoxFontText;
             model->focus = TextBoxFocusStart;
+            furi_string_reset(model->text_buffer);
+            model->text_lines = 0;
+            model->max_lines = 0;
             furi_string_reset(model->text_line);
             furi_string_reset(model->text_on_screen);
-            model->line_offset = 0;
-            model->text_offset = 0;
             model->lines_on_screen = 0;
-            model->scroll_num = 0;
-            model->scroll_pos = 0;
+            text_box_clear_lines(model);
+            memset(model->glyph_width, 0, sizeof(model->glyph_width));
             model->formatted = false;
         },
         true);
@@ -347,19 +340,77 @@ void text_box_set_text(TextBox* text_box, const char* text) {
         TextBoxModel * model,
         {
             model->text = text;
+            furi_string_reset(model->text_buffer);
+            model->text_lines = 0;
+            text_box_clear_lines(model);
+            model->formatted = false;
+        },
+        true);
+}
+
+void text_box_append_text(TextBox* text_box, const char* text) {
+    furi_check(text_box);
+    furi_check(text);
+
+    with_view_model(
+        text_box->view,
+        TextBoxModel * model,
+        {
+            if(model->text != furi_string_get_cstr(model->text_buffer)) {
+                // Take over text set by text_box_set_text, already wrapped lines stay valid
+                furi_string_set(model->text_buffer, model->text ? model->text : "");
+                model->text_lines = 0;
+                for(const char* c = model->text ? model->text : ""; *c; c++) {
+                    if(*c == '\n') model->text_lines++;
+                }
+            }
+
+            furi_string_cat(model->text_buffer, text);
+            for(const char* c = text; *c; c++) {
+                if(*c == '\n') model->text_lines++;
+            }
+            model->text = furi_string_get_cstr(model->text_buffer);
+
+            text_box_trim_text(model);
             model->formatted = false;
         },
         true);
 }
 
+void text_box_set_max_lines(TextBox* text_box, size_t max_lines) {
+    furi_check(text_box);
+
+    with_view_model(
+        text_box->view, TextBoxModel * model, { model->max_lines = max_lines; }, false);
+}
+
 void text_box_set_font(TextBox* text_box, TextBoxFont font) {
     furi_check(text_box);
 
-    with_view_model(text_box->view, TextBoxModel * model, { model->font = font; }, true);
+    with_view_model(
+        text_box->view,
+        TextBoxModel * model,
+        {
+            if(model->font != font) {
+                model->font = font;
+                memset(model->glyph_width, 0, sizeof(model->glyph_width));
+                text_box_clear_lines(model);
+                model->formatted = false;
+            }
+        },
+        true);
 }
 
 void text_box_set_focus(TextBox* text_box, TextBoxFocus focus) {
     furi_check(text_box);
 
-    with_view_model(text_box->view, TextBoxModel * model, { model->focus = focus; }, true);
+    with_view_model(
+        text_box->view,
+        TextBoxModel * model,
+        {
+            model->focus = focus;
+            text_box_clear_lines(model);
+            model->formatted = false;
+        },
+        true);
 }
@@ -57,6 +57,26 @@ void text_box_reset(TextBox* text_box);
  */
 void text_box_set_text(TextBox* text_box, const char* text);
 
+/** Append text to text_box
+ *
+ * Text is copied into a buffer owned by text_box, only the appended part is
+ * wrapped again on the next redraw. Text previously set with text_box_set_text
+ * is copied into the buffer on the first append.
+ *
+ * @param      text_box  TextBox instance
+ * @param      text      text to append
+ */
+void text_box_append_text(TextBox* text_box, const char* text);
+
+/** Limit lines kept by text_box_append_text
+ *
+ * Oldest lines are dropped once the limit is exceeded, 0 means no limit.
+ *
+ * @param      text_box   TextBox instance
+ * @param      max_lines  maximum number of text lines
+ */
+void text_box_set_max_lines(TextBox* text_box, size_t max_lines);
+
 /** Set TextBox font
  *
  * @param      text_box  TextBox instance
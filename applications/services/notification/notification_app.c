@@ -188,26 +188,73 @@ static void notification_display_timer(void* ctx) {
     notification_message(app, &sequence_display_backlight_off);
 }
 
-// message processing
-static void notification_process_notification_message(
-    NotificationApp* app,
-    NotificationAppMessage* message) {
-    uint32_t notification_message_index = 0;
-    bool force_volume = false;
-    bool force_vibro = false;
-    const NotificationMessage* notification_message;
-    notification_message = (*message->sequence)[notification_message_index];
+// sequence players
+static uint8_t notification_message_channels(const NotificationMessage* notification_message) {
+    switch(notification_message->type) {
+    case NotificationMessageTypeLedRed:
+    case NotificationMessageTypeLedGreen:
+    case NotificationMessageTypeLedBlue:
+    case NotificationMessageTypeLedBlinkStart:
+    case NotificationMessageTypeLedBlinkStop:
+    case NotificationMessageTypeLedBlinkColor:
+    case NotificationMessageTypeLedBrightnessSettingApply:
+        return NotificationChannelLed;
+    case NotificationMessageTypeVibro:
+        return NotificationChannelVibro;
+    case NotificationMessageTypeSoundOn:
+    case NotificationMessageTypeSoundOff:
+        return NotificationChannelSound;
+    default:
+        // display backlight is a plain state change, any sequence may touch it
+        return 0;
+    }
+}
+
+static void notification_player_scan(
+    const NotificationSequence* sequence,
+    uint8_t* channels,
+    NotificationPriority* priority) {
+    *channels = 0;
+    for(uint32_t i = 0; (*sequence)[i] != NULL; i++) {
+        *channels |= notification_message_channels((*sequence)[i]);
+    }
+
+    if(*channels & NotificationChannelSound) {
+        *priority = NotificationPrioritySound;
+    } else if(*channels & NotificationChannelVibro) {
+        *priority = NotificationPriorityVibro;
+    } else {
+        *priority = NotificationPriorityLow;
+    }
+}
 
-    bool led_active = false;
-    uint8_t led_values[NOTIFICATION_LED_COUNT] = {0x00, 0x00, 0x00};
-    bool reset_notifications = true;
-    float speaker_volume_setting = app->settings.speaker_volume;
-    bool vibro_setting = app->settings.vibro_on;
-    float display_brightness_setting = app->settings.display_brightness;
+static bool notification_player_is_due(NotificationPlayer* player, uint32_t now) {
+    return (int32_t)(now - player->deadline) >= 0;
+}
 
-    uint8_t reset_mask = 0;
+static void notification_message_complete(NotificationAppMessage* message) {
+    if(message->back_event != NULL) {
+        furi_event_flag_set(message->back_event, NOTIFICATION_EVENT_COMPLETE);
+    }
+}
+
+static void notification_player_finish(NotificationApp* app, NotificationPlayer* player) {
+    if(player->reset_notifications) {
+        notification_reset_notification_layer(
+            app, player->reset_mask, player->display_brightness_setting);
+    }
+
+    player->state = NotificationPlayerStateIdle;
+    notification_message_complete(&player->message);
+}
+
+// runs the sequence until the next delay or to the end
+static void notification_player_run(NotificationApp* app, NotificationPlayer* player) {
+    const NotificationMessage* notification_message;
+
+    while((notification_message = (*player->message.sequence)[player->index]) != NULL) {
+        player->index++;
 
-    while(notification_message != NULL) {
         switch(notification_message->type) {
         case NotificationMessageTypeLedDisplayBacklight:
             // if on - switch on and start timer
@@ -216,10 +263,10 @@ static void notification_process_notification_message(
             if(notification_message->data.led.value > 0x00) {
                 notification_apply_notification_led_layer(
                     &app->display,
-                    notification_message->data.led.value * display_brightness_setting);
-                reset_mask |= reset_display_mask;
+                    notification_message->data.led.value * player->display_brightness_setting);
+                player->reset_mask |= reset_display_mask;
             } else {
-                reset_mask &= ~reset_display_mask;
+                player->reset_mask &= ~reset_display_mask;
                 notification_reset_notification_led_layer(&app->display);
                 if(furi_timer_is_running(app->display_timer)) {
                     furi_timer_stop(app->display_timer);
@@ -232,7 +279,7 @@ static void notification_process_notification_message(
             if(app->display_led_lock == 1) {
                 notification_apply_internal_led_layer(
                     &app->display,
-                    notification_message->data.led.value * display_brightness_setting);
+                    notification_message->data.led.value * player->display_brightness_setting);
             }
             break;
         case NotificationMessageTypeLedDisplayBacklightEnforceAuto:
@@ -241,7 +288,7 @@ static void notification_process_notification_message(
                 if(app->display_led_lock == 0) {
                     notification_apply_internal_led_layer(
                         &app->display,
-                        notification_message->data.led.value * display_brightness_setting);
+                        notification_message->data.led.value * player->display_brightness_setting);
                 }
             } else {
                 FURI_LOG_E(TAG, "Incorrect BacklightEnforce use");
@@ -249,138 +296,335 @@ static void notification_process_notification_message(
             break;
         case NotificationMessageTypeLedRed:
             // store and send on delay or after seq
-            led_active = true;
-            led_values[0] = notification_message->data.led.value;
-            app->led[0].value_last[LayerNotification] = led_values[0];
-            reset_mask |= reset_red_mask;
+            player->led_active = true;
+            player->led_values[0] = notification_message->data.led.value;
+            app->led[0].value_last[LayerNotification] = player->led_values[0];
+            player->reset_mask |= reset_red_mask;
             break;
         case NotificationMessageTypeLedGreen:
             // store and send on delay or after seq
-            led_active = true;
-            led_values[1] = notification_message->data.led.value;
-            app->led[1].value_last[LayerNotification] = led_values[1];
-            reset_mask |= reset_green_mask;
+            player->led_active = true;
+            player->led_values[1] = notification_message->data.led.value;
+            app->led[1].value_last[LayerNotification] = player->led_values[1];
+            player->reset_mask |= reset_green_mask;
             break;
         case NotificationMessageTypeLedBlue:
             // store and send on delay or after seq
-            led_active = true;
-            led_values[2] = notification_message->data.led.value;
-            app->led[2].value_last[LayerNotification] = led_values[2];
-            reset_mask |= reset_blue_mask;
+            player->led_active = true;
+            player->led_values[2] = notification_message->data.led.value;
+            app->led[2].value_last[LayerNotification] = player->led_values[2];
+            player->reset_mask |= reset_blue_mask;
             break;
         case NotificationMessageTypeLedBlinkStart:
             // store and send on delay or after seq
-            led_active = true;
+            player->led_active = true;
             furi_hal_light_blink_start(
                 notification_message->data.led_blink.color,
                 app->settings.led_brightness * 255,
                 notification_message->data.led_blink.on_time,
                 notification_message->data.led_blink.period);
-            reset_mask |= reset_blink_mask;
-            reset_mask |= reset_red_mask;
-            reset_mask |= reset_green_mask;
-            reset_mask |= reset_blue_mask;
+            player->reset_mask |= reset_blink_mask;
+            player->reset_mask |= reset_red_mask;
+            player->reset_mask |= reset_green_mask;
+            player->reset_mask |= reset_blue_mask;
             break;
         case NotificationMessageTypeLedBlinkColor:
-            led_active = true;
+            player->led_active = true;
             furi_hal_light_blink_set_color(notification_message->data.led_blink.color);
             break;
         case NotificationMessageTypeLedBlinkStop:
             furi_hal_light_blink_stop();
-            reset_mask &= ~reset_blink_mask;
-            reset_mask |= reset_red_mask;
-            reset_mask |= reset_green_mask;
-            reset_mask |= reset_blue_mask;
+            player->reset_mask &= ~reset_blink_mask;
+            player->reset_mask |= reset_red_mask;
+            player->reset_mask |= reset_green_mask;
+            player->reset_mask |= reset_blue_mask;
             break;
         case NotificationMessageTypeVibro:
             if(notification_message->data.vibro.on) {
-                if(vibro_setting) notification_vibro_on(force_vibro);
+                if(player->vibro_setting) notification_vibro_on(player->force_vibro);
             } else {
                 notification_vibro_off();
             }
-            reset_mask |= reset_vibro_mask;
+            player->reset_mask |= reset_vibro_mask;
             break;
         case NotificationMessageTypeSoundOn:
             notification_sound_on(
                 notification_message->data.sound.frequency,
-                notification_message->data.sound.volume * speaker_volume_setting,
-                force_volume);
-            reset_mask |= reset_sound_mask;
+                notification_message->data.sound.volume * player->speaker_volume_setting,
+                player->force_volume);
+            player->reset_mask |= reset_sound_mask;
             break;
         case NotificationMessageTypeSoundOff:
             notification_sound_off();
-            reset_mask |= reset_sound_mask;
+            player->reset_mask |= reset_sound_mask;
             break;
         case NotificationMessageTypeDelay:
-            if(led_active) {
+            // deadlines are accumulated, so late wakeups do not stretch the sequence
+            if(player->led_active) {
+                player->led_active = false;
+                player->reset_mask |= reset_red_mask;
+                player->reset_mask |= reset_green_mask;
+                player->reset_mask |= reset_blue_mask;
+
                 if(notification_is_any_led_layer_internal_and_not_empty(app)) {
                     notification_apply_notification_leds(app, led_off_values);
-                    furi_delay_ms(minimal_delay);
+                    player->delay = furi_ms_to_ticks(notification_message->data.delay.length);
+                    player->deadline += furi_ms_to_ticks(minimal_delay);
+                    player->state = NotificationPlayerStateLedOff;
+                    return;
                 }
 
-                led_active = false;
-
-                notification_apply_notification_leds(app, led_values);
-                reset_mask |= reset_red_mask;
-                reset_mask |= reset_green_mask;
-                reset_mask |= reset_blue_mask;
+                notification_apply_notification_leds(app, player->led_values);
             }
 
-            furi_delay_ms(notification_message->data.delay.length);
-            break;
+            player->deadline += furi_ms_to_ticks(notification_message->data.delay.length);
+            player->state = NotificationPlayerStateRun;
+            return;
         case NotificationMessageTypeDoNotReset:
-            reset_notifications = false;
+            player->reset_notifications = false;
             break;
         case NotificationMessageTypeForceSpeakerVolumeSetting:
-            speaker_volume_setting = notification_message->data.forced_settings.speaker_volume;
-            force_volume = true;
+            player->speaker_volume_setting =
+                notification_message->data.forced_settings.speaker_volume;
+            player->force_volume = true;
             break;
         case NotificationMessageTypeForceVibroSetting:
-            vibro_setting = notification_message->data.forced_settings.vibro;
-            force_vibro = true;
+            player->vibro_setting = notification_message->data.forced_settings.vibro;
+            player->force_vibro = true;
             break;
         case NotificationMessageTypeForceDisplayBrightnessSetting:
-            display_brightness_setting =
+            player->display_brightness_setting =
                 notification_message->data.forced_settings.display_brightness;
             break;
         case NotificationMessageTypeLedBrightnessSettingApply:
-            led_active = true;
+            player->led_active = true;
             for(uint8_t i = 0; i < NOTIFICATION_LED_COUNT; i++) {
-                led_values[i] = app->led[i].value_last[LayerNotification];
+                player->led_values[i] = app->led[i].value_last[LayerNotification];
             }
-            reset_mask |= reset_red_mask;
-            reset_mask |= reset_green_mask;
-            reset_mask |= reset_blue_mask;
+            player->reset_mask |= reset_red_mask;
+            player->reset_mask |= reset_green_mask;
+            player->reset_mask |= reset_blue_mask;
             break;
         case NotificationMessageTypeLcdContrastUpdate:
             notification_apply_lcd_contrast(app);
             break;
         }
-        notification_message_index++;
-        notification_message = (*message->sequence)[notification_message_index];
-    };
+    }
 
     // send and do minimal delay
-    if(led_active) {
+    if(player->led_active) {
+        player->led_active = false;
         bool need_minimal_delay = false;
         if(notification_is_any_led_layer_internal_and_not_empty(app)) {
             need_minimal_delay = true;
         }
 
-        notification_apply_notification_leds(app, led_values);
-        reset_mask |= reset_red_mask;
-        reset_mask |= reset_green_mask;
-        reset_mask |= reset_blue_mask;
+        notification_apply_notification_leds(app, player->led_values);
+        player->reset_mask |= reset_red_mask;
+        player->reset_mask |= reset_green_mask;
+        player->reset_mask |= reset_blue_mask;
 
-        if((need_minimal_delay) && (reset_notifications)) {
+        if((need_minimal_delay) && (player->reset_notifications)) {
             notification_apply_notification_leds(app, led_off_values);
-            furi_delay_ms(minimal_delay);
+            player->deadline += furi_ms_to_ticks(minimal_delay);
+            player->state = NotificationPlayerStateFinish;
+            return;
         }
     }
 
-    if(reset_notifications) {
-        notification_reset_notification_layer(app, reset_mask, display_brightness_setting);
+    notification_player_finish(app, player);
+}
+
+static void notification_player_step(NotificationApp* app, NotificationPlayer* player) {
+    switch(player->state) {
+    case NotificationPlayerStateLedOff:
+        notification_apply_notification_leds(app, player->led_values);
+        player->deadline += player->delay;
+        player->state = NotificationPlayerStateRun;
+        break;
+    case NotificationPlayerStateRun:
+        notification_player_run(app, player);
+        break;
+    case NotificationPlayerStateFinish:
+        notification_player_finish(app, player);
+        break;
+    case NotificationPlayerStateIdle:
+        break;
+    }
+}
+
+static bool notification_player_can_start(
+    NotificationApp* app,
+    uint8_t channels,
+    NotificationPriority priority) {
+    // channels of a higher priority sequence are not taken over, the request has to wait
+    for(size_t i = 0; i < NOTIFICATION_PLAYER_COUNT; i++) {
+        NotificationPlayer* player = &app->player[i];
+        if(player->state != NotificationPlayerStateIdle && (player->channels & channels) &&
+           player->priority > priority) {
+            return false;
+        }
     }
+
+    return true;
+}
+
+static bool notification_player_start(
+    NotificationApp* app,
+    NotificationAppMessage* message,
+    uint8_t channels,
+    NotificationPriority priority) {
+    if(!notification_player_can_start(app, channels, priority)) {
+        return false;
+    }
+
+    // otherwise the newest request wins, sequences on other channels keep playing
+    NotificationPlayer* player = NULL;
+    for(size_t i = 0; i < NOTIFICATION_PLAYER_COUNT; i++) {
+        NotificationPlayer* other = &app->player[i];
+        if(other->state != NotificationPlayerStateIdle && (other->channels & channels)) {
+            notification_player_finish(app, other);
+        }
+        if(other->state == NotificationPlayerStateIdle) {
+            player = other;
+        } else if(!player || (player->state != NotificationPlayerStateIdle &&
+                              (int32_t)(other->order - player->order) < 0)) {
+            player = other;
+        }
+    }
+
+    // all slots are taken by sequences without channels, drop the oldest
+    if(player->state != NotificationPlayerStateIdle) {
+        notification_player_finish(app, player);
+    }
+
+    player->message = *message;
+    player->index = 0;
+    player->deadline = furi_get_tick();
+    player->order = app->player_order++;
+    player->channels = channels;
+    player->priority = priority;
+
+    player->force_volume = false;
+    player->force_vibro = false;
+    player->led_active = false;
+    memset(player->led_values, 0x00, sizeof(player->led_values));
+    player->reset_notifications = true;
+    player->speaker_volume_setting = app->settings.speaker_volume;
+    player->vibro_setting = app->settings.vibro_on;
+    player->display_brightness_setting = app->settings.display_brightness;
+    player->reset_mask = 0;
+
+    player->state = NotificationPlayerStateRun;
+    notification_player_run(app, player);
+
+    return true;
+}
+
+static bool notification_is_sequence_queued(
+    NotificationApp* app,
+    const NotificationSequence* sequence) {
+    for(size_t i = 0; i < NOTIFICATION_PLAYER_COUNT; i++) {
+        if(app->player[i].state != NotificationPlayerStateIdle &&
+           app->player[i].message.sequence == sequence) {
+            return true;
+        }
+    }
+
+    for(size_t i = 0; i < app->pending_count; i++) {
+        if(app->pending[i].sequence == sequence) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void notification_process_notification_message(
+    NotificationApp* app,
+    NotificationAppMessage* message) {
+    // repeated requests for a sequence that is still playing are merged into it
+    if(message->back_event == NULL && notification_is_sequence_queued(app, message->sequence)) {
+        return;
+    }
+
+    uint8_t channels;
+    NotificationPriority priority;
+    notification_player_scan(message->sequence, &channels, &priority);
+
+    if(notification_player_start(app, message, channels, priority)) {
+        return;
+    }
+
+    if(app->pending_count == NOTIFICATION_PENDING_COUNT) {
+        FURI_LOG_W(TAG, "Pending sequence dropped");
+        notification_message_complete(&app->pending[0]);
+        app->pending_count--;
+        memmove(&app->pending[0], &app->pending[1], sizeof(app->pending[0]) * app->pending_count);
+    }
+
+    app->pending[app->pending_count++] = *message;
+}
+
+static void notification_process_pending(NotificationApp* app) {
+    uint8_t channels[NOTIFICATION_PENDING_COUNT];
+    NotificationPriority priority[NOTIFICATION_PENDING_COUNT];
+    bool can_start[NOTIFICATION_PENDING_COUNT];
+    bool superseded[NOTIFICATION_PENDING_COUNT];
+
+    // a request that a newer one would preempt right away is not played at all,
+    // otherwise each of them would flash its first step
+    for(size_t i = app->pending_count; i-- > 0;) {
+        notification_player_scan(app->pending[i].sequence, &channels[i], &priority[i]);
+        can_start[i] = notification_player_can_start(app, channels[i], priority[i]);
+        superseded[i] = false;
+        for(size_t j = i + 1; can_start[i] && j < app->pending_count; j++) {
+            if(can_start[j] && !superseded[j] && (channels[j] & channels[i]) &&
+               priority[j] >= priority[i]) {
+                superseded[i] = true;
+                break;
+            }
+        }
+    }
+
+    size_t count = 0;
+    for(size_t i = 0; i < app->pending_count; i++) {
+        NotificationAppMessage message = app->pending[i];
+        if(superseded[i]) {
+            notification_message_complete(&message);
+        } else if(
+            !can_start[i] ||
+            !notification_player_start(app, &message, channels[i], priority[i])) {
+            app->pending[count++] = message;
+        }
+    }
+    app->pending_count = count;
+}
+
+static void notification_process_players(NotificationApp* app) {
+    uint32_t now = furi_get_tick();
+    for(size_t i = 0; i < NOTIFICATION_PLAYER_COUNT; i++) {
+        NotificationPlayer* player = &app->player[i];
+        while(player->state != NotificationPlayerStateIdle &&
+              notification_player_is_due(player, now)) {
+            notification_player_step(app, player);
+        }
+    }
+}
+
+static uint32_t notification_players_get_timeout(NotificationApp* app) {
+    uint32_t timeout = FuriWaitForever;
+    uint32_t now = furi_get_tick();
+    for(size_t i = 0; i < NOTIFICATION_PLAYER_COUNT; i++) {
+        NotificationPlayer* player = &app->player[i];
+        if(player->state == NotificationPlayerStateIdle) continue;
+
+        uint32_t player_timeout =
+            notification_player_is_due(player, now) ? 0 : player->deadline - now;
+        timeout = MIN(timeout, player_timeout);
+    }
+
+    return timeout;
 }
 
 static void
@@ -517,6 +761,12 @@ static NotificationApp* notification_app_alloc(void) {
     app->queue = furi_message_queue_alloc(8, sizeof(NotificationAppMessage));
     app->display_timer = furi_timer_alloc(notification_display_timer, FuriTimerTypeOnce, app);
 
+    for(size_t i = 0; i < NOTIFICATION_PLAYER_COUNT; i++) {
+        app->player[i].state = NotificationPlayerStateIdle;
+    }
+    app->player_order = 0;
+    app->pending_count = 0;
+
     app->settings.speaker_volume = 1.0f;
     app->settings.display_brightness = 1.0f;
     app->settings.led_brightness = 1.0f;
@@ -605,11 +855,19 @@ int32_t notification_srv(void* p) {
 
     NotificationAppMessage message;
     while(1) {
-        furi_check(furi_message_queue_get(app->queue, &message, FuriWaitForever) == FuriStatusOk);
+        // sequences are advanced between messages, so requests are never stuck behind a delay
+        if(furi_message_queue_get(app->queue, &message, notification_players_get_timeout(app)) !=
+           FuriStatusOk) {
+            notification_process_players(app);
+            notification_process_pending(app);
+            continue;
+        }
 
         switch(message.type) {
         case NotificationLayerMessage:
+            // completion is reported when the sequence is over
             notification_process_notification_message(app, &message);
+            message.back_event = NULL;
             break;
         case InternalLayerMessage:
             notification_process_internal_message(app, &message);
@@ -622,9 +880,10 @@ int32_t notification_srv(void* p) {
             break;
         }
 
-        if(message.back_event != NULL) {
-            furi_event_flag_set(message.back_event, NOTIFICATION_EVENT_COMPLETE);
-        }
+        notification_message_complete(&message);
+
+        notification_process_players(app);
+        notification_process_pending(app);
     }
 
     return 0;
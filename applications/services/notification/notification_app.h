@@ -46,6 +46,51 @@ typedef struct {
     bool vibro_on;
 } NotificationSettings;
 
+#define NOTIFICATION_PLAYER_COUNT  4
+#define NOTIFICATION_PENDING_COUNT 4
+
+typedef enum {
+    NotificationChannelLed = (1 << 0),
+    NotificationChannelVibro = (1 << 1),
+    NotificationChannelSound = (1 << 2),
+} NotificationChannel;
+
+/** Sequence priority, derived from the most intrusive channel it uses */
+typedef enum {
+    NotificationPriorityLow, /**< led and display only */
+    NotificationPriorityVibro, /**< uses vibro */
+    NotificationPrioritySound, /**< uses speaker */
+} NotificationPriority;
+
+typedef enum {
+    NotificationPlayerStateIdle,
+    NotificationPlayerStateRun, /**< waiting for the delay before the next message */
+    NotificationPlayerStateLedOff, /**< leds are off for minimal delay, then the delay follows */
+    NotificationPlayerStateFinish, /**< leds are off for minimal delay, then the layer is reset */
+} NotificationPlayerState;
+
+/** Notification layer sequence in progress */
+typedef struct {
+    NotificationPlayerState state;
+    NotificationAppMessage message;
+    uint32_t index;
+    uint32_t deadline;
+    uint32_t delay;
+    uint32_t order;
+    uint8_t channels;
+    NotificationPriority priority;
+
+    bool force_volume;
+    bool force_vibro;
+    bool led_active;
+    uint8_t led_values[NOTIFICATION_LED_COUNT];
+    bool reset_notifications;
+    float speaker_volume_setting;
+    bool vibro_setting;
+    float display_brightness_setting;
+    uint8_t reset_mask;
+} NotificationPlayer;
+
 struct NotificationApp {
     FuriMessageQueue* queue;
     FuriPubSub* event_record;
@@ -55,6 +100,11 @@ struct NotificationApp {
     NotificationLedLayer led[NOTIFICATION_LED_COUNT];
     uint8_t display_led_lock;
 
+    NotificationPlayer player[NOTIFICATION_PLAYER_COUNT];
+    uint32_t player_order;
+    NotificationAppMessage pending[NOTIFICATION_PENDING_COUNT];
+    size_t pending_count;
+
     NotificationSettings settings;
 };
 
@@ -5,7 +5,7 @@
 #include <rpc/rpc_i.h>
 #include <storage/filesystem_api_defines.h>
 #include <storage/storage.h>
-#include <lib/toolbox/md5_calc.h>
+#include <lib/toolbox/file_digest.h>
 #include <lib/toolbox/path.h>
 #include <update_util/int_backup.h>
 #include <toolbox/tar/tar_archive.h>
@@ -16,6 +16,8 @@
 
 #define TAG "RpcStorage"
 
+#define RPC_STORAGE_DIGEST_CACHE_SIZE (16)
+
 #define MAX_NAME_LENGTH 255
 
 static const size_t MAX_DATA_SIZE = 512;
@@ -29,6 +31,7 @@ typedef struct {
     RpcSession* session;
     Storage* api;
     File* file;
+    FileDigestCache* digest_cache;
     RpcStorageState state;
     uint32_t current_command_id;
 } RpcStorageSystem;
@@ -249,6 +252,28 @@ static bool rpc_system_storage_list_filter(
     return result;
 }
 
+static bool rpc_system_storage_md5sum_calc(
+    RpcStorageSystem* rpc_storage,
+    File* file,
+    const char* path,
+    char* md5sum,
+    size_t md5sum_size,
+    FS_Error* file_error) {
+    furi_check(md5sum_size > FILE_DIGEST_MD5_SIZE * 2);
+
+    FileDigest digest;
+    if(!file_digest_cache_calc_file(
+           rpc_storage->digest_cache, file, path, FileDigestTypeMd5, &digest, file_error)) {
+        return false;
+    }
+
+    for(size_t i = 0; i < FILE_DIGEST_MD5_SIZE; i++) {
+        snprintf(&md5sum[i * 2], md5sum_size - i * 2, "%02x", digest.md5[i]);
+    }
+
+    return true;
+}
+
 static void rpc_system_storage_list_process(const PB_Main* request, void* context) {
     furi_assert(request);
     furi_assert(context);
@@ -280,7 +305,6 @@ static void rpc_system_storage_list_process(const PB_Main* request, void* contex
     PB_Storage_ListResponse* list = &response.content.storage_list_response;
 
     bool include_md5 = list_request->include_md5;
-    FuriString* md5 = furi_string_alloc();
     FuriString* md5_path = furi_string_alloc();
     File* file = storage_file_alloc(rpc_storage->api);
 
@@ -313,11 +337,13 @@ static void rpc_system_storage_list_process(const PB_Main* request, void* contex
                 if(include_md5 && !file_info_is_dir(&fileinfo)) {
                     furi_string_printf(md5_path, "%s/%s", list_request->path, name); //-V576
 
-                    if(md5_string_calc_file(file, furi_string_get_cstr(md5_path), md5, NULL)) {
-                        char* md5sum = list->file[i].md5sum;
-                        size_t md5sum_size = sizeof(list->file[i].md5sum);
-                        snprintf(md5sum, md5sum_size, "%s", furi_string_get_cstr(md5));
-                    }
+                    rpc_system_storage_md5sum_calc(
+                        rpc_storage,
+                        file,
+                        furi_string_get_cstr(md5_path),
+                        list->file[i].md5sum,
+                        sizeof(list->file[i].md5sum),
+                        NULL);
                 }
 
                 ++i;
@@ -334,7 +360,6 @@ static void rpc_system_storage_list_process(const PB_Main* request, void* contex
     response.has_next = false;
     rpc_send_and_release(session, &response);
 
-    furi_string_free(md5);
     furi_string_free(md5_path);
     storage_dir_close(dir);
     storage_file_free(dir);
@@ -435,6 +460,7 @@ static void rpc_system_storage_write_process(const PB_Main* request, void* conte
     }
 
     if(rpc_storage->state != RpcStorageStateWriting) {
+        file_digest_cache_reset(rpc_storage->digest_cache);
         rpc_storage->file = storage_file_alloc(rpc_storage->api);
         rpc_storage->current_command_id = request->command_id;
         rpc_storage->state = RpcStorageStateWriting;
@@ -512,6 +538,8 @@ static void rpc_system_storage_delete_process(const PB_Main* request, void* cont
     RpcSession* session = rpc_storage->session;
     furi_assert(session);
 
+    file_digest_cache_reset(rpc_storage->digest_cache);
+
     PB_CommandStatus status = PB_CommandStatus_ERROR;
     rpc_system_storage_reset_state(rpc_storage, session, true);
 
@@ -589,28 +617,28 @@ static void rpc_system_storage_md5sum_process(const PB_Main* request, void* cont
     }
 
     File* file = storage_file_alloc(rpc_storage->api);
-    FuriString* md5 = furi_string_alloc();
     FS_Error file_error;
 
-    if(md5_string_calc_file(file, filename, md5, &file_error)) {
-        PB_Main response = {
-            .command_id = request->command_id,
-            .command_status = PB_CommandStatus_OK,
-            .which_content = PB_Main_storage_md5sum_response_tag,
-            .has_next = false,
-        };
-
-        char* md5sum = response.content.storage_md5sum_response.md5sum;
-        size_t md5sum_size = sizeof(response.content.storage_md5sum_response.md5sum);
-        snprintf(md5sum, md5sum_size, "%s", furi_string_get_cstr(md5));
+    PB_Main response = {
+        .command_id = request->command_id,
+        .command_status = PB_CommandStatus_OK,
+        .which_content = PB_Main_storage_md5sum_response_tag,
+        .has_next = false,
+    };
 
+    if(rpc_system_storage_md5sum_calc(
+           rpc_storage,
+           file,
+           filename,
+           response.content.storage_md5sum_response.md5sum,
+           sizeof(response.content.storage_md5sum_response.md5sum),
+           &file_error)) {
         rpc_send_and_release(session, &response);
     } else {
         rpc_send_and_release_empty(
             session, request->command_id, rpc_system_storage_get_error(file_error));
     }
 
-    furi_string_free(md5);
     storage_file_free(file);
 }
 
@@ -625,6 +653,8 @@ static void rpc_system_storage_rename_process(const PB_Main* request, void* cont
     RpcSession* session = rpc_storage->session;
     furi_assert(session);
 
+    file_digest_cache_reset(rpc_storage->digest_cache);
+
     PB_CommandStatus status;
     rpc_system_storage_reset_state(rpc_storage, session, true);
 
@@ -672,6 +702,8 @@ static void rpc_system_storage_backup_restore_process(const PB_Main* request, vo
     RpcSession* session = rpc_storage->session;
     furi_assert(session);
 
+    file_digest_cache_reset(rpc_storage->digest_cache);
+
     rpc_system_storage_reset_state(rpc_storage, session, true);
 
     bool backup_ok = int_backup_unpack(
@@ -692,6 +724,8 @@ static void rpc_system_storage_tar_extract_process(const PB_Main* request, void*
     RpcSession* session = rpc_storage->session;
     furi_assert(session);
 
+    file_digest_cache_reset(rpc_storage->digest_cache);
+
     PB_CommandStatus status;
     rpc_system_storage_reset_state(rpc_storage, session, true);
 
@@ -729,6 +763,8 @@ void* rpc_system_storage_alloc(RpcSession* session) {
 
     RpcStorageSystem* rpc_storage = malloc(sizeof(RpcStorageSystem));
     rpc_storage->api = furi_record_open(RECORD_STORAGE);
+    rpc_storage->digest_cache =
+        file_digest_cache_alloc(rpc_storage->api, RPC_STORAGE_DIGEST_CACHE_SIZE);
     rpc_storage->session = session;
     rpc_storage->state = RpcStorageStateIdle;
 
@@ -788,6 +824,7 @@ void rpc_system_storage_free(void* context) {
 
     rpc_system_storage_reset_state(rpc_storage, session, false);
 
+    file_digest_cache_free(rpc_storage->digest_cache);
     furi_record_close(RECORD_STORAGE);
     rpc_storage->api = NULL;
     free(rpc_storage);
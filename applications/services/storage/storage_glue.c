@@ -3,24 +3,52 @@
 
 #define TAG "StorageGlue"
 
+/****************** path hash ******************/
+
+// Paths mostly share long prefixes like "/ext/apps_data/appid/", so only the length and the
+// tail are hashed. Equal hashes only tell that paths may match, full comparison is still needed.
+#define STORAGE_PATH_HASH_TAIL (16U)
+
+// FNV-1a, trailing slashes ignored and case-insensitive like FAT
+static uint32_t storage_path_hash(FuriString* path, size_t* length) {
+    const char* path_cstr = furi_string_get_cstr(path);
+    size_t path_length = furi_string_size(path);
+    while(path_length > 1 && path_cstr[path_length - 1] == '/') {
+        path_length--;
+    }
+
+    uint32_t hash = 2166136261UL ^ path_length;
+    for(size_t i = path_length - MIN(path_length, STORAGE_PATH_HASH_TAIL); i < path_length; i++) {
+        uint8_t c = path_cstr[i];
+        if(c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        hash = (hash ^ c) * 16777619UL;
+    }
+
+    if(length) *length = path_length;
+    return hash;
+}
+
 /****************** storage file ******************/
 
 void storage_file_init(StorageFile* obj) {
     obj->file = NULL;
     obj->file_data = NULL;
     obj->path = furi_string_alloc();
+    obj->path_hash = 0;
 }
 
 void storage_file_init_set(StorageFile* obj, const StorageFile* src) {
     obj->file = src->file;
     obj->file_data = src->file_data;
     obj->path = furi_string_alloc_set(src->path);
+    obj->path_hash = src->path_hash;
 }
 
 void storage_file_set(StorageFile* obj, const StorageFile* src) { //-V524
     obj->file = src->file;
     obj->file_data = src->file_data;
     furi_string_set(obj->path, src->path);
+    obj->path_hash = src->path_hash;
 }
 
 void storage_file_clear(StorageFile* obj) {
@@ -33,6 +61,12 @@ void storage_data_init(StorageData* storage) {
     storage->data = NULL;
     storage->status = StorageStatusNotReady;
     StorageFileList_init(storage->files);
+
+    for(size_t i = 0; i < STORAGE_DIR_CACHE_SIZE; i++) {
+        storage->dir_cache[i].path = furi_string_alloc();
+        storage->dir_cache[i].path_hash = 0;
+    }
+    storage->dir_cache_next = 0;
 }
 
 StorageStatus storage_data_status(StorageData* storage) {
@@ -98,6 +132,7 @@ bool storage_has_file(const File* file, StorageData* storage) {
 
 bool storage_path_already_open(FuriString* path, StorageData* storage) {
     bool open = false;
+    const uint32_t path_hash = storage_path_hash(path, NULL);
 
     StorageFileList_it_t it;
 
@@ -105,7 +140,8 @@ bool storage_path_already_open(FuriString* path, StorageData* storage) {
         StorageFileList_next(it)) {
         const StorageFile* storage_file = StorageFileList_cref(it);
 
-        if(furi_string_cmp(storage_file->path, path) == 0) {
+        if(storage_file->path_hash == path_hash &&
+           furi_string_cmp(storage_file->path, path) == 0) {
             open = true;
             break;
         }
@@ -131,6 +167,7 @@ void storage_push_storage_file(File* file, FuriString* path, StorageData* storag
     file->file_id = (uint32_t)storage_file;
     storage_file->file = file;
     furi_string_set(storage_file->path, path);
+    storage_file->path_hash = storage_path_hash(path, NULL);
 }
 
 bool storage_pop_storage_file(File* file, StorageData* storage) {
@@ -156,3 +193,53 @@ size_t storage_open_files_count(StorageData* storage) {
     size_t count = StorageFileList_size(storage->files);
     return count;
 }
+
+/****************** directory cache ******************/
+
+static StorageDirCacheEntry* storage_dir_cache_find(StorageData* storage, FuriString* path) {
+    size_t path_length;
+    const uint32_t path_hash = storage_path_hash(path, &path_length);
+
+    for(size_t i = 0; i < STORAGE_DIR_CACHE_SIZE; i++) {
+        StorageDirCacheEntry* entry = &storage->dir_cache[i];
+        if(entry->path_hash == path_hash && furi_string_size(entry->path) == path_length &&
+           strncasecmp(
+               furi_string_get_cstr(entry->path), furi_string_get_cstr(path), path_length) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+bool storage_dir_cache_has(StorageData* storage, FuriString* path) {
+    return storage_dir_cache_find(storage, path) != NULL;
+}
+
+void storage_dir_cache_add(StorageData* storage, FuriString* path) {
+    if(storage_dir_cache_find(storage, path)) return;
+
+    // round robin, entries are cheap to get back with a stat
+    StorageDirCacheEntry* entry = &storage->dir_cache[storage->dir_cache_next];
+    storage->dir_cache_next = (storage->dir_cache_next + 1) % STORAGE_DIR_CACHE_SIZE;
+
+    size_t path_length;
+    entry->path_hash = storage_path_hash(path, &path_length);
+    furi_string_set_strn(entry->path, furi_string_get_cstr(path), path_length);
+}
+
+void storage_dir_cache_remove(StorageData* storage, FuriString* path) {
+    StorageDirCacheEntry* entry = storage_dir_cache_find(storage, path);
+    if(entry) {
+        furi_string_reset(entry->path);
+        entry->path_hash = 0;
+    }
+}
+
+void storage_dir_cache_reset(StorageData* storage) {
+    for(size_t i = 0; i < STORAGE_DIR_CACHE_SIZE; i++) {
+        furi_string_reset(storage->dir_cache[i].path);
+        storage->dir_cache[i].path_hash = 0;
+    }
+    storage->dir_cache_next = 0;
+}
@@ -25,8 +25,16 @@ typedef struct {
     File* file;
     void* file_data;
     FuriString* path;
+    uint32_t path_hash;
 } StorageFile;
 
+#define STORAGE_DIR_CACHE_SIZE (8U)
+
+typedef struct {
+    FuriString* path; /**< empty when the entry is not used */
+    uint32_t path_hash;
+} StorageDirCacheEntry;
+
 typedef enum {
     StorageStatusOK, /**< storage ok */
     StorageStatusNotReady, /**< storage not ready (not initialized or waiting for data storage to appear) */
@@ -62,6 +70,8 @@ struct StorageData {
     StorageStatus status;
     StorageFileList_t files;
     uint32_t timestamp;
+    StorageDirCacheEntry dir_cache[STORAGE_DIR_CACHE_SIZE];
+    size_t dir_cache_next;
 };
 
 bool storage_has_file(const File* file, StorageData* storage_data);
@@ -75,6 +85,15 @@ bool storage_pop_storage_file(File* file, StorageData* storage);
 
 size_t storage_open_files_count(StorageData* storage);
 
+/**
+ * Cache of directories known to exist, filled by the storage service for the
+ * directories it creates itself. Must be reset when the filesystem goes away.
+ */
+bool storage_dir_cache_has(StorageData* storage, FuriString* path);
+void storage_dir_cache_add(StorageData* storage, FuriString* path);
+void storage_dir_cache_remove(StorageData* storage, FuriString* path);
+void storage_dir_cache_reset(StorageData* storage);
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,6 +25,7 @@ struct Storage {
     StorageData storage[STORAGE_COUNT];
     StorageSDGui sd_gui;
     FuriPubSub* pubsub;
+    FuriString* alias_path;
 };
 
 #ifdef __cplusplus
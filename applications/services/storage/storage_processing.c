@@ -367,6 +367,10 @@ static FS_Error storage_process_common_remove(Storage* app, FuriString* path) {
 
         storage_data_timestamp(storage);
         FS_CALL(storage, common.remove(storage, cstr_path_without_vfs_prefix(path)));
+
+        if(ret == FSE_OK) {
+            storage_dir_cache_remove(storage, path);
+        }
     } while(false);
 
     return ret;
@@ -437,6 +441,7 @@ static FS_Error storage_process_sd_format(Storage* app) {
         ret = FSE_NOT_READY;
     } else {
         ret = sd_format_card(&app->storage[ST_EXT]);
+        storage_dir_cache_reset(&app->storage[ST_EXT]);
         storage_data_timestamp(&app->storage[ST_EXT]);
     }
 
@@ -515,14 +520,35 @@ static FS_Error storage_process_sd_status(Storage* app) {
 
 /******************** Aliases processing *******************/
 
+/* Make sure alias directory exists, without a stat for the ones seen before */
+static void storage_process_alias_mkdir(Storage* app, FuriString* path, const char* parent) {
+    StorageData* storage = &app->storage[ST_EXT];
+    if(storage_dir_cache_has(storage, path)) return;
+
+    FS_Error error = storage_process_common_stat(app, path, NULL);
+    if(error != FSE_OK) {
+        if(parent) {
+            FuriString* parent_path = furi_string_alloc_set(parent);
+            storage_process_common_mkdir(app, parent_path);
+            furi_string_free(parent_path);
+        }
+        error = storage_process_common_mkdir(app, path);
+    }
+
+    if(error == FSE_OK || error == FSE_EXIST) {
+        storage_dir_cache_add(storage, path);
+    }
+}
+
 void storage_process_alias(
     Storage* app,
     FuriString* path,
     FuriThreadId thread_id,
     bool create_folders) {
     if(furi_string_start_with(path, STORAGE_APP_DATA_PATH_PREFIX)) {
-        FuriString* apps_data_path_with_appsid = furi_string_alloc_set(APPS_DATA_PATH "/");
-        furi_string_cat(apps_data_path_with_appsid, furi_thread_get_appid(thread_id));
+        FuriString* apps_data_path_with_appsid = app->alias_path;
+        furi_string_printf(
+            apps_data_path_with_appsid, APPS_DATA_PATH "/%s", furi_thread_get_appid(thread_id));
 
         // "/data" -> "/ext/apps_data/appsid"
         furi_string_replace_at(
@@ -532,19 +558,15 @@ void storage_process_alias(
             furi_string_get_cstr(apps_data_path_with_appsid));
 
         // Create app data folder if not exists
-        if(create_folders &&
-           storage_process_common_stat(app, apps_data_path_with_appsid, NULL) != FSE_OK) {
-            furi_string_set(apps_data_path_with_appsid, APPS_DATA_PATH);
-            storage_process_common_mkdir(app, apps_data_path_with_appsid);
-            furi_string_cat(apps_data_path_with_appsid, "/");
-            furi_string_cat(apps_data_path_with_appsid, furi_thread_get_appid(thread_id));
-            storage_process_common_mkdir(app, apps_data_path_with_appsid);
+        if(create_folders) {
+            storage_process_alias_mkdir(app, apps_data_path_with_appsid, APPS_DATA_PATH);
         }
-
-        furi_string_free(apps_data_path_with_appsid);
     } else if(furi_string_start_with(path, STORAGE_APP_ASSETS_PATH_PREFIX)) {
-        FuriString* apps_assets_path_with_appsid = furi_string_alloc_set(APPS_ASSETS_PATH "/");
-        furi_string_cat(apps_assets_path_with_appsid, furi_thread_get_appid(thread_id));
+        FuriString* apps_assets_path_with_appsid = app->alias_path;
+        furi_string_printf(
+            apps_assets_path_with_appsid,
+            APPS_ASSETS_PATH "/%s",
+            furi_thread_get_appid(thread_id));
 
         // "/assets" -> "/ext/apps_assets/appsid"
         furi_string_replace_at(
@@ -553,17 +575,12 @@ void storage_process_alias(
             strlen(STORAGE_APP_ASSETS_PATH_PREFIX),
             furi_string_get_cstr(apps_assets_path_with_appsid));
 
-        furi_string_free(apps_assets_path_with_appsid);
-
     } else if(furi_string_start_with(path, STORAGE_INT_PATH_PREFIX)) {
         furi_string_replace_at(
             path, 0, strlen(STORAGE_INT_PATH_PREFIX), EXT_PATH(STORAGE_INTERNAL_DIR_NAME));
 
-        FuriString* int_on_ext_path = furi_string_alloc_set(EXT_PATH(STORAGE_INTERNAL_DIR_NAME));
-        if(storage_process_common_stat(app, int_on_ext_path, NULL) != FSE_OK) {
-            storage_process_common_mkdir(app, int_on_ext_path);
-        }
-        furi_string_free(int_on_ext_path);
+        furi_string_set(app->alias_path, EXT_PATH(STORAGE_INTERNAL_DIR_NAME));
+        storage_process_alias_mkdir(app, app->alias_path, NULL);
     }
 }
 
@@ -8,7 +8,6 @@
 #include "../filesystem_api_internal.h"
 #include "../storage_internal_dirname_i.h"
 
-typedef FIL SDFile;
 typedef DIR SDDir;
 typedef FILINFO SDFileInfo;
 typedef FRESULT SDError;
@@ -23,6 +22,19 @@ typedef struct {
     bool sd_was_present;
 } SDData;
 
+typedef struct {
+    FIL fil;
+    // cluster link map for fast seek, see storage_ext_file_link_map
+    DWORD* link_map;
+    bool link_map_checked;
+} SDFile;
+
+// files shorter than this many clusters are cheap enough to seek by following the FAT chain
+#define STORAGE_EXT_LINK_MAP_MIN_CLUSTERS (16U)
+// link map sizes in DWORDs: 2 per fragment, plus table size and terminator
+#define STORAGE_EXT_LINK_MAP_SIZE_INITIAL (8U)
+#define STORAGE_EXT_LINK_MAP_SIZE_MAX     (64U)
+
 static FS_Error storage_ext_parse_error(SDError error);
 
 /******************* Core Functions *******************/
@@ -163,6 +175,7 @@ FS_Error sd_unmount_card(StorageData* storage) {
 
     // TODO FL-3522: do i need to close the files?
     f_mount(0, sd_data->path, 0);
+    storage_dir_cache_reset(storage);
 
     return storage_ext_parse_error(error);
 }
@@ -405,9 +418,12 @@ static bool storage_ext_file_open(
     if(open_mode & FSOM_CREATE_ALWAYS) _mode |= FA_CREATE_ALWAYS;
 
     SDFile* file_data = malloc(sizeof(SDFile));
+    file_data->link_map = NULL;
+    // link map can't follow the file growing or shrinking, so only read-only files get one
+    file_data->link_map_checked = access_mode != FSAM_READ;
     storage_set_storage_file_data(file, file_data, storage);
 
-    file->internal_error_id = f_open(file_data, path, _mode);
+    file->internal_error_id = f_open(&file_data->fil, path, _mode);
     file->error_id = storage_ext_parse_error(file->internal_error_id);
     return file->error_id == FSE_OK;
 }
@@ -415,8 +431,9 @@ static bool storage_ext_file_open(
 static bool storage_ext_file_close(void* ctx, File* file) {
     StorageData* storage = ctx;
     SDFile* file_data = storage_get_storage_file_data(file, storage);
-    file->internal_error_id = f_close(file_data);
+    file->internal_error_id = f_close(&file_data->fil);
     file->error_id = storage_ext_parse_error(file->internal_error_id);
+    free(file_data->link_map);
     free(file_data);
     storage_set_storage_file_data(file, NULL, storage);
     return file->error_id == FSE_OK;
@@ -427,7 +444,7 @@ static uint16_t
     StorageData* storage = ctx;
     SDFile* file_data = storage_get_storage_file_data(file, storage);
     uint16_t bytes_read = 0;
-    file->internal_error_id = f_read(file_data, buff, bytes_to_read, &bytes_read);
+    file->internal_error_id = f_read(&file_data->fil, buff, bytes_to_read, &bytes_read);
     file->error_id = storage_ext_parse_error(file->internal_error_id);
     return bytes_read;
 }
@@ -444,25 +461,64 @@ static uint16_t
     StorageData* storage = ctx;
     SDFile* file_data = storage_get_storage_file_data(file, storage);
     uint16_t bytes_written = 0;
-    file->internal_error_id = f_write(file_data, buff, bytes_to_write, &bytes_written);
+    file->internal_error_id = f_write(&file_data->fil, buff, bytes_to_write, &bytes_written);
     file->error_id = storage_ext_parse_error(file->internal_error_id);
     return bytes_written;
 #endif
 }
 
+/**
+ * Build cluster link map for a big read-only file, so FatFs can seek without walking
+ * the FAT chain from the start of the file. Map is kept until the file is closed,
+ * files too fragmented for STORAGE_EXT_LINK_MAP_SIZE_MAX keep seeking the usual way.
+ */
+static void storage_ext_file_link_map(SDFile* file_data) {
+    FIL* fil = &file_data->fil;
+    file_data->link_map_checked = true;
+
+    const FSIZE_t cluster_size = (FSIZE_t)fil->obj.fs->csize * _MAX_SS;
+    if(f_size(fil) <= cluster_size * STORAGE_EXT_LINK_MAP_MIN_CLUSTERS) return;
+
+    DWORD* link_map = malloc(STORAGE_EXT_LINK_MAP_SIZE_INITIAL * sizeof(DWORD));
+    link_map[0] = STORAGE_EXT_LINK_MAP_SIZE_INITIAL;
+    fil->cltbl = link_map;
+    FRESULT result = f_lseek(fil, CREATE_LINKMAP);
+
+    if(result == FR_NOT_ENOUGH_CORE && link_map[0] <= STORAGE_EXT_LINK_MAP_SIZE_MAX) {
+        // first table holds the required size
+        const DWORD link_map_size = link_map[0];
+        link_map = realloc(link_map, link_map_size * sizeof(DWORD)); //-V701
+        link_map[0] = link_map_size;
+        fil->cltbl = link_map;
+        result = f_lseek(fil, CREATE_LINKMAP);
+    }
+
+    if(result == FR_OK) {
+        file_data->link_map = link_map;
+    } else {
+        FURI_LOG_D(TAG, "no link map: %d, %lu", result, link_map[0]);
+        fil->cltbl = NULL;
+        free(link_map);
+    }
+}
+
 static bool
     storage_ext_file_seek(void* ctx, File* file, const uint32_t offset, const bool from_start) {
     StorageData* storage = ctx;
     SDFile* file_data = storage_get_storage_file_data(file, storage);
 
-    if(from_start) {
-        file->internal_error_id = f_lseek(file_data, offset);
-    } else {
-        uint64_t position = f_tell(file_data);
-        position += offset;
-        file->internal_error_id = f_lseek(file_data, position);
+    uint64_t position = offset;
+    if(!from_start) {
+        position += f_tell(&file_data->fil);
     }
 
+    // sequential access never needs the map, only build it on the first real seek
+    if(!file_data->link_map_checked && position != f_tell(&file_data->fil)) {
+        storage_ext_file_link_map(file_data);
+    }
+
+    file->internal_error_id = f_lseek(&file_data->fil, position);
+
     file->error_id = storage_ext_parse_error(file->internal_error_id);
     return file->error_id == FSE_OK;
 }
@@ -472,7 +528,7 @@ static uint64_t storage_ext_file_tell(void* ctx, File* file) {
     SDFile* file_data = storage_get_storage_file_data(file, storage);
 
     uint64_t position = 0;
-    position = f_tell(file_data);
+    position = f_tell(&file_data->fil);
     file->error_id = FSE_OK;
     return position;
 }
@@ -486,7 +542,7 @@ static bool storage_ext_file_truncate(void* ctx, File* file) {
     StorageData* storage = ctx;
     SDFile* file_data = storage_get_storage_file_data(file, storage);
 
-    file->internal_error_id = f_truncate(file_data);
+    file->internal_error_id = f_truncate(&file_data->fil);
     file->error_id = storage_ext_parse_error(file->internal_error_id);
     return file->error_id == FSE_OK;
 #endif
@@ -501,7 +557,7 @@ static bool storage_ext_file_sync(void* ctx, File* file) {
     StorageData* storage = ctx;
     SDFile* file_data = storage_get_storage_file_data(file, storage);
 
-    file->internal_error_id = f_sync(file_data);
+    file->internal_error_id = f_sync(&file_data->fil);
     file->error_id = storage_ext_parse_error(file->internal_error_id);
     return file->error_id == FSE_OK;
 #endif
@@ -512,7 +568,7 @@ static uint64_t storage_ext_file_size(void* ctx, File* file) {
     SDFile* file_data = storage_get_storage_file_data(file, storage);
 
     uint64_t size = 0;
-    size = f_size(file_data);
+    size = f_size(&file_data->fil);
     file->error_id = FSE_OK;
     return size;
 }
@@ -521,7 +577,7 @@ static bool storage_ext_file_eof(void* ctx, File* file) {
     StorageData* storage = ctx;
     SDFile* file_data = storage_get_storage_file_data(file, storage);
 
-    bool eof = f_eof(file_data);
+    bool eof = f_eof(&file_data->fil);
     file->internal_error_id = 0;
     file->error_id = FSE_OK;
     return eof;
@@ -267,6 +267,7 @@ void js_check_sdk_compatibility(struct mjs* mjs) {
 
 static const char* extra_features[] = {
     "baseline", // dummy "feature"
+    "serial-expect-poll",
 };
 
 /**
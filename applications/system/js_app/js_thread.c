@@ -291,6 +291,9 @@ static int32_t js_thread(void* arg) {
 
     mjs_set_exec_flags_poller(mjs, js_exit_flag_poll);
 
+    // keep the parsed bcode next to the script, so next launches skip parsing
+    mjs_set_generate_jsc(mjs, 1);
+
     mjs_err_t err = mjs_exec_file(mjs, furi_string_get_cstr(worker->path), NULL);
 
 #ifdef JS_DEBUG
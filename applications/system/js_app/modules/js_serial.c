@@ -2,23 +2,44 @@
 #include <expansion/expansion.h>
 #include <furi_hal.h>
 #include "../js_modules.h"
-#include <m-array.h>
+#include <toolbox/pattern_matcher.h>
 
 #define TAG "JsSerial"
 
 #define RX_BUF_LEN 2048
 
+// Bytes taken from the stream buffer at once while matching patterns
+#define EXPECT_CHUNK_LEN (64)
+// Received bytes kept to report the data preceding a match
+#define EXPECT_LOOKBACK_LEN (256)
+
+_Static_assert(EXPECT_CHUNK_LEN <= EXPECT_LOOKBACK_LEN, "Lookback must fit a whole chunk");
+
+typedef struct {
+    uint8_t* data; // sequence of (size_t length, pattern bytes)
+    size_t size;
+} JsSerialPatterns;
+
 typedef struct {
     bool setup_done;
     FuriStreamBuffer* rx_stream;
     FuriHalSerialHandle* serial_handle;
     struct mjs* mjs;
-} JsSerialInst;
 
-typedef struct {
-    size_t len;
-    char* data;
-} PatternArrayItem;
+    // Bytes read ahead by expect past the match, returned by the next read
+    uint8_t rx_pending[EXPECT_CHUNK_LEN];
+    size_t rx_pending_len;
+    // Number of bytes handed to the script since setup
+    uint32_t rx_offset;
+
+    // Compiled patterns of the last expect call, reused while they don't change
+    PatternMatcher* matcher;
+    JsSerialPatterns matcher_patterns;
+    uint32_t matcher_base;
+    uint32_t poll_offset;
+    uint8_t lookback[EXPECT_LOOKBACK_LEN];
+    size_t lookback_len;
+} JsSerialInst;
 
 static const struct {
     const char* name;
@@ -28,8 +49,6 @@ static const struct {
     {"lpuart", FuriHalSerialIdLpuart},
 };
 
-ARRAY_DEF(PatternArray, PatternArrayItem, M_POD_OPLIST);
-
 static void
     js_serial_on_async_rx(FuriHalSerialHandle* handle, FuriHalSerialRxEvent event, void* context) {
     JsSerialInst* serial = context;
@@ -96,6 +115,12 @@ static void js_serial_setup(struct mjs* mjs) {
     serial->serial_handle = furi_hal_serial_control_acquire(serial_id);
     if(serial->serial_handle) {
         serial->rx_stream = furi_stream_buffer_alloc(RX_BUF_LEN, 1);
+        serial->rx_pending_len = 0;
+        serial->rx_offset = 0;
+        serial->matcher_base = 0;
+        serial->poll_offset = 0;
+        serial->lookback_len = 0;
+        pattern_matcher_reset(serial->matcher);
         furi_hal_serial_init(serial->serial_handle, baudrate);
         furi_hal_serial_async_rx_start(
             serial->serial_handle, js_serial_on_async_rx, serial, false);
@@ -203,9 +228,17 @@ static void js_serial_write(struct mjs* mjs) {
     mjs_return(mjs, MJS_UNDEFINED);
 }
 
+static size_t js_serial_receive_pending(JsSerialInst* serial, uint8_t* buf, size_t len) {
+    size_t pending_len = MIN(len, serial->rx_pending_len);
+    memcpy(buf, serial->rx_pending, pending_len);
+    serial->rx_pending_len -= pending_len;
+    memmove(serial->rx_pending, &serial->rx_pending[pending_len], serial->rx_pending_len);
+    return pending_len;
+}
+
 static size_t js_serial_receive(JsSerialInst* serial, char* buf, size_t len, uint32_t timeout) {
-    size_t bytes_read = 0;
-    while(1) {
+    size_t bytes_read = js_serial_receive_pending(serial, (uint8_t*)buf, len);
+    while(bytes_read < len) {
         uint32_t flags = ThreadEventCustomDataRx;
         if(furi_stream_buffer_is_empty(serial->rx_stream)) {
             flags = js_flags_wait(serial->mjs, ThreadEventCustomDataRx, timeout);
@@ -219,11 +252,9 @@ static size_t js_serial_receive(JsSerialInst* serial, char* buf, size_t len, uin
             size_t rx_len = furi_stream_buffer_receive(
                 serial->rx_stream, &buf[bytes_read], len - bytes_read, 0);
             bytes_read += rx_len;
-            if(bytes_read == len) {
-                break;
-            }
         }
     }
+    serial->rx_offset += bytes_read;
     return bytes_read;
 }
 
@@ -384,14 +415,18 @@ static void js_serial_read_bytes(struct mjs* mjs) {
 
 static char* js_serial_receive_any(JsSerialInst* serial, size_t* len, uint32_t timeout) {
     uint32_t flags = ThreadEventCustomDataRx;
-    if(furi_stream_buffer_is_empty(serial->rx_stream)) {
+    if(!serial->rx_pending_len && furi_stream_buffer_is_empty(serial->rx_stream)) {
         flags = js_flags_wait(serial->mjs, ThreadEventCustomDataRx, timeout);
     }
     if(flags & ThreadEventCustomDataRx) { // New data received
-        *len = furi_stream_buffer_bytes_available(serial->rx_stream);
+        size_t pending_len = serial->rx_pending_len;
+        *len = pending_len + furi_stream_buffer_bytes_available(serial->rx_stream);
         if(!*len) return NULL;
         char* buf = malloc(*len);
-        furi_stream_buffer_receive(serial->rx_stream, buf, *len, 0);
+        js_serial_receive_pending(serial, (uint8_t*)buf, pending_len);
+        *len = pending_len + furi_stream_buffer_receive(
+                                 serial->rx_stream, &buf[pending_len], *len - pending_len, 0);
+        serial->rx_offset += *len;
         return buf;
     }
     return NULL;
@@ -431,26 +466,31 @@ static void js_serial_read_any(struct mjs* mjs) {
     free(read_buf);
 }
 
+static void js_serial_patterns_add(JsSerialPatterns* patterns, const void* data, size_t len) {
+    patterns->data = realloc(patterns->data, patterns->size + sizeof(len) + len); //-V701
+    memcpy(&patterns->data[patterns->size], &len, sizeof(len));
+    memcpy(&patterns->data[patterns->size + sizeof(len)], data, len);
+    patterns->size += sizeof(len) + len;
+}
+
 static bool
-    js_serial_expect_parse_string(struct mjs* mjs, mjs_val_t arg, PatternArray_t patterns) {
+    js_serial_expect_parse_string(struct mjs* mjs, mjs_val_t arg, JsSerialPatterns* patterns) {
     size_t str_len = 0;
     const char* arg_str = mjs_get_string(mjs, &arg, &str_len);
     if((str_len == 0) || (arg_str == NULL)) {
         return false;
     }
-    PatternArrayItem* item = PatternArray_push_new(patterns);
-    item->data = malloc(str_len + 1);
-    memcpy(item->data, arg_str, str_len);
-    item->len = str_len;
+    js_serial_patterns_add(patterns, arg_str, str_len);
     return true;
 }
 
-static bool js_serial_expect_parse_array(struct mjs* mjs, mjs_val_t arg, PatternArray_t patterns) {
+static bool
+    js_serial_expect_parse_array(struct mjs* mjs, mjs_val_t arg, JsSerialPatterns* patterns) {
     size_t array_len = mjs_array_length(mjs, arg);
     if(array_len == 0) {
         return false;
     }
-    char* array_data = malloc(array_len + 1);
+    uint8_t* array_data = malloc(array_len);
 
     for(size_t i = 0; i < array_len; i++) {
         mjs_val_t array_arg = mjs_array_get(mjs, arg, i);
@@ -467,25 +507,15 @@ static bool js_serial_expect_parse_array(struct mjs* mjs, mjs_val_t arg, Pattern
         array_data[i] = byte_val;
     }
 
-    PatternArrayItem* item = PatternArray_push_new(patterns);
-    item->data = array_data;
-    item->len = array_len;
+    js_serial_patterns_add(patterns, array_data, array_len);
+    free(array_data);
     return true;
 }
 
-static bool
-    js_serial_expect_parse_args(struct mjs* mjs, PatternArray_t patterns, uint32_t* timeout) {
-    size_t num_args = mjs_nargs(mjs);
-    if(num_args == 2) {
-        mjs_val_t timeout_arg = mjs_arg(mjs, 1);
-        if(!mjs_is_number(timeout_arg)) {
-            return false;
-        }
-        *timeout = mjs_get_int32(mjs, timeout_arg);
-    } else if(num_args != 1) {
-        return false;
-    }
-    mjs_val_t patterns_arg = mjs_arg(mjs, 0);
+static bool js_serial_expect_parse_patterns(
+    struct mjs* mjs,
+    mjs_val_t patterns_arg,
+    JsSerialPatterns* patterns) {
     if(mjs_is_string(patterns_arg)) { // Single string pattern
         if(!js_serial_expect_parse_string(mjs, patterns_arg, patterns)) {
             return false;
@@ -524,20 +554,122 @@ static bool
     return true;
 }
 
-static int32_t js_serial_expect_check_pattern_start(
-    PatternArray_t patterns,
-    char value,
-    int32_t pattern_last) {
-    size_t array_len = PatternArray_size(patterns);
-    if((pattern_last + 1) >= (int32_t)array_len) {
-        return -1;
-    }
-    for(size_t i = pattern_last + 1; i < array_len; i++) {
-        if(PatternArray_get(patterns, i)->data[0] == value) {
-            return i;
+static bool js_serial_expect_parse_args(
+    struct mjs* mjs,
+    JsSerialPatterns* patterns,
+    uint32_t* timeout) {
+    size_t num_args = mjs_nargs(mjs);
+    if(num_args == 2) {
+        mjs_val_t timeout_arg = mjs_arg(mjs, 1);
+        if(!mjs_is_number(timeout_arg)) {
+            return false;
         }
+        *timeout = mjs_get_int32(mjs, timeout_arg);
+    } else if(num_args != 1) {
+        return false;
+    }
+    return js_serial_expect_parse_patterns(mjs, mjs_arg(mjs, 0), patterns);
+}
+
+/**
+ * @brief Restarts matching at the current stream position
+ */
+static void js_serial_expect_restart(JsSerialInst* serial) {
+    pattern_matcher_reset(serial->matcher);
+    serial->matcher_base = serial->rx_offset;
+    serial->lookback_len = 0;
+}
+
+/**
+ * @brief Loads patterns into the matcher, unless it already holds the same ones
+ *
+ * @returns false if patterns are too long, true if the matcher is ready.
+ * `patterns` is taken over in both cases.
+ */
+static bool js_serial_expect_load(JsSerialInst* serial, JsSerialPatterns* patterns) {
+    if(patterns->size == serial->matcher_patterns.size &&
+       memcmp(patterns->data, serial->matcher_patterns.data, patterns->size) == 0) {
+        free(patterns->data);
+        *patterns = (JsSerialPatterns){0};
+        return true;
+    }
+
+    free(serial->matcher_patterns.data);
+    serial->matcher_patterns = *patterns;
+    *patterns = (JsSerialPatterns){0};
+
+    const uint8_t* data = serial->matcher_patterns.data;
+    bool loaded = true;
+    pattern_matcher_clear(serial->matcher);
+    for(size_t offset = 0; offset < serial->matcher_patterns.size && loaded;) {
+        size_t len;
+        memcpy(&len, &data[offset], sizeof(len));
+        offset += sizeof(len);
+        loaded = pattern_matcher_add(serial->matcher, &data[offset], len);
+        offset += len;
+    }
+
+    if(!loaded) {
+        // keep the cache consistent with the matcher contents
+        pattern_matcher_clear(serial->matcher);
+        free(serial->matcher_patterns.data);
+        serial->matcher_patterns = (JsSerialPatterns){0};
+    }
+
+    js_serial_expect_restart(serial);
+    return loaded;
+}
+
+static void js_serial_expect_lookback_push(JsSerialInst* serial, const uint8_t* data, size_t len) {
+    furi_assert(len <= EXPECT_LOOKBACK_LEN);
+
+    size_t keep = MIN(serial->lookback_len, EXPECT_LOOKBACK_LEN - len);
+    memmove(serial->lookback, &serial->lookback[serial->lookback_len - keep], keep);
+    memcpy(&serial->lookback[keep], data, len);
+    serial->lookback_len = keep + len;
+}
+
+/**
+ * @brief Feeds received data to the matcher until a pattern is found
+ *
+ * Data is taken from the stream buffer in chunks. Bytes following the match
+ * are kept for the next read. If `wait` is false, only the data received so
+ * far is checked.
+ */
+static bool js_serial_expect_run(
+    JsSerialInst* serial,
+    bool wait,
+    uint32_t timeout,
+    PatternMatcherMatch* match) {
+    uint8_t chunk[EXPECT_CHUNK_LEN];
+
+    while(true) {
+        size_t chunk_len = js_serial_receive_pending(serial, chunk, sizeof(chunk));
+
+        if(!chunk_len) {
+            uint32_t flags = ThreadEventCustomDataRx;
+            if(furi_stream_buffer_is_empty(serial->rx_stream)) {
+                if(!wait) return false;
+                flags = js_flags_wait(serial->mjs, ThreadEventCustomDataRx, timeout);
+            }
+            if(!(flags & ThreadEventCustomDataRx) || (flags & ThreadEventStop)) {
+                return false;
+            }
+            chunk_len = furi_stream_buffer_receive(serial->rx_stream, chunk, sizeof(chunk), 0);
+            if(!chunk_len) continue;
+        }
+
+        size_t consumed;
+        bool found = pattern_matcher_feed(serial->matcher, chunk, chunk_len, &consumed, match);
+        js_serial_expect_lookback_push(serial, chunk, consumed);
+        serial->rx_offset += consumed;
+
+        // chunk came either from the empty stream buffer or from the pending bytes
+        memcpy(serial->rx_pending, &chunk[consumed], chunk_len - consumed);
+        serial->rx_pending_len = chunk_len - consumed;
+
+        if(found) return true;
     }
-    return -1;
 }
 
 static void js_serial_expect(struct mjs* mjs) {
@@ -551,117 +683,78 @@ static void js_serial_expect(struct mjs* mjs) {
     }
 
     uint32_t timeout = FuriWaitForever;
-    PatternArray_t patterns;
-    PatternArray_it_t it;
-    PatternArray_init(patterns);
+    JsSerialPatterns patterns = {0};
 
-    if(!js_serial_expect_parse_args(mjs, patterns, &timeout)) {
+    if(!js_serial_expect_parse_args(mjs, &patterns, &timeout) ||
+       !js_serial_expect_load(serial, &patterns)) {
+        free(patterns.data);
         mjs_prepend_errorf(mjs, MJS_BAD_ARGS_ERROR, "");
         mjs_return(mjs, MJS_UNDEFINED);
-        for(PatternArray_it(it, patterns); !PatternArray_end_p(it); PatternArray_next(it)) {
-            const PatternArrayItem* item = PatternArray_cref(it);
-            free(item->data);
-        }
-        PatternArray_clear(patterns);
         return;
     }
 
-    size_t pattern_len_max = 0;
-    for(PatternArray_it(it, patterns); !PatternArray_end_p(it); PatternArray_next(it)) {
-        const PatternArrayItem* item = PatternArray_cref(it);
-        if(item->len > pattern_len_max) {
-            pattern_len_max = item->len;
-        }
-    }
+    js_serial_expect_restart(serial);
 
-    char* compare_buf = malloc(pattern_len_max);
-    int32_t pattern_found = -1;
-    int32_t pattern_candidate = -1;
-    size_t buf_len = 0;
-    bool is_timeout = false;
+    PatternMatcherMatch match;
+    if(js_serial_expect_run(serial, true, timeout, &match)) {
+        js_serial_expect_restart(serial);
+        mjs_return(mjs, mjs_mk_number(mjs, match.index));
+    } else {
+        FURI_LOG_W(TAG, "Expect: timeout");
+        mjs_return(mjs, MJS_UNDEFINED);
+    }
+}
 
-    while(1) {
-        if(buf_len == 0) {
-            // Empty buffer - read by 1 byte to find pattern start
-            size_t bytes_read = js_serial_receive(serial, &compare_buf[0], 1, timeout);
-            if(bytes_read != 1) {
-                is_timeout = true;
-                break;
-            }
-            pattern_candidate = js_serial_expect_check_pattern_start(patterns, compare_buf[0], -1);
-            if(pattern_candidate == -1) {
-                continue;
-            }
-            buf_len = 1;
-        }
-        assert(pattern_candidate >= 0);
-
-        // Read next and try to find pattern match
-        PatternArrayItem* pattern_cur = PatternArray_get(patterns, pattern_candidate);
-        pattern_found = pattern_candidate;
-        for(size_t i = 0; i < pattern_cur->len; i++) {
-            if(i >= buf_len) {
-                size_t bytes_read = js_serial_receive(serial, &compare_buf[i], 1, timeout);
-                if(bytes_read != 1) {
-                    is_timeout = true;
-                    break;
-                }
-                buf_len++;
-            }
-            if(compare_buf[i] != pattern_cur->data[i]) {
-                pattern_found = -1;
-                break;
-            }
-        }
-        if((is_timeout) || (pattern_found >= 0)) {
-            break;
-        }
+static void js_serial_expect_poll(struct mjs* mjs) {
+    mjs_val_t obj_inst = mjs_get(mjs, mjs_get_this(mjs), INST_PROP_NAME, ~0);
+    JsSerialInst* serial = mjs_get_ptr(mjs, obj_inst);
+    furi_assert(serial);
+    if(!serial->setup_done) {
+        mjs_prepend_errorf(mjs, MJS_INTERNAL_ERROR, "Serial is not configured");
+        mjs_return(mjs, MJS_UNDEFINED);
+        return;
+    }
 
-        // Search other patterns with the same start char
-        pattern_candidate =
-            js_serial_expect_check_pattern_start(patterns, compare_buf[0], pattern_candidate);
-        if(pattern_candidate >= 0) {
-            continue;
-        }
+    JsSerialPatterns patterns = {0};
 
-        // Look for another pattern start
-        for(size_t i = 1; i < buf_len; i++) {
-            pattern_candidate = js_serial_expect_check_pattern_start(patterns, compare_buf[i], -1);
-            if(pattern_candidate >= 0) {
-                memmove(&compare_buf[0], &compare_buf[i], buf_len - i);
-                buf_len -= i;
-                break;
-            }
-        }
-        if(pattern_candidate >= 0) {
-            continue;
-        }
-        // Nothing found - reset buffer
-        buf_len = 0;
+    if(mjs_nargs(mjs) != 1 || !js_serial_expect_parse_patterns(mjs, mjs_arg(mjs, 0), &patterns) ||
+       !js_serial_expect_load(serial, &patterns)) {
+        free(patterns.data);
+        mjs_prepend_errorf(mjs, MJS_BAD_ARGS_ERROR, "");
+        mjs_return(mjs, MJS_UNDEFINED);
+        return;
     }
 
-    if(is_timeout) {
-        FURI_LOG_W(TAG, "Expect: timeout");
+    // partial matches only carry over if nothing else read the data in between
+    if(serial->poll_offset != serial->rx_offset) {
+        js_serial_expect_restart(serial);
     }
 
-    for(PatternArray_it(it, patterns); !PatternArray_end_p(it); PatternArray_next(it)) {
-        const PatternArrayItem* item = PatternArray_cref(it);
-        free(item->data);
+    PatternMatcherMatch match;
+    mjs_val_t result = MJS_UNDEFINED;
+    if(js_serial_expect_run(serial, false, 0, &match)) {
+        size_t before_len = serial->lookback_len > match.size ?
+                                serial->lookback_len - match.size :
+                                0;
+        result = mjs_mk_object(mjs);
+        JS_ASSIGN_MULTI(mjs, result) {
+            JS_FIELD("index", mjs_mk_number(mjs, match.index));
+            JS_FIELD("offset", mjs_mk_number(mjs, serial->matcher_base + match.offset));
+            JS_FIELD(
+                "before", mjs_mk_string(mjs, (const char*)serial->lookback, before_len, true));
+        }
+        js_serial_expect_restart(serial);
     }
-    PatternArray_clear(patterns);
-    free(compare_buf);
 
-    if(pattern_found >= 0) {
-        mjs_return(mjs, mjs_mk_number(mjs, pattern_found));
-    } else {
-        mjs_return(mjs, MJS_UNDEFINED);
-    }
+    serial->poll_offset = serial->rx_offset;
+    mjs_return(mjs, result);
 }
 
 static void* js_serial_create(struct mjs* mjs, mjs_val_t* object, JsModules* modules) {
     UNUSED(modules);
     JsSerialInst* js_serial = malloc(sizeof(JsSerialInst));
     js_serial->mjs = mjs;
+    js_serial->matcher = pattern_matcher_alloc();
     mjs_val_t serial_obj = mjs_mk_object(mjs);
     mjs_set(mjs, serial_obj, INST_PROP_NAME, ~0, mjs_mk_foreign(mjs, js_serial));
     mjs_set(mjs, serial_obj, "setup", ~0, MJS_MK_FN(js_serial_setup));
@@ -672,6 +765,7 @@ static void* js_serial_create(struct mjs* mjs, mjs_val_t* object, JsModules* mod
     mjs_set(mjs, serial_obj, "readBytes", ~0, MJS_MK_FN(js_serial_read_bytes));
     mjs_set(mjs, serial_obj, "readAny", ~0, MJS_MK_FN(js_serial_read_any));
     mjs_set(mjs, serial_obj, "expect", ~0, MJS_MK_FN(js_serial_expect));
+    mjs_set(mjs, serial_obj, "expectPoll", ~0, MJS_MK_FN(js_serial_expect_poll));
     *object = serial_obj;
 
     return js_serial;
@@ -680,6 +774,8 @@ static void* js_serial_create(struct mjs* mjs, mjs_val_t* object, JsModules* mod
 static void js_serial_destroy(void* inst) {
     JsSerialInst* js_serial = inst;
     js_serial_deinit(js_serial);
+    pattern_matcher_free(js_serial->matcher);
+    free(js_serial->matcher_patterns.data);
     free(js_serial);
 }
 
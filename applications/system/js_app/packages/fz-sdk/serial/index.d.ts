@@ -100,11 +100,40 @@ export declare function readBytes(length: number, timeout?: number): ArrayBuffer
  *                applies to characters, not entire strings.
  * @returns The index of the matched pattern if multiple were provided, or 0 if
  *          only one was provided and it matched, or `undefined` if none of the
- *          patterns matched.
+ *          patterns matched. If several patterns match, the one that ends
+ *          first in the received data wins; on a tie, the one listed first.
+ *          Data received after the match is left for subsequent reads.
  * @version Added in JS SDK 0.1
  */
 export declare function expect(patterns: string | number[] | string[] | number[][], timeout?: number): number | undefined;
 
+/**
+ * @brief Result of `expectPoll`
+ * @version Added in JS SDK 0.1, extra feature `"serial-expect-poll"`
+ */
+export interface ExpectMatch {
+    /** Index of the matched pattern, as returned by `expect` */
+    index: number;
+    /** Number of bytes received since `setup` before the match */
+    offset: number;
+    /** Up to 256 bytes received before the match since the previous one */
+    before: string;
+}
+
+/**
+ * @brief Checks the data received so far against patterns, without waiting
+ *
+ * Takes the same patterns as `expect`. Partial matches are kept between
+ * calls with the same patterns, so this can be called periodically, e.g.
+ * from an event loop, to scan the incoming stream.
+ *
+ * @param patterns Patterns, see `expect`
+ * @returns Match description, or `undefined` if none of the patterns matched
+ *          yet.
+ * @version Added in JS SDK 0.1, extra feature `"serial-expect-poll"`
+ */
+export declare function expectPoll(patterns: string | number[] | string[] | number[][]): ExpectMatch | undefined;
+
 /**
  * @brief Deinitializes the serial port, allowing multiple initializations per script run
  * @version Added in JS SDK 0.1
@@ -15,6 +15,9 @@
 
 #define TAG "UpdWorkerBackup"
 
+#define UPDATE_RESOURCE_MANIFEST_NAME     "Manifest"
+#define UPDATE_RESOURCE_MANIFEST_TMP_NAME "Manifest.new"
+
 static bool update_task_pre_update(UpdateTask* update_task) {
     bool success = false;
     FuriString* backup_file_path;
@@ -38,20 +41,75 @@ static bool update_task_pre_update(UpdateTask* update_task) {
 typedef struct {
     UpdateTask* update_task;
     TarArchive* archive;
+    ResourceManifestIndex* index;
+    uint32_t n_skipped_files;
 } TarUnpackProgress;
 
 static bool update_task_resource_unpack_cb(const char* name, bool is_directory, void* context) {
-    UNUSED(name);
-    UNUSED(is_directory);
     TarUnpackProgress* unpack_progress = context;
     int32_t progress = 0, total = 0;
     tar_archive_get_read_progress(unpack_progress->archive, &progress, &total);
     update_task_set_progress(
         unpack_progress->update_task, UpdateTaskStageProgress, (progress * 100) / (total + 1));
+
+    if(unpack_progress->index && !is_directory) {
+        /* Manifest is put in place last, after all files it lists */
+        if(strcmp(name, UPDATE_RESOURCE_MANIFEST_NAME) == 0) {
+            return false;
+        }
+        /* Unchanged files are seeked over */
+        if(resource_manifest_index_is_installed(unpack_progress->index, name)) {
+            unpack_progress->n_skipped_files++;
+            return false;
+        }
+    }
     return true;
 }
 
-static void update_task_cleanup_resources(UpdateTask* update_task) {
+/* Index new manifest from the bundle, NULL means all resources are to be reinstalled */
+static ResourceManifestIndex*
+    update_task_index_resources(UpdateTask* update_task, TarArchive* archive) {
+    ResourceManifestIndex* index = NULL;
+    FuriString* manifest_path = furi_string_alloc();
+    path_concat(
+        furi_string_get_cstr(update_task->update_path),
+        UPDATE_RESOURCE_MANIFEST_TMP_NAME,
+        manifest_path);
+
+    do {
+        if(!storage_file_exists(update_task->storage, EXT_PATH(UPDATE_RESOURCE_MANIFEST_NAME))) {
+            FURI_LOG_W(TAG, "No existing manifest");
+            break;
+        }
+
+        if(!tar_archive_unpack_file(
+               archive, UPDATE_RESOURCE_MANIFEST_NAME, furi_string_get_cstr(manifest_path))) {
+            FURI_LOG_W(TAG, "No manifest in resource bundle");
+            break;
+        }
+
+        index = resource_manifest_index_alloc(
+            update_task->storage, furi_string_get_cstr(manifest_path));
+    } while(false);
+
+    if(!index) {
+        storage_common_remove(update_task->storage, furi_string_get_cstr(manifest_path));
+    }
+
+    furi_string_free(manifest_path);
+    return index;
+}
+
+static bool update_task_is_resource_installed(
+    UpdateTask* update_task,
+    const ResourceManifestEntry* entry,
+    const char* path) {
+    FileInfo fileinfo;
+    return (storage_common_stat(update_task->storage, path, &fileinfo) == FSE_OK) &&
+           !file_info_is_dir(&fileinfo) && (fileinfo.size == entry->size);
+}
+
+static void update_task_cleanup_resources(UpdateTask* update_task, ResourceManifestIndex* index) {
     ResourceManifestReader* manifest_reader = resource_manifest_reader_alloc(update_task->storage);
     do {
         FURI_LOG_D(TAG, "Cleaning up old manifest");
@@ -84,17 +142,30 @@ static void update_task_cleanup_resources(UpdateTask* update_task) {
                 FuriString* file_path = furi_string_alloc();
                 path_concat(
                     STORAGE_EXT_PATH_PREFIX, furi_string_get_cstr(entry_ptr->name), file_path);
-                FURI_LOG_D(TAG, "Removing %s", furi_string_get_cstr(file_path));
 
-                FS_Error result =
-                    storage_common_remove(update_task->storage, furi_string_get_cstr(file_path));
-                if(result != FSE_OK && result != FSE_EXIST) {
-                    FURI_LOG_E(
-                        TAG,
-                        "%s remove failed, cause %s",
-                        furi_string_get_cstr(file_path),
-                        storage_error_get_desc(result));
+                const ResourceManifestIndexMatch match =
+                    index ? resource_manifest_index_match(index, entry_ptr) :
+                            ResourceManifestIndexMatchNone;
+
+                if(match == ResourceManifestIndexMatchSame &&
+                   update_task_is_resource_installed(
+                       update_task, entry_ptr, furi_string_get_cstr(file_path))) {
+                    resource_manifest_index_set_installed(
+                        index, furi_string_get_cstr(entry_ptr->name));
+                } else if(match == ResourceManifestIndexMatchNone) {
+                    FURI_LOG_D(TAG, "Removing %s", furi_string_get_cstr(file_path));
+
+                    FS_Error result = storage_common_remove(
+                        update_task->storage, furi_string_get_cstr(file_path));
+                    if(result != FSE_OK && result != FSE_EXIST) {
+                        FURI_LOG_E(
+                            TAG,
+                            "%s remove failed, cause %s",
+                            furi_string_get_cstr(file_path),
+                            storage_error_get_desc(result));
+                    }
                 }
+                /* Changed files are overwritten on unpack */
                 furi_string_free(file_path);
             }
         }
@@ -111,6 +182,11 @@ static void update_task_cleanup_resources(UpdateTask* update_task) {
                 FuriString* folder_path = furi_string_alloc();
 
                 do {
+                    if(index && resource_manifest_index_match(index, entry_ptr) !=
+                                    ResourceManifestIndexMatchNone) {
+                        break;
+                    }
+
                     path_concat(
                         STORAGE_EXT_PATH_PREFIX,
                         furi_string_get_cstr(entry_ptr->name),
@@ -166,11 +242,39 @@ static bool update_task_post_update(UpdateTask* update_task) {
             CHECK_RESULT(tar_archive_open(
                 archive, furi_string_get_cstr(file_path), TarOpenModeReadHeatshrink));
 
-            update_task_cleanup_resources(update_task);
+            progress.index = update_task_index_resources(update_task, archive);
+
+            update_task_cleanup_resources(update_task, progress.index);
 
             update_task_set_progress(update_task, UpdateTaskStageResourcesFileUnpack, 0);
             tar_archive_set_file_callback(archive, update_task_resource_unpack_cb, &progress);
-            CHECK_RESULT(tar_archive_unpack_to(archive, STORAGE_EXT_PATH_PREFIX, NULL));
+            const bool unpack_success =
+                tar_archive_unpack_to(archive, STORAGE_EXT_PATH_PREFIX, NULL);
+
+            if(progress.index) {
+                FURI_LOG_I(
+                    TAG,
+                    "%lu of %zu resources unchanged",
+                    progress.n_skipped_files,
+                    resource_manifest_index_get_count(progress.index));
+                resource_manifest_index_free(progress.index);
+
+                path_concat(
+                    furi_string_get_cstr(update_task->update_path),
+                    UPDATE_RESOURCE_MANIFEST_TMP_NAME,
+                    file_path);
+                if(unpack_success) {
+                    CHECK_RESULT(
+                        storage_common_rename(
+                            update_task->storage,
+                            furi_string_get_cstr(file_path),
+                            EXT_PATH(UPDATE_RESOURCE_MANIFEST_NAME)) == FSE_OK);
+                } else {
+                    storage_common_remove(update_task->storage, furi_string_get_cstr(file_path));
+                }
+            }
+
+            CHECK_RESULT(unpack_success);
         }
 
         if(update_task->state.groups & UpdateTaskStageGroupSplashscreen) {
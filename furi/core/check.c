@@ -146,6 +146,9 @@ FURI_NORETURN void __furi_crash_implementation(void) {
         __furi_check_message = "furi_check failed";
     }
 
+    // Records logged right before the crash are the most valuable ones
+    furi_log_flush();
+
     furi_log_puts("\r\n\033[0;31m[CRASH]");
     __furi_print_name(isr);
     furi_log_puts(__furi_check_message);
@@ -193,6 +196,8 @@ FURI_NORETURN void __furi_halt_implementation(void) {
         __furi_check_message = "System halt requested.";
     }
 
+    furi_log_flush();
+
     furi_log_puts("\r\n\033[0;31m[HALT]");
     __furi_print_name(isr);
     furi_log_puts(__furi_check_message);
@@ -1,21 +1,70 @@
-#include "log.h"
+#include "log_i.h"
 #include "check.h"
 #include "mutex.h"
+#include "thread.h"
 #include <furi_hal.h>
+#include <stm32wbxx.h>
 #include <m-list.h>
 
+#include <FreeRTOS.h>
+#include <task.h>
+
 LIST_DEF(FuriLogHandlersList, FuriLogHandler, M_POD_OPLIST)
 
 #define FURI_LOG_LEVEL_DEFAULT FuriLogLevelInfo
 
+#define FURI_LOG_TAG "FuriLog"
+
+/* Records are formatted by the drain thread, producers only copy arguments to the ring */
+#ifndef FURI_LOG_RING_SIZE
+#define FURI_LOG_RING_SIZE (2048U)
+#endif
+
+#define FURI_LOG_RECORD_SIZE_MAX   (512U)
+#define FURI_LOG_LINE_SIZE         (128U)
+#define FURI_LOG_SPEC_SIZE_MAX     (32U)
+#define FURI_LOG_THREAD_STACK_SIZE (1024U)
+#define FURI_LOG_THREAD_FLAG       (1UL << 0)
+
+/* Record header word: size of the record including header, multiple of 4 */
+#define FURI_LOG_HEADER_READY   (1UL << 31)
+#define FURI_LOG_HEADER_PADDING (1UL << 30)
+#define FURI_LOG_HEADER_SIZE    (0xFFFFUL)
+
+#define FURI_LOG_RECORD_RAW           (1U << 0)
+#define FURI_LOG_RECORD_TAG_INLINE    (1U << 1)
+#define FURI_LOG_RECORD_FORMAT_INLINE (1U << 2)
+
+/* Strings in flash outlive the record, anything else (stack, heap, loaded FAPs) is copied */
+#ifndef FURI_LOG_IS_CONST
+#define FURI_LOG_IS_CONST(ptr) \
+    ((uint32_t)(ptr) >= FLASH_BASE && (uint32_t)(ptr) < (FLASH_BASE + FLASH_SIZE))
+#endif
+
+_Static_assert(
+    (FURI_LOG_RING_SIZE & (FURI_LOG_RING_SIZE - 1)) == 0,
+    "FURI_LOG_RING_SIZE must be a power of 2");
+_Static_assert(
+    FURI_LOG_RECORD_SIZE_MAX + 8 <= FURI_LOG_RING_SIZE / 2,
+    "FURI_LOG_RECORD_SIZE_MAX is too big for the ring");
+
 typedef struct {
     FuriLogLevel log_level;
     FuriMutex* mutex;
     FuriLogHandlersList_t tx_handlers;
+
+    FuriThread* thread;
+    FuriThreadId thread_id;
+    uint32_t ring_head; // reserved by producers
+    uint32_t ring_tail; // released by consumer
+    uint32_t dropped;
+    uint32_t dropped_reported;
 } FuriLogParams;
 
 static FuriLogParams furi_log = {0};
 
+static uint32_t furi_log_ring[FURI_LOG_RING_SIZE / sizeof(uint32_t)];
+
 typedef struct {
     const char* str;
     FuriLogLevel level;
@@ -31,6 +80,47 @@ static const FuriLogLevelDescription FURI_LOG_LEVEL_DESCRIPTIONS[] = {
     {"trace", FuriLogLevelTrace},
 };
 
+typedef enum {
+    FuriLogArgNone,
+    FuriLogArgInt,
+    FuriLogArgLong,
+    FuriLogArgLongLong,
+    FuriLogArgSize,
+    FuriLogArgPtrdiff,
+    FuriLogArgIntmax,
+    FuriLogArgDouble,
+    FuriLogArgLongDouble,
+    FuriLogArgPointer,
+    FuriLogArgString,
+    FuriLogArgInvalid,
+} FuriLogArg;
+
+typedef struct {
+    FuriLogArg arg;
+    bool width_star;
+    bool precision_star;
+    int32_t precision; // -1 if not specified
+    size_t size; // including '%' and conversion
+} FuriLogSpec;
+
+typedef struct {
+    uint8_t* data; // NULL when only measuring
+    size_t size;
+    size_t capacity;
+} FuriLogEncoder;
+
+typedef struct {
+    const uint8_t* data;
+    const uint8_t* end;
+} FuriLogDecoder;
+
+typedef struct {
+    size_t size;
+    char data[FURI_LOG_LINE_SIZE];
+} FuriLogLine;
+
+static int32_t furi_log_thread(void* context);
+
 void furi_log_init(void) {
     // Set default logging parameters
     furi_log.log_level = FURI_LOG_LEVEL_DEFAULT;
@@ -38,6 +128,17 @@ void furi_log_init(void) {
     FuriLogHandlersList_init(furi_log.tx_handlers);
 }
 
+void furi_log_thread_start(void) {
+    furi_check(furi_log.thread == NULL);
+
+    // Records put before this point stay in the ring until the thread runs
+    furi_log.thread = furi_thread_alloc_service(
+        "LogDrain", FURI_LOG_THREAD_STACK_SIZE, furi_log_thread, NULL);
+    furi_thread_set_priority(furi_log.thread, FuriThreadPriorityLow);
+    furi_thread_start(furi_log.thread);
+    furi_log.thread_id = furi_thread_get_id(furi_log.thread);
+}
+
 bool furi_log_add_handler(FuriLogHandler handler) {
     furi_check(handler.callback);
 
@@ -107,80 +208,619 @@ void furi_log_puts(const char* data) {
     furi_log_tx((const uint8_t*)data, strlen(data));
 }
 
-void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...) {
-    do {
-        if(level > furi_log.log_level) {
-            break;
+static size_t furi_log_spec_parse(const char* format, FuriLogSpec* spec) {
+    const char* p = format + 1;
+
+    spec->arg = FuriLogArgInvalid;
+    spec->width_star = false;
+    spec->precision_star = false;
+    spec->precision = -1;
+
+    while(*p && strchr("-+ #0", *p)) {
+        p++;
+    }
+
+    if(*p == '*') {
+        spec->width_star = true;
+        p++;
+    } else {
+        while(*p >= '0' && *p <= '9') {
+            p++;
         }
+    }
 
-        if(furi_mutex_acquire(furi_log.mutex, furi_kernel_is_running() ? FuriWaitForever : 0) !=
-           FuriStatusOk) {
-            break;
+    if(*p == '.') {
+        p++;
+        if(*p == '*') {
+            spec->precision_star = true;
+            p++;
+        } else {
+            spec->precision = 0;
+            while(*p >= '0' && *p <= '9') {
+                if(spec->precision < UINT16_MAX) spec->precision = spec->precision * 10 + *p - '0';
+                p++;
+            }
+        }
+    }
+
+    char length = '\0';
+    if(*p == 'h') {
+        p++;
+        if(*p == 'h') p++;
+    } else if(*p == 'l') {
+        length = *p++;
+        if(*p == 'l') {
+            length = 'q';
+            p++;
+        }
+    } else if(*p && strchr("jztL", *p)) {
+        length = *p++;
+    }
+
+    const char conversion = *p;
+    if(conversion) p++;
+
+    switch(conversion) {
+    case '%':
+        spec->arg = FuriLogArgNone;
+        break;
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'c':
+        if(length == '\0') {
+            spec->arg = FuriLogArgInt;
+        } else if(conversion == 'c') {
+            spec->arg = FuriLogArgInvalid;
+        } else if(length == 'l') {
+            spec->arg = FuriLogArgLong;
+        } else if(length == 'q') {
+            spec->arg = FuriLogArgLongLong;
+        } else if(length == 'z') {
+            spec->arg = FuriLogArgSize;
+        } else if(length == 't') {
+            spec->arg = FuriLogArgPtrdiff;
+        } else if(length == 'j') {
+            spec->arg = FuriLogArgIntmax;
+        }
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if(length == '\0' || length == 'l') {
+            spec->arg = FuriLogArgDouble;
+        } else if(length == 'L') {
+            spec->arg = FuriLogArgLongDouble;
         }
+        break;
+    case 'p':
+        spec->arg = FuriLogArgPointer;
+        break;
+    case 's':
+        if(length == '\0') spec->arg = FuriLogArgString;
+        break;
+    default:
+        break;
+    }
 
-        FuriString* string = furi_string_alloc();
+    spec->size = p - format;
+    return spec->size;
+}
 
-        const char* color = _FURI_LOG_CLR_RESET;
-        const char* log_letter = " ";
-        switch(level) {
-        case FuriLogLevelError:
-            color = _FURI_LOG_CLR_E;
-            log_letter = "E";
-            break;
-        case FuriLogLevelWarn:
-            color = _FURI_LOG_CLR_W;
-            log_letter = "W";
-            break;
-        case FuriLogLevelInfo:
-            color = _FURI_LOG_CLR_I;
-            log_letter = "I";
+static void furi_log_encode(FuriLogEncoder* encoder, const void* data, size_t size) {
+    if(encoder->size + size > encoder->capacity) {
+        encoder->size = encoder->capacity;
+        return;
+    }
+    if(encoder->data) memcpy(&encoder->data[encoder->size], data, size);
+    encoder->size += size;
+}
+
+static void furi_log_encode_string(FuriLogEncoder* encoder, const char* str, size_t size_max) {
+    if(encoder->size >= encoder->capacity) return;
+
+    size_t size = strnlen(str, MIN(size_max, encoder->capacity - encoder->size - 1));
+    if(encoder->data) {
+        memcpy(&encoder->data[encoder->size], str, size);
+        encoder->data[encoder->size + size] = '\0';
+    }
+    encoder->size += size + 1;
+}
+
+static void furi_log_encode_const(FuriLogEncoder* encoder, const char* str, uint8_t inline_flag) {
+    if(inline_flag) {
+        furi_log_encode_string(encoder, str, SIZE_MAX);
+    } else {
+        furi_log_encode(encoder, &str, sizeof(str));
+    }
+}
+
+static void furi_log_encode_args(FuriLogEncoder* encoder, const char* format, va_list* args) {
+    while((format = strchr(format, '%')) != NULL) {
+        FuriLogSpec spec;
+        format += furi_log_spec_parse(format, &spec);
+
+        if(spec.arg == FuriLogArgInvalid) break;
+
+        if(spec.width_star) {
+            int width = va_arg(*args, int);
+            furi_log_encode(encoder, &width, sizeof(width));
+        }
+        if(spec.precision_star) {
+            int precision = va_arg(*args, int);
+            furi_log_encode(encoder, &precision, sizeof(precision));
+            spec.precision = precision < 0 ? -1 : precision;
+        }
+
+        switch(spec.arg) {
+        case FuriLogArgInt: {
+            int value = va_arg(*args, int);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgLong: {
+            long value = va_arg(*args, long);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgLongLong: {
+            long long value = va_arg(*args, long long);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgSize: {
+            size_t value = va_arg(*args, size_t);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgPtrdiff: {
+            ptrdiff_t value = va_arg(*args, ptrdiff_t);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgIntmax: {
+            intmax_t value = va_arg(*args, intmax_t);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgDouble: {
+            double value = va_arg(*args, double);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgLongDouble: {
+            long double value = va_arg(*args, long double);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgPointer: {
+            void* value = va_arg(*args, void*);
+            furi_log_encode(encoder, &value, sizeof(value));
+        } break;
+        case FuriLogArgString: {
+            const char* value = va_arg(*args, const char*);
+            furi_log_encode_string(
+                encoder,
+                value ? value : "(null)",
+                spec.precision < 0 ? SIZE_MAX : (size_t)spec.precision);
+        } break;
+        default:
             break;
-        case FuriLogLevelDebug:
-            color = _FURI_LOG_CLR_D;
-            log_letter = "D";
+        }
+    }
+}
+
+static void furi_log_encode_record(
+    FuriLogEncoder* encoder,
+    FuriLogLevel level,
+    uint8_t flags,
+    const char* tag,
+    const char* format,
+    va_list* args) {
+    const uint32_t tick = furi_get_tick();
+    const uint8_t level_byte = level;
+    furi_log_encode(encoder, &tick, sizeof(tick));
+    furi_log_encode(encoder, &level_byte, sizeof(level_byte));
+    furi_log_encode(encoder, &flags, sizeof(flags));
+    if(!(flags & FURI_LOG_RECORD_RAW)) {
+        furi_log_encode_const(encoder, tag, flags & FURI_LOG_RECORD_TAG_INLINE);
+    }
+    furi_log_encode_const(encoder, format, flags & FURI_LOG_RECORD_FORMAT_INLINE);
+    furi_log_encode_args(encoder, format, args);
+}
+
+static uint8_t* furi_log_ring_reserve(uint32_t size) {
+    uint8_t* ring = (uint8_t*)furi_log_ring;
+    uint32_t head = __atomic_load_n(&furi_log.ring_head, __ATOMIC_RELAXED);
+    uint32_t offset;
+    uint32_t padding;
+
+    do {
+        offset = head % FURI_LOG_RING_SIZE;
+        // Records never wrap, the tail of the ring is skipped instead
+        padding = (offset + size > FURI_LOG_RING_SIZE) ? FURI_LOG_RING_SIZE - offset : 0;
+        uint32_t tail = __atomic_load_n(&furi_log.ring_tail, __ATOMIC_ACQUIRE);
+        if(head + padding + size - tail > FURI_LOG_RING_SIZE) {
+            return NULL;
+        }
+    } while(!__atomic_compare_exchange_n(
+        &furi_log.ring_head,
+        &head,
+        head + padding + size,
+        true,
+        __ATOMIC_ACQ_REL,
+        __ATOMIC_RELAXED));
+
+    if(padding) {
+        __atomic_store_n(
+            (uint32_t*)&ring[offset],
+            FURI_LOG_HEADER_READY | FURI_LOG_HEADER_PADDING | padding,
+            __ATOMIC_RELEASE);
+        offset = 0;
+    }
+
+    return &ring[offset];
+}
+
+static void
+    furi_log_record_put(FuriLogLevel level, const char* tag, const char* format, va_list args) {
+    uint8_t flags = 0;
+    if(tag == NULL) {
+        flags |= FURI_LOG_RECORD_RAW;
+    } else if(!FURI_LOG_IS_CONST(tag)) {
+        flags |= FURI_LOG_RECORD_TAG_INLINE;
+    }
+    if(!FURI_LOG_IS_CONST(format)) {
+        flags |= FURI_LOG_RECORD_FORMAT_INLINE;
+    }
+
+    // Measure, then encode in place: arguments are walked twice, nothing is staged
+    FuriLogEncoder encoder = {.data = NULL, .size = 0, .capacity = FURI_LOG_RECORD_SIZE_MAX};
+    va_list args_copy;
+    va_copy(args_copy, args);
+    furi_log_encode_record(&encoder, level, flags, tag, format, &args_copy);
+    va_end(args_copy);
+
+    const uint32_t size =
+        (sizeof(uint32_t) + encoder.size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+    uint8_t* record = furi_log_ring_reserve(size);
+    if(!record) {
+        __atomic_fetch_add(&furi_log.dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // Strings may change between passes, capacity keeps the record in its slot
+    encoder.data = record + sizeof(uint32_t);
+    encoder.size = 0;
+    encoder.capacity = size - sizeof(uint32_t);
+    va_copy(args_copy, args);
+    furi_log_encode_record(&encoder, level, flags, tag, format, &args_copy);
+    va_end(args_copy);
+
+    __atomic_store_n((uint32_t*)record, FURI_LOG_HEADER_READY | size, __ATOMIC_RELEASE);
+
+    if(furi_log.thread_id && (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)) {
+        furi_thread_flags_set(furi_log.thread_id, FURI_LOG_THREAD_FLAG);
+    }
+}
+
+static void furi_log_line_flush(FuriLogLine* line) {
+    if(line->size) {
+        furi_log_tx((const uint8_t*)line->data, line->size);
+        line->size = 0;
+    }
+}
+
+static void furi_log_line_write(FuriLogLine* line, const char* data, size_t size) {
+    while(size) {
+        size_t chunk = MIN(size, sizeof(line->data) - line->size);
+        memcpy(&line->data[line->size], data, chunk);
+        line->size += chunk;
+        data += chunk;
+        size -= chunk;
+        if(line->size == sizeof(line->data)) furi_log_line_flush(line);
+    }
+}
+
+static void furi_log_line_printf(FuriLogLine* line, const char* format, ...)
+    _ATTRIBUTE((__format__(__printf__, 2, 3)));
+
+static void furi_log_line_printf(FuriLogLine* line, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t space = sizeof(line->data) - line->size;
+    int size = vsnprintf(&line->data[line->size], space, format, args);
+    va_end(args);
+
+    if(size < 0) return;
+
+    if((size_t)size >= space) {
+        // Retry from the start of the line, longer output is truncated
+        furi_log_line_flush(line);
+        va_start(args, format);
+        size = vsnprintf(line->data, sizeof(line->data), format, args);
+        va_end(args);
+        if(size < 0) return;
+        size = MIN((size_t)size, sizeof(line->data) - 1);
+    }
+
+    line->size += size;
+    if(line->size == sizeof(line->data) - 1) furi_log_line_flush(line);
+}
+
+static void furi_log_decode(FuriLogDecoder* decoder, void* data, size_t size) {
+    if(decoder->data + size > decoder->end) {
+        memset(data, 0, size);
+        decoder->data = decoder->end;
+    } else {
+        memcpy(data, decoder->data, size);
+        decoder->data += size;
+    }
+}
+
+static const char* furi_log_decode_string(FuriLogDecoder* decoder) {
+    const char* str = (const char*)decoder->data;
+    size_t size = strnlen(str, decoder->end - decoder->data);
+    if(decoder->data + size == decoder->end) return "";
+    decoder->data += size + 1;
+    return str;
+}
+
+static const char* furi_log_decode_const(FuriLogDecoder* decoder, bool is_inline) {
+    if(is_inline) return furi_log_decode_string(decoder);
+
+    const char* str;
+    furi_log_decode(decoder, &str, sizeof(str));
+    return str ? str : "";
+}
+
+static int furi_log_decode_int(FuriLogDecoder* decoder) {
+    int value;
+    furi_log_decode(decoder, &value, sizeof(value));
+    return value;
+}
+
+static void furi_log_line_format(FuriLogLine* line, const char* format, FuriLogDecoder* decoder) {
+    while(*format) {
+        if(*format != '%') {
+            const char* next = strchr(format, '%');
+            size_t size = next ? (size_t)(next - format) : strlen(format);
+            furi_log_line_write(line, format, size);
+            format += size;
+            continue;
+        }
+
+        FuriLogSpec spec;
+        furi_log_spec_parse(format, &spec);
+
+        if(spec.arg == FuriLogArgInvalid || spec.size >= FURI_LOG_SPEC_SIZE_MAX / 2) {
+            furi_log_line_write(line, format, strlen(format));
             break;
-        case FuriLogLevelTrace:
-            color = _FURI_LOG_CLR_T;
-            log_letter = "T";
+        } else if(spec.arg == FuriLogArgNone) {
+            furi_log_line_write(line, "%", 1);
+            format += spec.size;
+            continue;
+        }
+
+        // Rebuild the conversion spec with '*' replaced by the recorded values
+        char spec_str[FURI_LOG_SPEC_SIZE_MAX];
+        size_t spec_size = 0;
+        for(size_t i = 0; i < spec.size; i++) {
+            if(format[i] == '*') {
+                spec_size += snprintf(
+                    &spec_str[spec_size],
+                    sizeof(spec_str) - spec_size,
+                    "%d",
+                    furi_log_decode_int(decoder));
+            } else if(format[i] == '.' && format[i + 1] == '*') {
+                int precision = furi_log_decode_int(decoder);
+                if(precision >= 0) {
+                    spec_size += snprintf(
+                        &spec_str[spec_size], sizeof(spec_str) - spec_size, ".%d", precision);
+                }
+                i++;
+            } else {
+                spec_str[spec_size++] = format[i];
+            }
+            spec_size = MIN(spec_size, sizeof(spec_str) - 2);
+        }
+        spec_str[spec_size] = '\0';
+        format += spec.size;
+
+        switch(spec.arg) {
+        case FuriLogArgInt:
+            furi_log_line_printf(line, spec_str, furi_log_decode_int(decoder));
             break;
+        case FuriLogArgLong: {
+            long value;
+            furi_log_decode(decoder, &value, sizeof(value));
+            furi_log_line_printf(line, spec_str, value);
+        } break;
+        case FuriLogArgLongLong: {
+            long long value;
+            furi_log_decode(decoder, &value, sizeof(value));
+            furi_log_line_printf(line, spec_str, value);
+        } break;
+        case FuriLogArgSize: {
+            size_t value;
+            furi_log_decode(decoder, &value, sizeof(value));
+            furi_log_line_printf(line, spec_str, value);
+        } break;
+        case FuriLogArgPtrdiff: {
+            ptrdiff_t value;
+            furi_log_decode(decoder, &value, sizeof(value));
+            furi_log_line_printf(line, spec_str, value);
+        } break;
+        case FuriLogArgIntmax: {
+            intmax_t value;
+            furi_log_decode(decoder, &value, sizeof(value));
+            furi_log_line_printf(line, spec_str, value);
+        } break;
+        case FuriLogArgDouble: {
+            double value;
+            furi_log_decode(decoder, &value, sizeof(value));
+            furi_log_line_printf(line, spec_str, value);
+        } break;
+        case FuriLogArgLongDouble: {
+            long double value;
+            furi_log_decode(decoder, &value, sizeof(value));
+            furi_log_line_printf(line, spec_str, value);
+        } break;
+        case FuriLogArgPointer: {
+            void* value;
+            furi_log_decode(decoder, &value, sizeof(value));
+            furi_log_line_printf(line, spec_str, value);
+        } break;
+        case FuriLogArgString: {
+            const char* value = furi_log_decode_string(decoder);
+            if(spec_size == 2) {
+                // Plain "%s" is not limited by the line size
+                furi_log_line_write(line, value, strlen(value));
+            } else {
+                furi_log_line_printf(line, spec_str, value);
+            }
+        } break;
         default:
             break;
         }
+    }
+}
 
-        // Timestamp
-        furi_string_printf(
-            string, "%lu %s[%s][%s] " _FURI_LOG_CLR_RESET, furi_get_tick(), color, log_letter, tag);
-        furi_log_puts(furi_string_get_cstr(string));
-        furi_string_reset(string);
+static void
+    furi_log_line_header(FuriLogLine* line, uint32_t tick, uint8_t level, const char* tag) {
+    const char* color = _FURI_LOG_CLR_RESET;
+    const char* log_letter = " ";
+    switch(level) {
+    case FuriLogLevelError:
+        color = _FURI_LOG_CLR_E;
+        log_letter = "E";
+        break;
+    case FuriLogLevelWarn:
+        color = _FURI_LOG_CLR_W;
+        log_letter = "W";
+        break;
+    case FuriLogLevelInfo:
+        color = _FURI_LOG_CLR_I;
+        log_letter = "I";
+        break;
+    case FuriLogLevelDebug:
+        color = _FURI_LOG_CLR_D;
+        log_letter = "D";
+        break;
+    case FuriLogLevelTrace:
+        color = _FURI_LOG_CLR_T;
+        log_letter = "T";
+        break;
+    default:
+        break;
+    }
 
-        va_list args;
-        va_start(args, format);
-        furi_string_vprintf(string, format, args);
-        va_end(args);
+    // Timestamp
+    furi_log_line_printf(
+        line, "%lu %s[%s][%s] " _FURI_LOG_CLR_RESET, tick, color, log_letter, tag);
+}
 
-        furi_log_puts(furi_string_get_cstr(string));
-        furi_string_free(string);
+static void furi_log_record_output(FuriLogLine* line, const uint8_t* data, const uint8_t* end) {
+    FuriLogDecoder decoder = {.data = data, .end = end};
 
-        furi_log_puts("\r\n");
+    uint32_t tick;
+    uint8_t level;
+    uint8_t flags;
+    furi_log_decode(&decoder, &tick, sizeof(tick));
+    furi_log_decode(&decoder, &level, sizeof(level));
+    furi_log_decode(&decoder, &flags, sizeof(flags));
 
-        furi_mutex_release(furi_log.mutex);
-    } while(0);
+    if(flags & FURI_LOG_RECORD_RAW) {
+        const char* format =
+            furi_log_decode_const(&decoder, flags & FURI_LOG_RECORD_FORMAT_INLINE);
+        furi_log_line_format(line, format, &decoder);
+    } else {
+        const char* tag = furi_log_decode_const(&decoder, flags & FURI_LOG_RECORD_TAG_INLINE);
+        const char* format =
+            furi_log_decode_const(&decoder, flags & FURI_LOG_RECORD_FORMAT_INLINE);
+        furi_log_line_header(line, tick, level, tag);
+        furi_log_line_format(line, format, &decoder);
+        furi_log_line_write(line, "\r\n", 2);
+    }
 }
 
-void furi_log_print_raw_format(FuriLogLevel level, const char* format, ...) {
-    if(level <= furi_log.log_level &&
-       furi_mutex_acquire(furi_log.mutex, FuriWaitForever) == FuriStatusOk) {
-        FuriString* string;
-        string = furi_string_alloc();
+static void furi_log_drain(void) {
+    uint8_t* ring = (uint8_t*)furi_log_ring;
+    uint32_t tail = furi_log.ring_tail;
+    FuriLogLine line = {.size = 0};
+
+    while(true) {
+        uint8_t* record = &ring[tail % FURI_LOG_RING_SIZE];
+        const uint32_t header = __atomic_load_n((uint32_t*)record, __ATOMIC_ACQUIRE);
+        // Record is not committed yet, its producer will wake us up again
+        if(!(header & FURI_LOG_HEADER_READY)) break;
+
+        const uint32_t size = header & FURI_LOG_HEADER_SIZE;
+        if(!(header & FURI_LOG_HEADER_PADDING)) {
+            furi_log_record_output(&line, record + sizeof(uint32_t), record + size);
+        }
+
+        // Producers rely on free space being zeroed
+        memset(record, 0, size);
+        tail += size;
+        __atomic_store_n(&furi_log.ring_tail, tail, __ATOMIC_RELEASE);
+    }
+
+    const uint32_t dropped = __atomic_load_n(&furi_log.dropped, __ATOMIC_RELAXED);
+    if(dropped != furi_log.dropped_reported) {
+        furi_log_line_header(&line, furi_get_tick(), FuriLogLevelWarn, FURI_LOG_TAG);
+        furi_log_line_printf(
+            &line, "%lu records dropped\r\n", dropped - furi_log.dropped_reported);
+        furi_log.dropped_reported = dropped;
+    }
+
+    furi_log_line_flush(&line);
+}
+
+static int32_t furi_log_thread(void* context) {
+    UNUSED(context);
+
+    // Records logged before the scheduler start are waiting already
+    while(true) {
+        furi_log_flush();
+        furi_thread_flags_wait(FURI_LOG_THREAD_FLAG, FuriFlagWaitAny, FuriWaitForever);
+    }
+
+    return 0;
+}
+
+void furi_log_flush(void) {
+    if(!FURI_IS_ISR()) {
+        furi_check(furi_mutex_acquire(furi_log.mutex, FuriWaitForever) == FuriStatusOk);
+    } else {
+        // Consumer may be interrupted in the middle of a record
+        if(furi_mutex_get_owner(furi_log.mutex)) return;
+    }
+
+    furi_log_drain();
+
+    if(!FURI_IS_ISR()) furi_mutex_release(furi_log.mutex);
+}
+
+uint32_t furi_log_get_dropped_count(void) {
+    return __atomic_load_n(&furi_log.dropped, __ATOMIC_RELAXED);
+}
+
+void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...) {
+    if(level <= furi_log.log_level) {
         va_list args;
         va_start(args, format);
-        furi_string_vprintf(string, format, args);
+        furi_log_record_put(level, tag ? tag : "", format, args);
         va_end(args);
+    }
+}
 
-        furi_log_puts(furi_string_get_cstr(string));
-        furi_string_free(string);
-
-        furi_mutex_release(furi_log.mutex);
+void furi_log_print_raw_format(FuriLogLevel level, const char* format, ...) {
+    if(level <= furi_log.log_level) {
+        va_list args;
+        va_start(args, format);
+        furi_log_record_put(level, NULL, format, args);
+        va_end(args);
     }
 }
 
@@ -79,6 +79,11 @@ void furi_log_tx(const uint8_t* data, size_t size);
 void furi_log_puts(const char* data);
 
 /** Print log record
+ *
+ * Record is formatted later by the log thread: arguments are copied to the
+ * log ring, strings included. Formats and tags outside of flash are copied
+ * too. Never blocks, records that do not fit into the ring are dropped.
+ * Conversions beyond standard printf ones, like %n, end the record.
  * 
  * @param level 
  * @param tag 
@@ -97,6 +102,19 @@ void furi_log_print_format(FuriLogLevel level, const char* tag, const char* form
 void furi_log_print_raw_format(FuriLogLevel level, const char* format, ...)
     _ATTRIBUTE((__format__(__printf__, 2, 3)));
 
+/** Output pending log records
+ *
+ * Formats pending records in the calling thread. Called on crash, before
+ * the crash report.
+ */
+void furi_log_flush(void);
+
+/** Get number of log records dropped because the log ring was full
+ *
+ * @return     Total number of dropped records
+ */
+uint32_t furi_log_get_dropped_count(void);
+
 /** Set log level
  *
  * @param[in]  level  The level
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "log.h"
+
+/** Start the thread that prints log records, requires early HAL init */
+void furi_log_thread_start(void);
@@ -23,11 +23,14 @@
 
 #define THREAD_MAX_STACK_SIZE (UINT16_MAX * sizeof(StackType_t))
 
+#define THREAD_STDOUT_BUFFER_SIZE (128U)
+
 typedef struct FuriThreadStdout FuriThreadStdout;
 
 struct FuriThreadStdout {
     FuriThreadStdoutWriteCallback write_callback;
-    FuriString* buffer;
+    char* buffer; // allocated on first buffered write
+    size_t buffer_used;
 };
 
 struct FuriThread {
@@ -72,6 +75,7 @@ static FuriMessageQueue* furi_thread_scrub_message_queue = NULL;
 
 static size_t __furi_thread_stdout_write(FuriThread* thread, const char* data, size_t size);
 static int32_t __furi_thread_stdout_flush(FuriThread* thread);
+static void __furi_thread_stdout_release(FuriThread* thread);
 
 /** Catch threads that are trying to exit wrong way */
 __attribute__((__noreturn__)) void furi_thread_catch(void) { //-V1082
@@ -109,6 +113,10 @@ static void furi_thread_body(void* context) {
 
     furi_check(!thread->is_service, "Service threads MUST NOT return");
 
+    // flush stdout, buffer belongs to thread and must not affect allocation balance
+    __furi_thread_stdout_flush(thread);
+    __furi_thread_stdout_release(thread);
+
     if(thread->heap_trace_enabled == true) {
         furi_delay_ms(33);
         thread->heap_size = memmgr_heap_get_thread_memory((FuriThreadId)thread);
@@ -123,9 +131,6 @@ static void furi_thread_body(void* context) {
 
     furi_check(thread->state == FuriThreadStateRunning);
 
-    // flush stdout
-    __furi_thread_stdout_flush(thread);
-
     furi_thread_set_state(thread, FuriThreadStateStopping);
 
     furi_message_queue_put(furi_thread_scrub_message_queue, &thread, FuriWaitForever);
@@ -135,7 +140,8 @@ static void furi_thread_body(void* context) {
 }
 
 static void furi_thread_init_common(FuriThread* thread) {
-    thread->output.buffer = furi_string_alloc();
+    thread->output.buffer = NULL;
+    thread->output.buffer_used = 0;
 
     FuriThread* parent = NULL;
     if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
@@ -244,7 +250,7 @@ void furi_thread_free(FuriThread* thread) {
         free(thread->stack_buffer);
     }
 
-    furi_string_free(thread->output.buffer);
+    __furi_thread_stdout_release(thread);
     free(thread);
 }
 
@@ -718,15 +724,36 @@ static size_t __furi_thread_stdout_write(FuriThread* thread, const char* data, s
 }
 
 static int32_t __furi_thread_stdout_flush(FuriThread* thread) {
-    FuriString* buffer = thread->output.buffer;
-    size_t size = furi_string_size(buffer);
-    if(size > 0) {
-        __furi_thread_stdout_write(thread, furi_string_get_cstr(buffer), size);
-        furi_string_reset(buffer);
+    if(thread->output.buffer_used > 0) {
+        __furi_thread_stdout_write(thread, thread->output.buffer, thread->output.buffer_used);
+        thread->output.buffer_used = 0;
     }
     return 0;
 }
 
+static void __furi_thread_stdout_release(FuriThread* thread) {
+    free(thread->output.buffer);
+    thread->output.buffer = NULL;
+    thread->output.buffer_used = 0;
+}
+
+static void __furi_thread_stdout_append(FuriThread* thread, const char* data, size_t size) {
+    if(thread->output.buffer_used + size > THREAD_STDOUT_BUFFER_SIZE) {
+        __furi_thread_stdout_flush(thread);
+    }
+
+    if(size >= THREAD_STDOUT_BUFFER_SIZE) {
+        // nothing to gain from copying
+        __furi_thread_stdout_write(thread, data, size);
+    } else {
+        if(thread->output.buffer == NULL) {
+            thread->output.buffer = malloc(THREAD_STDOUT_BUFFER_SIZE);
+        }
+        memcpy(&thread->output.buffer[thread->output.buffer_used], data, size);
+        thread->output.buffer_used += size;
+    }
+}
+
 void furi_thread_set_stdout_callback(FuriThreadStdoutWriteCallback callback) {
     FuriThread* thread = furi_thread_get_current();
     furi_check(thread);
@@ -747,18 +774,18 @@ size_t furi_thread_stdout_write(const char* data, size_t size) {
     if(size == 0 || data == NULL) {
         return __furi_thread_stdout_flush(thread);
     } else {
-        if(data[size - 1] == '\n') {
-            // if the last character is a newline, we can flush buffer and write data as is, wo buffers
+        // everything up to the last newline goes out now, the rest waits for the next one
+        size_t lines_size = size;
+        while(lines_size > 0 && data[lines_size - 1] != '\n') {
+            lines_size--;
+        }
+
+        if(lines_size > 0) {
+            __furi_thread_stdout_append(thread, data, lines_size);
             __furi_thread_stdout_flush(thread);
-            __furi_thread_stdout_write(thread, data, size);
-        } else {
-            // string_cat doesn't work here because we need to write the exact size data
-            for(size_t i = 0; i < size; i++) {
-                furi_string_push_back(thread->output.buffer, data[i]);
-                if(data[i] == '\n') {
-                    __furi_thread_stdout_flush(thread);
-                }
-            }
+        }
+        if(lines_size < size) {
+            __furi_thread_stdout_append(thread, &data[lines_size], size - lines_size);
         }
     }
 
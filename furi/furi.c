@@ -1,5 +1,6 @@
 #include "furi.h"
 
+#include "core/log_i.h"
 #include "core/thread_i.h"
 
 #include <FreeRTOS.h>
@@ -18,6 +19,9 @@ void furi_run(void) {
     furi_check(!furi_kernel_is_irq_or_masked());
     furi_check(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED);
 
+    /* Thread creation needs the HAL, so it can not be done in furi_init */
+    furi_log_thread_start();
+
     /* Start the kernel scheduler */
     vTaskStartScheduler();
 }
@@ -41,6 +41,39 @@ typedef enum {
  */
 void bit_lib_push_bit(uint8_t* data, size_t data_size, bool bit);
 
+typedef struct BitLibRing BitLibRing;
+
+/** @brief Allocate a bit ring, a constant-time alternative to bit_lib_push_bit.
+ *  @param size window size in bits
+ *  @return BitLibRing instance
+ */
+BitLibRing* bit_lib_ring_alloc(size_t size);
+
+/** @brief Free a bit ring.
+ *  @param ring BitLibRing instance
+ */
+void bit_lib_ring_free(BitLibRing* ring);
+
+/** @brief Clear all bits in a bit ring.
+ *  @param ring BitLibRing instance
+ */
+void bit_lib_ring_reset(BitLibRing* ring);
+
+/** @brief Push a bit into a bit ring, dropping the oldest one.
+ *  @param ring BitLibRing instance
+ *  @param bit bit to push
+ */
+void bit_lib_ring_push_bit(BitLibRing* ring, bool bit);
+
+/** @brief Get a contiguous view of the bit ring window.
+ *  Window bits are laid out exactly as bit_lib_push_bit would leave them in
+ *  a buffer of the same size, starting at the returned bit position.
+ *  @param ring BitLibRing instance
+ *  @param position pointer to store window start bit position
+ *  @return data to be used with bit_lib_get_bit* functions
+ */
+const uint8_t* bit_lib_ring_get_data(const BitLibRing* ring, size_t* position);
+
 /** @brief Set a bit in a byte array.
  *  @param data array to set bit in
  *  @param position The position of the bit to set.
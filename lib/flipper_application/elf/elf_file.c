@@ -11,7 +11,7 @@
 #define ELF_NAME_BUFFER_LEN 32
 #define SECTION_OFFSET(e, n) ((e)->section_table + (n) * sizeof(Elf32_Shdr))
 #define IS_FLAGS_SET(v, m) (((v) & (m)) == (m))
-#define RESOLVER_THREAD_YIELD_STEP 30
+#define RELOCATION_CHUNK_ENTRIES 64
 #define FAST_RELOCATION_VERSION 1
 
 // #define ELF_DEBUG_LOG 1
@@ -358,72 +358,81 @@ static bool elf_relocate_symbol(ELFFile* elf, Elf32_Addr relAddr, int type, Elf3
 
 static bool elf_relocate(ELFFile* elf, ELFSection* s) {
     if(s->data) {
-        Elf32_Rel rel;
         size_t relEntries = s->rel_count;
-        size_t relCount;
-        (void)storage_file_seek(elf->fd, s->rel_offset, true);
+        size_t chunkEntries = MIN(relEntries, (size_t)RELOCATION_CHUNK_ENTRIES);
+        Elf32_Rel* rels = malloc(sizeof(Elf32_Rel) * chunkEntries);
         FURI_LOG_D(TAG, " Offset   Info     Type             Name");
 
         int relocate_result = true;
+        bool read_result = true;
         FuriString* symbol_name;
         symbol_name = furi_string_alloc();
 
-        for(relCount = 0; relCount < relEntries; relCount++) {
-            if(relCount % RESOLVER_THREAD_YIELD_STEP == 0) {
-                FURI_LOG_D(TAG, "  reloc YIELD");
-                furi_delay_tick(1);
-            }
+        // Relocation table is read in chunks, symbol lookups below move the file position
+        for(size_t relCount = 0; read_result && relCount < relEntries; relCount += chunkEntries) {
+            chunkEntries = MIN(relEntries - relCount, (size_t)RELOCATION_CHUNK_ENTRIES);
+            size_t chunkSize = chunkEntries * sizeof(Elf32_Rel);
+
+            // Yield once per chunk
+            FURI_LOG_D(TAG, "  reloc YIELD");
+            furi_delay_tick(1);
 
-            if(storage_file_read(elf->fd, &rel, sizeof(Elf32_Rel)) != sizeof(Elf32_Rel)) {
+            if(!storage_file_seek(elf->fd, s->rel_offset + relCount * sizeof(Elf32_Rel), true) ||
+               storage_file_read(elf->fd, rels, chunkSize) != chunkSize) {
                 FURI_LOG_E(TAG, "  reloc read fail");
-                furi_string_free(symbol_name);
-                return false;
+                read_result = false;
+                break;
             }
 
-            Elf32_Addr symAddr;
-
-            int symEntry = ELF32_R_SYM(rel.r_info);
-            int relType = ELF32_R_TYPE(rel.r_info);
-            Elf32_Addr relAddr = ((Elf32_Addr)s->data) + rel.r_offset;
-
-            if(!address_cache_get(elf->relocation_cache, symEntry, &symAddr)) {
-                Elf32_Sym sym;
-                furi_string_reset(symbol_name);
-                if(!elf_read_symbol(elf, symEntry, &sym, symbol_name)) {
-                    FURI_LOG_E(TAG, "  symbol read fail");
-                    furi_string_free(symbol_name);
-                    return false;
+            for(size_t i = 0; i < chunkEntries; i++) {
+                Elf32_Rel* rel = &rels[i];
+                Elf32_Addr symAddr;
+
+                int symEntry = ELF32_R_SYM(rel->r_info);
+                int relType = ELF32_R_TYPE(rel->r_info);
+                Elf32_Addr relAddr = ((Elf32_Addr)s->data) + rel->r_offset;
+
+                if(!address_cache_get(elf->relocation_cache, symEntry, &symAddr)) {
+                    Elf32_Sym sym;
+                    furi_string_reset(symbol_name);
+                    if(!elf_read_symbol(elf, symEntry, &sym, symbol_name)) {
+                        FURI_LOG_E(TAG, "  symbol read fail");
+                        read_result = false;
+                        break;
+                    }
+
+                    FURI_LOG_D(
+                        TAG,
+                        " %08X %08X %-16s %s",
+                        (unsigned int)rel->r_offset,
+                        (unsigned int)rel->r_info,
+                        elf_reloc_type_to_str(relType),
+                        furi_string_get_cstr(symbol_name));
+
+                    symAddr = elf_address_of(elf, &sym, furi_string_get_cstr(symbol_name));
+                    address_cache_put(elf->relocation_cache, symEntry, symAddr);
                 }
 
-                FURI_LOG_D(
-                    TAG,
-                    " %08X %08X %-16s %s",
-                    (unsigned int)rel.r_offset,
-                    (unsigned int)rel.r_info,
-                    elf_reloc_type_to_str(relType),
-                    furi_string_get_cstr(symbol_name));
-
-                symAddr = elf_address_of(elf, &sym, furi_string_get_cstr(symbol_name));
-                address_cache_put(elf->relocation_cache, symEntry, symAddr);
-            }
-
-            if(symAddr != ELF_INVALID_ADDRESS) {
-                FURI_LOG_D(
-                    TAG,
-                    "  symAddr=%08X relAddr=%08X",
-                    (unsigned int)symAddr,
-                    (unsigned int)relAddr);
-                if(!elf_relocate_symbol(elf, relAddr, relType, symAddr)) {
+                if(symAddr != ELF_INVALID_ADDRESS) {
+                    FURI_LOG_D(
+                        TAG,
+                        "  symAddr=%08X relAddr=%08X",
+                        (unsigned int)symAddr,
+                        (unsigned int)relAddr);
+                    if(!elf_relocate_symbol(elf, relAddr, relType, symAddr)) {
+                        relocate_result = false;
+                    }
+                } else {
+                    FURI_LOG_E(
+                        TAG, "  No symbol address of %s", furi_string_get_cstr(symbol_name));
                     relocate_result = false;
                 }
-            } else {
-                FURI_LOG_E(TAG, "  No symbol address of %s", furi_string_get_cstr(symbol_name));
-                relocate_result = false;
             }
         }
         furi_string_free(symbol_name);
+        free(rels);
 
-        return relocate_result;
+        return read_result && relocate_result;
     } else {
         FURI_LOG_D(TAG, "Section not loaded");
     }
@@ -141,6 +141,15 @@ bool flipper_format_key_exist(FlipperFormat* flipper_format, const char* key) {
     return result;
 }
 
+bool flipper_format_read_next_line(
+    FlipperFormat* flipper_format,
+    FuriString* key,
+    FuriString* data) {
+    furi_check(flipper_format);
+    furi_check(key);
+    return flipper_format_stream_read_next_line(flipper_format->stream, key, data);
+}
+
 bool flipper_format_read_header(
     FlipperFormat* flipper_format,
     FuriString* filetype,
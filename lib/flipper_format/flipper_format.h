@@ -235,6 +235,24 @@ bool flipper_format_seek_to_end(FlipperFormat* flipper_format);
  */
 bool flipper_format_key_exist(FlipperFormat* flipper_format, const char* key);
 
+/** Read the next key and its value as a string, in file order.
+ *
+ * Comments and empty lines are skipped. Unlike keyed reads this does not
+ * search, so long sections with a known layout (dump blocks, pages) can be
+ * walked in a single pass. Callers are expected to check the key and fall back
+ * to keyed reads when the layout is not the expected one.
+ *
+ * @param      flipper_format  Pointer to a FlipperFormat instance
+ * @param      key             FuriString to store the key
+ * @param      data            FuriString to store the value, can be NULL to skip it
+ *
+ * @return     True on success
+ */
+bool flipper_format_read_next_line(
+    FlipperFormat* flipper_format,
+    FuriString* key,
+    FuriString* data);
+
 /** Read the header (file type and version).
  *
  * @param      flipper_format  Pointer to a FlipperFormat instance
@@ -266,11 +266,129 @@ static bool flipper_format_stream_seek_to_next_line(Stream* stream) {
     return result;
 }
 
+// Same rules as reading value by value: space separated, first two chars of each value are used.
+// Hex arrays can be thousands of values long, so they are parsed as the line is read.
+static bool flipper_format_stream_read_hex(Stream* stream, uint8_t* data, size_t data_size) {
+    const size_t buffer_size = 32;
+    uint8_t buffer[buffer_size];
+    size_t count = 0;
+    size_t value_size = 0;
+    char high_char = 0;
+    bool error = false;
+    bool eol = false;
+
+    while(!eol && !error) {
+        size_t was_read = stream_read(stream, buffer, buffer_size);
+        if(was_read == 0) break;
+
+        for(size_t i = 0; i < was_read; i++) {
+            const uint8_t c = buffer[i];
+
+            if(c == flipper_format_eoln) {
+                // leave the stream at the EOL, as the line reads do
+                if(!stream_seek(stream, i - was_read, StreamOffsetFromCurrent)) {
+                    error = true;
+                }
+                eol = true;
+                break;
+            } else if(count == data_size) {
+                // skip values past the requested ones
+            } else if(flipper_format_stream_is_space(c)) {
+                if(value_size == 1) {
+                    error = true;
+                    break;
+                } else if(value_size > 1) {
+                    count++;
+                }
+                value_size = 0;
+            } else if(value_size == 0) {
+                high_char = c;
+                value_size++;
+            } else if(value_size == 1) {
+                if(!hex_char_to_uint8(high_char, c, &data[count])) {
+                    error = true;
+                    break;
+                }
+                value_size++;
+            }
+        }
+    }
+
+    // the last value is ended by the EOL
+    if(value_size == 1) {
+        error = true;
+    } else if(value_size > 1) {
+        count++;
+    }
+
+    return !error && (count == data_size);
+}
+
+static size_t flipper_format_stream_count_values(Stream* stream) {
+    const size_t buffer_size = 32;
+    uint8_t buffer[buffer_size];
+    size_t count = 0;
+    bool space = true;
+    bool eol = false;
+
+    while(!eol) {
+        size_t was_read = stream_read(stream, buffer, buffer_size);
+        if(was_read == 0) break;
+
+        for(size_t i = 0; i < was_read; i++) {
+            const uint8_t c = buffer[i];
+
+            if(c == flipper_format_eoln) {
+                eol = true;
+                break;
+            } else if(flipper_format_stream_is_space(c)) {
+                space = true;
+            } else if(space) {
+                space = false;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+static bool
+    flipper_format_stream_write_hex(Stream* stream, const uint8_t* data, size_t data_size) {
+    // "XX " per byte, collected in a small buffer instead of a printf and a write per byte
+    char buffer[3 * 16];
+    size_t buffer_pos = 0;
+    bool result = true;
+
+    for(size_t i = 0; i < data_size; i++) {
+        uint8_to_hex_chars(&data[i], (uint8_t*)&buffer[buffer_pos], 2);
+        buffer_pos += 2;
+        if((i + 1) < data_size) {
+            buffer[buffer_pos++] = ' ';
+        }
+
+        if((buffer_pos + 3) > sizeof(buffer) || (i + 1) == data_size) {
+            if(!flipper_format_stream_write(stream, buffer, buffer_pos)) {
+                result = false;
+                break;
+            }
+            buffer_pos = 0;
+        }
+    }
+
+    return result;
+}
+
 bool flipper_format_stream_write_value_line(Stream* stream, FlipperStreamWriteData* write_data) {
     bool result = false;
 
     if(write_data->type == FlipperStreamValueIgnore) {
         result = true;
+    } else if(write_data->type == FlipperStreamValueHex) {
+        result =
+            flipper_format_stream_write_key(stream, write_data->key) &&
+            flipper_format_stream_write_hex(stream, write_data->data, write_data->data_size) &&
+            flipper_format_stream_write_eol(stream);
     } else {
         FuriString* value;
         value = furi_string_alloc();
@@ -287,10 +405,6 @@ bool flipper_format_stream_write_value_line(Stream* stream, FlipperStreamWriteDa
                     const char* data = write_data->data;
                     furi_string_printf(value, "%s", data);
                 }; break;
-                case FlipperStreamValueHex: {
-                    const uint8_t* data = write_data->data;
-                    furi_string_printf(value, "%02X", data[i]);
-                }; break;
 #ifndef FLIPPER_STREAM_LITE
                 case FlipperStreamValueFloat: {
                     const float* data = write_data->data;
@@ -358,6 +472,8 @@ bool flipper_format_stream_read_value_line(
                 result = true;
                 break;
             }
+        } else if(type == FlipperStreamValueHex) {
+            result = flipper_format_stream_read_hex(stream, _data, data_size);
         } else {
             result = true;
             FuriString* value;
@@ -447,40 +563,141 @@ bool flipper_format_stream_read_value_line(
     return result;
 }
 
+bool flipper_format_stream_read_next_line(Stream* stream, FuriString* key, FuriString* value) {
+    enum {
+        NewLine,
+        Skip,
+        Key,
+        LeadingSpace,
+        Value,
+    } state = NewLine;
+    const size_t buffer_size = 64;
+    uint8_t buffer[buffer_size];
+    bool result = false;
+    bool error = false;
+
+    furi_string_reset(key);
+    if(value) furi_string_reset(value);
+
+    while(true) {
+        size_t was_read = stream_read(stream, buffer, buffer_size);
+        if(was_read == 0) {
+            // last line without EOL
+            result = (state == LeadingSpace || state == Value) && stream_eof(stream);
+            break;
+        }
+
+        for(size_t i = 0; i < was_read; i++) {
+            const uint8_t data = buffer[i];
+
+            if(data == flipper_format_eoln) {
+                if(state == LeadingSpace || state == Value) {
+                    // leave the stream at the EOL, as the key-based reads do
+                    if(!stream_seek(stream, i - was_read, StreamOffsetFromCurrent)) {
+                        error = true;
+                    } else {
+                        result = true;
+                    }
+                    break;
+                }
+
+                // comment or line without a key
+                furi_string_reset(key);
+                state = NewLine;
+            } else if(data == flipper_format_eolr || state == Skip) {
+                // ignore
+            } else if(state == NewLine) {
+                if(data == flipper_format_comment || data == flipper_format_delimiter) {
+                    state = Skip;
+                } else {
+                    furi_string_push_back(key, data);
+                    state = Key;
+                }
+            } else if(state == Key) {
+                if(data == flipper_format_delimiter) {
+                    state = LeadingSpace;
+                } else {
+                    furi_string_push_back(key, data);
+                }
+            } else if(state == LeadingSpace && flipper_format_stream_is_space(data)) {
+                // ignore
+            } else {
+                state = Value;
+                if(value) furi_string_push_back(value, data);
+            }
+        }
+
+        if(result || error) break;
+    }
+
+    return result;
+}
+
+bool flipper_format_stream_peek_next_key(Stream* stream, FuriString* key) {
+    enum {
+        NewLine,
+        Skip,
+        Key,
+    } state = NewLine;
+    const size_t buffer_size = 32;
+    uint8_t buffer[buffer_size];
+    bool result = false;
+
+    furi_string_reset(key);
+    const size_t position = stream_tell(stream);
+
+    while(!result) {
+        size_t was_read = stream_read(stream, buffer, buffer_size);
+        if(was_read == 0) break;
+
+        for(size_t i = 0; i < was_read; i++) {
+            const uint8_t data = buffer[i];
+
+            if(data == flipper_format_eoln) {
+                // comment or line without a key
+                furi_string_reset(key);
+                state = NewLine;
+            } else if(data == flipper_format_eolr || state == Skip) {
+                // ignore
+            } else if(state == NewLine &&
+                      (data == flipper_format_comment || data == flipper_format_delimiter)) {
+                state = Skip;
+            } else if(state == Key && data == flipper_format_delimiter) {
+                // the value is not needed, stop here
+                result = true;
+                break;
+            } else {
+                furi_string_push_back(key, data);
+                state = Key;
+            }
+        }
+    }
+
+    if(!stream_seek(stream, position, StreamOffsetFromStart)) result = false;
+
+    return result;
+}
+
 bool flipper_format_stream_get_value_count(
     Stream* stream,
     const char* key,
     uint32_t* count,
     bool strict_mode) {
     bool result = false;
-    bool last = false;
-
-    FuriString* value;
-    value = furi_string_alloc();
 
     uint32_t position = stream_tell(stream);
     do {
         if(!flipper_format_stream_seek_to_key(stream, key, strict_mode)) break;
-        *count = 0;
-
-        result = true;
-        while(true) {
-            if(!flipper_format_stream_read_value(stream, value, &last)) {
-                result = false;
-                break;
-            }
-
-            *count = *count + 1;
-            if(last) break;
-        }
 
+        // one pass over the line instead of a read and seek back per value
+        *count = flipper_format_stream_count_values(stream);
+        result = (*count != 0);
     } while(false);
 
     if(!stream_seek(stream, position, StreamOffsetFromStart)) {
         result = false;
     }
 
-    furi_string_free(value);
     return result;
 }
 
@@ -53,6 +53,26 @@ bool flipper_format_stream_read_value_line(
     size_t data_size,
     bool strict_mode);
 
+/**
+ * Reads the next key/value pair from a stream, skipping comments and empty lines.
+ * @param stream 
+ * @param key 
+ * @param value can be NULL to skip the value
+ * @return true 
+ * @return false 
+ */
+bool flipper_format_stream_read_next_line(Stream* stream, FuriString* key, FuriString* value);
+
+/**
+ * Reads the next key from a stream, skipping comments and empty lines.
+ * Stops at the delimiter and leaves the stream position unchanged.
+ * @param stream 
+ * @param key 
+ * @return true 
+ * @return false 
+ */
+bool flipper_format_stream_peek_next_key(Stream* stream, FuriString* key);
+
 /**
  * Get the count of values by key from a stream.
  * @param stream 
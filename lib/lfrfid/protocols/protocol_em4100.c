@@ -227,15 +227,11 @@ bool protocol_em4100_decoder_feed(ProtocolEM4100* proto, bool level, uint32_t du
     }
 
     if(event != ManchesterEventReset) {
-        bool data;
-        bool data_ok = manchester_advance(
-            proto->decoder_manchester_state, event, &proto->decoder_manchester_state, &data);
-
-        if(data_ok) {
-            bool carry = proto->encoded_epilogue >> 63 & 0b1;
+        bool carry = proto->encoded_epilogue >> 63 & 0b1;
 
+        if(manchester_advance_shift(
+               &proto->decoder_manchester_state, event, &proto->encoded_epilogue)) {
             proto->encoded_data = (proto->encoded_data << 1) | carry;
-            proto->encoded_epilogue = (proto->encoded_epilogue << 1) | data;
 
             if(em4100_can_be_decoded(
                    (uint8_t*)&proto->encoded_data,
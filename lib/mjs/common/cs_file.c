@@ -50,6 +50,53 @@ char* cs_read_file(const char* path, size_t* size) {
     return data;
 }
 
+int cs_hash_file(const char* path, uint32_t* hash, size_t* size) WEAK;
+int cs_hash_file(const char* path, uint32_t* hash, size_t* size) {
+    FILE* fp;
+    unsigned char buf[256];
+    size_t n;
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    if((fp = fopen(path, "rb")) == NULL) return 0;
+    *size = 0;
+    while((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        size_t i;
+        for(i = 0; i < n; i++) {
+            h = (h ^ buf[i]) * 16777619u;
+        }
+        *size += n;
+    }
+    n = ferror(fp);
+    fclose(fp);
+    *hash = h;
+    return n == 0;
+}
+
+uint32_t cs_build_id(void) WEAK;
+uint32_t cs_build_id(void) {
+    /* FNV-1a of the compilation time of this file */
+    const char* build = __DATE__ " " __TIME__;
+    uint32_t h = 2166136261u;
+    while(*build) {
+        h = (h ^ (unsigned char)*build++) * 16777619u;
+    }
+    return h;
+}
+
+int cs_write_file(const char* path, const struct cs_file_chunk* chunks, size_t chunks_cnt) WEAK;
+int cs_write_file(const char* path, const struct cs_file_chunk* chunks, size_t chunks_cnt) {
+    FILE* fp;
+    size_t i;
+    int ok = 1;
+    if((fp = fopen(path, "wb")) == NULL) return 0;
+    for(i = 0; i < chunks_cnt && ok; i++) {
+        ok = fwrite(chunks[i].p, 1, chunks[i].len, fp) == chunks[i].len;
+    }
+    if(fclose(fp) != 0) ok = 0;
+    if(!ok) remove(path);
+    return ok;
+}
+
 char* cs_mmap_file(const char* path, size_t* size) WEAK;
 char* cs_mmap_file(const char* path, size_t* size) {
     char* r;
@@ -33,6 +33,32 @@ extern "C" {
  */
 char *cs_read_file(const char *path, size_t *size);
 
+/*
+ * Compute a 32-bit hash of file `path` contents, reading it in small chunks
+ * instead of loading it in memory. File size is returned in `size` variable.
+ * Return: 1 on success, 0 on error.
+ */
+int cs_hash_file(const char *path, uint32_t *hash, size_t *size);
+
+/*
+ * Identifier of the running firmware build. Files cached by one build
+ * (e.g. compiled bytecode) must not be trusted by another one.
+ */
+uint32_t cs_build_id(void);
+
+struct cs_file_chunk {
+  const void *p; /* Chunk data */
+  size_t len;    /* Chunk length */
+};
+
+/*
+ * Write `chunks_cnt` chunks to file `path` one after another, replacing its
+ * previous contents.
+ * Return: 1 on success, 0 on error.
+ */
+int cs_write_file(const char *path, const struct cs_file_chunk *chunks,
+                  size_t chunks_cnt);
+
 #ifdef CS_MMAP
 /*
  * Only on platforms which support mmapping: mmap file `path` to the returned
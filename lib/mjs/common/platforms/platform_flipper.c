@@ -1,6 +1,10 @@
 #include <furi.h>
 #include <toolbox/stream/file_stream.h>
+#include <toolbox/crc32_calc.h>
+#include <toolbox/version.h>
+#include <furi_hal_info.h>
 #include "../cs_dbg.h"
+#include "../cs_file.h"
 #include "../frozen/frozen.h"
 
 char* cs_read_file(const char* path, size_t* size) {
@@ -29,6 +33,48 @@ char* cs_read_file(const char* path, size_t* size) {
     return data;
 }
 
+int cs_hash_file(const char* path, uint32_t* hash, size_t* size) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    int ok = 0;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        *size = storage_file_size(file);
+        *hash = crc32_calc_file(file, NULL, NULL);
+        ok = storage_file_get_error(file) == FSE_OK;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
+
+uint32_t cs_build_id(void) {
+    const char* githash = version_get_githash(NULL);
+    const char* builddate = version_get_builddate(NULL);
+    const bool dirty = version_get_dirty_flag(NULL);
+    uint16_t api_version[2];
+    furi_hal_info_get_api_version(&api_version[0], &api_version[1]);
+
+    uint32_t id = crc32_calc_buffer(0, githash, strlen(githash));
+    id = crc32_calc_buffer(id, builddate, strlen(builddate));
+    id = crc32_calc_buffer(id, &dirty, sizeof(dirty));
+    return crc32_calc_buffer(id, api_version, sizeof(api_version));
+}
+
+int cs_write_file(const char* path, const struct cs_file_chunk* chunks, size_t chunks_cnt) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    int ok = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    for(size_t i = 0; i < chunks_cnt && ok; i++) {
+        ok = storage_file_write(file, chunks[i].p, chunks[i].len) == chunks[i].len;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    if(!ok) storage_common_remove(storage, path);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
+
 char* json_fread(const char* path) {
     UNUSED(path);
     return NULL;
@@ -60,6 +60,25 @@ struct mjs_bcode_part {
     unsigned in_rom : 1;
 };
 
+/*
+ * Number of entries in the string literal and property lookup caches, must be
+ * a power of two
+ */
+#define MJS_LOOKUP_CACHE_SIZE 32
+
+/* Value of a string literal created at the given bcode offset */
+struct mjs_str_cache_entry {
+    size_t bcode_offset;
+    mjs_val_t str;
+};
+
+/* Last property found in the given object under the given name */
+struct mjs_prop_cache_entry {
+    struct mjs_object* obj;
+    struct mjs_property* prop;
+    mjs_val_t name;
+};
+
 struct mjs {
     struct mbuf bcode_gen;
     struct mbuf bcode_parts;
@@ -89,6 +108,9 @@ struct mjs {
     struct gc_arena property_arena;
     struct gc_arena ffi_sig_arena;
 
+    struct mjs_str_cache_entry str_cache[MJS_LOOKUP_CACHE_SIZE];
+    struct mjs_prop_cache_entry prop_cache[MJS_LOOKUP_CACHE_SIZE];
+
     unsigned inhibit_gc : 1;
     unsigned need_gc : 1;
     unsigned generate_jsc : 1;
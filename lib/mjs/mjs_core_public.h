@@ -254,11 +254,11 @@ const char* mjs_strerror(struct mjs* mjs, enum mjs_err err);
 const char* mjs_get_stack_trace(struct mjs* mjs);
 
 /*
- * Sets whether *.jsc files are generated when *.js file is executed. By
- * default it's 0.
+ * Sets whether *.jsc bcode caches are used when *.js file is executed. If
+ * enabled, a *.jsc file is (re)generated when it's missing or stale, and is
+ * loaded instead of parsing the source otherwise. By default it's 0.
  *
- * If either `MJS_GENERATE_JSC` or `CS_MMAP` is off, then this function has no
- * effect.
+ * If `MJS_GENERATE_JSC` is off, then this function has no effect.
  */
 void mjs_set_generate_jsc(struct mjs* mjs, int generate_jsc);
 
@@ -19,9 +19,34 @@
 #include "mjs_util.h"
 #include "mjs_array_buf.h"
 
-#if MJS_GENERATE_JSC && defined(CS_MMAP)
-#include <sys/mman.h>
-#endif
+#define MJS_JSC_MAGIC (0x43534a4d) /* "MJSC" */
+
+/*
+ * Version of the .jsc trailer format. Bcode compatibility is not tracked by
+ * hand: the opcode and header item counts are folded into the version, and
+ * the trailer also records the id of the firmware build which produced the
+ * cache (see cs_build_id()), so caches from any other build are rebuilt
+ * instead of executed.
+ */
+#define MJS_JSC_VERSION ((2 << 16) | (OP_MAX << 8) | MJS_HDR_ITEMS_CNT)
+
+/*
+ * A .jsc file holds the bcode part of the .js file with the same base name,
+ * followed by this trailer. The trailer goes last, so an interrupted write
+ * never leaves a cache which looks valid.
+ */
+struct mjs_jsc_trailer {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t build_id;
+    uint32_t src_hash;
+    uint32_t src_size;
+};
+
+struct mjs_jsc {
+    char* path;
+    struct mjs_jsc_trailer trailer;
+};
 
 /*
  * Pushes call stack frame. Offset is a global bcode offset. Retval_stack_idx
@@ -808,7 +833,8 @@ MJS_PRIVATE mjs_err_t mjs_execute(struct mjs* mjs, size_t off, mjs_val_t* res) {
             break;
         case OP_PUSH_STR: {
             int llen, n = cs_varint_decode_unsafe(&code[i + 1], &llen);
-            mjs_push(mjs, mjs_mk_string(mjs, (char*)code + i + 1 + llen, n, 1));
+            mjs_push(
+                mjs, mjs_mk_string_literal(mjs, bp.start_idx + i, (char*)code + i + 1 + llen, n));
             i += llen + n;
             break;
         }
@@ -1083,11 +1109,96 @@ clean:
     return mjs->error;
 }
 
+#if MJS_GENERATE_JSC
+/*
+ * Returns a heap-allocated path of the .jsc counterpart of the given .js file,
+ * or NULL if `path` doesn't have a .js extension
+ */
+static char* mjs_jsc_path_alloc(const char* path) {
+    const char* jsext = ".js";
+    size_t path_len = strlen(path);
+    char* jsc_path;
+
+    if(path_len <= strlen(jsext) || strcmp(path + path_len - strlen(jsext), jsext) != 0) {
+        return NULL;
+    }
+
+    jsc_path = malloc(path_len + 2 /* "c" and nul-term */);
+    memcpy(jsc_path, path, path_len);
+    jsc_path[path_len] = 'c';
+    jsc_path[path_len + 1] = '\0';
+    return jsc_path;
+}
+
+/*
+ * Loads bcode of the file `path` from its .jsc cache and commits it as the
+ * next bcode part. Returns 0 if there's no cache, or if it was made for
+ * another source, path or firmware build.
+ */
+static int mjs_jsc_load(struct mjs* mjs, const char* path, const struct mjs_jsc* jsc) {
+    const size_t filename_off = 1 /* OP_BCODE_HEADER */ +
+                                sizeof(mjs_header_item_t) * MJS_HDR_ITEMS_CNT;
+    const size_t path_size = strlen(path) + 1 /* nul-term */;
+    struct mjs_jsc_trailer trailer;
+    mjs_header_item_t total_size;
+    struct mjs_bcode_part bp;
+    size_t size;
+    int valid;
+    char* data = cs_read_file(jsc->path, &size);
+
+    if(data == NULL) return 0;
+
+    valid = size >= filename_off + path_size + sizeof(trailer);
+    if(valid) {
+        size -= sizeof(trailer);
+        memcpy(&trailer, data + size, sizeof(trailer));
+        memcpy(
+            &total_size,
+            data + 1 /* OP_BCODE_HEADER */ + sizeof(mjs_header_item_t) * MJS_HDR_ITEM_TOTAL_SIZE,
+            sizeof(total_size));
+
+        valid = memcmp(&trailer, &jsc->trailer, sizeof(trailer)) == 0 &&
+                data[0] == OP_BCODE_HEADER && total_size + 1 == size &&
+                memcmp(data + filename_off, path, path_size) == 0;
+    }
+
+    if(!valid) {
+        free(data);
+        return 0;
+    }
+
+    memset(&bp, 0, sizeof(bp));
+    bp.data.p = data;
+    bp.data.len = size;
+    bp.start_idx = mjs->bcode_len;
+    bp.exec_res = MJS_ERRS_CNT;
+    mjs_bcode_part_add(mjs, &bp);
+    mjs->bcode_len += bp.data.len;
+
+    return 1;
+}
+
+/*
+ * Writes the last bcode part to the .jsc cache
+ */
+static void mjs_jsc_save(struct mjs* mjs, const struct mjs_jsc* jsc) {
+    struct mjs_bcode_part* bp = mjs_bcode_part_get(mjs, mjs_bcode_parts_cnt(mjs) - 1);
+    struct cs_file_chunk chunks[] = {
+        {bp->data.p, bp->data.len},
+        {&jsc->trailer, sizeof(jsc->trailer)},
+    };
+
+    if(!cs_write_file(jsc->path, chunks, sizeof(chunks) / sizeof(chunks[0]))) {
+        LOG(LL_WARN, ("Failed to write %s", jsc->path));
+    }
+}
+#endif
+
 MJS_PRIVATE mjs_err_t mjs_exec_internal(
     struct mjs* mjs,
     const char* path,
     const char* src,
-    int generate_jsc,
+    const struct mjs_jsc* jsc,
     mjs_val_t* res) {
     size_t off = mjs->bcode_len;
     mjs_val_t r = MJS_UNDEFINED;
@@ -1095,72 +1206,11 @@ MJS_PRIVATE mjs_err_t mjs_exec_internal(
 #if MJS_ENABLE_DEBUG
     if(cs_log_level >= LL_VERBOSE_DEBUG) mjs_dump(mjs, 1);
 #endif
-    if(generate_jsc == -1) generate_jsc = mjs->generate_jsc;
     if(mjs->error == MJS_OK) {
-#if MJS_GENERATE_JSC && defined(CS_MMAP)
-        if(generate_jsc && path != NULL) {
-            const char* jsext = ".js";
-            int basename_len = (int)strlen(path) - strlen(jsext);
-            if(basename_len > 0 && strcmp(path + basename_len, jsext) == 0) {
-                /* source file has a .js extension: create a .jsc counterpart */
-                int rewrite = 1;
-                int read_mmapped = 1;
-
-                /* construct .jsc filename */
-                const char* jscext = ".jsc";
-                char filename_jsc[basename_len + strlen(jscext) + 1 /* nul-term */];
-                memcpy(filename_jsc, path, basename_len);
-                strcpy(filename_jsc + basename_len, jscext);
-
-                /* get last bcode part */
-                struct mjs_bcode_part* bp = mjs_bcode_part_get(mjs, mjs_bcode_parts_cnt(mjs) - 1);
-
-                /*
-         * before writing .jsc file, check if it already exists and has the
-         * same contents
-         *
-         * TODO(dfrank): probably store crc32 before the bcode data, and only
-         * compare it.
-         */
-                {
-                    size_t size;
-                    char* data = cs_mmap_file(filename_jsc, &size);
-                    if(data != NULL) {
-                        if(size == bp->data.len) {
-                            if(memcmp(data, bp->data.p, size) == 0) {
-                                /* .jsc file is up to date, so don't rewrite it */
-                                rewrite = 0;
-                            }
-                        }
-                        munmap(data, size);
-                    }
-                }
-
-                /* try to open .jsc file for writing */
-                if(rewrite) {
-                    FILE* fp = fopen(filename_jsc, "wb");
-                    if(fp != NULL) {
-                        /* write last bcode part to .jsc */
-                        fwrite(bp->data.p, bp->data.len, 1, fp);
-                        fclose(fp);
-                    } else {
-                        LOG(LL_WARN, ("Failed to open %s for writing", filename_jsc));
-                        read_mmapped = 0;
-                    }
-                }
-
-                if(read_mmapped) {
-                    /* free RAM buffer with last bcode part */
-                    free((void*)bp->data.p);
-
-                    /* mmap .jsc file and set last bcode part buffer to it */
-                    bp->data.p = cs_mmap_file(filename_jsc, &bp->data.len);
-                    bp->in_rom = 1;
-                }
-            }
-        }
+#if MJS_GENERATE_JSC
+        if(jsc != NULL) mjs_jsc_save(mjs, jsc);
 #else
-        (void)generate_jsc;
+        (void)jsc;
 #endif
 
         mjs_execute(mjs, off, &r);
@@ -1170,14 +1220,42 @@ MJS_PRIVATE mjs_err_t mjs_exec_internal(
 }
 
 mjs_err_t mjs_exec(struct mjs* mjs, const char* src, mjs_val_t* res) {
-    return mjs_exec_internal(mjs, "<stdin>", src, 0 /* generate_jsc */, res);
+    return mjs_exec_internal(mjs, "<stdin>", src, NULL /* jsc */, res);
 }
 
 mjs_err_t mjs_exec_file(struct mjs* mjs, const char* path, mjs_val_t* res) {
     mjs_err_t error = MJS_FILE_READ_ERROR;
     mjs_val_t r = MJS_UNDEFINED;
     size_t size;
-    char* source_code = cs_read_file(path, &size);
+    char* source_code;
+    struct mjs_jsc jsc = {.path = NULL};
+
+#if MJS_GENERATE_JSC
+    size_t off = mjs->bcode_len;
+
+    if(mjs->generate_jsc) jsc.path = mjs_jsc_path_alloc(path);
+    if(jsc.path != NULL) {
+        jsc.trailer.magic = MJS_JSC_MAGIC;
+        jsc.trailer.version = MJS_JSC_VERSION;
+        jsc.trailer.build_id = cs_build_id();
+        if(cs_hash_file(path, &jsc.trailer.src_hash, &size)) {
+            jsc.trailer.src_size = size;
+        } else {
+            free(jsc.path);
+            jsc.path = NULL;
+        }
+    }
+
+    if(jsc.path != NULL && mjs_jsc_load(mjs, path, &jsc)) {
+        /* Cache hit: neither the source nor the parser state is kept in RAM */
+        mjs->error = MJS_OK;
+        mjs_execute(mjs, off, &r);
+        error = mjs->error;
+        goto clean;
+    }
+#endif
+
+    source_code = cs_read_file(path, &size);
 
     if(source_code == NULL) {
         error = MJS_FILE_READ_ERROR;
@@ -1186,10 +1264,11 @@ mjs_err_t mjs_exec_file(struct mjs* mjs, const char* path, mjs_val_t* res) {
     }
 
     r = MJS_UNDEFINED;
-    error = mjs_exec_internal(mjs, path, source_code, -1, &r);
+    error = mjs_exec_internal(mjs, path, source_code, jsc.path ? &jsc : NULL, &r);
     free(source_code);
 
 clean:
+    free(jsc.path);
     if(res != NULL) *res = r;
     return error;
 }
@@ -90,6 +90,50 @@ MJS_PRIVATE struct mjs_property*
     return NULL;
 }
 
+static struct mjs_prop_cache_entry*
+    mjs_prop_cache_entry(struct mjs* mjs, struct mjs_object* o, mjs_val_t name) {
+    uintptr_t h = (uintptr_t)o >> 3;
+    h ^= (uintptr_t)(name ^ (name >> 29));
+    h ^= h >> 7;
+    return &mjs->prop_cache[h & (MJS_LOOKUP_CACHE_SIZE - 1)];
+}
+
+/*
+ * Looks up a property by a name given both as a string value and as ptr+len.
+ * Successful lookups by string values are cached, so a repeated lookup of the
+ * same name (e.g. a string literal in a loop) doesn't walk the property list.
+ * Foreign strings are not cached: the memory they point to may be reused.
+ */
+static struct mjs_property* mjs_get_own_property_cached(
+    struct mjs* mjs,
+    mjs_val_t obj,
+    mjs_val_t name_v,
+    const char* name,
+    size_t len) {
+    if(!mjs_is_string(name_v) || (name_v & MJS_TAG_MASK) == MJS_TAG_STRING_F ||
+       !mjs_is_object_based(obj)) {
+        return mjs_get_own_property(mjs, obj, name, len);
+    }
+
+    struct mjs_object* o = get_object_struct(obj);
+    struct mjs_prop_cache_entry* entry = mjs_prop_cache_entry(mjs, o, name_v);
+    if(entry->obj == o && entry->name == name_v) {
+        return entry->prop;
+    }
+
+    struct mjs_property* p = mjs_get_own_property(mjs, obj, name, len);
+    if(p != NULL) {
+        entry->obj = o;
+        entry->name = name_v;
+        entry->prop = p;
+    }
+    return p;
+}
+
+MJS_PRIVATE void mjs_prop_cache_reset(struct mjs* mjs) {
+    memset(mjs->prop_cache, 0, sizeof(mjs->prop_cache));
+}
+
 MJS_PRIVATE struct mjs_property*
     mjs_get_own_property_v(struct mjs* mjs, mjs_val_t obj, mjs_val_t key) {
     size_t n;
@@ -98,7 +142,7 @@ MJS_PRIVATE struct mjs_property*
     struct mjs_property* p = NULL;
     mjs_err_t err = mjs_to_string(mjs, &key, &s, &n, &need_free);
     if(err == MJS_OK) {
-        p = mjs_get_own_property(mjs, obj, s, n);
+        p = mjs_get_own_property_cached(mjs, obj, key, s, n);
     }
     if(need_free) free(s);
     return p;
@@ -192,7 +236,7 @@ MJS_PRIVATE mjs_err_t mjs_set_internal(
         name_v = MJS_UNDEFINED;
     }
 
-    p = mjs_get_own_property(mjs, obj, name, name_len);
+    p = mjs_get_own_property_cached(mjs, obj, name_v, name, name_len);
 
     if(p == NULL) {
         struct mjs_object* o;
@@ -251,6 +295,7 @@ int mjs_del(struct mjs* mjs, mjs_val_t obj, const char* name, size_t len) {
             } else {
                 get_object_struct(obj)->properties = prop->next;
             }
+            mjs_prop_cache_reset(mjs);
             mjs_destroy_property(&prop);
             return 0;
         }
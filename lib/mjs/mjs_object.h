@@ -32,6 +32,12 @@ MJS_PRIVATE struct mjs_property*
 MJS_PRIVATE struct mjs_property*
     mjs_get_own_property_v(struct mjs* mjs, mjs_val_t obj, mjs_val_t key);
 
+/*
+ * Drops all cached property lookups. Must be called whenever properties may
+ * be destroyed: on property deletion and on GC.
+ */
+MJS_PRIVATE void mjs_prop_cache_reset(struct mjs* mjs);
+
 /*
  * A worker function for `mjs_set()` and `mjs_set_v()`: it takes name as both
  * ptr+len and mjs_val_t. If `name` pointer is not NULL, it takes precedence
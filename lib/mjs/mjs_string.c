@@ -433,6 +433,27 @@ clean:
     mjs_return(mjs, ret);
 }
 
+MJS_PRIVATE mjs_val_t
+    mjs_mk_string_literal(struct mjs* mjs, size_t bcode_offset, const char* p, size_t len) {
+    /* Short strings are stored inside mjs_val_t and don't need caching */
+    if(len <= 5) {
+        return mjs_mk_string(mjs, p, len, 1);
+    }
+
+    struct mjs_str_cache_entry* entry =
+        &mjs->str_cache[bcode_offset & (MJS_LOOKUP_CACHE_SIZE - 1)];
+    if(entry->bcode_offset != bcode_offset || !mjs_is_string(entry->str)) {
+        entry->str = mjs_mk_string(mjs, p, len, 1);
+        entry->bcode_offset = bcode_offset;
+    }
+
+    return entry->str;
+}
+
+MJS_PRIVATE void mjs_str_cache_reset(struct mjs* mjs) {
+    memset(mjs->str_cache, 0, sizeof(mjs->str_cache));
+}
+
 MJS_PRIVATE void mjs_mkstr(struct mjs* mjs) {
     int nargs = mjs_nargs(mjs);
     mjs_val_t ret = MJS_UNDEFINED;
@@ -33,6 +33,20 @@ MJS_PRIVATE void embed_string(
 
 MJS_PRIVATE void mjs_mkstr(struct mjs* mjs);
 
+/*
+ * Makes an owned copy of the string literal located at the given bcode
+ * offset. Repeated executions of the same literal reuse the copy until the
+ * next GC, so that loops don't fill the owned strings buffer with duplicates.
+ */
+MJS_PRIVATE mjs_val_t
+    mjs_mk_string_literal(struct mjs* mjs, size_t bcode_offset, const char* p, size_t len);
+
+/*
+ * Drops all cached string literals, must be called when owned strings are
+ * compacted.
+ */
+MJS_PRIVATE void mjs_str_cache_reset(struct mjs* mjs);
+
 MJS_PRIVATE void mjs_string_to_lower_case(struct mjs* mjs);
 MJS_PRIVATE void mjs_string_to_upper_case(struct mjs* mjs);
 MJS_PRIVATE void mjs_string_slice(struct mjs* mjs);
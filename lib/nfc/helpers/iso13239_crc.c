@@ -1,35 +1,21 @@
 #include "iso13239_crc.h"
 
 #include <core/check.h>
-
-#define ISO13239_CRC_INIT_DEFAULT  (0xFFFFU)
-#define ISO13239_CRC_INIT_PICOPASS (0xE012U)
-#define ISO13239_CRC_POLY          (0x8408U)
+#include <toolbox/crc.h>
 
 static uint16_t
     iso13239_crc_calculate(Iso13239CrcType type, const uint8_t* data, size_t data_size) {
-    uint16_t crc;
+    const CrcModel* model;
 
     if(type == Iso13239CrcTypeDefault) {
-        crc = ISO13239_CRC_INIT_DEFAULT;
+        model = &crc_model_crc16_x25;
     } else if(type == Iso13239CrcTypePicopass) {
-        crc = ISO13239_CRC_INIT_PICOPASS;
+        model = &crc_model_crc16_picopass;
     } else {
         furi_crash("Wrong ISO13239 CRC type");
     }
 
-    for(size_t i = 0; i < data_size; ++i) {
-        crc ^= (uint16_t)data[i];
-        for(size_t j = 0; j < 8; ++j) {
-            if(crc & 1U) {
-                crc = (crc >> 1) ^ ISO13239_CRC_POLY;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-
-    return type == Iso13239CrcTypePicopass ? crc : ~crc;
+    return crc_calculate(model, data, data_size);
 }
 
 void iso13239_crc_append(Iso13239CrcType type, BitBuffer* buf) {
@@ -99,18 +99,19 @@ bool mf_classic_verify(MfClassicData* data, const FuriString* device_type) {
 }
 
 static void mf_classic_parse_block(FuriString* block_str, MfClassicData* data, uint8_t block_num) {
+    // Keyed reads return the value as is, leading whitespace included
     furi_string_trim(block_str);
     MfClassicBlock block_tmp = {};
     bool is_sector_trailer = mf_classic_is_sector_trailer(block_num);
     uint8_t sector_num = mf_classic_get_sector_by_block(block_num);
     uint16_t block_unknown_bytes_mask = 0;
 
-    furi_string_trim(block_str);
+    const char* block_cstr = furi_string_get_cstr(block_str);
+    const size_t block_str_size = furi_string_size(block_str);
     for(size_t i = 0; i < MF_CLASSIC_BLOCK_SIZE; i++) {
-        char hi = furi_string_get_char(block_str, 3 * i);
-        char low = furi_string_get_char(block_str, 3 * i + 1);
         uint8_t byte = 0;
-        if(hex_char_to_uint8(hi, low, &byte)) {
+        if((3 * i + 1) < block_str_size &&
+           hex_char_to_uint8(block_cstr[3 * i], block_cstr[3 * i + 1], &byte)) {
             block_tmp.data[i] = byte;
         } else {
             FURI_BIT_SET(block_unknown_bytes_mask, i);
@@ -147,6 +148,36 @@ static void mf_classic_parse_block(FuriString* block_str, MfClassicData* data, u
     }
 }
 
+static bool mf_classic_load_blocks(MfClassicData* data, FlipperFormat* ff) {
+    FuriString* key = furi_string_alloc();
+    FuriString* block_key = furi_string_alloc();
+    FuriString* block_str = furi_string_alloc();
+    bool block_read = true;
+
+    uint16_t blocks_total = mf_classic_get_total_block_num(data->type);
+    for(size_t i = 0; i < blocks_total; i++) {
+        furi_string_printf(block_key, "Block %d", i);
+
+        // Blocks are saved in order, so normally the next line is the block itself
+        if(!flipper_format_read_next_line(ff, key, block_str) ||
+           !furi_string_equal(key, block_key)) {
+            // Search for the key from the start otherwise
+            if(!flipper_format_rewind(ff) ||
+               !flipper_format_read_string(ff, furi_string_get_cstr(block_key), block_str)) {
+                block_read = false;
+                break;
+            }
+        }
+        mf_classic_parse_block(block_str, data, i);
+    }
+
+    furi_string_free(block_str);
+    furi_string_free(block_key);
+    furi_string_free(key);
+
+    return block_read;
+}
+
 bool mf_classic_load(MfClassicData* data, FlipperFormat* ff, uint32_t version) {
     furi_check(data);
     furi_check(ff);
@@ -184,19 +215,7 @@ bool mf_classic_load(MfClassicData* data, FlipperFormat* ff, uint32_t version) {
         }
 
         // Read Mifare Classic blocks
-        bool block_read = true;
-        FuriString* block_str = furi_string_alloc();
-        uint16_t blocks_total = mf_classic_get_total_block_num(data->type);
-        for(size_t i = 0; i < blocks_total; i++) {
-            furi_string_printf(temp_str, "Block %d", i);
-            if(!flipper_format_read_string(ff, furi_string_get_cstr(temp_str), block_str)) {
-                block_read = false;
-                break;
-            }
-            mf_classic_parse_block(block_str, data, i);
-        }
-        furi_string_free(block_str);
-        if(!block_read) break;
+        if(!mf_classic_load_blocks(data, ff)) break;
 
         // Set keys and blocks as unknown for backward compatibility
         if(old_format) {
@@ -215,46 +234,36 @@ bool mf_classic_load(MfClassicData* data, FlipperFormat* ff, uint32_t version) {
 
 static void
     mf_classic_set_block_str(FuriString* block_str, const MfClassicData* data, uint8_t block_num) {
-    furi_string_reset(block_str);
-    bool is_sec_trailer = mf_classic_is_sector_trailer(block_num);
-    if(is_sec_trailer) {
+    // Same masks as in mf_classic_parse_block()
+    uint16_t block_known_bytes_mask = 0;
+    if(mf_classic_is_sector_trailer(block_num)) {
         uint8_t sector_num = mf_classic_get_sector_by_block(block_num);
-        MfClassicSectorTrailer* sec_tr = mf_classic_get_sector_trailer_by_sector(data, sector_num);
-        // Write key A
-        for(size_t i = 0; i < sizeof(sec_tr->key_a); i++) {
-            if(mf_classic_is_key_found(data, sector_num, MfClassicKeyTypeA)) {
-                furi_string_cat_printf(block_str, "%02X ", sec_tr->key_a.data[i]);
-            } else {
-                furi_string_cat_printf(block_str, "?? ");
-            }
+        if(mf_classic_is_key_found(data, sector_num, MfClassicKeyTypeA)) {
+            block_known_bytes_mask |= 0x003f;
         }
-        // Write Access bytes
-        for(size_t i = 0; i < MF_CLASSIC_ACCESS_BYTES_SIZE; i++) {
-            if(mf_classic_is_block_read(data, block_num)) {
-                furi_string_cat_printf(block_str, "%02X ", sec_tr->access_bits.data[i]);
-            } else {
-                furi_string_cat_printf(block_str, "?? ");
-            }
+        if(mf_classic_is_block_read(data, block_num)) {
+            block_known_bytes_mask |= 0x03c0;
         }
-        // Write key B
-        for(size_t i = 0; i < sizeof(sec_tr->key_b); i++) {
-            if(mf_classic_is_key_found(data, sector_num, MfClassicKeyTypeB)) {
-                furi_string_cat_printf(block_str, "%02X ", sec_tr->key_b.data[i]);
-            } else {
-                furi_string_cat_printf(block_str, "?? ");
-            }
+        if(mf_classic_is_key_found(data, sector_num, MfClassicKeyTypeB)) {
+            block_known_bytes_mask |= 0xfc00;
         }
-    } else {
-        // Write data block
-        for(size_t i = 0; i < MF_CLASSIC_BLOCK_SIZE; i++) {
-            if(mf_classic_is_block_read(data, block_num)) {
-                furi_string_cat_printf(block_str, "%02X ", data->block[block_num].data[i]);
-            } else {
-                furi_string_cat_printf(block_str, "?? ");
-            }
+    } else if(mf_classic_is_block_read(data, block_num)) {
+        block_known_bytes_mask = 0xffff;
+    }
+
+    // "XX " per byte, without the trailing space
+    char block_cstr[MF_CLASSIC_BLOCK_SIZE * 3];
+    for(size_t i = 0; i < MF_CLASSIC_BLOCK_SIZE; i++) {
+        char* byte_str = &block_cstr[3 * i];
+        if(FURI_BIT(block_known_bytes_mask, i)) {
+            uint8_to_hex_chars(&data->block[block_num].data[i], (uint8_t*)byte_str, 2);
+        } else {
+            byte_str[0] = '?';
+            byte_str[1] = '?';
         }
+        byte_str[2] = ' ';
     }
-    furi_string_trim(block_str);
+    furi_string_set_strn(block_str, block_cstr, sizeof(block_cstr) - 1);
 }
 
 bool mf_classic_save(const MfClassicData* data, FlipperFormat* ff) {
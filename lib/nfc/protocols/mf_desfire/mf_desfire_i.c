@@ -1,5 +1,8 @@
 #include "mf_desfire_i.h"
 
+#include <flipper_format/flipper_format_i.h>
+#include <flipper_format/flipper_format_stream.h>
+
 #define TAG "MfDesfire"
 
 #define BITS_IN_BYTE (8U)
@@ -478,10 +481,23 @@ bool mf_desfire_file_settings_load(
     return success;
 }
 
+static bool mf_desfire_file_data_is_next(const char* prefix, FlipperFormat* ff) {
+    Stream* stream = flipper_format_get_raw_stream(ff);
+    FuriString* key = furi_string_alloc();
+
+    const bool is_next = flipper_format_stream_peek_next_key(stream, key) &&
+                         furi_string_equal_str(key, prefix);
+
+    furi_string_free(key);
+    return is_next;
+}
+
 bool mf_desfire_file_data_load(MfDesfireFileData* data, const char* prefix, FlipperFormat* ff) {
     bool success = false;
     do {
-        if(!flipper_format_key_exist(ff, prefix)) {
+        // Data is saved right after the file settings, only look through the whole file when
+        // it is somewhere else or missing
+        if(!mf_desfire_file_data_is_next(prefix, ff) && !flipper_format_key_exist(ff, prefix)) {
             success = true;
             break;
         }
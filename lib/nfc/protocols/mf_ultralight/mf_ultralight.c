@@ -2,6 +2,7 @@
 
 #include <bit_lib/bit_lib.h>
 #include <furi.h>
+#include <toolbox/hex.h>
 
 #define MF_ULTRALIGHT_PROTOCOL_NAME "NTAG/Ultralight"
 
@@ -239,6 +240,55 @@ bool mf_ultralight_verify(MfUltralightData* data, const FuriString* device_type)
     return verified;
 }
 
+// Exactly "XX XX XX XX" as written by mf_ultralight_save()
+static bool mf_ultralight_parse_page(FuriString* page_str, MfUltralightPage* page) {
+    const char* page_cstr = furi_string_get_cstr(page_str);
+    bool parsed = (furi_string_size(page_str) == sizeof(MfUltralightPage) * 3 - 1);
+
+    for(size_t i = 0; parsed && i < sizeof(MfUltralightPage); i++) {
+        const char* byte_str = &page_cstr[3 * i];
+        parsed = hex_char_to_uint8(byte_str[0], byte_str[1], &page->data[i]) &&
+                 (i + 1 == sizeof(MfUltralightPage) || byte_str[2] == ' ');
+    }
+
+    return parsed;
+}
+
+static bool
+    mf_ultralight_load_pages(MfUltralightData* data, FlipperFormat* ff, uint32_t pages_total) {
+    FuriString* key = furi_string_alloc();
+    FuriString* page_key = furi_string_alloc();
+    FuriString* page_str = furi_string_alloc();
+    bool pages_parsed = true;
+
+    for(size_t i = 0; i < pages_total; i++) {
+        furi_string_printf(page_key, "%s %d", MF_ULTRALIGHT_PAGE_KEY, i);
+
+        // Pages are saved in order, so normally the next line is the page itself
+        if(flipper_format_read_next_line(ff, key, page_str) && furi_string_equal(key, page_key) &&
+           mf_ultralight_parse_page(page_str, &data->page[i])) {
+            continue;
+        }
+
+        // Search for the key from the start and use the regular parser otherwise
+        if(!flipper_format_rewind(ff) ||
+           !flipper_format_read_hex(
+               ff,
+               furi_string_get_cstr(page_key),
+               data->page[i].data,
+               sizeof(MfUltralightPage))) {
+            pages_parsed = false;
+            break;
+        }
+    }
+
+    furi_string_free(page_str);
+    furi_string_free(page_key);
+    furi_string_free(key);
+
+    return pages_parsed;
+}
+
 bool mf_ultralight_load(MfUltralightData* data, FlipperFormat* ff, uint32_t version) {
     furi_check(data);
     furi_check(ff);
@@ -311,19 +361,7 @@ bool mf_ultralight_load(MfUltralightData* data, FlipperFormat* ff, uint32_t vers
         if((pages_read > MF_ULTRALIGHT_MAX_PAGE_NUM) || (pages_total > MF_ULTRALIGHT_MAX_PAGE_NUM))
             break;
 
-        bool pages_parsed = true;
-        for(size_t i = 0; i < pages_total; i++) {
-            furi_string_printf(temp_str, "%s %d", MF_ULTRALIGHT_PAGE_KEY, i);
-            if(!flipper_format_read_hex(
-                   ff,
-                   furi_string_get_cstr(temp_str),
-                   data->page[i].data,
-                   sizeof(MfUltralightPage))) {
-                pages_parsed = false;
-                break;
-            }
-        }
-        if(!pages_parsed) break;
+        if(!mf_ultralight_load_pages(data, ff, pages_total)) break;
 
         // Read authentication counter
         if(!flipper_format_read_uint32(
@@ -1031,8 +1031,12 @@ int vsnprintf_(char* buffer, size_t count, const char* format, va_list va) {
 int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...) {
     va_list va;
     va_start(va, format);
-    const out_fct_wrap_type out_fct_wrap = {out, arg};
-    const int ret = _vsnprintf(_out_fct, (char*)(uintptr_t)&out_fct_wrap, (size_t)-1, format, va);
+    const int ret = vfctprintf(out, arg, format, va);
     va_end(va);
     return ret;
 }
+
+int vfctprintf(void (*out)(char character, void* arg), void* arg, const char* format, va_list va) {
+    const out_fct_wrap_type out_fct_wrap = {out, arg};
+    return _vsnprintf(_out_fct, (char*)(uintptr_t)&out_fct_wrap, (size_t)-1, format, va);
+}
@@ -7,16 +7,39 @@
 #include <furi/core/common_defines.h>
 #include "printf_tiny.h"
 
+#define PRINTF_OUTPUT_CHUNK_SIZE (64U)
+
+typedef struct {
+    size_t size;
+    char buffer[PRINTF_OUTPUT_CHUNK_SIZE];
+} PrintfOutput;
+
 void _putchar(char character) {
     furi_thread_stdout_write(&character, 1);
 }
 
+// Formatted output is passed to thread stdout in chunks rather than char by char
+static void printf_output_char(char character, void* context) {
+    PrintfOutput* output = context;
+    output->buffer[output->size++] = character;
+    if(output->size == PRINTF_OUTPUT_CHUNK_SIZE) {
+        furi_thread_stdout_write(output->buffer, output->size);
+        output->size = 0;
+    }
+}
+
 int __wrap_printf(const char* format, ...) {
+    PrintfOutput output = {.size = 0};
+
     va_list args;
     va_start(args, format);
-    int ret = vprintf_(format, args);
+    int ret = vfctprintf(printf_output_char, &output, format, args);
     va_end(args);
 
+    if(output.size) {
+        furi_thread_stdout_write(output.buffer, output.size);
+    }
+
     return ret;
 }
 
@@ -323,12 +323,8 @@ void subghz_protocol_decoder_marantec_feed(void* context, bool level, volatile u
             }
         }
         if(event != ManchesterEventReset) {
-            bool data;
-            bool data_ok = manchester_advance(
-                instance->manchester_saved_state, event, &instance->manchester_saved_state, &data);
-
-            if(data_ok) {
-                instance->decoder.decode_data = (instance->decoder.decode_data << 1) | data;
+            if(manchester_advance_shift(
+                   &instance->manchester_saved_state, event, &instance->decoder.decode_data)) {
                 instance->decoder.decode_count_bit++;
             }
         }
@@ -0,0 +1,120 @@
+/**
+ * @file crc.h
+ * Table driven CRC engine
+ *
+ * Models are described with Rocksoft parameters (width, polynomial, init,
+ * reflect in/out, xor out). Models shipped with the firmware carry
+ * precomputed lookup tables: slicing-by-8 for CRC-32 and bytewise tables
+ * for CCITT CRC-16 variants. Custom models without a table are calculated
+ * bit by bit.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <storage/storage.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** CRC model description */
+typedef struct {
+    uint8_t width; /**< CRC width in bits, 8..32 */
+    uint32_t polynomial; /**< Polynomial, normal (MSB first) notation */
+    uint32_t init; /**< Initial register value, normal notation */
+    bool reflect_in; /**< Process input bytes LSB first */
+    bool reflect_out; /**< Reflect register before final xor */
+    uint32_t xor_out; /**< Value to xor with the result */
+    const void* table; /**< Internal: lookup table for precomputed models, NULL otherwise */
+} CrcModel;
+
+/** CRC-32/ISO-HDLC, same as zlib and crc32_calc */
+extern const CrcModel crc_model_crc32;
+
+/** CRC-16/ISO-IEC-14443-3-A */
+extern const CrcModel crc_model_crc16_iso14443a;
+
+/** CRC-16/IBM-SDLC (X-25), ISO 14443-3 type B and ISO 13239 */
+extern const CrcModel crc_model_crc16_x25;
+
+/** ISO 13239 with Picopass init value */
+extern const CrcModel crc_model_crc16_picopass;
+
+/** CRC-16/XMODEM, FeliCa */
+extern const CrcModel crc_model_crc16_xmodem;
+
+/** Streaming CRC context */
+typedef struct {
+    const CrcModel* model;
+    uint32_t value;
+} CrcContext;
+
+/** Start new calculation
+ *
+ * @param      context  CrcContext instance
+ * @param      model    CRC model
+ */
+void crc_init(CrcContext* context, const CrcModel* model);
+
+/** Continue calculation from previously finished CRC value
+ *
+ * Only valid for models with equal reflect_in and reflect_out.
+ *
+ * @param      context  CrcContext instance
+ * @param      model    CRC model
+ * @param      crc      value previously returned by crc_finish or crc_calculate
+ */
+void crc_resume(CrcContext* context, const CrcModel* model, uint32_t crc);
+
+/** Feed data into calculation
+ *
+ * @param      context  CrcContext instance
+ * @param      data     data to process
+ * @param      size     data size in bytes
+ */
+void crc_update(CrcContext* context, const void* data, size_t size);
+
+/** Get CRC of all data fed so far
+ *
+ * Context is not modified and can be updated further.
+ *
+ * @param      context  CrcContext instance
+ *
+ * @return     CRC value
+ */
+uint32_t crc_finish(const CrcContext* context);
+
+/** Calculate CRC of buffer in one call
+ *
+ * @param      model  CRC model
+ * @param      data   data to process
+ * @param      size   data size in bytes
+ *
+ * @return     CRC value
+ */
+uint32_t crc_calculate(const CrcModel* model, const void* data, size_t size);
+
+typedef void (*FileCrcProgressCb)(const uint8_t progress, void* context);
+
+/** Calculate CRC of whole file contents
+ *
+ * File is rewound and read in large chunks.
+ *
+ * @param      model        CRC model
+ * @param      file         opened File instance
+ * @param      progress_cb  optional progress callback, receives percents
+ * @param      context      progress callback context
+ *
+ * @return     CRC value
+ */
+uint32_t crc_calculate_file(
+    const CrcModel* model,
+    File* file,
+    const FileCrcProgressCb progress_cb,
+    void* context);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <storage/storage.h>
+#include "crc.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -9,8 +10,6 @@ extern "C" {
 
 uint32_t crc32_calc_buffer(uint32_t crc, const void* buffer, size_t size);
 
-typedef void (*FileCrcProgressCb)(const uint8_t progress, void* context);
-
 uint32_t crc32_calc_file(File* file, const FileCrcProgressCb progress_cb, void* context);
 
 #ifdef __cplusplus
@@ -0,0 +1,329 @@
+#include "file_digest.h"
+#include "crc.h"
+
+#include <furi.h>
+#include <furi_hal_rtc.h>
+#include <mbedtls/md5.h>
+#include <mbedtls/sha256.h>
+
+#define TAG "FileDigest"
+
+#define FILE_DIGEST_CHUNK_SIZE        (4096)
+#define FILE_DIGEST_CHUNK_COUNT       (2)
+#define FILE_DIGEST_READER_STACK_SIZE (1024)
+#define FILE_DIGEST_SYNC_SIZE_MAX     (4 * FILE_DIGEST_CHUNK_SIZE)
+#define FILE_DIGEST_ALL_TYPES \
+    (FileDigestTypeMd5 | FileDigestTypeSha256 | FileDigestTypeCrc32)
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+} FileDigestChunk;
+
+typedef struct {
+    File* file;
+    FileDigestChunk chunks[FILE_DIGEST_CHUNK_COUNT];
+    FuriMessageQueue* free_queue;
+    FuriMessageQueue* filled_queue;
+} FileDigestReader;
+
+typedef struct {
+    uint32_t types;
+    mbedtls_md5_context* md5_ctx;
+    mbedtls_sha256_context* sha256_ctx;
+    CrcContext crc_ctx;
+} FileDigestHasher;
+
+typedef struct {
+    FuriString* path;
+    uint64_t size;
+    uint32_t timestamp;
+    uint32_t types;
+    uint32_t last_used;
+    FileDigest digest;
+} FileDigestCacheEntry;
+
+struct FileDigestCache {
+    Storage* storage;
+    size_t capacity;
+    uint32_t use_counter;
+    FileDigestCacheEntry* entries;
+};
+
+static int32_t file_digest_reader_thread(void* context) {
+    FileDigestReader* reader = context;
+
+    while(true) {
+        uint8_t index;
+        furi_check(
+            furi_message_queue_get(reader->free_queue, &index, FuriWaitForever) == FuriStatusOk);
+
+        FileDigestChunk* chunk = &reader->chunks[index];
+        chunk->size = storage_file_read(reader->file, chunk->data, FILE_DIGEST_CHUNK_SIZE);
+        const bool done = (chunk->size == 0) || (storage_file_get_error(reader->file) != FSE_OK);
+        if(done) chunk->size = 0;
+
+        furi_check(
+            furi_message_queue_put(reader->filled_queue, &index, FuriWaitForever) ==
+            FuriStatusOk);
+
+        if(done) break;
+    }
+
+    return 0;
+}
+
+static void file_digest_hasher_init(FileDigestHasher* hasher, uint32_t types) {
+    hasher->types = types;
+    hasher->md5_ctx = NULL;
+    hasher->sha256_ctx = NULL;
+
+    if(types & FileDigestTypeMd5) {
+        hasher->md5_ctx = malloc(sizeof(mbedtls_md5_context));
+        mbedtls_md5_init(hasher->md5_ctx);
+        mbedtls_md5_starts(hasher->md5_ctx);
+    }
+    if(types & FileDigestTypeSha256) {
+        hasher->sha256_ctx = malloc(sizeof(mbedtls_sha256_context));
+        mbedtls_sha256_init(hasher->sha256_ctx);
+        mbedtls_sha256_starts(hasher->sha256_ctx, 0);
+    }
+    if(types & FileDigestTypeCrc32) {
+        crc_init(&hasher->crc_ctx, &crc_model_crc32);
+    }
+}
+
+static void file_digest_hasher_update(FileDigestHasher* hasher, const uint8_t* data, size_t size) {
+    if(hasher->md5_ctx) mbedtls_md5_update(hasher->md5_ctx, data, size);
+    if(hasher->sha256_ctx) mbedtls_sha256_update(hasher->sha256_ctx, data, size);
+    if(hasher->types & FileDigestTypeCrc32) crc_update(&hasher->crc_ctx, data, size);
+}
+
+static void file_digest_hasher_finish(FileDigestHasher* hasher, FileDigest* digest) {
+    if(hasher->md5_ctx) {
+        mbedtls_md5_finish(hasher->md5_ctx, digest->md5);
+        mbedtls_md5_free(hasher->md5_ctx);
+        free(hasher->md5_ctx);
+    }
+    if(hasher->sha256_ctx) {
+        mbedtls_sha256_finish(hasher->sha256_ctx, digest->sha256);
+        mbedtls_sha256_free(hasher->sha256_ctx);
+        free(hasher->sha256_ctx);
+    }
+    if(hasher->types & FileDigestTypeCrc32) {
+        digest->crc32 = crc_finish(&hasher->crc_ctx);
+    }
+}
+
+static void file_digest_process_sync(File* file, FileDigestHasher* hasher, size_t buffer_size) {
+    uint8_t* buffer = aligned_malloc(buffer_size, sizeof(uint32_t));
+
+    while(true) {
+        const size_t size = storage_file_read(file, buffer, buffer_size);
+        if(size == 0 || storage_file_get_error(file) != FSE_OK) break;
+        file_digest_hasher_update(hasher, buffer, size);
+    }
+
+    aligned_free(buffer);
+}
+
+static void file_digest_process_pipelined(File* file, FileDigestHasher* hasher) {
+    FileDigestReader reader = {
+        .file = file,
+        .free_queue = furi_message_queue_alloc(FILE_DIGEST_CHUNK_COUNT, sizeof(uint8_t)),
+        .filled_queue = furi_message_queue_alloc(FILE_DIGEST_CHUNK_COUNT, sizeof(uint8_t)),
+    };
+
+    for(uint8_t i = 0; i < FILE_DIGEST_CHUNK_COUNT; i++) {
+        // word aligned size and address keep FatFs on the direct multi-sector read path
+        reader.chunks[i].data = aligned_malloc(FILE_DIGEST_CHUNK_SIZE, sizeof(uint32_t));
+        furi_check(furi_message_queue_put(reader.free_queue, &i, 0) == FuriStatusOk);
+    }
+
+    FuriThread* thread = furi_thread_alloc_ex(
+        TAG, FILE_DIGEST_READER_STACK_SIZE, file_digest_reader_thread, &reader);
+    furi_thread_start(thread);
+
+    while(true) {
+        uint8_t index;
+        furi_check(
+            furi_message_queue_get(reader.filled_queue, &index, FuriWaitForever) ==
+            FuriStatusOk);
+
+        const FileDigestChunk* chunk = &reader.chunks[index];
+        if(chunk->size == 0) break;
+
+        // next read is already in flight while this chunk is hashed
+        file_digest_hasher_update(hasher, chunk->data, chunk->size);
+
+        furi_check(furi_message_queue_put(reader.free_queue, &index, 0) == FuriStatusOk);
+    }
+
+    furi_thread_join(thread);
+    furi_thread_free(thread);
+
+    for(size_t i = 0; i < FILE_DIGEST_CHUNK_COUNT; i++) {
+        aligned_free(reader.chunks[i].data);
+    }
+    furi_message_queue_free(reader.free_queue);
+    furi_message_queue_free(reader.filled_queue);
+}
+
+static bool file_digest_process(File* file, uint32_t types, FileDigest* digest) {
+    FileDigestHasher hasher;
+    file_digest_hasher_init(&hasher, types);
+
+    const uint64_t file_size = storage_file_size(file);
+    if(file_size <= FILE_DIGEST_SYNC_SIZE_MAX) {
+        // reader thread costs more than it saves for a few chunks
+        if(file_size) {
+            file_digest_process_sync(file, &hasher, MIN(file_size, FILE_DIGEST_CHUNK_SIZE));
+        }
+    } else {
+        file_digest_process_pipelined(file, &hasher);
+    }
+
+    file_digest_hasher_finish(&hasher, digest);
+
+    return storage_file_get_error(file) == FSE_OK;
+}
+
+bool file_digest_calc_file(
+    File* file,
+    const char* path,
+    uint32_t types,
+    FileDigest* digest,
+    FS_Error* file_error) {
+    furi_check(file);
+    furi_check(path);
+    furi_check(digest);
+    furi_check(types && !(types & ~FILE_DIGEST_ALL_TYPES));
+
+    if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        if(file_error != NULL) {
+            *file_error = storage_file_get_error(file);
+        }
+        return false;
+    }
+
+    bool result = file_digest_process(file, types, digest);
+
+    if(file_error != NULL) {
+        *file_error = storage_file_get_error(file);
+    }
+
+    storage_file_close(file);
+    return result;
+}
+
+FileDigestCache* file_digest_cache_alloc(Storage* storage, size_t capacity) {
+    furi_check(storage);
+    furi_check(capacity > 0);
+
+    FileDigestCache* cache = malloc(sizeof(FileDigestCache));
+    cache->storage = storage;
+    cache->capacity = capacity;
+    cache->use_counter = 0;
+    cache->entries = malloc(sizeof(FileDigestCacheEntry) * capacity);
+    for(size_t i = 0; i < capacity; i++) {
+        cache->entries[i].path = furi_string_alloc();
+        cache->entries[i].types = 0;
+    }
+
+    return cache;
+}
+
+void file_digest_cache_free(FileDigestCache* cache) {
+    furi_check(cache);
+
+    for(size_t i = 0; i < cache->capacity; i++) {
+        furi_string_free(cache->entries[i].path);
+    }
+    free(cache->entries);
+    free(cache);
+}
+
+void file_digest_cache_reset(FileDigestCache* cache) {
+    furi_check(cache);
+
+    for(size_t i = 0; i < cache->capacity; i++) {
+        furi_string_reset(cache->entries[i].path);
+        cache->entries[i].types = 0;
+    }
+}
+
+static FileDigestCacheEntry* file_digest_cache_find(FileDigestCache* cache, const char* path) {
+    for(size_t i = 0; i < cache->capacity; i++) {
+        FileDigestCacheEntry* entry = &cache->entries[i];
+        if(entry->types && furi_string_cmp_str(entry->path, path) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static FileDigestCacheEntry* file_digest_cache_get_free(FileDigestCache* cache) {
+    FileDigestCacheEntry* oldest = &cache->entries[0];
+
+    for(size_t i = 0; i < cache->capacity; i++) {
+        FileDigestCacheEntry* entry = &cache->entries[i];
+        if(!entry->types) return entry;
+        if(entry->last_used < oldest->last_used) oldest = entry;
+    }
+
+    return oldest;
+}
+
+bool file_digest_cache_calc_file(
+    FileDigestCache* cache,
+    File* file,
+    const char* path,
+    uint32_t types,
+    FileDigest* digest,
+    FS_Error* file_error) {
+    furi_check(cache);
+    furi_check(path);
+    furi_check(digest);
+
+    // Storage timestamp changes on every write, truncate, remove or rename on that storage,
+    // but only has 1 second resolution. Same second as now means a later write in this
+    // second would keep it unchanged, so such results are neither trusted nor cached.
+    FileInfo file_info;
+    uint32_t timestamp;
+    const bool has_key = storage_common_stat(cache->storage, path, &file_info) == FSE_OK &&
+                         !file_info_is_dir(&file_info) &&
+                         storage_common_timestamp(cache->storage, path, &timestamp) == FSE_OK &&
+                         timestamp < furi_hal_rtc_get_timestamp();
+
+    FileDigestCacheEntry* entry = file_digest_cache_find(cache, path);
+
+    if(entry) {
+        if(has_key && entry->size == file_info.size && entry->timestamp == timestamp &&
+           (entry->types & types) == types) {
+            entry->last_used = ++cache->use_counter;
+            *digest = entry->digest;
+            if(file_error != NULL) *file_error = FSE_OK;
+            return true;
+        }
+
+        // stale entry
+        entry->types = 0;
+    }
+
+    if(!file_digest_calc_file(file, path, types, digest, file_error)) {
+        return false;
+    }
+
+    if(has_key) {
+        entry = file_digest_cache_get_free(cache);
+        furi_string_set(entry->path, path);
+        entry->size = file_info.size;
+        entry->timestamp = timestamp;
+        entry->types = types;
+        entry->last_used = ++cache->use_counter;
+        entry->digest = *digest;
+    }
+
+    return true;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file file_digest.h
+ * Single pass MD5/SHA-256/CRC32 file hashing
+ *
+ * Files larger than a few chunks are read by a reader thread while the
+ * calling thread hashes the previously read chunk, smaller ones are read
+ * directly. Optional cache keeps digests of recently hashed files keyed by
+ * path, size and storage modification timestamp.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <storage/storage.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FILE_DIGEST_MD5_SIZE    (16)
+#define FILE_DIGEST_SHA256_SIZE (32)
+
+typedef enum {
+    FileDigestTypeMd5 = (1 << 0),
+    FileDigestTypeSha256 = (1 << 1),
+    FileDigestTypeCrc32 = (1 << 2),
+} FileDigestType;
+
+typedef struct {
+    uint8_t md5[FILE_DIGEST_MD5_SIZE];
+    uint8_t sha256[FILE_DIGEST_SHA256_SIZE];
+    uint32_t crc32;
+} FileDigest;
+
+typedef struct FileDigestCache FileDigestCache;
+
+/** Calculate digests of file contents
+ *
+ * @param      file        File instance, will be opened and closed
+ * @param      path        file path
+ * @param      types       FileDigestType bitmask of digests to calculate
+ * @param      digest      FileDigest to fill, only requested fields are valid
+ * @param      file_error  optional pointer to store file error
+ *
+ * @return     true on success
+ */
+bool file_digest_calc_file(
+    File* file,
+    const char* path,
+    uint32_t types,
+    FileDigest* digest,
+    FS_Error* file_error);
+
+/** Allocate digest cache
+ *
+ * @param      storage   Storage instance used to check file size and timestamp
+ * @param      capacity  maximum number of cached files
+ *
+ * @return     FileDigestCache instance
+ */
+FileDigestCache* file_digest_cache_alloc(Storage* storage, size_t capacity);
+
+/** Free digest cache
+ *
+ * @param      cache  FileDigestCache instance
+ */
+void file_digest_cache_free(FileDigestCache* cache);
+
+/** Drop all cached digests
+ *
+ * Not needed after changes made through the storage service, they update
+ * the storage timestamp and invalidate the cache.
+ *
+ * @param      cache  FileDigestCache instance
+ */
+void file_digest_cache_reset(FileDigestCache* cache);
+
+/** Calculate digests of file contents, using cache if possible
+ *
+ * @param      cache       FileDigestCache instance
+ * @param      file        File instance, will be opened and closed
+ * @param      path        file path
+ * @param      types       FileDigestType bitmask of digests to calculate
+ * @param      digest      FileDigest to fill, only requested fields are valid
+ * @param      file_error  optional pointer to store file error
+ *
+ * @return     true on success
+ */
+bool file_digest_cache_calc_file(
+    FileDigestCache* cache,
+    File* file,
+    const char* path,
+    uint32_t types,
+    FileDigest* digest,
+    FS_Error* file_error);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,9 +1,62 @@
 #include "manchester_decoder.h"
 #include <stdint.h>
 
-static const uint8_t transitions[] = {0b00000001, 0b10010001, 0b10011011, 0b11111011};
 static const ManchesterState manchester_reset_state = ManchesterStateMid1;
 
+/* Lookup tables are expanded from transition masks at compile time.
+ * Transition masks per state: 0b00000001, 0b10010001, 0b10011011, 0b11111011.
+ * Event index is ManchesterEvent / 2, reset event is handled separately.
+ *
+ * Single event entry: [1:0] next state, [2] bit decoded, [3] bit value
+ * Event pair entry:   [1:0] next state, [3:2] bits decoded, [5:4] bits value (first bit is older)
+ */
+#define MANCHESTER_TRANSITIONS(s) \
+    ((s) == 0 ? 0b00000001 : (s) == 1 ? 0b10010001 : (s) == 2 ? 0b10011011 : 0b11111011)
+#define MANCHESTER_RAW(s, e) ((MANCHESTER_TRANSITIONS(s) >> ((e) * 2)) & 0x3)
+#define MANCHESTER_NEXT(s, e) \
+    (MANCHESTER_RAW(s, e) == (s) ? ManchesterStateMid1 : MANCHESTER_RAW(s, e))
+#define MANCHESTER_EMIT(s, e)       \
+    (MANCHESTER_RAW(s, e) != (s) && \
+     (MANCHESTER_RAW(s, e) == ManchesterStateMid0 || MANCHESTER_RAW(s, e) == ManchesterStateMid1))
+#define MANCHESTER_BIT(s, e) (MANCHESTER_EMIT(s, e) && MANCHESTER_RAW(s, e) == ManchesterStateMid1)
+
+#define MANCHESTER_SINGLE(s, e) \
+    (MANCHESTER_NEXT(s, e) | (MANCHESTER_EMIT(s, e) << 2) | (MANCHESTER_BIT(s, e) << 3))
+#define MANCHESTER_SINGLE_ROW(s) \
+    {MANCHESTER_SINGLE(s, 0),    \
+     MANCHESTER_SINGLE(s, 1),    \
+     MANCHESTER_SINGLE(s, 2),    \
+     MANCHESTER_SINGLE(s, 3)}
+
+#define MANCHESTER_PAIR(s, e1, e2)                                                       \
+    (MANCHESTER_NEXT(MANCHESTER_NEXT(s, e1), e2) |                                       \
+     ((MANCHESTER_EMIT(s, e1) + MANCHESTER_EMIT(MANCHESTER_NEXT(s, e1), e2)) << 2) |     \
+     ((MANCHESTER_EMIT(MANCHESTER_NEXT(s, e1), e2) ?                                     \
+           ((MANCHESTER_BIT(s, e1) << 1) | MANCHESTER_BIT(MANCHESTER_NEXT(s, e1), e2)) : \
+           MANCHESTER_BIT(s, e1))                                                        \
+      << 4))
+#define MANCHESTER_PAIR_ROW(s)                                                     \
+    {MANCHESTER_PAIR(s, 0, 0), MANCHESTER_PAIR(s, 0, 1), MANCHESTER_PAIR(s, 0, 2), \
+     MANCHESTER_PAIR(s, 0, 3), MANCHESTER_PAIR(s, 1, 0), MANCHESTER_PAIR(s, 1, 1), \
+     MANCHESTER_PAIR(s, 1, 2), MANCHESTER_PAIR(s, 1, 3), MANCHESTER_PAIR(s, 2, 0), \
+     MANCHESTER_PAIR(s, 2, 1), MANCHESTER_PAIR(s, 2, 2), MANCHESTER_PAIR(s, 2, 3), \
+     MANCHESTER_PAIR(s, 3, 0), MANCHESTER_PAIR(s, 3, 1), MANCHESTER_PAIR(s, 3, 2), \
+     MANCHESTER_PAIR(s, 3, 3)}
+
+static const uint8_t manchester_single_table[4][4] = {
+    MANCHESTER_SINGLE_ROW(0),
+    MANCHESTER_SINGLE_ROW(1),
+    MANCHESTER_SINGLE_ROW(2),
+    MANCHESTER_SINGLE_ROW(3),
+};
+
+static const uint8_t manchester_pair_table[4][16] = {
+    MANCHESTER_PAIR_ROW(0),
+    MANCHESTER_PAIR_ROW(1),
+    MANCHESTER_PAIR_ROW(2),
+    MANCHESTER_PAIR_ROW(3),
+};
+
 bool manchester_advance(
     ManchesterState state,
     ManchesterEvent event,
@@ -15,20 +68,71 @@ bool manchester_advance(
     if(event == ManchesterEventReset) {
         new_state = manchester_reset_state;
     } else {
-        new_state = transitions[state] >> event & 0x3;
-        if(new_state == state) {
-            new_state = manchester_reset_state;
-        } else {
-            if(new_state == ManchesterStateMid0) {
-                if(data) *data = false;
-                result = true;
-            } else if(new_state == ManchesterStateMid1) {
-                if(data) *data = true;
-                result = true;
-            }
+        const uint8_t entry = manchester_single_table[state][event >> 1];
+        new_state = entry & 0x3;
+        if(entry & 0x4) {
+            if(data) *data = (entry >> 3) & 0x1;
+            result = true;
         }
     }
 
     *next_state = new_state;
     return result;
 }
+
+bool manchester_advance_shift(
+    ManchesterState* state,
+    ManchesterEvent event,
+    uint64_t* shift_register) {
+    if(event == ManchesterEventReset) {
+        *state = manchester_reset_state;
+        return false;
+    }
+
+    const uint8_t entry = manchester_single_table[*state][event >> 1];
+    *state = entry & 0x3;
+
+    if(entry & 0x4) {
+        *shift_register = (*shift_register << 1) | ((entry >> 3) & 0x1);
+        return true;
+    }
+
+    return false;
+}
+
+size_t manchester_advance_run(
+    ManchesterState* state,
+    const ManchesterEvent* events,
+    size_t events_count,
+    uint64_t* shift_register) {
+    size_t bits_count = 0;
+    ManchesterState current_state = *state;
+    uint64_t current_register = *shift_register;
+
+    size_t index = 0;
+    while(index + 1 < events_count) {
+        const ManchesterEvent first = events[index];
+        const ManchesterEvent second = events[index + 1];
+
+        if(first == ManchesterEventReset || second == ManchesterEventReset) {
+            bits_count += manchester_advance_shift(&current_state, first, &current_register);
+            index++;
+            continue;
+        }
+
+        const uint8_t entry = manchester_pair_table[current_state][(first << 1) | (second >> 1)];
+        const uint8_t count = (entry >> 2) & 0x3;
+        current_state = entry & 0x3;
+        current_register = (current_register << count) | (entry >> 4);
+        bits_count += count;
+        index += 2;
+    }
+
+    if(index < events_count) {
+        bits_count += manchester_advance_shift(&current_state, events[index], &current_register);
+    }
+
+    *state = current_state;
+    *shift_register = current_register;
+    return bits_count;
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +28,41 @@ bool manchester_advance(
     ManchesterState* next_state,
     bool* data);
 
+/** Advance decoder by one event and shift decoded bit into register
+ *
+ * Same state machine as manchester_advance, but table driven and without
+ * bool out-parameter round trip. Decoded bit is shifted in from the LSB side.
+ *
+ * @param      state           decoder state, updated in place
+ * @param      event           half-period event
+ * @param      shift_register  register to shift decoded bit into
+ *
+ * @return     true if bit was decoded
+ */
+bool manchester_advance_shift(
+    ManchesterState* state,
+    ManchesterEvent event,
+    uint64_t* shift_register);
+
+/** Decode run of events into register
+ *
+ * Consumes events in pairs using precomputed two-event transition table, so
+ * up to two bits are shifted in per table lookup. Result is identical to
+ * calling manchester_advance_shift for every event in order.
+ *
+ * @param      state           decoder state, updated in place
+ * @param      events          events array
+ * @param      events_count    events count
+ * @param      shift_register  register to shift decoded bits into
+ *
+ * @return     decoded bits count
+ */
+size_t manchester_advance_run(
+    ManchesterState* state,
+    const ManchesterEvent* events,
+    size_t events_count,
+    uint64_t* shift_register);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,44 +1,17 @@
 #include "md5_calc.h"
+#include "file_digest.h"
 
 #include <storage/filesystem_api_defines.h>
 #include <storage/storage.h>
-#include <mbedtls/md5.h>
 
 bool md5_calc_file(File* file, const char* path, unsigned char output[16], FS_Error* file_error) {
-    if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        if(file_error != NULL) {
-            *file_error = storage_file_get_error(file);
-        }
-        return false;
-    }
-
-    const size_t size_to_read = 512;
-    uint8_t* data = malloc(size_to_read);
-    bool result = true;
-
-    mbedtls_md5_context* md5_ctx = malloc(sizeof(mbedtls_md5_context));
-    mbedtls_md5_init(md5_ctx);
-    mbedtls_md5_starts(md5_ctx);
-    while(true) {
-        size_t read_size = storage_file_read(file, data, size_to_read);
-        if(storage_file_get_error(file) != FSE_OK) {
-            result = false;
-            break;
-        }
-        if(read_size == 0) {
-            break;
-        }
-        mbedtls_md5_update(md5_ctx, data, read_size);
-    }
-    mbedtls_md5_finish(md5_ctx, output);
-    free(md5_ctx);
-    free(data);
+    FileDigest digest;
+    bool result = file_digest_calc_file(file, path, FileDigestTypeMd5, &digest, file_error);
 
-    if(file_error != NULL) {
-        *file_error = storage_file_get_error(file);
+    if(result) {
+        memcpy(output, digest.md5, FILE_DIGEST_MD5_SIZE);
     }
 
-    storage_file_close(file);
     return result;
 }
 
@@ -0,0 +1,279 @@
+#include "pattern_matcher.h"
+
+#include <furi.h>
+
+#define PATTERN_MATCHER_ROOT (0)
+
+typedef struct {
+    uint16_t offset;
+    uint16_t size;
+} PatternMatcherPattern;
+
+typedef struct {
+    uint16_t edge_start;
+    uint16_t edge_count;
+    uint16_t fail;
+    uint16_t match; // index + 1 of the first added pattern ending here, 0 if none
+} PatternMatcherState;
+
+struct PatternMatcher {
+    uint8_t* pattern_data;
+    size_t pattern_data_size;
+    PatternMatcherPattern* patterns;
+    size_t pattern_count;
+
+    bool compiled;
+    PatternMatcherState* states;
+    uint8_t* edge_bytes;
+    uint16_t* edge_targets;
+    // root transitions are looked up on most bytes, so they are kept as a full table
+    uint16_t root[UINT8_MAX + 1];
+
+    uint16_t state;
+    uint32_t position;
+};
+
+PatternMatcher* pattern_matcher_alloc(void) {
+    PatternMatcher* matcher = malloc(sizeof(PatternMatcher));
+    memset(matcher, 0, sizeof(PatternMatcher));
+    return matcher;
+}
+
+static void pattern_matcher_release_automaton(PatternMatcher* matcher) {
+    free(matcher->states);
+    free(matcher->edge_bytes);
+    free(matcher->edge_targets);
+    matcher->states = NULL;
+    matcher->edge_bytes = NULL;
+    matcher->edge_targets = NULL;
+    matcher->compiled = false;
+    pattern_matcher_reset(matcher);
+}
+
+void pattern_matcher_free(PatternMatcher* matcher) {
+    furi_check(matcher);
+
+    pattern_matcher_clear(matcher);
+    free(matcher);
+}
+
+void pattern_matcher_clear(PatternMatcher* matcher) {
+    furi_check(matcher);
+
+    pattern_matcher_release_automaton(matcher);
+    free(matcher->pattern_data);
+    free(matcher->patterns);
+    matcher->pattern_data = NULL;
+    matcher->pattern_data_size = 0;
+    matcher->patterns = NULL;
+    matcher->pattern_count = 0;
+}
+
+bool pattern_matcher_add(PatternMatcher* matcher, const uint8_t* pattern, size_t size) {
+    furi_check(matcher);
+    furi_check(pattern);
+    furi_check(size > 0);
+
+    if(matcher->pattern_data_size + size > PATTERN_MATCHER_MAX_SIZE) {
+        return false;
+    }
+
+    pattern_matcher_release_automaton(matcher);
+
+    matcher->pattern_data =
+        realloc(matcher->pattern_data, matcher->pattern_data_size + size); //-V701
+    memcpy(&matcher->pattern_data[matcher->pattern_data_size], pattern, size);
+
+    matcher->patterns = realloc( //-V701
+        matcher->patterns,
+        sizeof(PatternMatcherPattern) * (matcher->pattern_count + 1));
+    matcher->patterns[matcher->pattern_count].offset = matcher->pattern_data_size;
+    matcher->patterns[matcher->pattern_count].size = size;
+
+    matcher->pattern_data_size += size;
+    matcher->pattern_count++;
+
+    return true;
+}
+
+size_t pattern_matcher_get_count(const PatternMatcher* matcher) {
+    furi_check(matcher);
+    return matcher->pattern_count;
+}
+
+void pattern_matcher_reset(PatternMatcher* matcher) {
+    furi_check(matcher);
+    matcher->state = PATTERN_MATCHER_ROOT;
+    matcher->position = 0;
+}
+
+static inline uint16_t
+    pattern_matcher_find_edge(const PatternMatcher* matcher, uint16_t state, uint8_t byte) {
+    const PatternMatcherState* node = &matcher->states[state];
+    for(size_t i = node->edge_start; i < node->edge_start + node->edge_count; i++) {
+        if(matcher->edge_bytes[i] == byte) return matcher->edge_targets[i];
+    }
+    return PATTERN_MATCHER_ROOT;
+}
+
+static void pattern_matcher_compile(PatternMatcher* matcher) {
+    const size_t state_max = matcher->pattern_data_size + 1;
+    matcher->states = malloc(sizeof(PatternMatcherState) * state_max);
+    memset(matcher->states, 0, sizeof(PatternMatcherState) * state_max);
+    memset(matcher->root, 0, sizeof(matcher->root));
+
+    // Build the trie as first child / next sibling lists
+    uint16_t* first_child = malloc(sizeof(uint16_t) * state_max);
+    uint16_t* next_sibling = malloc(sizeof(uint16_t) * state_max);
+    uint8_t* state_byte = malloc(state_max);
+    memset(first_child, 0, sizeof(uint16_t) * state_max);
+    size_t state_count = 1;
+
+    for(size_t i = 0; i < matcher->pattern_count; i++) {
+        const PatternMatcherPattern* pattern = &matcher->patterns[i];
+        const uint8_t* data = &matcher->pattern_data[pattern->offset];
+        uint16_t state = PATTERN_MATCHER_ROOT;
+
+        for(size_t j = 0; j < pattern->size; j++) {
+            uint16_t child = first_child[state];
+            while(child && state_byte[child] != data[j]) {
+                child = next_sibling[child];
+            }
+            if(!child) {
+                child = state_count++;
+                state_byte[child] = data[j];
+                first_child[child] = 0;
+                next_sibling[child] = first_child[state];
+                first_child[state] = child;
+                matcher->states[state].edge_count++;
+            }
+            state = child;
+        }
+
+        if(!matcher->states[state].match) {
+            matcher->states[state].match = i + 1;
+        }
+    }
+
+    // Lay out the edges of each state contiguously
+    matcher->edge_bytes = malloc(state_count);
+    matcher->edge_targets = malloc(sizeof(uint16_t) * state_count);
+    size_t edge_count = 0;
+
+    for(size_t state = 0; state < state_count; state++) {
+        matcher->states[state].edge_start = edge_count;
+        for(uint16_t child = first_child[state]; child; child = next_sibling[child]) {
+            matcher->edge_bytes[edge_count] = state_byte[child];
+            matcher->edge_targets[edge_count] = child;
+            edge_count++;
+            if(state == PATTERN_MATCHER_ROOT) matcher->root[state_byte[child]] = child;
+        }
+    }
+
+    free(first_child);
+    free(next_sibling);
+    free(state_byte);
+
+    // Breadth-first pass: failure links and inherited matches
+    uint16_t* queue = malloc(sizeof(uint16_t) * state_count);
+    size_t queue_head = 0;
+    size_t queue_tail = 0;
+    queue[queue_tail++] = PATTERN_MATCHER_ROOT;
+
+    while(queue_head < queue_tail) {
+        const uint16_t state = queue[queue_head++];
+        const PatternMatcherState* node = &matcher->states[state];
+
+        for(size_t i = node->edge_start; i < node->edge_start + node->edge_count; i++) {
+            const uint8_t byte = matcher->edge_bytes[i];
+            const uint16_t child = matcher->edge_targets[i];
+            PatternMatcherState* child_node = &matcher->states[child];
+
+            uint16_t fail = PATTERN_MATCHER_ROOT;
+            if(state != PATTERN_MATCHER_ROOT) {
+                uint16_t candidate = node->fail;
+                while(candidate != PATTERN_MATCHER_ROOT &&
+                      !pattern_matcher_find_edge(matcher, candidate, byte)) {
+                    candidate = matcher->states[candidate].fail;
+                }
+                fail = candidate == PATTERN_MATCHER_ROOT ?
+                           matcher->root[byte] :
+                           pattern_matcher_find_edge(matcher, candidate, byte);
+            }
+            child_node->fail = fail;
+
+            // a pattern ending at the failure state also ends here
+            const uint16_t inherited = matcher->states[fail].match;
+            if(inherited && (!child_node->match || inherited < child_node->match)) {
+                child_node->match = inherited;
+            }
+
+            queue[queue_tail++] = child;
+        }
+    }
+
+    free(queue);
+    matcher->compiled = true;
+}
+
+bool pattern_matcher_feed(
+    PatternMatcher* matcher,
+    const uint8_t* data,
+    size_t size,
+    size_t* consumed,
+    PatternMatcherMatch* match) {
+    furi_check(matcher);
+    furi_check(data || !size);
+    furi_check(consumed);
+    furi_check(match);
+
+    if(!matcher->pattern_count) {
+        matcher->position += size;
+        *consumed = size;
+        return false;
+    }
+
+    if(!matcher->compiled) {
+        pattern_matcher_compile(matcher);
+    }
+
+    const PatternMatcherState* states = matcher->states;
+    uint16_t state = matcher->state;
+    bool found = false;
+    size_t i = 0;
+
+    while(i < size) {
+        const uint8_t byte = data[i++];
+
+        while(true) {
+            if(state == PATTERN_MATCHER_ROOT) {
+                state = matcher->root[byte];
+                break;
+            }
+            const uint16_t next = pattern_matcher_find_edge(matcher, state, byte);
+            if(next) {
+                state = next;
+                break;
+            }
+            state = states[state].fail;
+        }
+
+        if(states[state].match) {
+            found = true;
+            break;
+        }
+    }
+
+    matcher->state = state;
+    matcher->position += i;
+    *consumed = i;
+
+    if(found) {
+        const size_t index = states[state].match - 1;
+        match->index = index;
+        match->size = matcher->patterns[index].size;
+        match->offset = matcher->position - match->size;
+    }
+
+    return found;
+}
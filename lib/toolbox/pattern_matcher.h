@@ -0,0 +1,99 @@
+/**
+ * @file pattern_matcher.h
+ * Streaming multi-pattern matcher
+ *
+ * Patterns are compiled into an Aho-Corasick automaton, so data is scanned
+ * once regardless of the number and length of patterns, and may be fed in
+ * chunks of any size: partial matches carry over to the next chunk.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum total length of all patterns of one matcher */
+#define PATTERN_MATCHER_MAX_SIZE (UINT16_MAX - 1)
+
+typedef struct PatternMatcher PatternMatcher;
+
+typedef struct {
+    size_t index; /**< index of the matched pattern, in order of addition */
+    uint32_t offset; /**< offset of the first matched byte since the last reset */
+    size_t size; /**< length of the matched pattern */
+} PatternMatcherMatch;
+
+/** Allocate matcher
+ *
+ * @return     PatternMatcher instance
+ */
+PatternMatcher* pattern_matcher_alloc(void);
+
+/** Free matcher
+ *
+ * @param      matcher  PatternMatcher instance
+ */
+void pattern_matcher_free(PatternMatcher* matcher);
+
+/** Remove all patterns and reset stream state
+ *
+ * @param      matcher  PatternMatcher instance
+ */
+void pattern_matcher_clear(PatternMatcher* matcher);
+
+/** Add pattern
+ *
+ * The automaton is rebuilt on the next pattern_matcher_feed() call, stream
+ * state is reset.
+ *
+ * @param      matcher  PatternMatcher instance
+ * @param      pattern  pattern bytes, copied
+ * @param      size     pattern length, must not be 0
+ *
+ * @return     false if total patterns length exceeds PATTERN_MATCHER_MAX_SIZE
+ */
+bool pattern_matcher_add(PatternMatcher* matcher, const uint8_t* pattern, size_t size);
+
+/** Get number of added patterns
+ *
+ * @param      matcher  PatternMatcher instance
+ *
+ * @return     number of patterns
+ */
+size_t pattern_matcher_get_count(const PatternMatcher* matcher);
+
+/** Forget partial matches and restart stream offset counting from 0
+ *
+ * @param      matcher  PatternMatcher instance
+ */
+void pattern_matcher_reset(PatternMatcher* matcher);
+
+/** Feed next chunk of stream data
+ *
+ * Scanning stops right after the first match. Matches are reported in order
+ * of their end in the stream. If several patterns end at the same byte, the
+ * one added first wins.
+ *
+ * @param      matcher   PatternMatcher instance
+ * @param      data      stream data
+ * @param      size      data size
+ * @param      consumed  number of bytes scanned: size if nothing was found,
+ *                       otherwise the position right after the match
+ * @param      match     filled when a pattern is found
+ *
+ * @return     true if pattern was found
+ */
+bool pattern_matcher_feed(
+    PatternMatcher* matcher,
+    const uint8_t* data,
+    size_t size,
+    size_t* consumed,
+    PatternMatcherMatch* match);
+
+#ifdef __cplusplus
+}
+#endif
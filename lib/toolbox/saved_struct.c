@@ -1,35 +1,288 @@
 #include "saved_struct.h"
+#include "crc32_calc.h"
 #include <furi.h>
 #include <stdint.h>
 #include <storage/storage.h>
 
 #define TAG "SavedStruct"
 
+// Full rewrites go through this file, it is used if the main one got lost midway
+#define SAVED_STRUCT_NEW_SUFFIX ".new"
+// Journal is compacted once it outgrows twice the payload size plus this
+#define SAVED_STRUCT_JOURNAL_SIZE_EXTRA (256U)
+
 typedef struct {
     uint8_t magic;
     uint8_t version;
     uint8_t checksum;
     uint8_t flags;
-    uint32_t timestamp;
+    uint32_t payload_size; /**< 0 in files without journal support */
 } SavedStructHeader;
 
-bool saved_struct_save(
+/** Journal record, appended after the payload, holds chunks of changed payload bytes */
+typedef struct {
+    uint16_t size; /**< size of chunks following the record */
+    uint16_t reserved;
+    uint32_t crc; /**< crc32 of size, reserved and chunks */
+} SavedStructRecord;
+
+/** Chunk of a journal record, sets payload bytes [offset, offset + size) */
+typedef struct {
+    uint16_t offset;
+    uint16_t size;
+} SavedStructChunk;
+
+typedef struct {
+    bool journaled;
+    size_t journal_end;
+    size_t journal_size;
+} SavedStructJournal;
+
+static uint8_t saved_struct_checksum(const void* data, size_t size) {
+    uint8_t checksum = 0;
+    const uint8_t* source = data;
+    for(size_t i = 0; i < size; i++) {
+        checksum += source[i];
+    }
+    return checksum;
+}
+
+static uint32_t saved_struct_record_crc(const SavedStructRecord* record, const void* chunks) {
+    uint32_t crc = crc32_calc_buffer(0, record, offsetof(SavedStructRecord, crc));
+    return crc32_calc_buffer(crc, chunks, record->size);
+}
+
+// Chunks are checked before anything is applied, so a record is applied whole or not at all
+static bool saved_struct_record_check(const uint8_t* chunks, size_t chunks_size, size_t size) {
+    size_t offset = 0;
+    while(offset + sizeof(SavedStructChunk) <= chunks_size) {
+        SavedStructChunk chunk;
+        memcpy(&chunk, &chunks[offset], sizeof(SavedStructChunk));
+        offset += sizeof(SavedStructChunk) + chunk.size;
+        if(chunk.offset + chunk.size > size || offset > chunks_size) return false;
+    }
+    return offset == chunks_size;
+}
+
+static void saved_struct_record_apply(uint8_t* data, const uint8_t* chunks, size_t chunks_size) {
+    size_t offset = 0;
+    while(offset < chunks_size) {
+        SavedStructChunk chunk;
+        memcpy(&chunk, &chunks[offset], sizeof(SavedStructChunk));
+        offset += sizeof(SavedStructChunk);
+        memcpy(&data[chunk.offset], &chunks[offset], chunk.size);
+        offset += chunk.size;
+    }
+}
+
+// Collects changed bytes into chunks, equal runs shorter than a chunk header are included
+static size_t saved_struct_record_build(
+    uint8_t* chunks,
+    size_t chunks_capacity,
+    const uint8_t* data,
+    const uint8_t* data_saved,
+    size_t size) {
+    size_t chunks_size = 0;
+    size_t i = 0;
+
+    while(i < size) {
+        if(data[i] == data_saved[i]) {
+            i++;
+            continue;
+        }
+
+        SavedStructChunk chunk = {.offset = i};
+        size_t end = i + 1;
+        size_t equal = 0;
+        for(size_t j = end; j < size && equal <= sizeof(SavedStructChunk); j++) {
+            if(data[j] == data_saved[j]) {
+                equal++;
+            } else {
+                equal = 0;
+                end = j + 1;
+            }
+        }
+        chunk.size = end - i;
+
+        if(chunks_size + sizeof(SavedStructChunk) + chunk.size > chunks_capacity) return 0;
+        memcpy(&chunks[chunks_size], &chunk, sizeof(SavedStructChunk));
+        chunks_size += sizeof(SavedStructChunk);
+        memcpy(&chunks[chunks_size], &data[i], chunk.size);
+        chunks_size += chunk.size;
+        i = end;
+    }
+
+    return chunks_size;
+}
+
+// Reads payload and replays the journal up to the first incomplete record
+static bool saved_struct_read(
+    File* file,
+    const char* path,
+    void* data,
+    size_t size,
+    uint8_t magic,
+    uint8_t version,
+    SavedStructJournal* journal) {
+    SavedStructHeader header;
+
+    size_t bytes_count = storage_file_read(file, &header, sizeof(SavedStructHeader));
+    bytes_count += storage_file_read(file, data, size);
+
+    if(bytes_count != (sizeof(SavedStructHeader) + size)) {
+        FURI_LOG_E(TAG, "Size mismatch of file \"%s\"", path);
+        return false;
+    }
+
+    if(header.magic != magic || header.version != version) {
+        FURI_LOG_E(
+            TAG,
+            "Magic(%d != %d) or Version(%d != %d) mismatch of file \"%s\"",
+            header.magic,
+            magic,
+            header.version,
+            version,
+            path);
+        return false;
+    }
+
+    if(header.payload_size != 0 && header.payload_size != size) {
+        FURI_LOG_E(
+            TAG, "Size(%lu != %zu) mismatch of file \"%s\"", header.payload_size, size, path);
+        return false;
+    }
+
+    uint8_t checksum = saved_struct_checksum(data, size);
+    if(header.checksum != checksum) {
+        FURI_LOG_E(
+            TAG, "Checksum(%d != %d) mismatch of file \"%s\"", header.checksum, checksum, path);
+        return false;
+    }
+
+    journal->journaled = (header.payload_size != 0);
+    journal->journal_end = sizeof(SavedStructHeader) + size;
+    journal->journal_size = 0;
+
+    if(!journal->journaled) {
+        return true;
+    }
+
+    const size_t chunks_capacity = size + sizeof(SavedStructChunk);
+    uint8_t* chunks = malloc(chunks_capacity);
+    SavedStructRecord record;
+    while(storage_file_read(file, &record, sizeof(SavedStructRecord)) ==
+          sizeof(SavedStructRecord)) {
+        if(record.size == 0 || record.size > chunks_capacity) break;
+        if(storage_file_read(file, chunks, record.size) != record.size) break;
+        if(saved_struct_record_crc(&record, chunks) != record.crc) break;
+        if(!saved_struct_record_check(chunks, record.size, size)) break;
+
+        saved_struct_record_apply(data, chunks, record.size);
+        journal->journal_end += sizeof(SavedStructRecord) + record.size;
+        journal->journal_size += sizeof(SavedStructRecord) + record.size;
+    }
+    free(chunks);
+
+    if(journal->journal_end != storage_file_size(file)) {
+        FURI_LOG_W(TAG, "Incomplete journal record in \"%s\"", path);
+    }
+
+    return true;
+}
+
+static bool saved_struct_load_file(
+    File* file,
+    const char* path,
+    void* data,
+    size_t size,
+    uint8_t magic,
+    uint8_t version) {
+    SavedStructJournal journal;
+    bool result = false;
+
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        result = saved_struct_read(file, path, data, size, magic, version, &journal);
+    } else {
+        FURI_LOG_E(
+            TAG, "Failed to read \"%s\". Error: %s", path, storage_file_get_error_desc(file));
+    }
+
+    storage_file_close(file);
+    return result;
+}
+
+// Appends changed bytes as one record, false if a full rewrite is needed
+static bool saved_struct_append(
+    File* file,
     const char* path,
     const void* data,
     size_t size,
     uint8_t magic,
     uint8_t version) {
-    furi_check(path);
-    furi_check(data);
-    furi_check(size);
-    SavedStructHeader header;
+    SavedStructJournal journal;
+    uint8_t* data_saved = malloc(size);
+    const size_t chunks_capacity = size + sizeof(SavedStructChunk);
+    uint8_t* chunks = malloc(chunks_capacity);
+    bool result = false;
 
-    FURI_LOG_I(TAG, "Saving \"%s\"", path);
+    do {
+        if(chunks_capacity > UINT16_MAX) break;
+        if(!storage_file_open(file, path, FSAM_READ_WRITE, FSOM_OPEN_EXISTING)) break;
+        if(!saved_struct_read(file, path, data_saved, size, magic, version, &journal)) break;
+        // Files without journal support are migrated by a full rewrite
+        if(!journal.journaled) break;
 
-    // Store
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(storage);
+        if(memcmp(data, data_saved, size) == 0) {
+            result = true;
+            break;
+        }
+
+        SavedStructRecord record = {
+            .size = saved_struct_record_build(chunks, chunks_capacity, data, data_saved, size),
+            .reserved = 0,
+        };
+        if(record.size == 0 || journal.journal_size + sizeof(SavedStructRecord) + record.size >
+                                   size * 2 + SAVED_STRUCT_JOURNAL_SIZE_EXTRA) {
+            FURI_LOG_D(TAG, "Compacting \"%s\"", path);
+            break;
+        }
+        record.crc = saved_struct_record_crc(&record, chunks);
+
+        // Drop incomplete record left by an interrupted save
+        if(!storage_file_seek(file, journal.journal_end, true)) break;
+        if(journal.journal_end != storage_file_size(file) && !storage_file_truncate(file)) break;
+
+        size_t bytes_count = storage_file_write(file, &record, sizeof(SavedStructRecord));
+        bytes_count += storage_file_write(file, chunks, record.size);
+
+        if(bytes_count != (sizeof(SavedStructRecord) + record.size)) {
+            FURI_LOG_E(
+                TAG,
+                "Write failed \"%s\". Error: \'%s\'",
+                path,
+                storage_file_get_error_desc(file));
+            break;
+        }
+
+        result = true;
+    } while(false);
+
+    storage_file_close(file);
+    free(chunks);
+    free(data_saved);
+    return result;
+}
+
+static bool saved_struct_write(
+    File* file,
+    const char* path,
+    const void* data,
+    size_t size,
+    uint8_t magic,
+    uint8_t version) {
+    SavedStructHeader header;
     bool result = true;
+
     bool saved = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS);
     if(!saved) {
         FURI_LOG_E(
@@ -38,18 +291,12 @@ bool saved_struct_save(
     }
 
     if(result) {
-        // Calculate checksum
-        uint8_t checksum = 0;
-        const uint8_t* source = data;
-        for(size_t i = 0; i < size; i++) {
-            checksum += source[i];
-        }
         // Set header
         header.magic = magic;
         header.version = version;
-        header.checksum = checksum;
+        header.checksum = saved_struct_checksum(data, size);
         header.flags = 0;
-        header.timestamp = 0;
+        header.payload_size = size;
 
         size_t bytes_count = storage_file_write(file, &header, sizeof(header));
         bytes_count += storage_file_write(file, data, size);
@@ -62,72 +309,73 @@ bool saved_struct_save(
     }
 
     storage_file_close(file);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
     return result;
 }
 
-bool saved_struct_load(const char* path, void* data, size_t size, uint8_t magic, uint8_t version) {
+bool saved_struct_save(
+    const char* path,
+    const void* data,
+    size_t size,
+    uint8_t magic,
+    uint8_t version) {
     furi_check(path);
     furi_check(data);
     furi_check(size);
 
-    FURI_LOG_I(TAG, "Loading \"%s\"", path);
-
-    SavedStructHeader header;
+    FURI_LOG_I(TAG, "Saving \"%s\"", path);
 
-    uint8_t* data_read = malloc(size);
+    // Store
     Storage* storage = furi_record_open(RECORD_STORAGE);
     File* file = storage_file_alloc(storage);
     bool result = true;
-    bool loaded = storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING);
-    if(!loaded) {
-        FURI_LOG_E(
-            TAG, "Failed to read \"%s\". Error: %s", path, storage_file_get_error_desc(file));
-        result = false;
-    }
 
-    if(result) {
-        size_t bytes_count = storage_file_read(file, &header, sizeof(SavedStructHeader));
-        bytes_count += storage_file_read(file, data_read, size);
-
-        if(bytes_count != (sizeof(SavedStructHeader) + size)) {
-            FURI_LOG_E(TAG, "Size mismatch of file \"%s\"", path);
-            result = false;
+    if(!storage_file_exists(storage, path)) {
+        result = saved_struct_write(file, path, data, size, magic, version);
+    } else if(!saved_struct_append(file, path, data, size, magic, version)) {
+        // Full rewrite, existing file stays intact until the new one is complete
+        FuriString* path_new = furi_string_alloc_printf("%s%s", path, SAVED_STRUCT_NEW_SUFFIX);
+        result = saved_struct_write(
+            file, furi_string_get_cstr(path_new), data, size, magic, version);
+        if(result) {
+            result = storage_common_rename(storage, furi_string_get_cstr(path_new), path) ==
+                     FSE_OK;
         }
+        furi_string_free(path_new);
     }
 
-    if(result && (header.magic != magic || header.version != version)) {
-        FURI_LOG_E(
-            TAG,
-            "Magic(%d != %d) or Version(%d != %d) mismatch of file \"%s\"",
-            header.magic,
-            magic,
-            header.version,
-            version,
-            path);
-        result = false;
-    }
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return result;
+}
 
-    if(result) {
-        uint8_t checksum = 0;
-        const uint8_t* source = (const uint8_t*)data_read;
-        for(size_t i = 0; i < size; i++) {
-            checksum += source[i];
-        }
+bool saved_struct_load(const char* path, void* data, size_t size, uint8_t magic, uint8_t version) {
+    furi_check(path);
+    furi_check(data);
+    furi_check(size);
 
-        if(header.checksum != checksum) {
-            FURI_LOG_E(
-                TAG, "Checksum(%d != %d) mismatch of file \"%s\"", header.checksum, checksum, path);
-            result = false;
+    FURI_LOG_I(TAG, "Loading \"%s\"", path);
+
+    uint8_t* data_read = malloc(size);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    bool result = saved_struct_load_file(file, path, data_read, size, magic, version);
+
+    if(!result) {
+        // Save could have been interrupted while replacing the file
+        FuriString* path_new = furi_string_alloc_printf("%s%s", path, SAVED_STRUCT_NEW_SUFFIX);
+        if(storage_file_exists(storage, furi_string_get_cstr(path_new))) {
+            FURI_LOG_W(TAG, "Loading \"%s\"", furi_string_get_cstr(path_new));
+            result = saved_struct_load_file(
+                file, furi_string_get_cstr(path_new), data_read, size, magic, version);
         }
+        furi_string_free(path_new);
     }
 
     if(result) {
         memcpy(data, data_read, size);
     }
 
-    storage_file_close(file);
     storage_file_free(file);
     furi_record_close(RECORD_STORAGE);
     free(data_read);
@@ -151,7 +399,15 @@ bool saved_struct_get_metadata(
         if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
             FURI_LOG_E(
                 TAG, "Failed to read \"%s\". Error: %s", path, storage_file_get_error_desc(file));
-            break;
+
+            // Save could have been interrupted while replacing the file
+            FuriString* path_new =
+                furi_string_alloc_printf("%s%s", path, SAVED_STRUCT_NEW_SUFFIX);
+            storage_file_close(file);
+            bool opened = storage_file_open(
+                file, furi_string_get_cstr(path_new), FSAM_READ, FSOM_OPEN_EXISTING);
+            furi_string_free(path_new);
+            if(!opened) break;
         }
 
         if(storage_file_read(file, &header, sizeof(SavedStructHeader)) !=
@@ -167,8 +423,12 @@ bool saved_struct_get_metadata(
             *version = header.version;
         }
         if(payload_size) {
-            uint64_t file_size = storage_file_size(file);
-            *payload_size = file_size - sizeof(SavedStructHeader);
+            if(header.payload_size) {
+                *payload_size = header.payload_size;
+            } else {
+                uint64_t file_size = storage_file_size(file);
+                *payload_size = file_size - sizeof(SavedStructHeader);
+            }
         }
 
         result = true;
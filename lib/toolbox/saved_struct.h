@@ -26,6 +26,11 @@ extern "C" {
 bool saved_struct_load(const char* path, void* data, size_t size, uint8_t magic, uint8_t version);
 
 /** Save data in saved structure format
+ *
+ * Changed bytes are appended to the file as a checksummed journal record.
+ * Whole file is rewritten when the journal grows too large, the file has
+ * an older format or a different size. Interrupted save leaves the previous
+ * data loadable.
  *
  * @param[in]  path     The path to the file
  * @param[in]  data     Pointer to the memory where data
@@ -103,15 +103,15 @@ static void buffered_file_stream_free(BufferedFileStream* stream) {
 
 static bool buffered_file_stream_eof(BufferedFileStream* stream) {
     bool ret;
-    const bool file_stream_eof = stream_eof(stream->file_stream);
     const bool cache_at_end = stream_cache_at_end(stream->cache);
     if(!stream->sync_pending) {
-        ret = file_stream_eof && cache_at_end;
+        // Keyed reads check for EOF on every key, only ask the storage when the cache is used up
+        ret = cache_at_end && stream_eof(stream->file_stream);
     } else {
         const size_t remaining_size =
             stream_size(stream->file_stream) - stream_tell(stream->file_stream);
         ret = stream_cache_size(stream->cache) >=
-              (remaining_size ? cache_at_end : file_stream_eof);
+              (remaining_size ? cache_at_end : stream_eof(stream->file_stream));
     }
     return ret;
 }
@@ -340,7 +340,7 @@ static int archive_extract_foreach_cb(mtar_t* tar, const mtar_header_t* header,
     }
 
     if(skip_entry) {
-        FURI_LOG_W(TAG, "filter: skipping entry \"%s\"", header->name);
+        FURI_LOG_D(TAG, "filter: skipping entry \"%s\"", header->name);
         return 0;
     }
 
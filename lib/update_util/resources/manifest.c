@@ -4,6 +4,8 @@
 #include <toolbox/strint.h>
 #include <toolbox/hex.h>
 
+#define TAG "ResourceManifest"
+
 struct ResourceManifestReader {
     Storage* storage;
     Stream* stream;
@@ -173,3 +175,200 @@ bool resource_manifest_rewind(ResourceManifestReader* resource_manifest) {
 
     return stream_seek(resource_manifest->stream, 0, StreamOffsetFromStart);
 }
+
+/* Only manifests of this version are indexed, others get a full install */
+#define RESOURCE_MANIFEST_INDEX_VERSION "0"
+
+/* Half of the MD5: an edited file of the same size is never taken for the old one
+ * in practice, and 2000 entries still take less than 48 KiB */
+#define RESOURCE_MANIFEST_INDEX_HASH_SIZE (8U)
+
+typedef enum {
+    ResourceManifestIndexFlagDirectory = (1 << 0),
+    ResourceManifestIndexFlagAmbiguous = (1 << 1),
+    ResourceManifestIndexFlagInstalled = (1 << 2),
+} ResourceManifestIndexFlag;
+
+typedef struct {
+    uint64_t name_hash;
+    uint32_t size;
+    uint8_t hash[RESOURCE_MANIFEST_INDEX_HASH_SIZE];
+    uint8_t flags;
+} ResourceManifestIndexEntry;
+
+struct ResourceManifestIndex {
+    size_t count;
+    ResourceManifestIndexEntry* entries;
+};
+
+static uint64_t resource_manifest_index_hash_name(const char* name) {
+    /* FNV-1a */
+    uint64_t hash = 14695981039346656037ULL;
+    while(*name) {
+        hash = (hash ^ (uint8_t)*name++) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int resource_manifest_index_compare(const void* a, const void* b) {
+    const uint64_t hash_a = ((const ResourceManifestIndexEntry*)a)->name_hash;
+    const uint64_t hash_b = ((const ResourceManifestIndexEntry*)b)->name_hash;
+    return (hash_a > hash_b) - (hash_a < hash_b);
+}
+
+static ResourceManifestIndexEntry*
+    resource_manifest_index_find(const ResourceManifestIndex* index, const char* name) {
+    const uint64_t name_hash = resource_manifest_index_hash_name(name);
+
+    size_t low = 0, high = index->count;
+    while(low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if(index->entries[mid].name_hash < name_hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if(low < index->count && index->entries[low].name_hash == name_hash) {
+        return &index->entries[low];
+    }
+    return NULL;
+}
+
+ResourceManifestIndex* resource_manifest_index_alloc(Storage* storage, const char* filename) {
+    furi_assert(storage);
+    furi_assert(filename);
+
+    ResourceManifestReader* reader = resource_manifest_reader_alloc(storage);
+    ResourceManifestIndex* index = NULL;
+
+    do {
+        if(!resource_manifest_reader_open(reader, filename)) break;
+
+        ResourceManifestEntry* entry;
+        size_t count = 0;
+        bool version_supported = true;
+        while((entry = resource_manifest_reader_next(reader))) {
+            if(entry->type == ResourceManifestEntryTypeFile ||
+               entry->type == ResourceManifestEntryTypeDirectory) {
+                count++;
+            } else if(entry->type == ResourceManifestEntryTypeVersion) {
+                version_supported &=
+                    furi_string_equal_str(entry->name, RESOURCE_MANIFEST_INDEX_VERSION);
+            }
+        }
+
+        if(!version_supported) {
+            FURI_LOG_W(TAG, "Unsupported manifest version");
+            break;
+        }
+
+        /* Leave most of the heap to the rest of the update */
+        const size_t entries_size = count * sizeof(ResourceManifestIndexEntry);
+        if(entries_size > memmgr_heap_get_max_free_block() / 2) {
+            FURI_LOG_W(TAG, "%zu entries do not fit in memory", count);
+            break;
+        }
+
+        if(!resource_manifest_rewind(reader)) break;
+
+        index = malloc(sizeof(ResourceManifestIndex));
+        index->entries = malloc(MAX(entries_size, sizeof(ResourceManifestIndexEntry)));
+        index->count = 0;
+
+        while((entry = resource_manifest_reader_next(reader)) && index->count < count) {
+            if(entry->type != ResourceManifestEntryTypeFile &&
+               entry->type != ResourceManifestEntryTypeDirectory) {
+                continue;
+            }
+
+            ResourceManifestIndexEntry* index_entry = &index->entries[index->count++];
+            index_entry->name_hash =
+                resource_manifest_index_hash_name(furi_string_get_cstr(entry->name));
+            index_entry->size = entry->size;
+            memcpy(index_entry->hash, entry->hash, RESOURCE_MANIFEST_INDEX_HASH_SIZE);
+            index_entry->flags = entry->type == ResourceManifestEntryTypeDirectory ?
+                                     ResourceManifestIndexFlagDirectory :
+                                     0;
+        }
+
+        qsort(
+            index->entries,
+            index->count,
+            sizeof(ResourceManifestIndexEntry),
+            resource_manifest_index_compare);
+
+        /* Entries with colliding name hashes are never considered the same */
+        for(size_t i = 1; i < index->count; i++) {
+            if(index->entries[i].name_hash == index->entries[i - 1].name_hash) {
+                index->entries[i].flags |= ResourceManifestIndexFlagAmbiguous;
+                index->entries[i - 1].flags |= ResourceManifestIndexFlagAmbiguous;
+            }
+        }
+    } while(false);
+
+    resource_manifest_reader_free(reader);
+    return index;
+}
+
+void resource_manifest_index_free(ResourceManifestIndex* index) {
+    furi_assert(index);
+
+    free(index->entries);
+    free(index);
+}
+
+size_t resource_manifest_index_get_count(const ResourceManifestIndex* index) {
+    furi_assert(index);
+
+    return index->count;
+}
+
+ResourceManifestIndexMatch resource_manifest_index_match(
+    const ResourceManifestIndex* index,
+    const ResourceManifestEntry* entry) {
+    furi_assert(index);
+    furi_assert(entry);
+
+    const ResourceManifestIndexEntry* index_entry =
+        resource_manifest_index_find(index, furi_string_get_cstr(entry->name));
+
+    if(!index_entry) {
+        return ResourceManifestIndexMatchNone;
+    } else if(index_entry->flags & ResourceManifestIndexFlagAmbiguous) {
+        return ResourceManifestIndexMatchChanged;
+    }
+
+    const bool is_directory = index_entry->flags & ResourceManifestIndexFlagDirectory;
+    if((entry->type == ResourceManifestEntryTypeDirectory) != is_directory) {
+        /* File replaced with directory or vice versa */
+        return ResourceManifestIndexMatchNone;
+    } else if(is_directory) {
+        return ResourceManifestIndexMatchSame;
+    } else if(
+        index_entry->size != entry->size ||
+        memcmp(index_entry->hash, entry->hash, RESOURCE_MANIFEST_INDEX_HASH_SIZE) != 0) {
+        return ResourceManifestIndexMatchChanged;
+    }
+
+    return ResourceManifestIndexMatchSame;
+}
+
+void resource_manifest_index_set_installed(ResourceManifestIndex* index, const char* name) {
+    furi_assert(index);
+    furi_assert(name);
+
+    ResourceManifestIndexEntry* index_entry = resource_manifest_index_find(index, name);
+    if(index_entry && !(index_entry->flags & ResourceManifestIndexFlagAmbiguous)) {
+        index_entry->flags |= ResourceManifestIndexFlagInstalled;
+    }
+}
+
+bool resource_manifest_index_is_installed(const ResourceManifestIndex* index, const char* name) {
+    furi_assert(index);
+    furi_assert(name);
+
+    const ResourceManifestIndexEntry* index_entry = resource_manifest_index_find(index, name);
+    return index_entry && (index_entry->flags & ResourceManifestIndexFlagInstalled);
+}
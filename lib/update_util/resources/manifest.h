@@ -73,6 +73,64 @@ ResourceManifestEntry* resource_manifest_reader_next(ResourceManifestReader* res
 ResourceManifestEntry*
     resource_manifest_reader_previous(ResourceManifestReader* resource_manifest);
 
+typedef enum {
+    ResourceManifestIndexMatchNone, /**< No entry of the same type with this name */
+    ResourceManifestIndexMatchChanged, /**< File differs in size or hash */
+    ResourceManifestIndexMatchSame, /**< Entry is the same */
+} ResourceManifestIndexMatch;
+
+typedef struct ResourceManifestIndex ResourceManifestIndex;
+
+/**
+ * @brief Load file and directory entries of a manifest into a compact lookup index
+ *
+ * Only a hash of each name is kept, along with the size and the first half of the file MD5.
+ *
+ * @param storage Storage API pointer
+ * @param filename manifest file name
+ * @return allocated object or NULL if the manifest can't be read, has an unsupported
+ *         version or does not fit in memory
+ */
+ResourceManifestIndex* resource_manifest_index_alloc(Storage* storage, const char* filename);
+
+/**
+ * @brief Release resource manifest index
+ * @param index allocated object
+ */
+void resource_manifest_index_free(ResourceManifestIndex* index);
+
+/**
+ * @brief Get number of indexed entries
+ * @param index allocated object
+ * @return number of file and directory entries
+ */
+size_t resource_manifest_index_get_count(const ResourceManifestIndex* index);
+
+/**
+ * @brief Compare an entry of another manifest with the indexed one of the same name
+ * @param index allocated object
+ * @param entry file or directory entry
+ * @return match result
+ */
+ResourceManifestIndexMatch resource_manifest_index_match(
+    const ResourceManifestIndex* index,
+    const ResourceManifestEntry* entry);
+
+/**
+ * @brief Mark indexed file as already present at its destination
+ * @param index allocated object
+ * @param name file name as in the manifest
+ */
+void resource_manifest_index_set_installed(ResourceManifestIndex* index, const char* name);
+
+/**
+ * @brief Check if indexed file has been marked as already present at its destination
+ * @param index allocated object
+ * @param name file name as in the manifest
+ * @return true if marked with resource_manifest_index_set_installed
+ */
+bool resource_manifest_index_is_installed(const ResourceManifestIndex* index, const char* name);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
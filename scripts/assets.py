@@ -95,6 +95,13 @@ class Main(App):
             help="Symbol and file name in dolphin output directory",
             default=None,
         )
+        self.parser_dolphin.add_argument(
+            "-p",
+            "--pack",
+            help="Pack each external animation into a single file",
+            action="store_true",
+            default=False,
+        )
         self.parser_dolphin.add_argument(
             "input_directory", help="Dolphin source directory"
         )
@@ -290,7 +297,7 @@ class Main(App):
         self.logger.info("Loading data")
         dolphin.load(self.args.input_directory)
         self.logger.info("Packing")
-        dolphin.pack(self.args.output_directory, self.args.symbol_name)
+        dolphin.pack(self.args.output_directory, self.args.symbol_name, self.args.pack)
         self.logger.info("Complete")
 
         return 0
@@ -206,6 +206,7 @@ def generate(env):
                             "${PYTHON3}",
                             "${ASSETS_COMPILER}",
                             "dolphin",
+                            "--pack",
                             "${_DOLPHIN_SRC_DIR}",
                             "${_DOLPHIN_OUT_DIR}",
                         ],
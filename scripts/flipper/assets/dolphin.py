@@ -1,6 +1,8 @@
 import multiprocessing
 import logging
 import os
+import shutil
+import struct
 from collections import Counter
 
 from flipper.utils.fff import FlipperFormatFile
@@ -10,11 +12,17 @@ from .icon import ImageTools, file2image
 
 def _convert_image_to_bm(pair: set):
     source_filename, destination_filename = pair
+    if source_filename.endswith(".bm"):
+        shutil.copyfile(source_filename, destination_filename)
+        return
     image = file2image(source_filename)
     image.write(destination_filename)
 
 
 def _convert_image(source_filename: str):
+    if source_filename.endswith(".bm"):
+        with open(source_filename, "rb") as file:
+            return file.read()
     image = file2image(source_filename)
     return image.data
 
@@ -23,6 +31,15 @@ class DolphinBubbleAnimation:
     FILE_TYPE = "Flipper Animation"
     FILE_VERSION = 1
 
+    # Single file animation, see animation_storage.c
+    PACK_FILENAME = "animation.pack"
+    PACK_MAGIC = b"ANPK"
+    PACK_VERSION = 1
+    PACK_HEADER = struct.Struct("<4sBBBBBBBBHHBBHI")
+    PACK_BUBBLE = struct.Struct("<8B")
+    PACK_ALIGN = ["Left", "Right", "Top", "Bottom", "Center"]
+    BUBBLE_TEXT_MAX = 100
+
     def __init__(
         self,
         name: str,
@@ -101,6 +118,9 @@ class DolphinBubbleAnimation:
             ordered_frames_count = len(self.meta["Frames order"])
             for i in range(max_frame_number + 1):
                 frame_filename = os.path.join(animation_directory, f"frame_{i}.png")
+                if not os.path.isfile(frame_filename):
+                    # Already converted animation, i.e. resources from SD card
+                    frame_filename = os.path.join(animation_directory, f"frame_{i}.bm")
                 assert os.path.isfile(frame_filename)
                 self.frames.append(frame_filename)
             # Sanity check
@@ -231,6 +251,62 @@ class DolphinBubbleAnimation:
             for image in to_pack:
                 _convert_image_to_bm(image)
 
+    def save_pack(self, output_directory: str):
+        animation_directory = os.path.join(output_directory, self.name)
+        os.makedirs(animation_directory, exist_ok=True)
+        pack_filename = os.path.join(animation_directory, self.PACK_FILENAME)
+
+        self.process()
+
+        frame_offsets = []
+        frame_data = bytearray()
+        for frame in self.frames:
+            frame_offsets.append(len(frame_data))
+            frame_data += frame
+
+        bubble_data = bytearray()
+        for bubble in self.bubbles:
+            text = bubble["Text"].replace("\\n", "\n").encode()
+            assert len(text) <= self.BUBBLE_TEXT_MAX
+            bubble_data += self.PACK_BUBBLE.pack(
+                bubble["Slot"],
+                bubble["X"],
+                bubble["Y"],
+                self.PACK_ALIGN.index(bubble["AlignH"]),
+                self.PACK_ALIGN.index(bubble["AlignV"]),
+                bubble["StartFrame"],
+                bubble["EndFrame"],
+                len(text),
+            )
+            bubble_data += text
+
+        meta = struct.pack(f"<{len(frame_offsets)}I", *frame_offsets)
+        meta += bytes(self.meta["Frames order"])
+        meta += bubble_data
+
+        header = self.PACK_HEADER.pack(
+            self.PACK_MAGIC,
+            self.PACK_VERSION,
+            self.meta["Width"],
+            self.meta["Height"],
+            len(self.frames),
+            self.meta["Passive frames"],
+            self.meta["Active frames"],
+            self.meta["Active cycles"],
+            self.meta["Frame rate"],
+            self.meta["Duration"],
+            self.meta["Active cooldown"],
+            self.bubble_slots,
+            len(self.bubbles),
+            len(meta),
+            len(frame_data),
+        )
+
+        with open(pack_filename, "wb") as file:
+            file.write(header)
+            file.write(meta)
+            file.write(frame_data)
+
     def process(self):
         if ImageTools.is_processing_slow():
             pool = multiprocessing.Pool()
@@ -325,7 +401,7 @@ class DolphinManifest:
             symbol_name=symbol_name,
         )
 
-    def save2folder(self, output_directory: str):
+    def save2folder(self, output_directory: str, packed: bool = False):
         manifest_filename = os.path.join(output_directory, "manifest.txt")
         file = FlipperFormatFile()
         file.setHeader(self.FILE_TYPE, self.FILE_VERSION)
@@ -340,16 +416,19 @@ class DolphinManifest:
             file.writeKey("Weight", animation.weight)
             file.writeEmptyLine()
 
-            animation.save(output_directory)
+            if packed:
+                animation.save_pack(output_directory)
+            else:
+                animation.save(output_directory)
 
         file.save(manifest_filename)
 
-    def save(self, output_directory: str, symbol_name: str):
+    def save(self, output_directory: str, symbol_name: str, packed: bool = False):
         os.makedirs(output_directory, exist_ok=True)
         if symbol_name:
             self.save2code(output_directory, symbol_name)
         else:
-            self.save2folder(output_directory)
+            self.save2folder(output_directory, packed)
 
 
 class Dolphin:
@@ -363,5 +442,7 @@ class Dolphin:
         self.logger.info(f"Loading directory {source_directory}")
         self.manifest.load(source_directory)
 
-    def pack(self, output_directory: str, symbol_name: str = None):
-        self.manifest.save(output_directory, symbol_name)
+    def pack(
+        self, output_directory: str, symbol_name: str = None, packed: bool = False
+    ):
+        self.manifest.save(output_directory, symbol_name, packed)
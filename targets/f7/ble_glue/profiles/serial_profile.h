@@ -31,6 +31,18 @@ extern const FuriHalBleProfileTemplate* ble_profile_serial;
  */
 bool ble_profile_serial_tx(FuriHalBleProfileBase* profile, uint8_t* data, uint16_t size);
 
+/** Check if the last sent data is to be confirmed by the client
+ *
+ * Indications are confirmed one by one, FuriHalBtSerialCallback receives
+ * SerialServiceEventTypeDataSent for each. Notifications are queued in the
+ * controller without confirmation, so the next packet can be sent right away.
+ *
+ * @param profile       Profile instance
+ *
+ * @return      true if confirmation is to be awaited
+ */
+bool ble_profile_serial_is_tx_acknowledged(FuriHalBleProfileBase* profile);
+
 /** Set BLE RPC status
  *
  * @param profile       Profile instance
@@ -11,6 +11,14 @@
 
 #define TAG "BtSerialSvc"
 
+#define BLE_SVC_SERIAL_TX_POOL_TIMEOUT_MS (1000UL)
+
+// Flow control state: credits granted to the client and a flag for a write being fed to the app
+#define BLE_SVC_SERIAL_RX_CREDITS_MASK (0xFFFFUL)
+#define BLE_SVC_SERIAL_RX_FEEDING      (1UL << 16)
+
+#define BLE_SVC_SERIAL_TX_CCCD_NOTIFY (0x0001U)
+
 typedef enum {
     SerialSvcGattCharacteristicRx = 0,
     SerialSvcGattCharacteristicTx,
@@ -36,7 +44,7 @@ static const BleGattCharacteristicParams ble_svc_serial_chars[SerialSvcGattChara
          .data.fixed.length = BLE_SVC_SERIAL_DATA_LEN_MAX,
          .uuid.Char_UUID_128 = BLE_SVC_SERIAL_TX_CHAR_UUID,
          .uuid_type = UUID_TYPE_128,
-         .char_properties = CHAR_PROP_READ | CHAR_PROP_INDICATE,
+         .char_properties = CHAR_PROP_READ | CHAR_PROP_NOTIFY | CHAR_PROP_INDICATE,
          .security_permissions = ATTR_PERMISSION_AUTHEN_READ,
          .gatt_evt_mask = GATT_DONT_NOTIFY_EVENTS,
          .is_variable = CHAR_VALUE_LEN_VARIABLE},
@@ -64,9 +72,10 @@ static const BleGattCharacteristicParams ble_svc_serial_chars[SerialSvcGattChara
 struct BleServiceSerial {
     uint16_t svc_handle;
     BleGattCharacteristicInstance chars[SerialSvcGattCharacteristicCount];
-    FuriMutex* buff_size_mtx;
     uint32_t buff_size;
-    uint16_t bytes_ready_to_receive;
+    uint32_t rx_state;
+    bool tx_acknowledged;
+    FuriSemaphore* tx_pool_sem;
     SerialServiceEventCallback callback;
     void* context;
     GapSvcEventHandler* event_handler;
@@ -91,18 +100,27 @@ static BleEventAckStatus ble_svc_serial_event_handler(void* event, void* context
                 serial_svc->chars[SerialSvcGattCharacteristicRx].handle + 1) {
                 FURI_LOG_D(TAG, "Received %d bytes", attribute_modified->Attr_Data_Length);
                 if(serial_svc->callback) {
-                    furi_check(
-                        furi_mutex_acquire(serial_svc->buff_size_mtx, FuriWaitForever) ==
-                        FuriStatusOk);
-                    if(attribute_modified->Attr_Data_Length > serial_svc->bytes_ready_to_receive) {
+                    // Credits are taken before feeding, so a concurrent buffer empty
+                    // notification knows that this write is not in the buffer yet
+                    uint32_t state = __atomic_load_n(&serial_svc->rx_state, __ATOMIC_RELAXED);
+                    uint32_t credits;
+                    do {
+                        credits = state & BLE_SVC_SERIAL_RX_CREDITS_MASK;
+                    } while(!__atomic_compare_exchange_n(
+                        &serial_svc->rx_state,
+                        &state,
+                        (credits - MIN(credits, attribute_modified->Attr_Data_Length)) |
+                            BLE_SVC_SERIAL_RX_FEEDING,
+                        true,
+                        __ATOMIC_ACQ_REL,
+                        __ATOMIC_RELAXED));
+                    if(attribute_modified->Attr_Data_Length > credits) {
                         FURI_LOG_W(
                             TAG,
-                            "Received %d, while was ready to receive %d bytes. Can lead to buffer overflow!",
+                            "Received %d, while was ready to receive %ld bytes. Can lead to buffer overflow!",
                             attribute_modified->Attr_Data_Length,
-                            serial_svc->bytes_ready_to_receive);
+                            credits);
                     }
-                    serial_svc->bytes_ready_to_receive -= MIN(
-                        serial_svc->bytes_ready_to_receive, attribute_modified->Attr_Data_Length);
                     SerialServiceEvent event = {
                         .event = SerialServiceEventTypeDataReceived,
                         .data = {
@@ -111,7 +129,8 @@ static BleEventAckStatus ble_svc_serial_event_handler(void* event, void* context
                         }};
                     uint32_t buff_free_size = serial_svc->callback(event, serial_svc->context);
                     FURI_LOG_D(TAG, "Available buff size: %ld", buff_free_size);
-                    furi_check(furi_mutex_release(serial_svc->buff_size_mtx) == FuriStatusOk);
+                    __atomic_fetch_and(
+                        &serial_svc->rx_state, ~BLE_SVC_SERIAL_RX_FEEDING, __ATOMIC_RELEASE);
                 }
                 ret = BleEventAckFlowEnable;
             } else if(
@@ -136,6 +155,10 @@ static BleEventAckStatus ble_svc_serial_event_handler(void* event, void* context
                 serial_svc->callback(event, serial_svc->context);
             }
             ret = BleEventAckFlowEnable;
+        } else if(blecore_evt->ecode == ACI_GATT_TX_POOL_AVAILABLE_VSEVT_CODE) {
+            if(furi_semaphore_get_count(serial_svc->tx_pool_sem) == 0) {
+                furi_semaphore_release(serial_svc->tx_pool_sem);
+            }
         }
     }
     return ret;
@@ -169,7 +192,9 @@ BleServiceSerial* ble_svc_serial_start(void) {
     }
 
     ble_svc_serial_update_rpc_char(serial_svc, SerialServiceRpcStatusNotActive);
-    serial_svc->buff_size_mtx = furi_mutex_alloc(FuriMutexTypeNormal);
+    serial_svc->rx_state = 0;
+    serial_svc->tx_acknowledged = true;
+    serial_svc->tx_pool_sem = furi_semaphore_alloc(1, 0);
 
     return serial_svc;
 }
@@ -183,7 +208,7 @@ void ble_svc_serial_set_callbacks(
     serial_svc->callback = callback;
     serial_svc->context = context;
     serial_svc->buff_size = buff_size;
-    serial_svc->bytes_ready_to_receive = buff_size;
+    __atomic_store_n(&serial_svc->rx_state, buff_size, __ATOMIC_RELEASE);
 
     uint32_t buff_size_reversed = REVERSE_BYTES_U32(serial_svc->buff_size);
     ble_gatt_characteristic_update(
@@ -194,20 +219,33 @@ void ble_svc_serial_set_callbacks(
 
 void ble_svc_serial_notify_buffer_is_empty(BleServiceSerial* serial_svc) {
     furi_check(serial_svc);
-    furi_check(serial_svc->buff_size_mtx);
-
-    furi_check(furi_mutex_acquire(serial_svc->buff_size_mtx, FuriWaitForever) == FuriStatusOk);
-    if(serial_svc->bytes_ready_to_receive == 0) {
-        FURI_LOG_D(TAG, "Buffer is empty. Notifying client");
-        serial_svc->bytes_ready_to_receive = serial_svc->buff_size;
-
-        uint32_t buff_size_reversed = REVERSE_BYTES_U32(serial_svc->buff_size);
-        ble_gatt_characteristic_update(
-            serial_svc->svc_handle,
-            &serial_svc->chars[SerialSvcGattCharacteristicFlowCtrl],
-            &buff_size_reversed);
-    }
-    furi_check(furi_mutex_release(serial_svc->buff_size_mtx) == FuriStatusOk);
+
+    uint32_t state = __atomic_load_n(&serial_svc->rx_state, __ATOMIC_ACQUIRE);
+    uint32_t credits;
+    do {
+        if(state & BLE_SVC_SERIAL_RX_CREDITS_MASK) {
+            // Client still has credits, it will run out of them first
+            return;
+        }
+        // A write that already took its credits may still be on its way to the buffer
+        credits = serial_svc->buff_size;
+        if(state & BLE_SVC_SERIAL_RX_FEEDING) {
+            credits -= MIN(credits / 2, BLE_SVC_SERIAL_DATA_LEN_MAX);
+        }
+    } while(!__atomic_compare_exchange_n(
+        &serial_svc->rx_state,
+        &state,
+        credits | (state & BLE_SVC_SERIAL_RX_FEEDING),
+        true,
+        __ATOMIC_ACQ_REL,
+        __ATOMIC_ACQUIRE));
+
+    FURI_LOG_D(TAG, "Buffer is empty. Notifying client");
+    uint32_t credits_reversed = REVERSE_BYTES_U32(credits);
+    ble_gatt_characteristic_update(
+        serial_svc->svc_handle,
+        &serial_svc->chars[SerialSvcGattCharacteristicFlowCtrl],
+        &credits_reversed);
 }
 
 void ble_svc_serial_stop(BleServiceSerial* serial_svc) {
@@ -219,29 +257,66 @@ void ble_svc_serial_stop(BleServiceSerial* serial_svc) {
         ble_gatt_characteristic_delete(serial_svc->svc_handle, &serial_svc->chars[i]);
     }
     ble_gatt_service_delete(serial_svc->svc_handle);
-    furi_mutex_free(serial_svc->buff_size_mtx);
+    furi_semaphore_free(serial_svc->tx_pool_sem);
     free(serial_svc);
 }
 
+/* Client configuration is read from the stack on every send: the stack restores it for
+ * a bonded client, which does not write the descriptor again, and forgets it on disconnect */
+static bool ble_svc_serial_is_tx_notify(BleServiceSerial* serial_svc) {
+    uint16_t cccd = 0;
+    uint16_t length = 0;
+    uint16_t value_length = 0;
+    tBleStatus result = aci_gatt_read_handle_value(
+        serial_svc->chars[SerialSvcGattCharacteristicTx].handle + 2,
+        0,
+        sizeof(cccd),
+        &length,
+        &value_length,
+        (uint8_t*)&cccd);
+    if(result) {
+        FURI_LOG_W(TAG, "Failed reading TX client configuration: %d", result);
+        return false;
+    }
+
+    // Notifications take precedence over indications
+    return cccd & BLE_SVC_SERIAL_TX_CCCD_NOTIFY;
+}
+
 bool ble_svc_serial_update_tx(BleServiceSerial* serial_svc, uint8_t* data, uint16_t data_len) {
     if(data_len > BLE_SVC_SERIAL_DATA_LEN_MAX) {
         return false;
     }
 
+    // Notifications are not confirmed, so several of them can be queued in the controller
+    const bool notify = ble_svc_serial_is_tx_notify(serial_svc);
+    serial_svc->tx_acknowledged = !notify;
+
     for(uint16_t remained = data_len; remained > 0;) {
         uint8_t value_len = MIN(BLE_SVC_SERIAL_CHAR_VALUE_LEN_MAX, remained);
         uint16_t value_offset = data_len - remained;
         remained -= value_len;
 
-        tBleStatus result = aci_gatt_update_char_value_ext(
-            0,
-            serial_svc->svc_handle,
-            serial_svc->chars[SerialSvcGattCharacteristicTx].handle,
-            remained ? 0x00 : 0x02,
-            data_len,
-            value_offset,
-            value_len,
-            data + value_offset);
+        tBleStatus result;
+        furi_semaphore_acquire(serial_svc->tx_pool_sem, 0);
+        while(true) {
+            result = aci_gatt_update_char_value_ext(
+                0,
+                serial_svc->svc_handle,
+                serial_svc->chars[SerialSvcGattCharacteristicTx].handle,
+                remained ? 0x00 : (notify ? 0x01 : 0x02),
+                data_len,
+                value_offset,
+                value_len,
+                data + value_offset);
+            // All controller buffers are taken, retry once some of them are transmitted
+            if(!notify || result != BLE_STATUS_INSUFFICIENT_RESOURCES) break;
+            if(furi_semaphore_acquire(
+                   serial_svc->tx_pool_sem, furi_ms_to_ticks(BLE_SVC_SERIAL_TX_POOL_TIMEOUT_MS)) !=
+               FuriStatusOk) {
+                break;
+            }
+        }
 
         if(result) {
             FURI_LOG_E(TAG, "Failed updating TX characteristic: %d", result);
@@ -252,6 +327,11 @@ bool ble_svc_serial_update_tx(BleServiceSerial* serial_svc, uint8_t* data, uint1
     return true;
 }
 
+bool ble_svc_serial_is_tx_acknowledged(BleServiceSerial* serial_svc) {
+    furi_check(serial_svc);
+    return serial_svc->tx_acknowledged;
+}
+
 void ble_svc_serial_set_rpc_active(BleServiceSerial* serial_svc, bool active) {
     furi_check(serial_svc);
     ble_svc_serial_update_rpc_char(
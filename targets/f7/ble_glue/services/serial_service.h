@@ -50,6 +50,13 @@ void ble_svc_serial_notify_buffer_is_empty(BleServiceSerial* service);
 
 bool ble_svc_serial_update_tx(BleServiceSerial* service, uint8_t* data, uint16_t data_len);
 
+/* 
+ * Whether the last TX update is an indication, to be confirmed with
+ * SerialServiceEventTypeDataSent. Notifications are not confirmed and
+ * update_tx blocks only while the controller buffers are full.
+ */
+bool ble_svc_serial_is_tx_acknowledged(BleServiceSerial* service);
+
 #ifdef __cplusplus
 }
 #endif